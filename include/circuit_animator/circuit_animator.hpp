@@ -2,6 +2,8 @@
 #define __CIRCUIT_ANIMATOR_HPP__
 
 #include "circuit_model/circuit_model.hpp"
+#include "draw_backend/draw_backend.hpp"
+#include "trace_events/trace_events.hpp"
 
 class CircuitAnimKeyFrame {
 private:
@@ -16,6 +18,14 @@ public:
   inline float getStartTime(void) const { return _start_time; }
 
   inline float getEndTime(void) const { return _end_time; }
+
+  // Whether the drawn state of the key frame may differ between prev_time
+  // and time. Everything drawn for a key frame is a function of the time
+  // clamped to [start, end], plus appearing at start and the edge head glow
+  // disappearing after end.
+  inline bool isChanging(const float prev_time, const float time) const {
+    return prev_time <= _end_time && time >= _start_time;
+  }
 };
 
 class CircuitNodeAnimKeyFrame : public CircuitAnimKeyFrame {
@@ -96,6 +106,15 @@ public:
 
   inline float getMaxRadius(void) const { return _max_radius; }
 
+  // The label glyph may stick out of the circle a bit.
+  inline Rectangle getBounds(void) const {
+    const float extent = 1.5f * _max_radius + 2.0f;
+    return {.x = _center.x - extent,
+            .y = _center.y - extent,
+            .width = 2.0f * extent,
+            .height = 2.0f * extent};
+  }
+
   inline float getCurrentRadius(const float time) const {
     const float clamped_time = Clamp(time, getStartTime(), getEndTime());
 
@@ -316,6 +335,25 @@ private:
   }
 
 public:
+  // Every segment lies in the convex hull of its end and control points,
+  // margin has to cover the stroke, the arrow head and the head glow.
+  inline Rectangle getBounds(const float margin) const {
+    Vector2 min_point = Vector2Min(_start_point, _end_point);
+    Vector2 max_point = Vector2Max(_start_point, _end_point);
+    for (const Vector2 point : _middle_points) {
+      min_point = Vector2Min(min_point, point);
+      max_point = Vector2Max(max_point, point);
+    }
+    for (const Vector2 point : _control_points) {
+      min_point = Vector2Min(min_point, point);
+      max_point = Vector2Max(max_point, point);
+    }
+    return {.x = min_point.x - margin,
+            .y = min_point.y - margin,
+            .width = max_point.x - min_point.x + 2.0f * margin,
+            .height = max_point.y - min_point.y + 2.0f * margin};
+  }
+
   inline void
   forEachBezierQuadraticPoint(const float time,
                               std::function<void(const Vector2 point)> f) {
@@ -382,12 +420,12 @@ private:
   static constexpr float EDGE_WIDTH = 4.0f;
   static constexpr Color EDGE_COLOR = BLACK;
   static constexpr float ANIM_END_DELAY = 30.0f;
+  static constexpr float HEAD_GLOW_RADIUS = 100.0f;
 
   const CircuitModel &_circuit;
   const Vector2 _screen_resolution;
   const Color _screen_background_color;
   const float _fps;
-  const Font _font;
 
   std::vector<CircuitNodeAnimKeyFrame> _node_animation_frames;
   std::vector<CircuitEdgeAnimKeyFrame *> _edge_animation_frames;
@@ -422,7 +460,6 @@ public:
                   const float start_time)
       : _circuit(circuit), _screen_resolution(screen_resolution),
         _screen_background_color(screen_background_color), _fps(fps),
-        _font(LoadFont("./resources/DotGothic16-Regular.ttf")),
         _animation_start_time(start_time) {
 
     _node_anim_frame_indices.resize(_circuit.getNodeCount(), 0);
@@ -430,13 +467,14 @@ public:
     finalizeLayout();
   }
 
-  inline bool updateCircuitAnimation(const float time) const {
+  inline bool updateCircuitAnimation(const float time,
+                                     DrawBackend &backend) const {
     for (size_t i = 0; i < _edge_animation_frames.size(); i++) {
       Vector2 curr_head_point;
       if (_edge_animation_frames[i]->getCurrentHeadPoint(time,
                                                          curr_head_point)) {
-        DrawCircleGradient(curr_head_point.x, curr_head_point.y, 100.0f, WHITE,
-                           Fade(_screen_background_color, 0.0f));
+        backend.drawCircleGradient(curr_head_point, HEAD_GLOW_RADIUS, WHITE,
+                                   Fade(_screen_background_color, 0.0f));
       }
     }
 
@@ -446,12 +484,12 @@ public:
       _edge_animation_frames[i]->forEachBezierQuadraticPoint(
           time, [&](const Vector2 point) { points.push_back(point); });
 
-      DrawSplineBezierQuadratic(&points[0], points.size(), EDGE_WIDTH,
-                                EDGE_COLOR);
+      backend.drawSplineBezierQuadratic(&points[0], points.size(), EDGE_WIDTH,
+                                        EDGE_COLOR);
 
       Vector2 v1, v2, v3;
       if (_edge_animation_frames[i]->getArrowPoints(time, v1, v2, v3)) {
-        DrawTriangle(v1, v2, v3, EDGE_COLOR);
+        backend.drawTriangle(v1, v2, v3, EDGE_COLOR);
       }
     }
 
@@ -460,15 +498,15 @@ public:
       const Vector2 center = node_anim_frame.getCenter();
       const Color outer_color = node_anim_frame.getOuterColor();
       const Color inner_color = node_anim_frame.getInnerColor();
-      DrawCircleGradient(center.x, center.y, radius, inner_color, outer_color);
-      DrawCircleLinesV(center, radius, RAYWHITE);
+      backend.drawCircleGradient(center, radius, inner_color, outer_color);
+      backend.drawCircleLines(center, radius, RAYWHITE);
 
       const char label_codepoint = node_anim_frame.getLabelCodepoint();
       const float label_size = node_anim_frame.getLabelCurrentSize(time);
       const Vector2 label_position =
           node_anim_frame.getLabelCurrentPosition(time);
-      DrawTextCodepoint(_font, label_codepoint, label_position, label_size,
-                        BLACK);
+      backend.drawTextCodepoint(label_codepoint, label_position, label_size,
+                                BLACK);
     }
 
     if (time > _animation_end_time) {
@@ -478,7 +516,32 @@ public:
     return true;
   }
 
+  inline float getAnimationStartTime(void) const {
+    return _animation_start_time;
+  }
+
   inline float getAnimationEndTime(void) const { return _animation_end_time; }
+
+  // One full levelized traversal of the circuit.
+  uint32_t getLayerCount(void) const;
+
+  // Appends the screen regions whose content may differ between the frames
+  // drawn at prev_time and time. Nothing appended means the frame at time is
+  // identical to the one at prev_time.
+  inline void collectDamage(const float prev_time, const float time,
+                            std::vector<Rectangle> &damage) const {
+    for (const auto &node_anim_frame : _node_animation_frames) {
+      if (node_anim_frame.isChanging(prev_time, time)) {
+        damage.push_back(node_anim_frame.getBounds());
+      }
+    }
+
+    for (const auto edge_anim_frame : _edge_animation_frames) {
+      if (edge_anim_frame->isChanging(prev_time, time)) {
+        damage.push_back(edge_anim_frame->getBounds(HEAD_GLOW_RADIUS + 1.0f));
+      }
+    }
+  }
 };
 
 #endif // __CIRCUIT_ANIMATOR_HPP__
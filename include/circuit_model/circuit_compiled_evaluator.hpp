@@ -0,0 +1,69 @@
+#ifndef __CIRCUIT_COMPILED_EVALUATOR_HPP__
+#define __CIRCUIT_COMPILED_EVALUATOR_HPP__
+
+#include "circuit_model/circuit_model.hpp"
+#include "native_kernel/native_kernel.hpp"
+
+// extern "C" function of the generated source. Inputs and outputs are the
+// InputNodeType and OutputNodeType nodes in index order, values is room for
+// one word per node.
+typedef void (*CircuitKernelFunction)(const uint32_t *inputs,
+                                      uint32_t *outputs, uint32_t *values);
+
+// Straight-line C++ for model in layer order, in functions of
+// KERNEL_CHUNK_NODES nodes: one word of values per node, adders and
+// multipliers over their fanins with parallel edges counted, in 32 bit
+// wrapping arithmetic, outputs the sum of their fanins. Fails when a
+// node is not reachable from the inputs and constants, on a cycle or behind
+// one.
+bool generateCircuitKernelSource(const CircuitModel &model,
+                                 const char *symbol, std::string &source);
+
+// Evaluates model through native code, see NativeKernel.
+class CircuitCompiledEvaluator {
+private:
+  static constexpr const char *SYMBOL = "circuit_kernel";
+
+  NativeKernel _kernel;
+  CircuitKernelFunction _function;
+  std::vector<uint32_t> _inputs;
+  std::vector<uint32_t> _outputs;
+  std::vector<uint32_t> _values;
+
+  static std::string getSource(const CircuitModel &model);
+
+public:
+  CircuitCompiledEvaluator(void) = delete;
+  CircuitCompiledEvaluator(const CircuitCompiledEvaluator &) = delete;
+  const CircuitCompiledEvaluator &
+  operator=(const CircuitCompiledEvaluator &) = delete;
+
+  CircuitCompiledEvaluator(const CircuitModel &model, const char *cache_dir);
+
+  // False when generating, compiling or loading failed; evaluate() must not
+  // be called then.
+  inline bool isLoaded(void) const { return _kernel.isLoaded(); }
+
+  inline bool wasCached(void) const { return _kernel.wasCached(); }
+
+  inline uint32_t getInputCount(void) const { return _inputs.size(); }
+
+  inline uint32_t getOutputCount(void) const { return _outputs.size(); }
+
+  inline void setInput(const uint32_t input, const uint32_t value) {
+    assert(input < getInputCount());
+    _inputs[input] = value;
+  }
+
+  inline void evaluate(void) {
+    assert(isLoaded());
+    _function(_inputs.data(), _outputs.data(), _values.data());
+  }
+
+  inline uint32_t getOutput(const uint32_t output) const {
+    assert(output < getOutputCount());
+    return _outputs[output];
+  }
+};
+
+#endif // __CIRCUIT_COMPILED_EVALUATOR_HPP__
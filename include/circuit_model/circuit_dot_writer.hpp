@@ -0,0 +1,74 @@
+#ifndef __CIRCUIT_DOT_WRITER_HPP__
+#define __CIRCUIT_DOT_WRITER_HPP__
+
+#include "circuit_model/circuit_model.hpp"
+
+// Streams a CircuitModel as a GraphViz digraph: one line per node, one per
+// edge (parallel edges are repeated), written through a fixed size buffer
+// so memory does not grow with the circuit.
+//
+// With rank_layers every layer of CircuitModel::computeLayers() becomes a
+// "rank=same" group, dot then keeps the animator's layering instead of
+// ranking the graph itself.
+class CircuitDotWriter {
+private:
+  static constexpr size_t BUFFER_SIZE = 1 << 16;
+  // Longest single write into the buffer: a node or edge line.
+  static constexpr size_t MAX_LINE_SIZE = 128;
+
+  FILE *_file;
+  char *_buffer;
+  size_t _used;
+  bool _failed;
+
+  inline void reserve(const size_t size) {
+    if (_used + size > BUFFER_SIZE) {
+      flush();
+    }
+  }
+
+  inline void append(const char *string, const size_t length) {
+    memcpy(_buffer + _used, string, length);
+    _used += length;
+  }
+
+  inline void append(const char *string) { append(string, strlen(string)); }
+
+  inline void appendNodeId(const uint32_t index) {
+    char digits[16];
+    size_t length = 0;
+    uint32_t value = index;
+    do {
+      digits[length++] = '0' + value % 10;
+      value /= 10;
+    } while (value != 0);
+
+    _buffer[_used++] = 'n';
+    while (length > 0) {
+      _buffer[_used++] = digits[--length];
+    }
+  }
+
+  void flush(void);
+
+  void writeNode(const CircuitNode &node);
+
+  void writeLayerGroups(const CircuitModel &circuit);
+
+public:
+  CircuitDotWriter(void) = delete;
+  CircuitDotWriter(const CircuitDotWriter &) = delete;
+  const CircuitDotWriter &operator=(const CircuitDotWriter &) = delete;
+
+  CircuitDotWriter(FILE *file);
+
+  ~CircuitDotWriter(void);
+
+  // Returns false when writing failed, the file is not closed.
+  bool write(const CircuitModel &circuit, const bool rank_layers);
+
+  static bool writeFile(const CircuitModel &circuit, const char *path,
+                        const bool rank_layers);
+};
+
+#endif // __CIRCUIT_DOT_WRITER_HPP__
@@ -35,22 +35,14 @@ public:
   inline CircuitNodeType getType(void) const { return _type; }
   inline uint32_t getValue(void) const { return _value; }
 
-  inline void addFanout(const uint32_t sink) {
-    if (!_fanout_nodes.contains(sink)) {
-      _fanout_nodes[sink] = 1;
-    } else {
-      _fanout_nodes[sink]++;
-    }
-    _fanout_count++;
+  inline void addFanout(const uint32_t sink, const uint32_t count = 1) {
+    _fanout_nodes[sink] += count;
+    _fanout_count += count;
   }
 
-  inline void addFanin(const uint32_t source) {
-    if (!_fanin_nodes.contains(source)) {
-      _fanin_nodes[source] = 1;
-    } else {
-      _fanin_nodes[source]++;
-    }
-    _fanin_count++;
+  inline void addFanin(const uint32_t source, const uint32_t count = 1) {
+    _fanin_nodes[source] += count;
+    _fanin_count += count;
   }
 
   inline void forEachFanout(
@@ -103,6 +95,19 @@ public:
     circuit_nodes[sink].addFanin(source);
   }
 
+  // count parallel edges from source to sink in one step.
+  inline void addEdges(const uint32_t source, const uint32_t sink,
+                       const uint32_t count) {
+    assert(count > 0);
+    circuit_nodes[source].addFanout(sink, count);
+    circuit_nodes[sink].addFanin(source, count);
+  }
+
+  // Bulk builders call this first, so adding nodes never reallocates.
+  inline void reserveNodes(const uint32_t count) {
+    circuit_nodes.reserve(count);
+  }
+
   inline uint32_t getNodeCount(void) const { return circuit_nodes.size(); }
 
   inline const CircuitNode &getNode(const uint32_t index) const {
@@ -110,6 +115,15 @@ public:
     return circuit_nodes[index];
   }
 
+  static constexpr uint32_t UNREACHED_LAYER = UINT32_MAX;
+
+  // Layer of every node, the same the circuit animator lays them out in:
+  // inputs are layer 0, constants layer 1 and every other node sits one
+  // layer below its deepest fanin (and below the constants). Nodes not
+  // reachable from an input or constant get UNREACHED_LAYER. Returns the
+  // layer count.
+  uint32_t computeLayers(std::vector<uint32_t> &layers) const;
+
   inline void
   forEachNode(std::function<IteratorStatus(const CircuitNode &)> f) const {
     for (uint32_t i = 0; i < circuit_nodes.size(); i++) {
@@ -1,9 +1,46 @@
 #ifndef __CIRCUIT_MODEL_SELF_TEST_HPP__
 #define __CIRCUIT_MODEL_SELF_TEST_HPP__
 
+#include "circuit_model/circuit_compiled_evaluator.hpp"
+#include "circuit_model/circuit_dot_writer.hpp"
+#include "circuit_model/circuit_simplify.hpp"
+#include "circuit_model/netlist_reader.hpp"
+#include "circuit_model/random_circuit.hpp"
+
 class CircuitModelSelfTest {
+private:
+  uint64_t _random_state;
+  uint32_t _failure_count;
+
+  uint64_t nextRandom(void);
+
+  void check(const bool condition, const char *what);
+
+  RandomCircuitParameters getCircuitParameters(const uint32_t node_count);
+
+  void testCompiled(const uint32_t node_count);
+
+  void checkSimplified(const CircuitModel &model, CircuitModel &simplified,
+                       std::vector<uint32_t> &new_indices,
+                       std::vector<uint32_t> &original_indices);
+
+  void testSimplify(const uint32_t node_count);
+
+  void testSimplifyCases(void);
+
+  void testNetlistCases(void);
+
+  void testNetlistChunks(void);
+
+  void testLayersAndDot(void);
+
+  void testDot(const uint32_t node_count);
+
 public:
-  void selfTest(void);
+  CircuitModelSelfTest(void) : _random_state(0x5eed), _failure_count(0) {}
+
+  // Returns false when any check failed, failures are printed to stderr.
+  bool selfTest(void);
 };
 
 #endif // __CIRCUIT_MODEL_SELF_TEST_HPP__
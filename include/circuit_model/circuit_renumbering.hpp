@@ -0,0 +1,25 @@
+#ifndef __CIRCUIT_RENUMBERING_HPP__
+#define __CIRCUIT_RENUMBERING_HPP__
+
+#include "circuit_model/circuit_model.hpp"
+#include "node_order/node_order.hpp"
+
+// Cache the statistics are estimated for, about an L2 per core.
+static constexpr uint32_t CIRCUIT_ORDER_CACHE_SIZE = 1 << 18;
+
+// Copies model into renumbered with its nodes in the order of type, so
+// fanins sit closer to their sinks. Inputs and constants have no fanins and
+// keep their relative order; new_indices receives the new index of every
+// old node. Parallel edges stay parallel edges.
+void renumberCircuitModel(const CircuitModel &model, const NodeOrderType type,
+                          CircuitModel &renumbered,
+                          std::vector<uint32_t> &new_indices);
+
+// Edge span and estimated misses of a sweep over the CircuitNodes reading
+// every fanin, renumbered by new_indices unless it is empty. A parallel
+// edge counts once.
+void computeCircuitNodeOrderStats(const CircuitModel &model,
+                                  const std::vector<uint32_t> &new_indices,
+                                  NodeOrderStats &stats);
+
+#endif // __CIRCUIT_RENUMBERING_HPP__
@@ -0,0 +1,32 @@
+#ifndef __CIRCUIT_SIMPLIFY_HPP__
+#define __CIRCUIT_SIMPLIFY_HPP__
+
+#include "circuit_model/circuit_model.hpp"
+
+static constexpr uint32_t REMOVED_CIRCUIT_NODE = UINT32_MAX;
+// Original index of a constant the simplification made up.
+static constexpr uint32_t NEW_CIRCUIT_NODE = UINT32_MAX;
+
+// Copies model into simplified without what cannot change an output.
+// Adders and multipliers sum and multiply their fanins, parallel edges
+// counted, in 32 bit wrapping arithmetic, and outputs pass their fanin on:
+//
+// - a gate whose fanins are all constant becomes a constant, a multiplier
+//   with a 0 fanin too;
+// - the constant fanins of any other gate merge into one, which is left out
+//   when it is 0 for an adder or 1 for a multiplier;
+// - a gate left with a single fanin over a single edge is replaced by it.
+//
+// Of what remains only nodes with a path to an output are kept, and every
+// input. A circuit without outputs keeps what reaches a node without
+// fanouts instead.
+//
+// new_indices receives for every node of model the node of simplified with
+// the same value, REMOVED_CIRCUIT_NODE when there is none, and
+// original_indices the node of model every node of simplified was made from,
+// NEW_CIRCUIT_NODE for merged constants.
+void simplifyCircuitModel(const CircuitModel &model, CircuitModel &simplified,
+                          std::vector<uint32_t> &new_indices,
+                          std::vector<uint32_t> &original_indices);
+
+#endif // __CIRCUIT_SIMPLIFY_HPP__
@@ -0,0 +1,85 @@
+#ifndef __NETLIST_READER_HPP__
+#define __NETLIST_READER_HPP__
+
+#include "circuit_model/circuit_model.hpp"
+#include "worker_pool/worker_pool.hpp"
+
+// Reads circuits from a plain text netlist, one record per line:
+//
+//   # comment
+//   N <index> <type> <value>         node, type is one of A (adder),
+//                                    M (multiplier), C (constant),
+//                                    I (input), O (output)
+//   E <source> <sink> [<count>]      count parallel edges, 1 if left out
+//
+// Node indices have to be 0 to node count - 1, each used once, in any
+// order; lines may come in any order too.
+//
+// The file is mapped, not read. It is cut into chunks at line boundaries and
+// parsed in two parallel passes: the first counts the node and edge lines
+// of every chunk, so the second can parse each chunk straight into its slot
+// of presized record arrays. Only filling the CircuitModel is serial.
+class NetlistReader {
+private:
+  // Chunks per thread, evens out chunks with many comments or long lines.
+  static constexpr uint32_t CHUNKS_PER_THREAD = 4;
+  static constexpr size_t MIN_CHUNK_SIZE = 1 << 20;
+
+  struct NodeRecord {
+    uint32_t index;
+    CircuitNodeType type;
+    uint32_t value;
+  };
+
+  struct EdgeRecord {
+    uint32_t source;
+    uint32_t sink;
+    uint32_t count;
+  };
+
+  struct Chunk {
+    const char *begin;
+    const char *end;
+    uint64_t node_count;
+    uint64_t edge_count;
+    uint64_t line_count;
+    // Offsets into the record arrays and the line the chunk starts at.
+    uint64_t first_node;
+    uint64_t first_edge;
+    uint64_t first_line;
+    // First error in the chunk, error_line is 0 for none.
+    uint64_t error_line;
+    const char *error;
+  };
+
+  WorkerPool _pool;
+  uint64_t _error_line;
+  std::vector<NodeRecord> _nodes;
+  std::vector<EdgeRecord> _edges;
+
+  static void countLines(Chunk &chunk);
+
+  void parseLines(Chunk &chunk);
+
+  bool parse(const char *path, const char *data, const size_t size);
+
+  bool buildCircuit(const char *path, CircuitModel &circuit);
+
+public:
+  NetlistReader(void) = delete;
+  NetlistReader(const NetlistReader &) = delete;
+  const NetlistReader &operator=(const NetlistReader &) = delete;
+
+  // thread_count == 0 picks one thread per hardware thread.
+  NetlistReader(const uint32_t thread_count)
+      : _pool(thread_count), _error_line(0) {}
+
+  // circuit has to be empty. Errors are logged with their line number.
+  bool read(const char *path, CircuitModel &circuit);
+
+  // Line of the record that failed the last read(), 0 when it did not fail
+  // on a line: a node defined twice, an index out of range and the like.
+  inline uint64_t getErrorLine(void) const { return _error_line; }
+};
+
+#endif // __NETLIST_READER_HPP__
@@ -0,0 +1,73 @@
+#ifndef __RANDOM_CIRCUIT_HPP__
+#define __RANDOM_CIRCUIT_HPP__
+
+#include "circuit_model/circuit_model.hpp"
+
+enum FaninDistribution : uint8_t {
+  FirstFaninDistribution = 0,
+  FaninUniform = FirstFaninDistribution,
+  // min_fanin, then one more fanin at a time until a draw below
+  // fanin_geometric_p or max_fanin, most gates end up with few fanins.
+  FaninGeometric,
+  LastFaninDistribution = FaninGeometric
+};
+
+struct RandomCircuitParameters {
+  uint64_t seed;
+  // All nodes, inputs, constants and outputs included.
+  uint32_t node_count;
+  // Gate layers between the inputs and the outputs.
+  uint32_t depth;
+  uint32_t input_count;
+  uint32_t output_count;
+  uint32_t min_fanin;
+  uint32_t max_fanin;
+  FaninDistribution fanin_distribution;
+  float fanin_geometric_p;
+  // Chance that a fanin is a double edge instead of a single one.
+  float multi_edge_rate;
+  // Share of node_count that are constants.
+  float constant_ratio;
+};
+
+// Roughly square circuit of node_count nodes: depth ~ sqrt(node_count), two
+// fanins per gate on average.
+static inline RandomCircuitParameters
+getDefaultRandomCircuitParameters(const uint32_t node_count,
+                                  const uint64_t seed) {
+  const uint32_t depth = std::max(1u, static_cast<uint32_t>(sqrtf(node_count)));
+  return {.seed = seed,
+          .node_count = node_count,
+          .depth = depth,
+          .input_count = std::max(1u, node_count / (4 * depth)),
+          .output_count = std::max(1u, node_count / (4 * depth)),
+          .min_fanin = 1,
+          .max_fanin = 4,
+          .fanin_distribution = FaninGeometric,
+          .fanin_geometric_p = 0.5f,
+          .multi_edge_rate = 0.05f,
+          .constant_ratio = 0.05f};
+}
+
+// Layered DAG built from the parameters alone: the same parameters give the
+// same circuit on every machine and with every standard library, the
+// generator does not use <random>.
+//
+// Inputs and constants come first and outputs last. Every gate of gate
+// layer l takes its first fanin from gate layer l - 1 (the sources for
+// l = 0) and the others from anything earlier, so levelization keeps the
+// gate layers apart: the animator lays out depth + 3 layers, inputs and
+// constants get one each. Constants get values 0 to 9, the animator labels
+// them with one digit.
+class RandomCircuit : public CircuitModel {
+private:
+  void createCircuit(const RandomCircuitParameters &parameters);
+
+public:
+  RandomCircuit(void) = delete;
+  RandomCircuit(const RandomCircuitParameters &parameters) {
+    createCircuit(parameters);
+  }
+};
+
+#endif // __RANDOM_CIRCUIT_HPP__
@@ -2,6 +2,10 @@
 #define __CIRCUIT_SOLVER_HPP__
 
 #include "circuit_animator/circuit_animator.hpp"
+#include "ffmpeg_rendering/yuv420_converter.hpp"
+#include "frame_sink/image_sequence_frame_sink.hpp"
+#include "render_profiler/render_profiler.hpp"
+#include "software_rasterizer/software_rasterizer.hpp"
 
 class ExampleCircuit001 : public CircuitModel {
 private:
@@ -58,12 +62,23 @@ private:
   static constexpr float SCREEN_FPS = 120;
   static constexpr Rectangle SCREEN_RECT = {
       .x = 0, .y = 0, .width = SCREEN_WIDTH, .height = SCREEN_HEIGHT};
+  static constexpr const char *VIDEO_OUTPUT_PATH = "output.mp4";
+  // Headless exports are encoded in segments of this many frames, a crashed
+  // export resumes at the first segment that was not finished.
+  static constexpr uint64_t EXPORT_SEGMENT_FRAMES = 1200;
+  static constexpr uint32_t IMAGE_SEQUENCE_IN_FLIGHT_FRAMES = 8;
 
   std::vector<CircuitModel *> _circuits;
 
   std::vector<CircuitAnimator> _animators;
   size_t _current_animator;
 
+  FFMPEGPipeFormat _video_pipe_format;
+  std::string _image_sequence_pattern;
+  ImageSequenceFormat _image_sequence_format;
+  std::string _render_profile_path;
+  std::string _trace_path;
+
   void addOneCircuitToAnimate(CircuitModel *circuit);
 
   void stackCircuitsToAnimate(void);
@@ -76,16 +91,82 @@ private:
     return ColorFromHSV(162, 0.33f, 0.93f);
   }
 
-  void drawVideoBackground(const bool use_mp);
+  void drawVideoBackground(const bool use_mp, DrawBackend &backend) const;
+
+  inline bool drawCircuits(const float time, DrawBackend &backend);
+
+  // Screen regions that differ between the frames at prev_time and time.
+  // Returns false when the whole frame has to be redrawn, which is the case
+  // when the next circuit takes over.
+  inline bool collectDamage(const float prev_time, const float time,
+                            std::vector<Rectangle> &damage) const;
+
+  // The animator whose [start, end) window contains time, NULL past the end
+  // of the last one.
+  inline const CircuitAnimator *findAnimator(const float time) const;
+
+  inline uint64_t getFrameCount(void) const;
+
+  // The image sequence when one was requested, else NULL. One serves every
+  // segment of an export, so its encoder threads are only started once.
+  FrameSink *createImageSequenceSink(void) const;
+
+  // The converter of _video_pipe_format, NULL when it needs none. One serves
+  // every segment of an export, like the image sequence.
+  YUV420Converter *createVideoConverter(void) const;
+
+  // The video, plus image_sequence unless it is NULL. The caller keeps
+  // owning image_sequence and converter.
+  FrameSink *createFrameSink(const char *video_path, FrameSink *image_sequence,
+                             YUV420Converter *converter) const;
+
+  void reportRenderProfile(const RenderProfiler &profiler) const;
 
-  inline bool drawCircuits(const float time);
+  void writeTrace(void) const;
 
 public:
-  CircuitSolver(void) : _current_animator(0) {}
+  CircuitSolver(void)
+      : _current_animator(0), _video_pipe_format(FFMPEG_PIPE_YUV420P),
+        _image_sequence_format(ImageSequenceQOI) {}
+
+  // Frames go into the ffmpeg pipe as I420, converted on our side, unless
+  // this sets FFMPEG_PIPE_RGBA, which leaves the conversion to ffmpeg.
+  inline void setVideoPipeFormat(const FFMPEGPipeFormat pipe_format) {
+    _video_pipe_format = pipe_format;
+  }
+
+  // Video exports additionally write every frame as an image, path_pattern
+  // takes the frame index, e.g. "frames/frame_%06lu.qoi".
+  inline void exportImageSequence(const char *path_pattern,
+                                  const ImageSequenceFormat format) {
+    _image_sequence_pattern = path_pattern;
+    _image_sequence_format = format;
+  }
+
+  // Exports always print their per stage timings, this additionally writes
+  // them as JSON.
+  inline void dumpRenderProfile(const char *json_path) {
+    _render_profile_path = json_path;
+  }
+
+  // Records the given TraceCategory bits and writes them as a Chrome trace
+  // once solve() or an export is done.
+  inline void recordTrace(const char *json_path, const uint32_t categories) {
+    _trace_path = json_path;
+    TraceEvents::enableCategories(categories);
+  }
 
   void solve(void);
 
   void render_video(void);
+
+  // Draws the frame at time independent of any frame drawn before. Returns
+  // false when time is past the end of the last circuit.
+  bool renderFrameAt(const float time, DrawBackend &backend) const;
+
+  // Same output as render_video() but drawn by the CPU rasterizer, needs
+  // neither a display nor a GL context.
+  void render_video_headless(void);
 };
 
 #endif // __CIRCUIT_SOLVER_HPP__
@@ -0,0 +1,39 @@
+#ifndef __CPU_DISPATCH_HPP__
+#define __CPU_DISPATCH_HPP__
+
+#include "standard_defs/standard_defs.hpp"
+
+// Instruction set levels the SIMD kernels are compiled for. Everything else
+// is built for the oldest one, and each kernel picks its variant with
+// getCpuLevel() on every call or at construction, so one binary runs on any
+// of these machines and uses what it finds.
+enum CpuLevel : uint8_t {
+  FirstCpuLevel = 0,
+  // x86-64-v2, the build baseline: SSE4.2, SSSE3, POPCNT.
+  CpuLevelSse42 = FirstCpuLevel,
+  // Haswell and later: AVX2 and FMA, TRY_TARGET_AVX2.
+  CpuLevelAvx2,
+  // Skylake-SP and later: AVX-512 F, BW, DQ and VL, TRY_TARGET_AVX512.
+  CpuLevelAvx512,
+  LastCpuLevel
+};
+
+// What CPUID and the OS report, independent of any limit.
+CpuLevel getDetectedCpuLevel(void);
+
+// The level kernels should use: the detected one, lowered by
+// $CIRCUIT_CPU_LEVEL or setCpuLevelLimit(). Cheap enough for every call.
+CpuLevel getCpuLevel(void);
+
+// Forces kernels down to at most level, for benchmarks and tests comparing
+// variants; a limit above the detected level has no effect and LastCpuLevel
+// lifts it. Kernels that choose at construction only see it in objects
+// constructed afterwards.
+void setCpuLevelLimit(const CpuLevel level);
+
+const char *getCpuLevelName(const CpuLevel level);
+
+// Accepts the names of getCpuLevelName(), false for anything else.
+bool parseCpuLevel(const char *name, CpuLevel &level);
+
+#endif // __CPU_DISPATCH_HPP__
@@ -0,0 +1,76 @@
+#ifndef __DRAW_BACKEND_HPP__
+#define __DRAW_BACKEND_HPP__
+
+#include "standard_defs/standard_defs.hpp"
+
+// Draw primitives used by the circuit animator and the video background.
+// RaylibDrawBackend forwards them to raylib (needs a window and a GL
+// context), SoftwareRasterizer draws them into a plain RGBA buffer.
+class DrawBackend {
+public:
+  virtual ~DrawBackend(void) {}
+
+  virtual void clearBackground(const Color color) = 0;
+
+  virtual void drawRectangleGradientV(const Rectangle rect, const Color top,
+                                      const Color bottom) = 0;
+
+  virtual void drawRectangleLines(const Rectangle rect, const float thick,
+                                  const Color color) = 0;
+
+  virtual void drawCircleGradient(const Vector2 center, const float radius,
+                                  const Color inner, const Color outer) = 0;
+
+  virtual void drawCircleLines(const Vector2 center, const float radius,
+                               const Color color) = 0;
+
+  virtual void drawSplineBezierQuadratic(const Vector2 *points,
+                                         const size_t point_count,
+                                         const float thick,
+                                         const Color color) = 0;
+
+  virtual void drawTriangle(const Vector2 v1, const Vector2 v2,
+                            const Vector2 v3, const Color color) = 0;
+
+  virtual void drawTextCodepoint(const int codepoint, const Vector2 position,
+                                 const float font_size, const Color color) = 0;
+};
+
+class RaylibDrawBackend : public DrawBackend {
+private:
+  const Font _font;
+
+public:
+  static constexpr const char *FONT_PATH =
+      "./resources/DotGothic16-Regular.ttf";
+
+  RaylibDrawBackend(void) : _font(LoadFont(FONT_PATH)) {}
+
+  ~RaylibDrawBackend(void) { UnloadFont(_font); }
+
+  void clearBackground(const Color color) override;
+
+  void drawRectangleGradientV(const Rectangle rect, const Color top,
+                              const Color bottom) override;
+
+  void drawRectangleLines(const Rectangle rect, const float thick,
+                          const Color color) override;
+
+  void drawCircleGradient(const Vector2 center, const float radius,
+                          const Color inner, const Color outer) override;
+
+  void drawCircleLines(const Vector2 center, const float radius,
+                       const Color color) override;
+
+  void drawSplineBezierQuadratic(const Vector2 *points,
+                                 const size_t point_count, const float thick,
+                                 const Color color) override;
+
+  void drawTriangle(const Vector2 v1, const Vector2 v2, const Vector2 v3,
+                    const Color color) override;
+
+  void drawTextCodepoint(const int codepoint, const Vector2 position,
+                         const float font_size, const Color color) override;
+};
+
+#endif // __DRAW_BACKEND_HPP__
@@ -5,11 +5,35 @@
 #include <stddef.h>
 
 typedef struct FFMPEG FFMPEG;
+class YUV420Converter;
 
+// Format of the frames written into the ffmpeg pipe. Frames are always passed
+// in as RGBA, with FFMPEG_PIPE_YUV420P they are converted to I420 on our side
+// first, which is 12 instead of 32 bits per pixel through the pipe.
+typedef enum {
+  FFMPEG_PIPE_RGBA,
+  FFMPEG_PIPE_YUV420P,
+} FFMPEGPipeFormat;
+
+// FFMPEG_PIPE_YUV420P frames are converted by converter, which stays the
+// caller's: one converter serves every ffmpeg of an export, so its threads
+// are started once. It is not used with FFMPEG_PIPE_RGBA and may be NULL.
 FFMPEG *ffmpeg_start_rendering(const char *output_path, size_t width,
-                               size_t height, size_t fps);
-bool ffmpeg_send_frame_flipped(FFMPEG *ffmpeg, void *data, size_t width,
+                               size_t height, size_t fps,
+                               FFMPEGPipeFormat pipe_format,
+                               YUV420Converter *converter);
+bool ffmpeg_send_frame_flipped(FFMPEG *ffmpeg, const void *data, size_t width,
                                size_t height);
+// With FFMPEG_PIPE_RGBA data is written as it is, not copied, and repeated
+// from there by ffmpeg_send_previous_frame(): it has to stay unchanged until
+// the next frame is sent.
+bool ffmpeg_send_frame(FFMPEG *ffmpeg, const void *data, size_t width,
+                       size_t height);
+// Writes the last frame sent once more, for frames known to be identical.
+bool ffmpeg_send_previous_frame(FFMPEG *ffmpeg);
 bool ffmpeg_end_rendering(FFMPEG *ffmpeg, bool cancel);
+// Joins the videos listed in an ffmpeg concat demuxer file without
+// re-encoding.
+bool ffmpeg_concat_files(const char *list_path, const char *output_path);
 
 #endif // FFMPEG_H_
@@ -0,0 +1,37 @@
+#ifndef __YUV420_CONVERTER_HPP__
+#define __YUV420_CONVERTER_HPP__
+
+#include "worker_pool/worker_pool.hpp"
+
+// RGBA8 to planar I420 (BT.601, limited range), the layout ffmpeg reads as
+// -pix_fmt yuv420p: a full resolution Y plane followed by the U and V planes
+// at half resolution in both directions. Chroma is the average of each 2x2
+// block. flip reads the source rows bottom-up, as glReadPixels returns them.
+// An odd width or height rounds the chroma planes up, the blocks of the last
+// column or row repeat its pixels, as ffmpeg sizes yuv420p planes.
+class YUV420Converter {
+private:
+  static constexpr size_t ROW_PAIRS_PER_TASK = 16;
+
+  WorkerPool _pool;
+
+public:
+  YUV420Converter(void) = delete;
+
+  // thread_count == 0 picks one thread per hardware thread.
+  YUV420Converter(const uint32_t thread_count) : _pool(thread_count) {}
+
+  static inline size_t getFrameSize(const size_t width, const size_t height) {
+    return width * height + 2 * (((width + 1) / 2) * ((height + 1) / 2));
+  }
+
+  void convert(const void *rgba, const size_t width, const size_t height,
+               const bool flip, uint8_t *yuv);
+
+  static void convertRowPairs(const uint32_t *rgba, const size_t width,
+                              const size_t height, const bool flip,
+                              uint8_t *yuv, const size_t first_row_pair,
+                              const size_t last_row_pair);
+};
+
+#endif // __YUV420_CONVERTER_HPP__
@@ -0,0 +1,25 @@
+#ifndef __YUV420_CONVERTER_SELF_TEST_HPP__
+#define __YUV420_CONVERTER_SELF_TEST_HPP__
+
+#include "ffmpeg_rendering/yuv420_converter.hpp"
+
+class YUV420ConverterSelfTest {
+private:
+  uint64_t _random_state;
+  uint32_t _failure_count;
+
+  uint64_t nextRandom(void);
+
+  void check(const bool condition, const char *what);
+
+  void testFrame(YUV420Converter &converter, const size_t width,
+                 const size_t height);
+
+public:
+  YUV420ConverterSelfTest(void) : _random_state(0x5eed), _failure_count(0) {}
+
+  // Returns false when any check failed, failures are printed to stderr.
+  bool selfTest(void);
+};
+
+#endif // __YUV420_CONVERTER_SELF_TEST_HPP__
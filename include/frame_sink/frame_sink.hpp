@@ -0,0 +1,95 @@
+#ifndef __FRAME_SINK_HPP__
+#define __FRAME_SINK_HPP__
+
+#include "ffmpeg_rendering/ffmpeg.hpp"
+#include "standard_defs/standard_defs.hpp"
+#include "trace_events/trace_events.hpp"
+
+// Destination of rendered frames. Frames are RGBA8 of the size the sink was
+// created with, top-down unless flipped is set (GL readback is bottom-up).
+// Frame indices passed in are strictly increasing.
+class FrameSink {
+public:
+  virtual ~FrameSink(void) {}
+
+  virtual bool sendFrame(const uint64_t frame_index, const void *rgba,
+                         const bool flipped) = 0;
+
+  // The frame at frame_index is identical to the last one sent.
+  virtual bool sendDuplicateFrame(const uint64_t frame_index) = 0;
+
+  // Waits for everything sent to be written out. cancel drops what is not
+  // written yet.
+  virtual bool finish(const bool cancel) = 0;
+};
+
+// Frames that are not flipped go into the pipe from rgba as they are, with
+// FFMPEG_PIPE_RGBA they are also repeated from there by
+// sendDuplicateFrame(), so rgba has to stay unchanged until the next
+// sendFrame(). The software rasterizer's pixels do.
+class FFMPEGFrameSink : public FrameSink {
+private:
+  FFMPEG *_ffmpeg;
+  const size_t _width;
+  const size_t _height;
+
+public:
+  FFMPEGFrameSink(void) = delete;
+  FFMPEGFrameSink(const FFMPEGFrameSink &) = delete;
+  const FFMPEGFrameSink &operator=(const FFMPEGFrameSink &) = delete;
+
+  // Takes over an ffmpeg started with ffmpeg_start_rendering().
+  FFMPEGFrameSink(FFMPEG *ffmpeg, const size_t width, const size_t height)
+      : _ffmpeg(ffmpeg), _width(width), _height(height) {
+    assert(ffmpeg != NULL);
+  }
+
+  ~FFMPEGFrameSink(void) {
+    if (_ffmpeg != NULL) {
+      ffmpeg_end_rendering(_ffmpeg, true);
+    }
+  }
+
+  bool sendFrame(const uint64_t frame_index, const void *rgba,
+                 const bool flipped) override;
+
+  bool sendDuplicateFrame(const uint64_t frame_index) override;
+
+  bool finish(const bool cancel) override;
+};
+
+// Sends every frame to all of its sinks, so one render pass can produce
+// several outputs. Owns the sinks added as owned.
+class FanOutFrameSink : public FrameSink {
+private:
+  std::vector<FrameSink *> _sinks;
+  std::vector<FrameSink *> _owned_sinks;
+
+public:
+  FanOutFrameSink(void) {}
+  FanOutFrameSink(const FanOutFrameSink &) = delete;
+  const FanOutFrameSink &operator=(const FanOutFrameSink &) = delete;
+
+  ~FanOutFrameSink(void) {
+    for (auto sink : _owned_sinks) {
+      delete sink;
+    }
+  }
+
+  // A sink that is not owned outlives this one, e.g. to serve several.
+  inline void addSink(FrameSink *sink, const bool owned = true) {
+    _sinks.push_back(sink);
+    if (owned) {
+      _owned_sinks.push_back(sink);
+    }
+  }
+
+  bool sendFrame(const uint64_t frame_index, const void *rgba,
+                 const bool flipped) override;
+
+  bool sendDuplicateFrame(const uint64_t frame_index) override;
+
+  bool finish(const bool cancel) override;
+};
+
+#endif // __FRAME_SINK_HPP__
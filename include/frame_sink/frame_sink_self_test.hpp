@@ -0,0 +1,32 @@
+#ifndef __FRAME_SINK_SELF_TEST_HPP__
+#define __FRAME_SINK_SELF_TEST_HPP__
+
+#include "ffmpeg_rendering/yuv420_converter.hpp"
+#include "frame_sink/image_sequence_frame_sink.hpp"
+#include "frame_sink/qoi_encoder.hpp"
+
+class FrameSinkSelfTest {
+private:
+  uint64_t _random_state;
+  uint32_t _failure_count;
+
+  uint64_t nextRandom(void);
+
+  void check(const bool condition, const char *what);
+
+  void testQOIReference(void);
+
+  void testQOIRoundTrip(const size_t width, const size_t height);
+
+  void testImageSequence(void);
+
+  void testVideoPipe(const FFMPEGPipeFormat pipe_format);
+
+public:
+  FrameSinkSelfTest(void) : _random_state(0x5eed), _failure_count(0) {}
+
+  // Returns false when any check failed, failures are printed to stderr.
+  bool selfTest(void);
+};
+
+#endif // __FRAME_SINK_SELF_TEST_HPP__
@@ -0,0 +1,77 @@
+#ifndef __IMAGE_SEQUENCE_FRAME_SINK_HPP__
+#define __IMAGE_SEQUENCE_FRAME_SINK_HPP__
+
+#include "frame_sink/frame_sink.hpp"
+
+enum ImageSequenceFormat : uint8_t { ImageSequenceQOI, ImageSequencePNG };
+
+// Accepts "qoi" and "png", false for anything else.
+bool parseImageSequenceFormat(const char *name, ImageSequenceFormat &format);
+
+// Writes every frame into its own file, path_pattern is a printf pattern
+// taking the frame index as unsigned long, e.g. "frames/frame_%06lu.qoi".
+//
+// sendFrame() only copies the frame into one of max_in_flight buffers and
+// queues it, encoder threads compress and write it. When all buffers are in
+// use sendFrame() blocks, which bounds the memory an export can take.
+// Duplicate frames are hard links to the file of the frame they repeat.
+//
+// finish() waits for the queue but keeps the encoders, so one sink serves
+// every segment of an export; they stop when the sink is deleted.
+class ImageSequenceFrameSink : public FrameSink {
+private:
+  struct EncodeJob {
+    uint64_t frame_index;
+    uint32_t *pixels;
+  };
+
+  const std::string _path_pattern;
+  const ImageSequenceFormat _format;
+  const size_t _width;
+  const size_t _height;
+
+  std::vector<std::thread> _encoders;
+  std::mutex _mutex;
+  std::condition_variable _job_ready;
+  std::condition_variable _buffer_free;
+  std::deque<EncodeJob> _jobs;
+  std::vector<uint32_t *> _free_buffers;
+  std::vector<uint32_t *> _buffers;
+  bool _exit;
+  bool _cancel;
+  std::atomic<bool> _failed;
+
+  uint64_t _last_frame_index;
+  bool _has_last_frame;
+  std::vector<std::pair<uint64_t, uint64_t>> _pending_links;
+
+  std::string getFramePath(const uint64_t frame_index) const;
+
+  void encoderLoop(void);
+
+  bool encodeFrame(const EncodeJob &job, uint8_t *scratch) const;
+
+
+public:
+  ImageSequenceFrameSink(void) = delete;
+  ImageSequenceFrameSink(const ImageSequenceFrameSink &) = delete;
+  const ImageSequenceFrameSink &
+  operator=(const ImageSequenceFrameSink &) = delete;
+
+  // thread_count == 0 picks one encoder per hardware thread.
+  ImageSequenceFrameSink(const char *path_pattern,
+                         const ImageSequenceFormat format, const size_t width,
+                         const size_t height, const uint32_t thread_count,
+                         const uint32_t max_in_flight);
+
+  ~ImageSequenceFrameSink(void);
+
+  bool sendFrame(const uint64_t frame_index, const void *rgba,
+                 const bool flipped) override;
+
+  bool sendDuplicateFrame(const uint64_t frame_index) override;
+
+  bool finish(const bool cancel) override;
+};
+
+#endif // __IMAGE_SEQUENCE_FRAME_SINK_HPP__
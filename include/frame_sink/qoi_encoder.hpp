@@ -0,0 +1,21 @@
+#ifndef __QOI_ENCODER_HPP__
+#define __QOI_ENCODER_HPP__
+
+#include "standard_defs/standard_defs.hpp"
+
+// Encoder for the "Quite OK Image" format (https://qoiformat.org), RGBA8
+// input, 4 channels, sRGB. Single pass and several times faster than PNG,
+// which is what makes it worth having for frame sequences.
+static constexpr size_t QOI_HEADER_SIZE = 14;
+static constexpr size_t QOI_END_MARKER_SIZE = 8;
+
+static inline size_t qoi_max_encoded_size(const size_t width,
+                                          const size_t height) {
+  return QOI_HEADER_SIZE + width * height * 5 + QOI_END_MARKER_SIZE;
+}
+
+// out has to hold qoi_max_encoded_size() bytes. Returns the encoded size.
+size_t qoi_encode(const uint32_t *rgba, const size_t width,
+                  const size_t height, uint8_t *out);
+
+#endif // __QOI_ENCODER_HPP__
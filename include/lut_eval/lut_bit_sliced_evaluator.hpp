@@ -0,0 +1,92 @@
+#ifndef __LUT_BIT_SLICED_EVALUATOR_HPP__
+#define __LUT_BIT_SLICED_EVALUATOR_HPP__
+
+#include "lut_eval/lut_network.hpp"
+
+enum LutSliceWidth : uint8_t {
+  FirstLutSliceWidth = 0,
+  // One uint64_t per node, 64 patterns per evaluation.
+  LutSlice64 = FirstLutSliceWidth,
+  // Four uint64_t per node, 256 patterns per evaluation, one AVX2 register
+  // when the CPU has AVX2.
+  LutSlice256,
+  LastLutSliceWidth
+};
+
+// Simulates many input patterns at once: bit p of the words of a node is its
+// value under pattern p. A LUT is applied to whole bit-planes by Shannon
+// expansion, a mux tree over its truth table that selects with input 0
+// first, so a k input LUT costs 2^k - 1 muxes for all patterns together
+// instead of one table lookup per pattern.
+//
+// Pattern p lives in bit p % 64 of word p / 64.
+class LutBitSlicedEvaluator {
+public:
+  static constexpr uint32_t PATTERNS_PER_WORD = 64;
+
+private:
+  struct TRY_PACKED SlicedNode {
+    uint64_t function;
+    uint32_t input_edge_index;
+    uint8_t input_count;
+    uint8_t is_input;
+  };
+
+  SlicedNode *_nodes;
+  uint32_t *_fanins;
+  uint64_t *_values;
+  uint32_t *_input_nodes;
+  uint32_t *_output_nodes;
+  uint32_t _node_count;
+  uint32_t _input_count;
+  uint32_t _output_count;
+  uint32_t _word_count;
+  LutSliceWidth _width;
+  bool _use_avx2;
+
+  template <uint32_t WORDS> void evaluateScalar(void);
+
+  TRY_TARGET_AVX2 void evaluateAvx2(void);
+
+public:
+  LutBitSlicedEvaluator(void) = delete;
+  LutBitSlicedEvaluator(const LutBitSlicedEvaluator &) = delete;
+  const LutBitSlicedEvaluator &
+  operator=(const LutBitSlicedEvaluator &) = delete;
+
+  LutBitSlicedEvaluator(const LutNetwork &network, const LutSliceWidth width);
+
+  ~LutBitSlicedEvaluator(void);
+
+  inline LutSliceWidth getWidth(void) const { return _width; }
+
+  inline uint32_t getWordCount(void) const { return _word_count; }
+
+  inline uint32_t getPatternCount(void) const {
+    return _word_count * PATTERNS_PER_WORD;
+  }
+
+  inline uint32_t getInputCount(void) const { return _input_count; }
+
+  inline uint32_t getOutputCount(void) const { return _output_count; }
+
+  // words holds getWordCount() words.
+  void setInputPatterns(const uint32_t input, const uint64_t *words);
+
+  // Pattern p assigns bit i of first_pattern + p to input i, so consecutive
+  // calls with first_pattern += getPatternCount() walk through all input
+  // combinations. first_pattern has to be a multiple of PATTERNS_PER_WORD.
+  void setExhaustivePatterns(const uint64_t first_pattern);
+
+  void evaluate(void);
+
+  // words receives getWordCount() words.
+  void getOutputPatterns(const uint32_t output, uint64_t *words) const;
+
+  inline const uint64_t *getNodePatterns(const uint32_t node) const {
+    assert(node < _node_count);
+    return _values + static_cast<size_t>(node) * _word_count;
+  }
+};
+
+#endif // __LUT_BIT_SLICED_EVALUATOR_HPP__
@@ -0,0 +1,69 @@
+#ifndef __LUT_COMPILED_EVALUATOR_HPP__
+#define __LUT_COMPILED_EVALUATOR_HPP__
+
+#include "lut_eval/lut_network.hpp"
+#include "native_kernel/native_kernel.hpp"
+
+// extern "C" function of the generated source, bit p of inputs[i] is input i
+// under pattern p and the same for the outputs. values is room for one word
+// per node.
+typedef void (*LutKernelFunction)(const uint64_t *inputs, uint64_t *outputs,
+                                  uint64_t *values);
+
+// Straight-line C++ for network: one word of values per node holding 64
+// patterns, every LUT written out as the Shannon expansion of its truth
+// table with the branches that do not depend on an input dropped, in
+// functions of KERNEL_CHUNK_NODES nodes.
+void generateLutKernelSource(const LutNetwork &network, const char *symbol,
+                             std::string &source);
+
+// Evaluates 64 patterns per evaluate() through network compiled to native
+// code, see NativeKernel. Compiling takes seconds for tens of thousands of
+// LUTs and grows faster than the network, so this is for networks that are
+// evaluated far more often than they change.
+class LutCompiledEvaluator {
+private:
+  static constexpr const char *SYMBOL = "lut_kernel";
+
+  NativeKernel _kernel;
+  LutKernelFunction _function;
+  std::vector<uint64_t> _inputs;
+  std::vector<uint64_t> _outputs;
+  std::vector<uint64_t> _values;
+
+  static std::string getSource(const LutNetwork &network);
+
+public:
+  LutCompiledEvaluator(void) = delete;
+  LutCompiledEvaluator(const LutCompiledEvaluator &) = delete;
+  const LutCompiledEvaluator &operator=(const LutCompiledEvaluator &) = delete;
+
+  LutCompiledEvaluator(const LutNetwork &network, const char *cache_dir);
+
+  // False when generating, compiling or loading failed; evaluate() must not
+  // be called then.
+  inline bool isLoaded(void) const { return _kernel.isLoaded(); }
+
+  inline bool wasCached(void) const { return _kernel.wasCached(); }
+
+  inline uint32_t getInputCount(void) const { return _inputs.size(); }
+
+  inline uint32_t getOutputCount(void) const { return _outputs.size(); }
+
+  inline void setInputPatterns(const uint32_t input, const uint64_t word) {
+    assert(input < getInputCount());
+    _inputs[input] = word;
+  }
+
+  inline void evaluate(void) {
+    assert(isLoaded());
+    _function(_inputs.data(), _outputs.data(), _values.data());
+  }
+
+  inline uint64_t getOutputPatterns(const uint32_t output) const {
+    assert(output < getOutputCount());
+    return _outputs[output];
+  }
+};
+
+#endif // __LUT_COMPILED_EVALUATOR_HPP__
@@ -0,0 +1,94 @@
+#ifndef __LUT_DELTA_EVALUATOR_HPP__
+#define __LUT_DELTA_EVALUATOR_HPP__
+
+#include "lut_eval/lut_network.hpp"
+
+// One cache line of fan-in deltas: edge_count deltas of bit_width bits each,
+// packed little endian from bit 0 of payload. A delta is node - fanin - 1,
+// fan-ins always come before their LUT, so it is never negative and a chain
+// of LUTs each reading the one before packs into width 0.
+struct alignas(64) LutEdgeBlock {
+  static constexpr uint32_t PAYLOAD_SIZE = 62;
+  static constexpr uint32_t PAYLOAD_BITS = PAYLOAD_SIZE * 8;
+  static constexpr uint32_t MAX_EDGES = UINT8_MAX;
+
+  uint8_t bit_width;
+  uint8_t edge_count;
+  uint8_t payload[PAYLOAD_SIZE];
+};
+
+// Gather evaluation over delta encoded fan-ins. The fan-in lists of all LUTs
+// are stored back to back in node order as deltas from the LUT's own index,
+// cut into LutEdgeBlocks that each use the bit width of their largest delta.
+// Networks whose fan-ins are close to their LUTs need a byte or two per edge
+// instead of the 5 of LutEvaluator's records, and one byte per node for its
+// value and fan-in count.
+//
+// There is no index into the blocks, a sweep decodes them in order into a
+// small buffer, one block at a time.
+class LutDeltaEvaluator {
+private:
+  // Fan-in count of an input, LUTs have at most 6.
+  static constexpr uint8_t INPUT_MARK = 0xff;
+
+  LutEdgeBlock *_blocks;
+  uint64_t *_functions;
+  uint8_t *_fanin_counts;
+  uint8_t *_values;
+  uint32_t *_input_nodes;
+  uint32_t *_output_nodes;
+  uint32_t _node_count;
+  uint32_t _input_count;
+  uint32_t _output_count;
+  uint64_t _block_count;
+
+  void encodeEdges(const LutNetwork &network);
+
+public:
+  LutDeltaEvaluator(void) = delete;
+  LutDeltaEvaluator(const LutDeltaEvaluator &) = delete;
+  const LutDeltaEvaluator &operator=(const LutDeltaEvaluator &) = delete;
+
+  LutDeltaEvaluator(const LutNetwork &network);
+
+  ~LutDeltaEvaluator(void);
+
+  // Decodes the deltas of block into deltas, which has room for
+  // LutEdgeBlock::MAX_EDGES, and returns their count.
+  static uint32_t decodeBlock(const LutEdgeBlock &block, uint32_t *deltas);
+
+  inline uint64_t getBlockCount(void) const { return _block_count; }
+
+  inline uint64_t getEdgeBytes(void) const {
+    return _block_count * sizeof(LutEdgeBlock);
+  }
+
+  inline uint32_t getInputCount(void) const { return _input_count; }
+
+  inline uint32_t getOutputCount(void) const { return _output_count; }
+
+  inline void setInput(const uint32_t input, const bool value) {
+    assert(input < _input_count);
+    _values[_input_nodes[input]] = value;
+  }
+
+  // values holds one byte per input, 0 or 1.
+  void setInputs(const uint8_t *values);
+
+  void evaluate(void);
+
+  inline bool getOutput(const uint32_t output) const {
+    assert(output < _output_count);
+    return _values[_output_nodes[output]];
+  }
+
+  // values receives one byte per output.
+  void getOutputs(uint8_t *values) const;
+
+  inline bool getNodeValue(const uint32_t node) const {
+    assert(node < _node_count);
+    return _values[node];
+  }
+};
+
+#endif // __LUT_DELTA_EVALUATOR_HPP__
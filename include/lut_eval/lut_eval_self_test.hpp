@@ -0,0 +1,74 @@
+#ifndef __LUT_EVAL_SELF_TEST_HPP__
+#define __LUT_EVAL_SELF_TEST_HPP__
+
+#include "lut_eval/lut_bit_sliced_evaluator.hpp"
+#include "lut_eval/lut_compiled_evaluator.hpp"
+#include "lut_eval/lut_delta_evaluator.hpp"
+#include "lut_eval/lut_event_evaluator.hpp"
+#include "lut_eval/lut_parallel_evaluator.hpp"
+#include "lut_eval/lut_renumbering.hpp"
+#include "lut_eval/lut_simplify.hpp"
+#include "lut_eval/lut_stream.hpp"
+#include "lut_eval/random_lut_network.hpp"
+
+class LutEvalSelfTest {
+private:
+  uint64_t _random_state;
+  uint32_t _failure_count;
+
+  uint64_t nextRandom(void);
+
+  void check(const bool condition, const char *what);
+
+  RandomLutNetworkParameters
+  getNetworkParameters(const uint32_t input_count, const uint32_t lut_count,
+                       const uint32_t window);
+
+  void buildFullAdder(LutNetwork &network);
+
+  void testFullAdder(void);
+
+  void testLevels(void);
+
+  void testRandomNetwork(const uint32_t input_count, const uint32_t lut_count,
+                         const uint32_t window);
+
+  void testBitSlicedFullAdder(void);
+
+  void testBitSliced(const uint32_t input_count, const uint32_t lut_count,
+                     const uint32_t window, const LutSliceWidth width);
+
+  void testParallel(const uint32_t input_count, const uint32_t lut_count,
+                    const uint32_t window, const uint32_t thread_count,
+                    const LutParallelMode mode);
+
+  void testDeltaBlocks(void);
+
+  void testDeltaEdges(const uint32_t input_count, const uint32_t lut_count,
+                      const uint32_t window, const double max_edge_bytes);
+
+  void testEventDriven(const uint32_t input_count, const uint32_t lut_count,
+                       const uint32_t window, const uint32_t max_toggles);
+
+  void testRenumbering(const uint32_t input_count, const uint32_t lut_count,
+                       const uint32_t window, const NodeOrderType type);
+
+  void buildReducibleNetwork(const uint32_t input_count,
+                             const uint32_t lut_count, LutNetwork &network);
+
+  void testSimplify(const uint32_t input_count, const uint32_t lut_count);
+
+  void testCompiled(const uint32_t input_count, const uint32_t lut_count,
+                    const uint32_t window);
+
+  void testStream(const uint32_t input_count, const uint32_t lut_count,
+                  const uint32_t window, const size_t window_size);
+
+public:
+  LutEvalSelfTest(void) : _random_state(0x5eed), _failure_count(0) {}
+
+  // Returns false when any check failed, failures are printed to stderr.
+  bool selfTest(void);
+};
+
+#endif // __LUT_EVAL_SELF_TEST_HPP__
@@ -0,0 +1,100 @@
+#ifndef __LUT_EVENT_EVALUATOR_HPP__
+#define __LUT_EVENT_EVALUATOR_HPP__
+
+#include "lut_eval/lut_network.hpp"
+
+// Totals since construction or the last resetActivity().
+struct LutActivity {
+  uint64_t evaluate_count;
+  // LUTs re-evaluated and LUTs whose value changed.
+  uint64_t lut_evaluations;
+  uint64_t lut_toggles;
+  uint64_t input_toggles;
+};
+
+// Re-simulates only what changed: setInput() queues the fan-outs of an input
+// that toggled, and evaluate() works through per-level dirty queues from the
+// lowest level up. A LUT whose value did not change queues nothing, so
+// propagation stops there. Levels are levelization levels, inputs and
+// constants at 0, so a LUT is only evaluated after all its dirty fan-ins.
+//
+// A LUT evaluated here costs several times what it does in a full sweep, so
+// this pays off when few LUTs toggle per step. getActivityFactor() tells:
+// a random network with random truth tables toggles ~40% of its LUTs for a
+// single input, real logic far fewer.
+//
+// The values start out as a full evaluation with all inputs 0.
+class LutEventEvaluator {
+private:
+  std::vector<uint64_t> _functions;
+  std::vector<uint32_t> _first_fanins;
+  std::vector<uint32_t> _fanins;
+  std::vector<uint32_t> _first_fanouts;
+  std::vector<uint32_t> _fanouts;
+  std::vector<uint32_t> _levels;
+  std::vector<uint8_t> _values;
+  std::vector<uint8_t> _queued;
+  std::vector<std::vector<uint32_t>> _level_queues;
+  std::vector<uint32_t> _input_nodes;
+  std::vector<uint32_t> _output_nodes;
+  uint32_t _lut_count;
+  // Lowest level with a queued LUT, the level count when none is.
+  uint32_t _first_dirty_level;
+  LutActivity _activity;
+
+  inline bool computeValue(const uint32_t node) const {
+    uint32_t word = 0;
+    for (uint32_t i = _first_fanins[node]; i < _first_fanins[node + 1]; i++) {
+      word |= static_cast<uint32_t>(_values[_fanins[i]])
+              << (i - _first_fanins[node]);
+    }
+    return (_functions[node] >> word) & 1;
+  }
+
+  void queueFanouts(const uint32_t node);
+
+public:
+  LutEventEvaluator(void) = delete;
+  LutEventEvaluator(const LutEventEvaluator &) = delete;
+  const LutEventEvaluator &operator=(const LutEventEvaluator &) = delete;
+
+  LutEventEvaluator(const LutNetwork &network);
+
+  inline uint32_t getInputCount(void) const { return _input_nodes.size(); }
+
+  inline uint32_t getOutputCount(void) const { return _output_nodes.size(); }
+
+  inline uint32_t getLevelCount(void) const { return _level_queues.size(); }
+
+  void setInput(const uint32_t input, const bool value);
+
+  // values holds one byte per input, 0 or 1.
+  void setInputs(const uint8_t *values);
+
+  void evaluate(void);
+
+  inline bool getOutput(const uint32_t output) const {
+    assert(output < getOutputCount());
+    return _values[_output_nodes[output]];
+  }
+
+  // values receives one byte per output.
+  void getOutputs(uint8_t *values) const;
+
+  inline bool getNodeValue(const uint32_t node) const {
+    return _values[node];
+  }
+
+  inline const LutActivity &getActivity(void) const { return _activity; }
+
+  inline void resetActivity(void) { _activity = {}; }
+
+  // Average share of the LUTs that changed value per evaluate(), the
+  // activity factor of power estimation.
+  double getActivityFactor(void) const;
+
+  // Average share of the LUTs evaluated per evaluate(), 1 for a full sweep.
+  double getEvaluatedFraction(void) const;
+};
+
+#endif // __LUT_EVENT_EVALUATOR_HPP__
@@ -0,0 +1,83 @@
+#ifndef __LUT_NETWORK_HPP__
+#define __LUT_NETWORK_HPP__
+
+#include "standard_defs/standard_defs.hpp"
+
+// Network of single output look up tables. A LUT with k inputs carries a
+// 2^k bit truth table: input j of the LUT is bit j of the index into the
+// table, bit index of function is the output for that input combination.
+//
+// Nodes are numbered in creation order and a LUT can only read nodes created
+// before it, so node order is a topological order. A LUT without inputs is
+// a constant, bit 0 of its function.
+class LutNetwork {
+public:
+  static constexpr uint32_t MAX_LUT_INPUTS = 6;
+
+private:
+  std::vector<uint64_t> _functions;
+  std::vector<uint32_t> _first_fanins;
+  std::vector<uint8_t> _fanin_counts;
+  std::vector<uint8_t> _is_input;
+  std::vector<uint32_t> _fanins;
+  std::vector<uint32_t> _input_nodes;
+  std::vector<uint32_t> _output_nodes;
+
+public:
+  // Returns the node, the input number is getInputCount() - 1 afterwards.
+  uint32_t addInput(void);
+
+  uint32_t addLut(const uint64_t function, const uint32_t *fanins,
+                  const uint32_t fanin_count);
+
+  inline uint32_t addLut(const uint64_t function,
+                         std::initializer_list<uint32_t> fanins) {
+    return addLut(function, fanins.begin(), fanins.size());
+  }
+
+  // Returns the output number.
+  uint32_t addOutput(const uint32_t node);
+
+  inline uint32_t getNodeCount(void) const { return _functions.size(); }
+  inline uint64_t getEdgeCount(void) const { return _fanins.size(); }
+  inline uint32_t getInputCount(void) const { return _input_nodes.size(); }
+  inline uint32_t getOutputCount(void) const { return _output_nodes.size(); }
+
+  inline uint32_t getInputNode(const uint32_t input) const {
+    return _input_nodes[input];
+  }
+
+  inline uint32_t getOutputNode(const uint32_t output) const {
+    return _output_nodes[output];
+  }
+
+  inline bool isInput(const uint32_t node) const { return _is_input[node]; }
+
+  inline uint64_t getFunction(const uint32_t node) const {
+    return _functions[node];
+  }
+
+  inline uint32_t getFaninCount(const uint32_t node) const {
+    return _fanin_counts[node];
+  }
+
+  inline uint32_t getFanin(const uint32_t node, const uint32_t position) const {
+    assert(position < _fanin_counts[node]);
+    return _fanins[_first_fanins[node] + position];
+  }
+
+  // Fan-out count of every node, indexed by node.
+  void getFanoutCounts(std::vector<uint32_t> &fanout_counts) const;
+
+  // Level of every node: inputs and constants are level 0, a LUT is one
+  // level above its latest fan-in. Returns the level count.
+  uint32_t computeLevels(std::vector<uint32_t> &levels) const;
+
+  // Nodes sorted by level, in node order within a level: order[i] is the
+  // node at place i and level_starts[level] the first place of a level,
+  // with the node count after the last level.
+  void computeLevelOrder(std::vector<uint32_t> &order,
+                         std::vector<uint32_t> &level_starts) const;
+};
+
+#endif // __LUT_NETWORK_HPP__
@@ -0,0 +1,92 @@
+#ifndef __LUT_PARALLEL_EVALUATOR_HPP__
+#define __LUT_PARALLEL_EVALUATOR_HPP__
+
+#include "lut_eval/lut_network.hpp"
+#include "worker_pool/spin_barrier.hpp"
+#include "worker_pool/worker_pool.hpp"
+
+enum LutParallelMode : uint8_t {
+  FirstLutParallelMode = 0,
+  // Every level is split across all threads, one vector at a time.
+  LutParallelLayered = FirstLutParallelMode,
+  // Every thread owns a run of levels and vectors flow through them, thread
+  // t works on vector v - t while thread 0 starts vector v.
+  LutParallelPipelined,
+  LastLutParallelMode
+};
+
+// Evaluates a LutNetwork level by level on a pinned WorkerPool, with a
+// SpinBarrier between the steps. Nodes are renumbered by level so the nodes
+// of a level, and the share of a thread, are contiguous.
+//
+// Layered mode needs a barrier per level and vector and scales with the
+// width of the levels. Pipelined mode needs a barrier per vector only and
+// scales with the depth, as long as there are more vectors than threads;
+// it keeps one value array per thread since every vector in flight needs
+// all of its earlier levels.
+class LutParallelEvaluator {
+private:
+  struct ParallelNode {
+    uint64_t function;
+    uint32_t input_edge_index;
+    uint8_t input_count;
+    uint8_t is_input;
+  };
+
+  WorkerPool _pool;
+  SpinBarrier _barrier;
+  const LutParallelMode _mode;
+  std::vector<ParallelNode> _nodes;
+  std::vector<uint32_t> _fanins;
+  // First node of every level, level_count + 1 entries.
+  std::vector<uint32_t> _level_starts;
+  // First level of every pipeline stage, thread count + 1 entries.
+  std::vector<uint32_t> _stage_starts;
+  // Node values of every vector slot, node_count bytes each.
+  std::vector<uint8_t> _values;
+  // Renumbered nodes of the inputs and outputs.
+  std::vector<uint32_t> _input_nodes;
+  std::vector<uint32_t> _output_nodes;
+
+  void levelize(const LutNetwork &network);
+
+  void partitionStages(void);
+
+  void evaluateNodes(uint8_t *values, const uint32_t begin,
+                     const uint32_t end) const;
+
+  void evaluateLevelShare(uint8_t *values, const uint32_t level,
+                          const uint32_t thread) const;
+
+  void runLayered(const uint32_t thread, const uint8_t *inputs,
+                  uint8_t *outputs, const uint32_t vector_count);
+
+  void runPipelined(const uint32_t thread, const uint8_t *inputs,
+                    uint8_t *outputs, const uint32_t vector_count);
+
+public:
+  LutParallelEvaluator(void) = delete;
+  LutParallelEvaluator(const LutParallelEvaluator &) = delete;
+  const LutParallelEvaluator &operator=(const LutParallelEvaluator &) = delete;
+
+  // thread_count == 0 picks one thread per hardware thread.
+  LutParallelEvaluator(const LutNetwork &network, const uint32_t thread_count,
+                       const LutParallelMode mode);
+
+  inline LutParallelMode getMode(void) const { return _mode; }
+
+  inline uint32_t getThreadCount(void) const { return _pool.getThreadCount(); }
+
+  inline uint32_t getLevelCount(void) const { return _level_starts.size() - 1; }
+
+  inline uint32_t getInputCount(void) const { return _input_nodes.size(); }
+
+  inline uint32_t getOutputCount(void) const { return _output_nodes.size(); }
+
+  // inputs holds vector_count rows of one byte per input, outputs receives
+  // vector_count rows of one byte per output.
+  void evaluateBatch(const uint8_t *inputs, uint8_t *outputs,
+                     const uint32_t vector_count);
+};
+
+#endif // __LUT_PARALLEL_EVALUATOR_HPP__
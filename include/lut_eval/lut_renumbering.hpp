@@ -0,0 +1,26 @@
+#ifndef __LUT_RENUMBERING_HPP__
+#define __LUT_RENUMBERING_HPP__
+
+#include "lut_eval/lut_network.hpp"
+#include "node_order/node_order.hpp"
+
+// Node records of LutEvaluator and the cache the statistics are estimated
+// for, about an L2 per core.
+static constexpr uint32_t LUT_ORDER_RECORD_SIZE = 24;
+static constexpr uint32_t LUT_ORDER_CACHE_SIZE = 1 << 18;
+
+// Copies network into renumbered with its nodes in the order of type, so
+// fan-ins sit closer to their LUTs. Inputs, outputs and the fan-in positions
+// of every LUT keep their numbers; new_indices receives the new node of
+// every old one.
+void renumberLutNetwork(const LutNetwork &network, const NodeOrderType type,
+                        LutNetwork &renumbered,
+                        std::vector<uint32_t> &new_indices);
+
+// Edge span and estimated misses of a gather sweep over network, renumbered
+// by new_indices unless it is empty.
+void computeLutNodeOrderStats(const LutNetwork &network,
+                              const std::vector<uint32_t> &new_indices,
+                              NodeOrderStats &stats);
+
+#endif // __LUT_RENUMBERING_HPP__
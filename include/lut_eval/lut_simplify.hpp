@@ -0,0 +1,23 @@
+#ifndef __LUT_SIMPLIFY_HPP__
+#define __LUT_SIMPLIFY_HPP__
+
+#include "lut_eval/lut_network.hpp"
+
+static constexpr uint32_t REMOVED_LUT_NODE = UINT32_MAX;
+
+// Copies network into simplified without the logic that cannot change an
+// output. Constant fan-ins are folded into the truth table of their LUT, a
+// node read twice becomes one fan-in and fan-ins the table does not depend
+// on are dropped; a LUT left without fan-ins is a constant, one left passing
+// its only fan-in through is replaced by it. Of what remains only nodes with
+// a path to an output are kept, and every input.
+//
+// new_indices receives for every node of network the node of simplified with
+// the same value, REMOVED_LUT_NODE when there is none, and
+// original_indices the node of network every node of simplified was made
+// from. Input and output numbers do not change.
+void simplifyLutNetwork(const LutNetwork &network, LutNetwork &simplified,
+                        std::vector<uint32_t> &new_indices,
+                        std::vector<uint32_t> &original_indices);
+
+#endif // __LUT_SIMPLIFY_HPP__
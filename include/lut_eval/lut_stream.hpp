@@ -0,0 +1,139 @@
+#ifndef __LUT_STREAM_HPP__
+#define __LUT_STREAM_HPP__
+
+#include "lut_eval/lut_network.hpp"
+
+// On-disk LUT network for networks that do not fit in memory:
+//
+//   header     LutStreamHeader
+//   records    one per node in node order: uint64_t function, uint8_t fan-in
+//              count (INPUT_MARK for inputs), uint32_t fan-ins, packed and
+//              little endian
+//   trailer    uint32_t input nodes, then uint32_t output nodes
+//
+// Nodes have to come in topological order; writeLutStreamFile() writes them
+// level by level, so a sweep reads the file front to back.
+struct TRY_PACKED LutStreamHeader {
+  static constexpr uint64_t MAGIC = 0x314d52545354554cull; // "LUTSTRM1"
+
+  uint64_t magic;
+  uint64_t node_count;
+  uint64_t edge_count;
+  uint64_t input_count;
+  uint64_t output_count;
+  uint64_t trailer_offset;
+};
+
+class LutStreamWriter {
+public:
+  static constexpr uint8_t INPUT_MARK = 0xff;
+
+private:
+  static constexpr size_t BUFFER_SIZE = 1 << 16;
+
+  FILE *_file;
+  const char *_path;
+  LutStreamHeader _header;
+  std::vector<uint32_t> _input_nodes;
+  std::vector<uint32_t> _output_nodes;
+  bool _failed;
+
+  void write(const void *data, const size_t size);
+
+public:
+  LutStreamWriter(void) = delete;
+  LutStreamWriter(const LutStreamWriter &) = delete;
+  const LutStreamWriter &operator=(const LutStreamWriter &) = delete;
+
+  // Errors, opening included, show up in finish().
+  LutStreamWriter(const char *path);
+
+  ~LutStreamWriter(void);
+
+  uint32_t addInput(void);
+
+  uint32_t addLut(const uint64_t function, const uint32_t *fanins,
+                  const uint32_t fanin_count);
+
+  void addOutput(const uint32_t node);
+
+  // Writes the trailer and the header and closes the file.
+  bool finish(void);
+};
+
+// Writes network with its nodes sorted by level, inputs and outputs keep
+// their numbers.
+bool writeLutStreamFile(const LutNetwork &network, const char *path);
+
+// Evaluates a stream file without loading it: every evaluate() reads the
+// records front to back through a window of window_size bytes, with the
+// kernel asked to read ahead the next window while this one is evaluated.
+// Only the values, one bit per node, and the input and output lists stay
+// resident, about 1/260 of the file for LUTs with 6 inputs.
+class LutStreamEvaluator {
+private:
+  static constexpr size_t MAX_RECORD_SIZE =
+      sizeof(uint64_t) + 1 + LutNetwork::MAX_LUT_INPUTS * sizeof(uint32_t);
+
+  const size_t _window_size;
+  int _fd;
+  LutStreamHeader _header;
+  uint8_t *_window;
+  std::vector<uint64_t> _values;
+  std::vector<uint32_t> _input_nodes;
+  std::vector<uint32_t> _output_nodes;
+
+  inline bool getValue(const uint64_t node) const {
+    return (_values[node / 64] >> (node % 64)) & 1;
+  }
+
+  inline void setValue(const uint64_t node, const bool value) {
+    const uint64_t bit = 1ull << (node % 64);
+    _values[node / 64] = (_values[node / 64] & ~bit) | (value ? bit : 0);
+  }
+
+  bool readAt(void *data, const size_t size, const uint64_t offset) const;
+
+  void close(void);
+
+public:
+  LutStreamEvaluator(void) = delete;
+  LutStreamEvaluator(const LutStreamEvaluator &) = delete;
+  const LutStreamEvaluator &operator=(const LutStreamEvaluator &) = delete;
+
+  LutStreamEvaluator(const size_t window_size);
+
+  ~LutStreamEvaluator(void);
+
+  bool open(const char *path);
+
+  inline uint64_t getNodeCount(void) const { return _header.node_count; }
+
+  inline uint32_t getInputCount(void) const { return _input_nodes.size(); }
+
+  inline uint32_t getOutputCount(void) const { return _output_nodes.size(); }
+
+  // Memory held between evaluations, the window included.
+  uint64_t getResidentBytes(void) const;
+
+  inline void setInput(const uint32_t input, const bool value) {
+    assert(input < getInputCount());
+    setValue(_input_nodes[input], value);
+  }
+
+  // values holds one byte per input, 0 or 1.
+  void setInputs(const uint8_t *values);
+
+  // Fails on read errors and on records that do not match the header.
+  bool evaluate(void);
+
+  inline bool getOutput(const uint32_t output) const {
+    assert(output < getOutputCount());
+    return getValue(_output_nodes[output]);
+  }
+
+  // values receives one byte per output.
+  void getOutputs(uint8_t *values) const;
+};
+
+#endif // __LUT_STREAM_HPP__
@@ -0,0 +1,25 @@
+#ifndef __RANDOM_LUT_NETWORK_HPP__
+#define __RANDOM_LUT_NETWORK_HPP__
+
+#include "lut_eval/lut_network.hpp"
+
+struct RandomLutNetworkParameters {
+  uint64_t seed;
+  uint32_t input_count;
+  uint32_t lut_count;
+  // Fan-in counts are uniform in [min_fanin, max_fanin], 0 gives constants.
+  uint32_t min_fanin;
+  uint32_t max_fanin;
+  // Fan-ins of every LUT come from the window nodes before it, window == 0
+  // reads the inputs only, which gives the widest fan-outs.
+  uint32_t window;
+  // Chance that a LUT is also a network output.
+  float output_rate;
+};
+
+// Same parameters give the same network on every machine, the generator does
+// not use <random>. Truth tables are uniformly random.
+void buildRandomLutNetwork(const RandomLutNetworkParameters &parameters,
+                           LutNetwork &network);
+
+#endif // __RANDOM_LUT_NETWORK_HPP__
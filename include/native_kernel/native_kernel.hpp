@@ -0,0 +1,63 @@
+#ifndef __NATIVE_KERNEL_HPP__
+#define __NATIVE_KERNEL_HPP__
+
+#include "standard_defs/standard_defs.hpp"
+
+// Nodes per function of a generated kernel. Compile time grows much faster
+// than the size of a function: 2000 LUTs take gcc 24s in functions of 1024
+// nodes and 6s in functions of 64, in one function 100k take gigabytes.
+static constexpr uint32_t KERNEL_CHUNK_NODES = 64;
+
+// Where compiled kernels are kept between runs: $CIRCUIT_KERNEL_CACHE, else
+// $XDG_CACHE_HOME/circuit_vis/kernels, else ~/.cache/circuit_vis/kernels.
+const char *getDefaultKernelCacheDir(void);
+
+// Generated C++ compiled into a shared object and loaded with dlopen. The
+// object is cached in cache_dir under a hash of the source, the compiler and
+// its flags, so a circuit is only compiled the first time it is seen:
+// generating the source again is much cheaper than compiling it. cache_dir
+// is created 0700 and refused unless it belongs to this user and nobody else
+// can write to it.
+//
+// The compiler is $CXX, else c++, run as "$CXX -O1 -shared -fPIC"; -O1
+// because straight-line code gains little from more and large kernels take
+// much longer to compile at -O2.
+class NativeKernel {
+private:
+  void *_library;
+  void *_function;
+  uint64_t _hash;
+  bool _cached;
+
+  bool compile(const char *source_path, const char *library_path) const;
+
+public:
+  NativeKernel(void) = delete;
+  NativeKernel(const NativeKernel &) = delete;
+  const NativeKernel &operator=(const NativeKernel &) = delete;
+
+  // Errors are printed, isLoaded() tells. An empty source loads nothing, for
+  // generators that failed.
+  NativeKernel(const std::string &source, const char *symbol,
+               const char *cache_dir);
+
+  ~NativeKernel(void);
+
+  static uint64_t hashSource(const std::string &source);
+
+  inline bool isLoaded(void) const { return _function != NULL; }
+
+  // Whether the object came from the cache instead of the compiler.
+  inline bool wasCached(void) const { return _cached; }
+
+  // The cache key, hashSource() of the source behind a description of the
+  // compiler.
+  inline uint64_t getHash(void) const { return _hash; }
+
+  template <typename FunctionType>
+  inline FunctionType getFunction(void) const {
+    return reinterpret_cast<FunctionType>(_function);
+  }
+};
+
+#endif // __NATIVE_KERNEL_HPP__
@@ -0,0 +1,382 @@
+#ifndef __PACKED_ARRAY_HPP__
+#define __PACKED_ARRAY_HPP__
+
+#include "cpu_dispatch/cpu_dispatch.hpp"
+#include <immintrin.h>
+#include <type_traits>
+
+// Bytes the kernels below may read past the last byte of the last value.
+static constexpr uint32_t PACKED_BITS_PADDING = 32;
+
+// Smallest width that holds max_value, at least 1.
+constexpr uint32_t getPackedBits(const uint64_t max_value) {
+  return max_value == 0 ? 1 : 64 - __builtin_clzll(max_value);
+}
+
+// Value i of a packed run is bits [i * BITS, (i + 1) * BITS) of data, little
+// endian. Eight values take BITS bytes, so groups of eight start on a byte
+// and their shifts and byte offsets only depend on BITS, which is what the
+// group kernels below are specialized on.
+template <uint32_t BITS> struct PackedBits {
+  static_assert(BITS >= 1 && BITS <= 63, "1 to 63 bits");
+
+  typedef std::conditional_t<(BITS <= 32), uint32_t, uint64_t> Value;
+
+  static constexpr uint64_t MASK = (1ull << BITS) - 1;
+  static constexpr uint32_t GROUP_SIZE = 8;
+  // Widths up to this one fit, shifted, in the 8 bytes from their first
+  // byte; wider ones are read as 16.
+  static constexpr uint32_t MAX_WORD_BITS = 57;
+  // Widths up to this one fit, shifted, in the dword the SIMD kernels load.
+  static constexpr uint32_t MAX_LANE_BITS = 25;
+
+  static TRY_INLINE Value load(const uint8_t *data, const uint64_t index) {
+    const uint64_t bit = index * BITS;
+    if constexpr (BITS <= MAX_WORD_BITS) {
+      uint64_t word;
+      memcpy(&word, data + bit / 8, sizeof(word));
+      return (word >> (bit % 8)) & MASK;
+    } else {
+      unsigned __int128 word;
+      memcpy(&word, data + bit / 8, sizeof(word));
+      return static_cast<uint64_t>(word >> (bit % 8)) & MASK;
+    }
+  }
+
+  // Rewrites the neighbouring bits unchanged, so two threads must not store
+  // to the same 8 (or 16) bytes at once.
+  static TRY_INLINE void store(uint8_t *data, const uint64_t index,
+                               const uint64_t value) {
+    const uint64_t bit = index * BITS;
+    if constexpr (BITS <= MAX_WORD_BITS) {
+      uint64_t word;
+      memcpy(&word, data + bit / 8, sizeof(word));
+      word = (word & ~(MASK << (bit % 8))) | ((value & MASK) << (bit % 8));
+      memcpy(data + bit / 8, &word, sizeof(word));
+    } else {
+      unsigned __int128 word;
+      memcpy(&word, data + bit / 8, sizeof(word));
+      const unsigned __int128 mask = static_cast<unsigned __int128>(MASK)
+                                     << (bit % 8);
+      word = (word & ~mask) |
+             (static_cast<unsigned __int128>(value & MASK) << (bit % 8));
+      memcpy(data + bit / 8, &word, sizeof(word));
+    }
+  }
+
+  // The eight values of the group at data, assembled in registers and
+  // stored as BITS bytes. Fields straddle bytes and lanes, so this stays in
+  // general registers: the unrolled shifts beat merging AVX2 lanes back.
+  template <typename T>
+  static TRY_INLINE void packGroup(uint8_t *data, const T *values) {
+    uint64_t words[(GROUP_SIZE * BITS + 63) / 64] = {};
+#pragma GCC unroll 8
+    for (uint32_t i = 0; i < GROUP_SIZE; i++) {
+      const uint64_t value = values[i] & MASK;
+      const uint32_t bit = i * BITS;
+      words[bit / 64] |= value << (bit % 64);
+      if (bit % 64 + BITS > 64) {
+        words[bit / 64 + 1] |= value >> (64 - bit % 64);
+      }
+    }
+    // Word by word, a single copy of the array goes through the stack.
+    for (uint32_t word = 0; word < BITS / 8; word++) {
+      memcpy(data + word * 8, &words[word], sizeof(uint64_t));
+    }
+    if constexpr (BITS % 8 != 0) {
+      memcpy(data + BITS / 8 * 8, &words[BITS / 8], BITS % 8);
+    }
+  }
+
+  struct LaneMasks {
+    int8_t shuffle[32];
+    int32_t shifts[8];
+    int32_t multipliers[8];
+  };
+
+  // Lane 0 is loaded from the group's first byte and holds values 0 to 3,
+  // lane 1 from byte 4 * BITS / 8 and holds values 4 to 7. Every value's 4
+  // bytes are shuffled into its dword, then shifted down; SSE has no
+  // variable shift, it multiplies every dword up to a shift of 7 instead.
+  static constexpr LaneMasks getLaneMasks(void) {
+    LaneMasks masks = {};
+    for (uint32_t lane = 0; lane < 2; lane++) {
+      const uint32_t base_bit = lane == 0 ? 0 : (4 * BITS) % 8;
+      for (uint32_t i = 0; i < 4; i++) {
+        const uint32_t bit = base_bit + i * BITS;
+        for (uint32_t byte = 0; byte < 4; byte++) {
+          masks.shuffle[lane * 16 + i * 4 + byte] = bit / 8 + byte;
+        }
+        masks.shifts[lane * 4 + i] = bit % 8;
+        masks.multipliers[lane * 4 + i] = 1 << (7 - bit % 8);
+      }
+    }
+    return masks;
+  }
+
+  static constexpr LaneMasks LANE_MASKS = getLaneMasks();
+
+  // The kernels below read 16 bytes from a group's first byte and from byte
+  // 4 * BITS / 8, up to 28 past the first, and convert group_count groups.
+  TRY_TARGET_SSE42 static __m128i unpackLaneSse42(const uint8_t *data,
+                                                   const uint32_t lane) {
+    const __m128i bytes = _mm_loadu_si128(
+        reinterpret_cast<const __m128i *>(data + lane * (4 * BITS / 8)));
+    const __m128i dwords = _mm_shuffle_epi8(
+        bytes, _mm_loadu_si128(reinterpret_cast<const __m128i *>(
+                   LANE_MASKS.shuffle + lane * 16)));
+    const __m128i shifted = _mm_srli_epi32(
+        _mm_mullo_epi32(dwords,
+                        _mm_loadu_si128(reinterpret_cast<const __m128i *>(
+                            LANE_MASKS.multipliers + lane * 4))),
+        7);
+    return _mm_and_si128(shifted, _mm_set1_epi32(MASK));
+  }
+
+  template <typename T>
+  TRY_TARGET_SSE42 static void unpackGroupsSse42(const uint8_t *group,
+                                                 const uint64_t group_count,
+                                                 T *values) {
+    for (uint64_t i = 0; i < group_count; i++) {
+      const __m128i low = unpackLaneSse42(group, 0);
+      const __m128i high = unpackLaneSse42(group, 1);
+      if constexpr (sizeof(T) == sizeof(uint32_t)) {
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(values), low);
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(values + 4), high);
+      } else {
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(values),
+                         _mm_packus_epi32(low, high));
+      }
+      group += BITS;
+      values += GROUP_SIZE;
+    }
+  }
+
+  TRY_TARGET_AVX2 static inline __m256i unpackGroupAvx2(const uint8_t *data) {
+    const __m256i bytes = _mm256_loadu2_m128i(
+        reinterpret_cast<const __m128i *>(data + 4 * BITS / 8),
+        reinterpret_cast<const __m128i *>(data));
+    const __m256i dwords = _mm256_shuffle_epi8(
+        bytes, _mm256_loadu_si256(
+                   reinterpret_cast<const __m256i *>(LANE_MASKS.shuffle)));
+    const __m256i shifted = _mm256_srlv_epi32(
+        dwords, _mm256_loadu_si256(
+                    reinterpret_cast<const __m256i *>(LANE_MASKS.shifts)));
+    return _mm256_and_si256(shifted, _mm256_set1_epi32(MASK));
+  }
+
+  template <typename T>
+  TRY_TARGET_AVX2 static inline void storeGroupAvx2(const __m256i group_values,
+                                                    T *values) {
+    if constexpr (sizeof(T) == sizeof(uint32_t)) {
+      _mm256_storeu_si256(reinterpret_cast<__m256i *>(values), group_values);
+    } else {
+      // Both copies of the packed words per lane, quads 0 and 2 hold values
+      // 0 to 7 in order.
+      const __m256i words = _mm256_permute4x64_epi64(
+          _mm256_packus_epi32(group_values, group_values), 0x08);
+      _mm_storeu_si128(reinterpret_cast<__m128i *>(values),
+                       _mm256_castsi256_si128(words));
+    }
+  }
+
+  template <typename T>
+  TRY_TARGET_AVX2 static void unpackGroupsAvx2(const uint8_t *group,
+                                               const uint64_t group_count,
+                                               T *values) {
+    for (uint64_t i = 0; i < group_count; i++) {
+      storeGroupAvx2(unpackGroupAvx2(group), values);
+      group += BITS;
+      values += GROUP_SIZE;
+    }
+  }
+
+  // Two groups per register, lanes 2 and 3 are lanes 0 and 1 of the second
+  // group and use the same masks.
+  TRY_AVX512_WARNINGS_BEGIN
+  template <typename T>
+  TRY_TARGET_AVX512 static void unpackGroupsAvx512(const uint8_t *group,
+                                                   const uint64_t group_count,
+                                                   T *values) {
+    const __m512i shuffle = _mm512_broadcast_i64x4(_mm256_loadu_si256(
+        reinterpret_cast<const __m256i *>(LANE_MASKS.shuffle)));
+    const __m512i shifts = _mm512_broadcast_i64x4(_mm256_loadu_si256(
+        reinterpret_cast<const __m256i *>(LANE_MASKS.shifts)));
+    const __m512i mask = _mm512_set1_epi32(MASK);
+    uint64_t i = 0;
+    for (; i + 2 <= group_count; i += 2) {
+      __m512i bytes = _mm512_castsi128_si512(
+          _mm_loadu_si128(reinterpret_cast<const __m128i *>(group)));
+      bytes = _mm512_inserti32x4(
+          bytes,
+          _mm_loadu_si128(
+              reinterpret_cast<const __m128i *>(group + 4 * BITS / 8)),
+          1);
+      bytes = _mm512_inserti32x4(
+          bytes,
+          _mm_loadu_si128(reinterpret_cast<const __m128i *>(group + BITS)),
+          2);
+      bytes = _mm512_inserti32x4(
+          bytes,
+          _mm_loadu_si128(reinterpret_cast<const __m128i *>(
+              group + BITS + 4 * BITS / 8)),
+          3);
+      const __m512i group_values = _mm512_and_si512(
+          _mm512_srlv_epi32(_mm512_shuffle_epi8(bytes, shuffle), shifts),
+          mask);
+      if constexpr (sizeof(T) == sizeof(uint32_t)) {
+        _mm512_storeu_si512(values, group_values);
+      } else {
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(values),
+                            _mm512_cvtepi32_epi16(group_values));
+      }
+      group += 2 * BITS;
+      values += 2 * GROUP_SIZE;
+    }
+    if (i < group_count) {
+      storeGroupAvx2(unpackGroupAvx2(group), values);
+    }
+  }
+  TRY_AVX512_WARNINGS_END
+
+  // values receives count values from first on. T is uint16_t, uint32_t or
+  // uint64_t and wide enough for BITS.
+  template <typename T>
+  static void unpack(const uint8_t *data, uint64_t first, uint64_t count,
+                     T *values) {
+    static_assert(sizeof(T) * 8 >= BITS, "values too narrow for BITS");
+    for (; count > 0 && first % GROUP_SIZE != 0; count--) {
+      *values++ = load(data, first++);
+    }
+    if constexpr (BITS <= MAX_LANE_BITS && sizeof(T) <= sizeof(uint32_t)) {
+      const uint8_t *group = data + first / GROUP_SIZE * BITS;
+      const uint64_t group_count = count / GROUP_SIZE;
+      const CpuLevel level = getCpuLevel();
+      if (level >= CpuLevelAvx512) {
+        unpackGroupsAvx512(group, group_count, values);
+      } else if (level >= CpuLevelAvx2) {
+        unpackGroupsAvx2(group, group_count, values);
+      } else {
+        unpackGroupsSse42(group, group_count, values);
+      }
+      first += group_count * GROUP_SIZE;
+      count -= group_count * GROUP_SIZE;
+      values += group_count * GROUP_SIZE;
+    }
+    for (; count > 0; count--) {
+      *values++ = load(data, first++);
+    }
+  }
+
+  // Stores count values from first on, values wider than BITS lose their
+  // upper bits.
+  template <typename T>
+  static void pack(uint8_t *data, uint64_t first, uint64_t count,
+                   const T *values) {
+    for (; count > 0 && first % GROUP_SIZE != 0; count--) {
+      store(data, first++, *values++);
+    }
+    uint8_t *group = data + first / GROUP_SIZE * BITS;
+    for (; count >= GROUP_SIZE; count -= GROUP_SIZE) {
+      packGroup(group, values);
+      group += BITS;
+      values += GROUP_SIZE;
+      first += GROUP_SIZE;
+    }
+    for (; count > 0; count--) {
+      store(data, first++, *values++);
+    }
+  }
+};
+
+// Fixed size array of BITS bit unsigned values, for node indices, LUT
+// functions, offsets and the like stored at the width their range needs
+// (getPackedBits()). Random access reads and writes one unaligned word,
+// sequential access goes through the iterator or, faster, through the bulk
+// unpackTo() and packFrom(), which convert groups of eight at once, with
+// SSE4.2, AVX2 or AVX-512 by getCpuLevel() for widths up to 25.
+template <uint32_t BITS> class PackedArray {
+public:
+  typedef PackedBits<BITS> Bits;
+  typedef typename Bits::Value Value;
+
+  class ConstIterator {
+  private:
+    const uint8_t *_data;
+    uint64_t _index;
+
+  public:
+    ConstIterator(const uint8_t *data, const uint64_t index)
+        : _data(data), _index(index) {}
+
+    inline Value operator*(void) const { return Bits::load(_data, _index); }
+
+    inline ConstIterator &operator++(void) {
+      _index++;
+      return *this;
+    }
+
+    inline bool operator==(const ConstIterator &other) const {
+      return _index == other._index;
+    }
+
+    inline bool operator!=(const ConstIterator &other) const {
+      return _index != other._index;
+    }
+  };
+
+private:
+  uint8_t *_data;
+  uint64_t _size;
+
+public:
+  PackedArray(void) = delete;
+  PackedArray(const PackedArray &) = delete;
+  const PackedArray &operator=(const PackedArray &) = delete;
+
+  // Zero filled.
+  PackedArray(const uint64_t size) : _size(size) {
+    _data = static_cast<uint8_t *>(calloc(getBytes() + PACKED_BITS_PADDING, 1));
+    assert(_data != NULL && "Buy MORE RAM lol!!");
+  }
+
+  ~PackedArray(void) { free(_data); }
+
+  inline uint64_t getSize(void) const { return _size; }
+
+  // Payload bytes, without the padding.
+  inline uint64_t getBytes(void) const { return (_size * BITS + 7) / 8; }
+
+  inline const uint8_t *getData(void) const { return _data; }
+
+  inline Value get(const uint64_t index) const {
+    assert(index < _size);
+    return Bits::load(_data, index);
+  }
+
+  // Keeps the lower BITS bits of value.
+  inline void set(const uint64_t index, const uint64_t value) {
+    assert(index < _size);
+    Bits::store(_data, index, value);
+  }
+
+  inline ConstIterator begin(void) const { return ConstIterator(_data, 0); }
+
+  inline ConstIterator end(void) const { return ConstIterator(_data, _size); }
+
+  template <typename T>
+  inline void unpackTo(const uint64_t first, const uint64_t count,
+                       T *values) const {
+    assert(first + count <= _size);
+    Bits::unpack(_data, first, count, values);
+  }
+
+  template <typename T>
+  inline void packFrom(const uint64_t first, const uint64_t count,
+                       const T *values) {
+    assert(first + count <= _size);
+    Bits::pack(_data, first, count, values);
+  }
+};
+
+#endif // __PACKED_ARRAY_HPP__
@@ -0,0 +1,28 @@
+#ifndef __PACKED_ARRAY_SELF_TEST_HPP__
+#define __PACKED_ARRAY_SELF_TEST_HPP__
+
+#include "packed_array/packed_array.hpp"
+
+class PackedArraySelfTest {
+private:
+  uint64_t _random_state;
+  uint32_t _failure_count;
+
+  uint64_t nextRandom(void);
+
+  void check(const bool condition, const char *what);
+
+  template <uint32_t BITS, typename T>
+  void testBulk(const PackedArray<BITS> &array,
+                const std::vector<uint64_t> &expected);
+
+  template <uint32_t BITS> void testWidth(const uint64_t size);
+
+public:
+  PackedArraySelfTest(void) : _random_state(0x5eed), _failure_count(0) {}
+
+  // Returns false when any check failed, failures are printed to stderr.
+  bool selfTest(void);
+};
+
+#endif // __PACKED_ARRAY_SELF_TEST_HPP__
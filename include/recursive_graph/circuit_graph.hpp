@@ -0,0 +1,81 @@
+#ifndef __CIRCUIT_GRAPH_HPP__
+#define __CIRCUIT_GRAPH_HPP__
+
+#include "circuit_model/circuit_model.hpp"
+#include "recursive_graph/recursive_graph.hpp"
+
+// The nodes and edges of a CircuitModel in a pair of RecursiveGraph::Graphs,
+// fanouts and fanins, and the node types and values in plain arrays. It
+// answers the same fanout and fanin queries, in the same order, for a few
+// bytes per edge where every CircuitNode carries two std::maps, so large
+// circuits can be kept in memory as this once they are built.
+class CircuitGraph {
+private:
+  std::vector<CircuitNodeType> _types;
+  std::vector<uint32_t> _values;
+  RecursiveGraph::Graph _fanouts;
+  RecursiveGraph::Graph _fanins;
+
+  // Parallel edges come one after the other, reported as one with a count.
+  static void forEachCounted(
+      const RecursiveGraph::Graph &graph, const uint32_t node,
+      std::function<IteratorStatus(const uint32_t other, const uint32_t count)>
+          &f);
+
+public:
+  CircuitGraph(void) {}
+  CircuitGraph(const CircuitGraph &) = delete;
+  CircuitGraph(CircuitGraph &&) = delete;
+  const CircuitGraph &operator=(const CircuitGraph &) = delete;
+
+  // Every node and edge of circuit, under the same indices. The neighbours
+  // of every node go in median first, so a node with a high fanout or fanin
+  // gets a balanced edge tree.
+  explicit CircuitGraph(const CircuitModel &circuit);
+
+  uint32_t addNode(const CircuitNodeType type, const uint32_t value);
+
+  // Edges added in ascending order of sink, or of source for the fanins,
+  // turn the node's edge tree into a list, with lookups and deletions
+  // linear in its degree.
+  void addEdge(const uint32_t source, const uint32_t sink);
+
+  // count parallel edges from source to sink in one step.
+  void addEdges(const uint32_t source, const uint32_t sink,
+                const uint32_t count);
+
+  // Removes one edge from source to sink, false when there is none.
+  bool deleteEdge(const uint32_t source, const uint32_t sink);
+
+  inline uint32_t getNodeCount(void) const { return _types.size(); }
+  inline uint64_t getEdgeCount(void) const { return _fanouts.getEdgeCount(); }
+
+  inline CircuitNodeType getType(const uint32_t node) const {
+    return _types[node];
+  }
+
+  inline uint32_t getValue(const uint32_t node) const { return _values[node]; }
+
+  // Sinks in ascending order, as CircuitNode::forEachFanout().
+  void forEachFanout(
+      const uint32_t node,
+      std::function<IteratorStatus(const uint32_t sink, const uint32_t count)>
+          f) const;
+
+  // Sources in ascending order, as CircuitNode::forEachFanin().
+  void forEachFanin(
+      const uint32_t node,
+      std::function<IteratorStatus(const uint32_t source,
+                                   const uint32_t count)>
+          f) const;
+
+  // The fanins are the same edges the other way around, at the same widths.
+  inline const RecursiveGraph::Graph &getFanoutGraph(void) const {
+    return _fanouts;
+  }
+
+  // Both graphs and the node arrays, spare capacity included.
+  uint64_t getBytes(void) const;
+};
+
+#endif // __CIRCUIT_GRAPH_HPP__
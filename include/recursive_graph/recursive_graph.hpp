@@ -0,0 +1,182 @@
+#ifndef __RECURSIVE_GRAPH_HPP__
+#define __RECURSIVE_GRAPH_HPP__
+
+#include "standard_defs/standard_defs.hpp"
+
+namespace RecursiveGraph {
+
+// Edge index 0 is a sentinel record that is never handed out, so 0 means no
+// edge in every link, and links stay valid when widened by zero extension.
+static constexpr uint64_t NO_EDGE = 0;
+
+template <typename TYPE_EDGE_INDEX_OFFSET, typename TYPE_NODE_INDEX>
+class TRY_PACKED Edge {
+public:
+  // The edges of one start node form a binary search tree ordered by end
+  // node; these are its children, NO_EDGE for none. Deleted edges chain
+  // through _left_edge_index_offset until they are reused.
+  TYPE_EDGE_INDEX_OFFSET _left_edge_index_offset;
+  TYPE_EDGE_INDEX_OFFSET _right_edge_index_offset;
+  // The end node.
+  TYPE_NODE_INDEX _node_index;
+
+  TRY_NOMAGIC(Edge)
+
+  TRY_INLINE explicit Edge(const TYPE_EDGE_INDEX_OFFSET left_edge_index_offset,
+                           const TYPE_EDGE_INDEX_OFFSET right_edge_index_offset,
+                           const TYPE_NODE_INDEX node_index) {
+
+    _left_edge_index_offset = left_edge_index_offset;
+    _right_edge_index_offset = right_edge_index_offset;
+    _node_index = node_index;
+  }
+};
+
+static_assert(sizeof(Edge<uint8_t, uint8_t>) == 3);
+static_assert(sizeof(Edge<uint8_t, uint16_t>) == 4);
+static_assert(sizeof(Edge<uint8_t, uint32_t>) == 6);
+static_assert(sizeof(Edge<uint8_t, uint64_t>) == 10);
+
+static_assert(sizeof(Edge<uint16_t, uint8_t>) == 5);
+static_assert(sizeof(Edge<uint16_t, uint16_t>) == 6);
+static_assert(sizeof(Edge<uint16_t, uint32_t>) == 8);
+static_assert(sizeof(Edge<uint16_t, uint64_t>) == 12);
+
+static_assert(sizeof(Edge<uint32_t, uint8_t>) == 9);
+static_assert(sizeof(Edge<uint32_t, uint16_t>) == 10);
+static_assert(sizeof(Edge<uint32_t, uint32_t>) == 12);
+static_assert(sizeof(Edge<uint32_t, uint64_t>) == 16);
+
+static_assert(sizeof(Edge<uint64_t, uint8_t>) == 17);
+static_assert(sizeof(Edge<uint64_t, uint16_t>) == 18);
+static_assert(sizeof(Edge<uint64_t, uint32_t>) == 20);
+static_assert(sizeof(Edge<uint64_t, uint64_t>) == 24);
+
+template <typename TYPE_EDGE_INDEX, typename TYPE_NODE_INDEX>
+class TRY_PACKED Node {
+public:
+  // Root of the node's edge tree, NO_EDGE while it has no edges.
+  TYPE_EDGE_INDEX _root_edge_index;
+
+  TRY_NOMAGIC(Node)
+  TRY_INLINE explicit Node(const TYPE_EDGE_INDEX root_edge_index) {
+    _root_edge_index = root_edge_index;
+  }
+};
+
+static_assert(sizeof(Node<uint8_t, uint8_t>) == 1);
+static_assert(sizeof(Node<uint8_t, uint16_t>) == 1);
+static_assert(sizeof(Node<uint8_t, uint32_t>) == 1);
+static_assert(sizeof(Node<uint8_t, uint64_t>) == 1);
+
+static_assert(sizeof(Node<uint16_t, uint8_t>) == 2);
+static_assert(sizeof(Node<uint16_t, uint16_t>) == 2);
+static_assert(sizeof(Node<uint16_t, uint32_t>) == 2);
+static_assert(sizeof(Node<uint16_t, uint64_t>) == 2);
+
+static_assert(sizeof(Node<uint32_t, uint8_t>) == 4);
+static_assert(sizeof(Node<uint32_t, uint16_t>) == 4);
+static_assert(sizeof(Node<uint32_t, uint32_t>) == 4);
+static_assert(sizeof(Node<uint32_t, uint64_t>) == 4);
+
+static_assert(sizeof(Node<uint64_t, uint8_t>) == 8);
+static_assert(sizeof(Node<uint64_t, uint16_t>) == 8);
+static_assert(sizeof(Node<uint64_t, uint32_t>) == 8);
+static_assert(sizeof(Node<uint64_t, uint64_t>) == 8);
+
+// Directed multigraph whose node and edge indices are stored 1, 2, 4 or 8
+// bytes wide, the narrowest width that holds the current count, so an edge
+// record takes 3 bytes while there are fewer than 256 nodes and edges and 12
+// with a few hundred thousand. Both arrays double when full and are promoted
+// to a wider index with the widening copies when their count outgrows it;
+// indices handed out stay valid across both.
+//
+// The edges of a node are kept in an unbalanced binary search tree on the
+// end node, parallel edges to the right of each other, so lookups and
+// deletions take the depth of that tree and enumeration comes out sorted.
+class Graph {
+private:
+  uint8_t *_nodes;
+  uint64_t _node_count;
+  // Allocated entries of both arrays.
+  uint64_t _node_capacity;
+  uint32_t _node_index_bytes;
+
+  uint8_t *_edges;
+  // Records in use including the sentinel and deleted ones.
+  uint64_t _edge_records;
+  uint64_t _edge_capacity;
+  uint64_t _edge_count;
+  uint32_t _edge_index_bytes;
+  uint64_t _free_edge;
+
+  void resizeNodes(const uint64_t node_capacity,
+                   const uint32_t edge_index_bytes);
+
+  void resizeEdges(const uint64_t edge_capacity,
+                   const uint32_t edge_index_bytes,
+                   const uint32_t node_index_bytes);
+
+  template <typename E, typename N>
+  uint64_t addEdgeAs(const uint64_t start_node, const uint64_t end_node,
+                     const uint64_t edge);
+
+  template <typename E, typename N>
+  uint64_t findEdgeAs(const uint64_t start_node,
+                      const uint64_t end_node) const;
+
+  template <typename E, typename N>
+  bool deleteEdgeAs(const uint64_t start_node, const uint64_t end_node);
+
+  template <typename E, typename N>
+  void forEachEdgeAs(
+      const uint64_t start_node,
+      std::function<IteratorStatus(const uint64_t end_node)> &f) const;
+
+public:
+  Graph(void);
+  Graph(const Graph &) = delete;
+  Graph(Graph &&) = delete;
+  const Graph &operator=(const Graph &) = delete;
+  ~Graph(void);
+
+  // Returns the index of the new node, indices count up from 0.
+  uint64_t addNode(void);
+
+  // Adds an edge even when one from start_node to end_node exists, returns
+  // its index, never NO_EDGE.
+  uint64_t addEdge(const uint64_t start_node, const uint64_t end_node);
+
+  // Index of an edge from start_node to end_node, NO_EDGE when there is
+  // none.
+  uint64_t findEdge(const uint64_t start_node, const uint64_t end_node) const;
+
+  // Deletes one edge from start_node to end_node, false when there is none.
+  // Its index is reused by a later addEdge().
+  bool deleteEdge(const uint64_t start_node, const uint64_t end_node);
+
+  // End nodes of the edges of start_node in ascending order, parallel edges
+  // one after the other.
+  void
+  forEachEdge(const uint64_t start_node,
+              std::function<IteratorStatus(const uint64_t end_node)> f) const;
+
+  inline uint64_t getNodeCount(void) const { return _node_count; }
+  inline uint64_t getEdgeCount(void) const { return _edge_count; }
+  inline uint32_t getNodeIndexBytes(void) const { return _node_index_bytes; }
+  inline uint32_t getEdgeIndexBytes(void) const { return _edge_index_bytes; }
+
+  inline uint32_t getEdgeRecordBytes(void) const {
+    return 2 * _edge_index_bytes + _node_index_bytes;
+  }
+
+  // Bytes allocated for both arrays, spare capacity included.
+  inline uint64_t getBytes(void) const {
+    return _node_capacity * _edge_index_bytes +
+           _edge_capacity * getEdgeRecordBytes();
+  }
+};
+
+}; // namespace RecursiveGraph
+
+#endif // __RECURSIVE_GRAPH_HPP__
@@ -0,0 +1,28 @@
+#ifndef __RECURSIVE_GRAPH_SELF_TEST_HPP__
+#define __RECURSIVE_GRAPH_SELF_TEST_HPP__
+
+#include "recursive_graph/circuit_graph.hpp"
+
+class RecursiveGraphSelfTest {
+private:
+  uint64_t _random_state;
+  uint32_t _failure_count;
+
+  uint64_t nextRandom(void);
+
+  void check(const bool condition, const char *what);
+
+  void testPromotion(void);
+
+  void testRandomEdits(const uint32_t node_count, const uint32_t edit_count);
+
+  void testCircuitGraph(const uint32_t node_count, const uint32_t edge_count);
+
+public:
+  RecursiveGraphSelfTest(void) : _random_state(0x5eed), _failure_count(0) {}
+
+  // Returns false when any check failed, failures are printed to stderr.
+  bool selfTest(void);
+};
+
+#endif // __RECURSIVE_GRAPH_SELF_TEST_HPP__
@@ -0,0 +1,146 @@
+#ifndef __RENDER_PROFILER_HPP__
+#define __RENDER_PROFILER_HPP__
+
+#include "standard_defs/standard_defs.hpp"
+#include "trace_events/trace_events.hpp"
+#include <chrono>
+
+// Latency histogram with logarithmic buckets: SUB_BUCKETS buckets per power of
+// two, so any reported percentile is within 1 / SUB_BUCKETS of the real value.
+class LatencyHistogram {
+private:
+  static constexpr uint32_t SUB_BUCKET_BITS = 4;
+  static constexpr uint32_t SUB_BUCKETS = 1 << SUB_BUCKET_BITS;
+  static constexpr uint32_t OCTAVES = 64 - SUB_BUCKET_BITS;
+  static constexpr uint32_t BUCKET_COUNT = (OCTAVES + 1) * SUB_BUCKETS;
+
+  uint64_t _buckets[BUCKET_COUNT];
+  uint64_t _count;
+  uint64_t _total_ns;
+  uint64_t _min_ns;
+  uint64_t _max_ns;
+
+  static inline uint32_t getBucket(const uint64_t ns) {
+    if (ns < SUB_BUCKETS) {
+      return ns;
+    }
+    const uint32_t octave = 63 - __builtin_clzll(ns) - SUB_BUCKET_BITS + 1;
+    const uint32_t sub_bucket = (ns >> (octave - 1)) & (SUB_BUCKETS - 1);
+    return octave * SUB_BUCKETS + sub_bucket;
+  }
+
+  static inline uint64_t getBucketLowerBound(const uint32_t bucket) {
+    const uint32_t octave = bucket / SUB_BUCKETS;
+    const uint64_t sub_bucket = bucket % SUB_BUCKETS;
+    if (octave == 0) {
+      return sub_bucket;
+    }
+    return (SUB_BUCKETS + sub_bucket) << (octave - 1);
+  }
+
+public:
+  LatencyHistogram(void) { reset(); }
+
+  inline void reset(void) {
+    memset(_buckets, 0, sizeof(_buckets));
+    _count = 0;
+    _total_ns = 0;
+    _min_ns = UINT64_MAX;
+    _max_ns = 0;
+  }
+
+  inline void record(const uint64_t ns) {
+    _buckets[getBucket(ns)]++;
+    _count++;
+    _total_ns += ns;
+    _min_ns = std::min(_min_ns, ns);
+    _max_ns = std::max(_max_ns, ns);
+  }
+
+  inline uint64_t getCount(void) const { return _count; }
+  inline uint64_t getTotalNs(void) const { return _total_ns; }
+  inline uint64_t getMinNs(void) const { return _count ? _min_ns : 0; }
+  inline uint64_t getMaxNs(void) const { return _max_ns; }
+
+  // percentile in [0, 100], reports the middle of the bucket it falls into.
+  uint64_t getPercentileNs(const double percentile) const;
+};
+
+enum RenderStage : uint8_t {
+  FirstRenderStage = 0,
+  RenderStageDraw = FirstRenderStage,
+  RenderStageFlush,
+  RenderStageReadback,
+  RenderStageSend,
+  RenderStageEnd,
+  LastRenderStage = RenderStageEnd,
+  RenderStageCount
+};
+
+// Per stage timings of a video export. The exporter brackets every stage of a
+// frame with a RenderStageTimer (or begin()/end()) and calls frameDone() per
+// frame; the report gives p50/p95/p99 per stage and the frames/sec each stage
+// alone would allow, so the bottleneck is the stage with the lowest rate.
+// With TraceCategoryRender enabled every stage is also a trace span.
+class RenderProfiler {
+private:
+  using Clock = std::chrono::steady_clock;
+
+  LatencyHistogram _stages[RenderStageCount];
+  Clock::time_point _stage_start[RenderStageCount];
+  uint64_t _stage_trace_start_ns[RenderStageCount];
+  Clock::time_point _export_start;
+  uint64_t _frames;
+
+  static const char *getStageName(const RenderStage stage);
+
+public:
+  RenderProfiler(void) : _export_start(Clock::now()), _frames(0) {}
+
+  inline void begin(const RenderStage stage) {
+    if (TraceEvents::isEnabled(TraceCategoryRender)) {
+      _stage_trace_start_ns[stage] = TraceEvents::nowNs();
+    }
+    _stage_start[stage] = Clock::now();
+  }
+
+  inline void end(const RenderStage stage) {
+    const auto elapsed = Clock::now() - _stage_start[stage];
+    _stages[stage].record(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count());
+    if (TraceEvents::isEnabled(TraceCategoryRender)) {
+      TraceEvents::complete(TraceCategoryRender, getStageName(stage),
+                            _stage_trace_start_ns[stage], TraceEvents::nowNs(),
+                            {{"frame", static_cast<double>(_frames)}});
+    }
+  }
+
+  inline void frameDone(void) { _frames++; }
+
+  inline const LatencyHistogram &getStage(const RenderStage stage) const {
+    return _stages[stage];
+  }
+
+  void printReport(void) const;
+
+  bool dumpJson(const char *path) const;
+};
+
+// Times its scope as one stage, the stage also ends when the scope is left
+// by break or return.
+class RenderStageTimer {
+private:
+  RenderProfiler &_profiler;
+  const RenderStage _stage;
+
+public:
+  RenderStageTimer(void) = delete;
+  RenderStageTimer(RenderProfiler &profiler, const RenderStage stage)
+      : _profiler(profiler), _stage(stage) {
+    _profiler.begin(_stage);
+  }
+
+  ~RenderStageTimer(void) { _profiler.end(_stage); }
+};
+
+#endif // __RENDER_PROFILER_HPP__
@@ -0,0 +1,133 @@
+#ifndef __SOFTWARE_RASTERIZER_HPP__
+#define __SOFTWARE_RASTERIZER_HPP__
+
+#include "draw_backend/draw_backend.hpp"
+#include "worker_pool/worker_pool.hpp"
+
+enum SoftwareDrawCommandType : uint8_t {
+  FirstSoftwareDrawCommandType = 0,
+  SoftwareDrawClear = FirstSoftwareDrawCommandType,
+  SoftwareDrawRectangleGradientV,
+  SoftwareDrawCircleGradient,
+  SoftwareDrawCircleLines,
+  SoftwareDrawThickLine,
+  SoftwareDrawTriangle,
+  SoftwareDrawGlyph,
+  LastSoftwareDrawCommandType = SoftwareDrawGlyph
+};
+
+// One recorded draw call, clipped to its pixel bounding box
+// [x0, x1) x [y0, y1). Tiles only replay the commands overlapping them.
+struct SoftwareDrawCommand {
+  SoftwareDrawCommandType type;
+  int32_t x0;
+  int32_t y0;
+  int32_t x1;
+  int32_t y1;
+  Color color1;
+  Color color2;
+  Vector2 p1;
+  Vector2 p2;
+  Vector2 p3;
+  float f1;
+  float f2;
+  uint32_t glyph;
+};
+
+struct SoftwareGlyph {
+  int32_t codepoint;
+  int32_t offset_x;
+  int32_t offset_y;
+  int32_t width;
+  int32_t height;
+  uint8_t *alpha;
+};
+
+// CPU implementation of DrawBackend for hosts without GPU and display.
+//
+// Draw calls between beginFrame() and endFrame() are only recorded. endFrame()
+// splits the frame into TILE_SIZE x TILE_SIZE tiles and rasterizes them on a
+// WorkerPool, every tile replaying the recorded commands in order.
+// Because a tile always replays everything that overlaps it, tiles outside the
+// damage of a frame can be skipped and keep their previous content.
+// The result is a top-down RGBA8 buffer, the same layout raylib Image uses.
+class SoftwareRasterizer : public DrawBackend {
+private:
+  static constexpr int32_t TILE_SIZE = 64;
+  static constexpr int32_t FONT_BASE_SIZE = 32;
+  static constexpr int32_t FONT_FIRST_CODEPOINT = 32;
+  static constexpr int32_t FONT_CODEPOINT_COUNT = 95;
+  static constexpr uint32_t BEZIER_SEGMENT_DIVISIONS = 24;
+
+  const int32_t _width;
+  const int32_t _height;
+  const int32_t _tile_columns;
+  const int32_t _tile_rows;
+  uint32_t *_pixels;
+
+  std::vector<SoftwareDrawCommand> _commands;
+  std::vector<std::vector<uint32_t>> _tile_bins;
+  std::vector<uint8_t> _tile_dirty;
+  std::vector<int32_t> _dirty_tiles;
+  std::vector<SoftwareGlyph> _glyphs;
+  GlyphInfo *_font_data;
+
+  WorkerPool _pool;
+
+  void loadGlyphs(const char *font_path);
+
+  inline void pushCommand(const SoftwareDrawCommand &command);
+
+  void rasterizeDirtyTiles(void);
+
+  void rasterizeTile(const int32_t tile);
+
+public:
+  SoftwareRasterizer(void) = delete;
+  SoftwareRasterizer(const SoftwareRasterizer &) = delete;
+  const SoftwareRasterizer &operator=(const SoftwareRasterizer &) = delete;
+
+  // thread_count == 0 picks one thread per hardware thread.
+  SoftwareRasterizer(const int32_t width, const int32_t height,
+                     const uint32_t thread_count);
+
+  ~SoftwareRasterizer(void);
+
+  inline int32_t getWidth(void) const { return _width; }
+  inline int32_t getHeight(void) const { return _height; }
+  inline const uint32_t *getPixels(void) const { return _pixels; }
+
+  void beginFrame(void);
+
+  void endFrame(void);
+
+  // Only rasterizes the tiles touched by damage, all other pixels keep what
+  // the previous frame left in the buffer.
+  void endFrame(const std::vector<Rectangle> &damage);
+
+  void clearBackground(const Color color) override;
+
+  void drawRectangleGradientV(const Rectangle rect, const Color top,
+                              const Color bottom) override;
+
+  void drawRectangleLines(const Rectangle rect, const float thick,
+                          const Color color) override;
+
+  void drawCircleGradient(const Vector2 center, const float radius,
+                          const Color inner, const Color outer) override;
+
+  void drawCircleLines(const Vector2 center, const float radius,
+                       const Color color) override;
+
+  void drawSplineBezierQuadratic(const Vector2 *points,
+                                 const size_t point_count, const float thick,
+                                 const Color color) override;
+
+  void drawTriangle(const Vector2 v1, const Vector2 v2, const Vector2 v3,
+                    const Color color) override;
+
+  void drawTextCodepoint(const int codepoint, const Vector2 position,
+                         const float font_size, const Color color) override;
+};
+
+#endif // __SOFTWARE_RASTERIZER_HPP__
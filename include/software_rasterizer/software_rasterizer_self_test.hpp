@@ -0,0 +1,31 @@
+#ifndef __SOFTWARE_RASTERIZER_SELF_TEST_HPP__
+#define __SOFTWARE_RASTERIZER_SELF_TEST_HPP__
+
+#include "software_rasterizer/software_rasterizer.hpp"
+
+class SoftwareRasterizerSelfTest {
+private:
+  uint64_t _random_state;
+  uint32_t _failure_count;
+
+  uint64_t nextRandom(void);
+
+  void check(const bool condition, const char *what);
+
+  Color randomColor(void);
+
+  void drawScene(SoftwareRasterizer &rasterizer, const bool gradients);
+
+  void testSpans(void);
+
+  void testLevels(const int32_t width, const int32_t height,
+                  const bool gradients);
+
+public:
+  SoftwareRasterizerSelfTest(void) : _random_state(0x5eed), _failure_count(0) {}
+
+  // Returns false when any check failed, failures are printed to stderr.
+  bool selfTest(void);
+};
+
+#endif // __SOFTWARE_RASTERIZER_SELF_TEST_HPP__
@@ -24,12 +24,40 @@ enum IteratorStatus : uint8_t { IterationBreak, IterationContinue };
 #define TRY_PACKED __attribute__((packed))
 #define TRY_NOINLINE __attribute__((noinline))
 #define MAYBE_UNUSED __attribute__((unused))
+#define TRY_TARGET_SSE42 __attribute__((target("sse4.2")))
+#define TRY_TARGET_AVX2 __attribute__((target("avx2,fma")))
+#define TRY_TARGET_AVX512                                                      \
+  __attribute__((target("avx512f,avx512bw,avx512dq,avx512vl,avx2,fma")))
+
+// gcc before 12.3 reports its own AVX-512 intrinsics as reading uninitialized
+// values once they are inlined at -O3 (gcc bug 105593). Wrapped around the
+// functions using them, nowhere else.
+#if defined(__GNUC__) && !defined(__clang__) &&                               \
+    (__GNUC__ < 12 || (__GNUC__ == 12 && __GNUC_MINOR__ < 3))
+#define TRY_AVX512_WARNINGS_BEGIN                                              \
+  _Pragma("GCC diagnostic push")                                               \
+      _Pragma("GCC diagnostic ignored \"-Wuninitialized\"")                    \
+          _Pragma("GCC diagnostic ignored \"-Wmaybe-uninitialized\"")
+#define TRY_AVX512_WARNINGS_END _Pragma("GCC diagnostic pop")
+#else
+#define TRY_AVX512_WARNINGS_BEGIN
+#define TRY_AVX512_WARNINGS_END
+#endif
 
 void *operator new(std::size_t size);
 void operator delete(void *ptr) throw();
 void *operator new[](std::size_t size);
 void operator delete[](void *ptr) throw();
 
+// Between fork() and exec() the child may only make async-signal-safe
+// calls: it inherits the locks of stdio and malloc in whatever state the
+// parent's other threads had them. Prints message with write(2) and exits.
+[[noreturn]] TRY_INLINE void failForkedChild(const char *message) {
+  const ssize_t written = write(STDERR_FILENO, message, strlen(message));
+  (void)written;
+  _exit(1);
+}
+
 TRY_INLINE void *aligned_malloc(size_t size, size_t alignment) {
   void *ptr = NULL;
   if (posix_memalign(&ptr, alignment, size) != 0) {
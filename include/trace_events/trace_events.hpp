@@ -0,0 +1,108 @@
+#ifndef __TRACE_EVENTS_HPP__
+#define __TRACE_EVENTS_HPP__
+
+#include "standard_defs/standard_defs.hpp"
+
+enum TraceCategory : uint32_t {
+  TraceCategoryModel = 1u << 0,
+  TraceCategoryLayout = 1u << 1,
+  // One instant event per laid out node and edge, replaces the old
+  // NODE_LAYOUT / EDGE_LAYOUT printf output.
+  TraceCategoryLayoutDetail = 1u << 2,
+  TraceCategoryRender = 1u << 3,
+  TraceCategoryAll = ~0u
+};
+
+// Reads a comma separated list of category names as they appear in the
+// trace, "model", "layout", "layout_detail" and "render", or "all"; false
+// for anything else.
+bool parseTraceCategories(const char *names, uint32_t &categories);
+
+struct TraceArg {
+  const char *name;
+  double value;
+};
+
+struct TraceEvent {
+  static constexpr uint32_t MAX_ARGS = 4;
+
+  const char *name;
+  uint32_t category;
+  char phase;
+  uint8_t arg_count;
+  uint64_t start_ns;
+  uint64_t duration_ns;
+  TraceArg args[MAX_ARGS];
+};
+
+// Scoped spans and instant events, written out in the Chrome trace event
+// format (load the JSON in Perfetto or chrome://tracing).
+//
+// Every thread records into its own ring buffer, so recording takes no lock
+// and never blocks; when a ring is full its oldest events are overwritten.
+// The ring of an exited thread goes to the next thread that starts
+// recording, so a trace row can hold several short lived threads one after
+// the other and memory stays at one ring per thread alive at once.
+// Categories are switched on at runtime, a disabled category costs one
+// relaxed atomic load per event. Names and arg names must be string
+// literals, only the pointers are stored.
+class TraceEvents {
+private:
+  static std::atomic<uint32_t> _categories;
+
+public:
+  static inline void enableCategories(const uint32_t categories) {
+    _categories.store(categories, std::memory_order_relaxed);
+  }
+
+  static inline bool isEnabled(const uint32_t category) {
+    return (_categories.load(std::memory_order_relaxed) & category) != 0;
+  }
+
+  static uint64_t nowNs(void);
+
+  static void complete(const uint32_t category, const char *name,
+                       const uint64_t start_ns, const uint64_t end_ns,
+                       std::initializer_list<TraceArg> args = {});
+
+  static void instant(const uint32_t category, const char *name,
+                      std::initializer_list<TraceArg> args = {});
+
+  // Events still being recorded while this runs may come out torn, write the
+  // trace once the traced work is done.
+  static bool writeChromeTrace(const char *path);
+};
+
+class TraceScope {
+private:
+  const uint32_t _category;
+  const char *_name;
+  const uint64_t _start_ns;
+  TraceArg _args[TraceEvent::MAX_ARGS];
+  uint8_t _arg_count;
+
+public:
+  TraceScope(void) = delete;
+  TraceScope(const TraceScope &) = delete;
+  const TraceScope &operator=(const TraceScope &) = delete;
+
+  TraceScope(const uint32_t category, const char *name)
+      : _category(category), _name(name),
+        _start_ns(TraceEvents::isEnabled(category) ? TraceEvents::nowNs() : 0),
+        _arg_count(0) {}
+
+  ~TraceScope(void);
+
+  inline void addArg(const char *name, const double value) {
+    if (_arg_count < TraceEvent::MAX_ARGS) {
+      _args[_arg_count++] = {.name = name, .value = value};
+    }
+  }
+};
+
+#define TRACE_CONCAT_INNER(a, b) a##b
+#define TRACE_CONCAT(a, b) TRACE_CONCAT_INNER(a, b)
+#define TRACE_SCOPE(category, name)                                            \
+  TraceScope TRACE_CONCAT(_trace_scope_, __LINE__)(category, name)
+
+#endif // __TRACE_EVENTS_HPP__
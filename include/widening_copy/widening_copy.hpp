@@ -0,0 +1,39 @@
+#ifndef __WIDENING_COPY_HPP__
+#define __WIDENING_COPY_HPP__
+
+#include "standard_defs/standard_defs.hpp"
+
+// Zero extending copies between the index widths of a variable width store,
+// 1, 2, 4 or 8 bytes, for promoting an array in one pass when its indices
+// outgrow their width. The fast_memcpy experiment's AVX2 copy, completed
+// for every width pair, with SSE4.2, AVX2 and AVX-512 variants picked by
+// getCpuLevel() on every call.
+//
+// The vector loop starts once dst is aligned to the vector, elements before
+// that are copied one by one, so no store splits a cache line whatever
+// alignment the arrays come with; dst not aligned to its own element width
+// never reaches that point and is copied with unaligned stores throughout.
+// Source and destination must not overlap.
+
+void widenCopy8To16(const uint8_t *src, uint16_t *dst, const uint64_t count);
+
+void widenCopy16To32(const uint16_t *src, uint32_t *dst, const uint64_t count);
+
+void widenCopy32To64(const uint32_t *src, uint64_t *dst, const uint64_t count);
+
+// Any pair of widths in bytes with dst_width >= src_width, 8 to 32 or 16 to
+// 64 in one pass rather than through an intermediate array.
+void widenCopy(const void *src, const uint32_t src_width, void *dst,
+               const uint32_t dst_width, const uint64_t count);
+
+// count fields of src_width bytes, src_stride bytes apart, zero extended to
+// dst_width bytes dst_stride bytes apart: one field of an array of packed
+// records copied into the same field of wider records, or the interleaving
+// copies of fast_memcpy's copyarrINC loops. Strides equal to the widths
+// take widenCopy(). Neither pointer needs any alignment.
+void widenCopyStrided(const void *src, const uint64_t src_stride,
+                      const uint32_t src_width, void *dst,
+                      const uint64_t dst_stride, const uint32_t dst_width,
+                      const uint64_t count);
+
+#endif // __WIDENING_COPY_HPP__
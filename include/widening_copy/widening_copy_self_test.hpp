@@ -0,0 +1,27 @@
+#ifndef __WIDENING_COPY_SELF_TEST_HPP__
+#define __WIDENING_COPY_SELF_TEST_HPP__
+
+#include "widening_copy/widening_copy.hpp"
+
+class WideningCopySelfTest {
+private:
+  uint64_t _random_state;
+  uint32_t _failure_count;
+
+  uint64_t nextRandom(void);
+
+  void check(const bool condition, const char *what);
+
+  void testContiguous(const uint32_t src_width, const uint32_t dst_width);
+
+  void testStrided(const uint32_t src_width, const uint64_t src_stride,
+                   const uint32_t dst_width, const uint64_t dst_stride);
+
+public:
+  WideningCopySelfTest(void) : _random_state(0x5eed), _failure_count(0) {}
+
+  // Returns false when any check failed, failures are printed to stderr.
+  bool selfTest(void);
+};
+
+#endif // __WIDENING_COPY_SELF_TEST_HPP__
@@ -0,0 +1,47 @@
+#ifndef __SPIN_BARRIER_HPP__
+#define __SPIN_BARRIER_HPP__
+
+#include "standard_defs/standard_defs.hpp"
+
+// Barrier for a fixed set of threads that spins instead of sleeping, for
+// phases too short to pay for a futex wake-up. Waiters yield after a while,
+// so more threads than cores still make progress, only slowly.
+class SpinBarrier {
+private:
+  // A pause is about 140 cycles since Skylake, this spins for ~10 us.
+  static constexpr uint32_t SPINS_BEFORE_YIELD = 1 << 8;
+
+  alignas(64) std::atomic<uint32_t> _arrived;
+  alignas(64) std::atomic<uint32_t> _generation;
+  const uint32_t _thread_count;
+
+public:
+  SpinBarrier(void) = delete;
+  SpinBarrier(const SpinBarrier &) = delete;
+  const SpinBarrier &operator=(const SpinBarrier &) = delete;
+
+  SpinBarrier(const uint32_t thread_count)
+      : _arrived(0), _generation(0), _thread_count(thread_count) {
+    assert(thread_count > 0);
+  }
+
+  inline void wait(void) {
+    const uint32_t generation = _generation.load(std::memory_order_acquire);
+    if (_arrived.fetch_add(1, std::memory_order_acq_rel) + 1 ==
+        _thread_count) {
+      _arrived.store(0, std::memory_order_relaxed);
+      _generation.store(generation + 1, std::memory_order_release);
+      return;
+    }
+    uint32_t spins = 0;
+    while (_generation.load(std::memory_order_acquire) == generation) {
+      if (++spins < SPINS_BEFORE_YIELD) {
+        __builtin_ia32_pause();
+      } else {
+        std::this_thread::yield();
+      }
+    }
+  }
+};
+
+#endif // __SPIN_BARRIER_HPP__
@@ -0,0 +1,49 @@
+#ifndef __WORKER_POOL_HPP__
+#define __WORKER_POOL_HPP__
+
+#include "standard_defs/standard_defs.hpp"
+
+// Fixed set of threads running indexed tasks in parallel.
+//
+// parallelFor() hands out task indices [0, task_count) from an atomic counter
+// to the workers and to the calling thread, and returns once all of them are
+// done. Only one parallelFor() may run at a time.
+class WorkerPool {
+private:
+  std::vector<std::thread> _workers;
+  std::mutex _mutex;
+  std::condition_variable _wakeup;
+  std::condition_variable _done;
+  uint64_t _generation;
+  uint32_t _busy_workers;
+  bool _exit;
+
+  std::function<void(const uint32_t)> _task;
+  uint32_t _task_count;
+  std::atomic<uint32_t> _next_task;
+
+  void workerLoop(void);
+
+  void runTasks(void);
+
+  void pinWorkers(void);
+
+public:
+  WorkerPool(void) = delete;
+  WorkerPool(const WorkerPool &) = delete;
+  const WorkerPool &operator=(const WorkerPool &) = delete;
+
+  // thread_count counts the calling thread, 0 picks one thread per hardware
+  // thread. pin_threads binds worker i to the i-th CPU the process may run
+  // on (wrapping around), the calling thread is left alone.
+  WorkerPool(const uint32_t thread_count, const bool pin_threads = false);
+
+  ~WorkerPool(void);
+
+  inline uint32_t getThreadCount(void) const { return _workers.size() + 1; }
+
+  void parallelFor(const uint32_t task_count,
+                   std::function<void(const uint32_t)> task);
+};
+
+#endif // __WORKER_POOL_HPP__
@@ -5,6 +5,7 @@ inline void CircuitAnimator::traverseCircuitLevelized(
     std::function<IteratorStatus(const uint32_t, const uint32_t, const uint32_t,
                                  const uint32_t)>
         fe) const {
+  TRACE_SCOPE(TraceCategoryLayout, "traverseCircuitLevelized");
   std::vector<uint32_t> node_index_stk1;
   std::vector<uint32_t> const_node_index_stk1;
   std::vector<uint32_t> visited_fanin_counts;
@@ -137,6 +138,10 @@ inline uint32_t CircuitAnimator::getNumberOfLayers(void) const {
   return curr_layer + 1;
 }
 
+uint32_t CircuitAnimator::getLayerCount(void) const {
+  return getNumberOfLayers();
+}
+
 inline float CircuitAnimator::getInterLayerDistance(void) const {
   const uint32_t layer_count = getNumberOfLayers();
   const float screen_height = _screen_resolution.y;
@@ -176,6 +181,7 @@ inline float CircuitAnimator::getMaxNodeRadius(void) const {
 }
 
 void CircuitAnimator::finalizeLayout(void) {
+  TRACE_SCOPE(TraceCategoryLayout, "finalizeLayout");
   float curr_time(_animation_start_time);
   uint32_t curr_layer = 0;
   Vector2 curr_node_center = {.x = 0.0f, .y = getInterLayerDistance()};
@@ -199,8 +205,10 @@ void CircuitAnimator::finalizeLayout(void) {
             curr_node_center, _circuit.getNode(index).getType(),
             _circuit.getNode(index).getValue()));
 
-        printf("NODE_LAYOUT: index = %u, start_time = %f, end_time = %f\n",
-               index, curr_time, curr_time + KEY_FRAME_TIME);
+        TraceEvents::instant(TraceCategoryLayoutDetail, "NODE_LAYOUT",
+                             {{"index", static_cast<double>(index)},
+                              {"start_time", curr_time},
+                              {"end_time", curr_time + KEY_FRAME_TIME}});
 
         _node_anim_frame_indices[index] = _node_animation_frames.size() - 1;
 
@@ -210,6 +218,12 @@ void CircuitAnimator::finalizeLayout(void) {
       },
       [&](const uint32_t source_index, const uint32_t sink_index,
           const uint32_t sink_layer, const uint32_t count) {
+        // One span per batch of parallel edges: looking up their end points
+        // and building their key frames, each of which precomputes its arrow
+        // end time.
+        TraceScope edge_batch_scope(TraceCategoryLayout, "edge key frames");
+        edge_batch_scope.addArg("edges", count);
+
         const Vector2 start_point =
             _node_animation_frames[_node_anim_frame_indices[source_index]]
                 .getCenter();
@@ -258,10 +272,11 @@ void CircuitAnimator::finalizeLayout(void) {
           //_edge_animation_frames[_edge_animation_frames.size() - 1]
           //    ->addMiddlePoint(mid_point, control_point2);
 
-          printf("EDGE_LAYOUT: source_index = %u, sink_index = %u, start_time "
-                 "= %f, end_time = %f\n",
-                 source_index, sink_index, curr_time,
-                 curr_time + KEY_FRAME_TIME);
+          TraceEvents::instant(TraceCategoryLayoutDetail, "EDGE_LAYOUT",
+                               {{"source_index", static_cast<double>(source_index)},
+                                {"sink_index", static_cast<double>(sink_index)},
+                                {"start_time", curr_time},
+                                {"end_time", curr_time + KEY_FRAME_TIME}});
 
           curr_time += KEY_FRAME_TIME - KEY_FRAME_OVERLAP_TIME;
         }
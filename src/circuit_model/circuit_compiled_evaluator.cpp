@@ -0,0 +1,121 @@
+#include "circuit_model/circuit_compiled_evaluator.hpp"
+
+bool generateCircuitKernelSource(const CircuitModel &model,
+                                 const char *symbol, std::string &source) {
+  const uint32_t node_count = model.getNodeCount();
+  std::vector<uint32_t> layers;
+  model.computeLayers(layers);
+  std::vector<uint32_t> order(node_count);
+  for (uint32_t index = 0; index < node_count; index++) {
+    if (layers[index] == CircuitModel::UNREACHED_LAYER) {
+      TraceLog(LOG_ERROR, "CIRCUIT_KERNEL: node %u is not reachable", index);
+      return false;
+    }
+    order[index] = index;
+  }
+  std::stable_sort(order.begin(), order.end(),
+                   [&](const uint32_t a, const uint32_t b) {
+                     return layers[a] < layers[b];
+                   });
+
+  std::vector<uint32_t> numbers(node_count, 0);
+  uint32_t input_count = 0;
+  uint32_t output_count = 0;
+  model.forEachNode([&](const CircuitNode &node) {
+    if (node.getType() == InputNodeType) {
+      numbers[node.getIndex()] = input_count++;
+    } else if (node.getType() == OutputNodeType) {
+      numbers[node.getIndex()] = output_count++;
+    }
+    return IterationContinue;
+  });
+
+  const uint32_t chunk_count =
+      (node_count + KERNEL_CHUNK_NODES - 1) / KERNEL_CHUNK_NODES;
+  char line[128];
+  source = "// Generated from a CircuitModel, do not edit.\n"
+           "#include <stdint.h>\n";
+  for (uint32_t chunk = 0; chunk < chunk_count; chunk++) {
+    snprintf(line, sizeof(line),
+             "\n__attribute__((noinline)) static void chunk%u(const uint32_t "
+             "*inputs,\n    uint32_t *outputs, uint32_t *v) {\n",
+             chunk);
+    source += line;
+    const uint32_t first = chunk * KERNEL_CHUNK_NODES;
+    const uint32_t end = std::min(node_count, first + KERNEL_CHUNK_NODES);
+    for (uint32_t position = first; position < end; position++) {
+      const uint32_t index = order[position];
+      const CircuitNode &node = model.getNode(index);
+      switch (node.getType()) {
+      case InputNodeType:
+        snprintf(line, sizeof(line), "  v[%u] = inputs[%u];\n", index,
+                 numbers[index]);
+        source += line;
+        continue;
+      case ConstantType:
+        snprintf(line, sizeof(line), "  v[%u] = %uu;\n", index,
+                 node.getValue());
+        source += line;
+        continue;
+      case OutputNodeType:
+        snprintf(line, sizeof(line), "  outputs[%u] = 0u", numbers[index]);
+        break;
+      default:
+        snprintf(line, sizeof(line), "  v[%u] = %s", index,
+                 node.getType() == MultiplierType ? "1u" : "0u");
+        break;
+      }
+      source += line;
+
+      // A parallel edge adds a fanin once more or multiplies it in once
+      // more.
+      const char *op = node.getType() == MultiplierType ? " * v[" : " + v[";
+      node.forEachFanin(
+          [&](const uint32_t source_index, const uint32_t count) {
+            for (uint32_t i = 0; i < count; i++) {
+              source += op;
+              source += std::to_string(source_index) + "]";
+            }
+            return IterationContinue;
+          });
+      source += ";\n";
+    }
+    source += "}\n";
+  }
+
+  snprintf(line, sizeof(line),
+           "\nextern \"C\" void %s(const uint32_t *inputs, uint32_t "
+           "*outputs,\n    uint32_t *values) {\n",
+           symbol);
+  source += line;
+  for (uint32_t chunk = 0; chunk < chunk_count; chunk++) {
+    snprintf(line, sizeof(line), "  chunk%u(inputs, outputs, values);\n",
+             chunk);
+    source += line;
+  }
+  source += "}\n";
+  return true;
+}
+
+std::string CircuitCompiledEvaluator::getSource(const CircuitModel &model) {
+  std::string source;
+  if (!generateCircuitKernelSource(model, SYMBOL, source)) {
+    source.clear();
+  }
+  return source;
+}
+
+CircuitCompiledEvaluator::CircuitCompiledEvaluator(const CircuitModel &model,
+                                                   const char *cache_dir)
+    : _kernel(getSource(model), SYMBOL, cache_dir),
+      _function(_kernel.getFunction<CircuitKernelFunction>()),
+      _inputs(), _outputs(), _values(model.getNodeCount(), 0) {
+  model.forEachNode([&](const CircuitNode &node) {
+    if (node.getType() == InputNodeType) {
+      _inputs.push_back(0);
+    } else if (node.getType() == OutputNodeType) {
+      _outputs.push_back(0);
+    }
+    return IterationContinue;
+  });
+}
@@ -0,0 +1,159 @@
+#include "circuit_model/circuit_dot_writer.hpp"
+
+CircuitDotWriter::CircuitDotWriter(FILE *file)
+    : _file(file), _used(0), _failed(false) {
+  _buffer = static_cast<char *>(malloc(BUFFER_SIZE));
+  assert(_buffer != NULL && "Buy MORE RAM lol!!");
+}
+
+CircuitDotWriter::~CircuitDotWriter(void) { free(_buffer); }
+
+void CircuitDotWriter::flush(void) {
+  if (_used > 0 && !_failed && fwrite(_buffer, 1, _used, _file) != _used) {
+    _failed = true;
+  }
+  _used = 0;
+}
+
+static const char *getNodeLabel(const CircuitNode &node, char *digit) {
+  switch (node.getType()) {
+  case AdderType:
+    return "+";
+  case MultiplierType:
+    return "x";
+  case ConstantType:
+    if (node.getValue() <= 9) {
+      digit[0] = '0' + node.getValue();
+      digit[1] = '\0';
+      return digit;
+    }
+    return "C";
+  case InputNodeType:
+    return "I";
+  case OutputNodeType:
+    return "O";
+  default:
+    assert(0);
+    return "N";
+  }
+}
+
+static const char *getNodeColor(const CircuitNodeType type) {
+  switch (type) {
+  case AdderType:
+    return "skyblue";
+  case MultiplierType:
+    return "beige";
+  case ConstantType:
+    return "green";
+  case InputNodeType:
+    return "yellow";
+  case OutputNodeType:
+    return "pink";
+  default:
+    assert(0);
+    return "black";
+  }
+}
+
+void CircuitDotWriter::writeNode(const CircuitNode &node) {
+  char digit[2];
+  reserve(MAX_LINE_SIZE);
+  append("  ");
+  appendNodeId(node.getIndex());
+  append(" [label=\"");
+  append(getNodeLabel(node, digit));
+  append("\", fillcolor=");
+  append(getNodeColor(node.getType()));
+  append("];\n");
+
+  node.forEachFanout([&](const uint32_t sink, const uint32_t count) {
+    for (uint32_t i = 0; i < count; i++) {
+      reserve(MAX_LINE_SIZE);
+      append("  ");
+      appendNodeId(node.getIndex());
+      append(" -> ");
+      appendNodeId(sink);
+      append(";\n");
+    }
+    return IterationContinue;
+  });
+}
+
+void CircuitDotWriter::writeLayerGroups(const CircuitModel &circuit) {
+  std::vector<uint32_t> layers;
+  const uint32_t layer_count = circuit.computeLayers(layers);
+
+  // Counting sort of the node indices by layer.
+  std::vector<uint32_t> layer_starts(layer_count + 1, 0);
+  for (const uint32_t layer : layers) {
+    if (layer != CircuitModel::UNREACHED_LAYER) {
+      layer_starts[layer + 1]++;
+    }
+  }
+  for (uint32_t layer = 0; layer < layer_count; layer++) {
+    layer_starts[layer + 1] += layer_starts[layer];
+  }
+  std::vector<uint32_t> layer_nodes(layer_starts[layer_count]);
+  std::vector<uint32_t> layer_fill(layer_starts.begin(),
+                                   layer_starts.end() - 1);
+  for (uint32_t index = 0; index < layers.size(); index++) {
+    if (layers[index] != CircuitModel::UNREACHED_LAYER) {
+      layer_nodes[layer_fill[layers[index]]++] = index;
+    }
+  }
+
+  for (uint32_t layer = 0; layer < layer_count; layer++) {
+    reserve(MAX_LINE_SIZE);
+    append("  { rank=same;");
+    for (uint32_t i = layer_starts[layer]; i < layer_starts[layer + 1]; i++) {
+      reserve(MAX_LINE_SIZE);
+      append(" ");
+      appendNodeId(layer_nodes[i]);
+      append(";");
+    }
+    append(" }\n");
+  }
+}
+
+bool CircuitDotWriter::write(const CircuitModel &circuit,
+                             const bool rank_layers) {
+  reserve(MAX_LINE_SIZE);
+  append("digraph circuit {\n"
+         "  node [shape=circle, style=filled];\n");
+
+  circuit.forEachNode([&](const CircuitNode &node) {
+    writeNode(node);
+    return _failed ? IterationBreak : IterationContinue;
+  });
+
+  if (rank_layers && !_failed) {
+    writeLayerGroups(circuit);
+  }
+
+  reserve(MAX_LINE_SIZE);
+  append("}\n");
+  flush();
+  return !_failed;
+}
+
+bool CircuitDotWriter::writeFile(const CircuitModel &circuit, const char *path,
+                                 const bool rank_layers) {
+  FILE *file = fopen(path, "w");
+  if (file == NULL) {
+    TraceLog(LOG_ERROR, "DOT: could not create %s: %s", path,
+             strerror(errno));
+    return false;
+  }
+
+  bool written = false;
+  {
+    CircuitDotWriter writer(file);
+    written = writer.write(circuit, rank_layers);
+  }
+  if (fclose(file) != 0 || !written) {
+    TraceLog(LOG_ERROR, "DOT: could not write %s: %s", path, strerror(errno));
+    return false;
+  }
+  return true;
+}
@@ -1 +1,61 @@
 #include "circuit_model/circuit_model.hpp"
+
+uint32_t CircuitModel::computeLayers(std::vector<uint32_t> &layers) const {
+  const uint32_t node_count = getNodeCount();
+  std::vector<uint32_t> visited_fanin_counts(node_count, 0);
+  std::vector<uint32_t> ready;
+  ready.reserve(node_count);
+
+  bool has_constants = false;
+  for (const auto &node : circuit_nodes) {
+    if (node.getType() == InputNodeType) {
+      ready.push_back(node.getIndex());
+    } else if (node.getType() == ConstantType) {
+      ready.push_back(node.getIndex());
+      has_constants = true;
+    }
+  }
+
+  // The animator visits the constants as a layer of their own after the
+  // inputs, nothing else can end up above the layer after theirs.
+  const uint32_t first_gate_layer = has_constants ? 2 : 1;
+  layers.assign(node_count, UNREACHED_LAYER);
+  for (const uint32_t index : ready) {
+    layers[index] = circuit_nodes[index].getType() == InputNodeType ? 0 : 1;
+  }
+
+  uint32_t layer_count = ready.empty() ? 0 : 1;
+  for (size_t i = 0; i < ready.size(); i++) {
+    const uint32_t index = ready[i];
+    const uint32_t sink_layer = std::max(first_gate_layer, layers[index] + 1);
+    layer_count = std::max(layer_count, layers[index] + 1);
+
+    circuit_nodes[index].forEachFanout(
+        [&](const uint32_t sink_index, const uint32_t count) {
+          const CircuitNode &sink = circuit_nodes[sink_index];
+          if (sink.getType() == InputNodeType ||
+              sink.getType() == ConstantType) {
+            return IterationContinue;
+          }
+          layers[sink_index] = layers[sink_index] == UNREACHED_LAYER
+                                   ? sink_layer
+                                   : std::max(layers[sink_index], sink_layer);
+          visited_fanin_counts[sink_index] += count;
+          if (visited_fanin_counts[sink_index] == sink.getFaninCount()) {
+            ready.push_back(sink_index);
+          }
+          return IterationContinue;
+        });
+  }
+
+  // Nodes with a fanin that was never reached are not laid out either.
+  for (uint32_t index = 0; index < node_count; index++) {
+    if (layers[index] != UNREACHED_LAYER &&
+        visited_fanin_counts[index] != circuit_nodes[index].getFaninCount() &&
+        circuit_nodes[index].getType() != InputNodeType &&
+        circuit_nodes[index].getType() != ConstantType) {
+      layers[index] = UNREACHED_LAYER;
+    }
+  }
+  return layer_count;
+}
@@ -1 +1,714 @@
 #include "circuit_model/circuit_model_self_test.hpp"
+#include <dirent.h>
+#include <unistd.h>
+
+uint64_t CircuitModelSelfTest::nextRandom(void) {
+  // SplitMix64, identical sequence on every platform.
+  uint64_t z = (_random_state += 0x9e3779b97f4a7c15ull);
+  z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ull;
+  z = (z ^ (z >> 27)) * 0x94d049bb133111ebull;
+  return z ^ (z >> 31);
+}
+
+void CircuitModelSelfTest::check(const bool condition, const char *what) {
+  if (!condition) {
+    fprintf(stderr, "CIRCUIT_MODEL: self test failed: %s\n", what);
+    _failure_count++;
+  }
+}
+
+// Interprets model the way the kernels and the simplification define it:
+// adders and multipliers over their fanins with parallel edges counted, in
+// 32 bit wrapping arithmetic, outputs the sum of their fanins. inputs are
+// the values of the input nodes in index order, unreached nodes stay 0.
+static void evaluateCircuit(const CircuitModel &model,
+                            const std::vector<uint32_t> &inputs,
+                            std::vector<uint32_t> &values) {
+  std::vector<uint32_t> layers;
+  model.computeLayers(layers);
+  std::vector<uint32_t> order;
+  for (uint32_t index = 0; index < model.getNodeCount(); index++) {
+    if (layers[index] != CircuitModel::UNREACHED_LAYER) {
+      order.push_back(index);
+    }
+  }
+  std::stable_sort(order.begin(), order.end(),
+                   [&](const uint32_t a, const uint32_t b) {
+                     return layers[a] < layers[b];
+                   });
+
+  values.assign(model.getNodeCount(), 0);
+  uint32_t input = 0;
+  model.forEachNode([&](const CircuitNode &node) {
+    if (node.getType() == InputNodeType) {
+      values[node.getIndex()] = inputs[input++];
+    }
+    return IterationContinue;
+  });
+  for (const uint32_t index : order) {
+    const CircuitNode &node = model.getNode(index);
+    switch (node.getType()) {
+    case InputNodeType:
+      continue;
+    case ConstantType:
+      values[index] = node.getValue();
+      continue;
+    default:
+      break;
+    }
+    const bool product = node.getType() == MultiplierType;
+    uint32_t value = product ? 1 : 0;
+    node.forEachFanin([&](const uint32_t source, const uint32_t count) {
+      for (uint32_t i = 0; i < count; i++) {
+        value = product ? value * values[source] : value + values[source];
+      }
+      return IterationContinue;
+    });
+    values[index] = value;
+  }
+}
+
+static uint64_t getEdgeCount(const CircuitModel &model) {
+  uint64_t edge_count = 0;
+  model.forEachNode([&](const CircuitNode &node) {
+    edge_count += node.getFaninCount();
+    return IterationContinue;
+  });
+  return edge_count;
+}
+
+static void removeDirectory(const char *path) {
+  DIR *dir = opendir(path);
+  if (dir != NULL) {
+    for (struct dirent *entry = readdir(dir); entry != NULL;
+         entry = readdir(dir)) {
+      if (entry->d_name[0] != '.') {
+        unlinkat(dirfd(dir), entry->d_name, 0);
+      }
+    }
+    closedir(dir);
+  }
+  rmdir(path);
+}
+
+// Many parallel edges, and constants up to 9, so products of the deeper
+// layers wrap around.
+RandomCircuitParameters
+CircuitModelSelfTest::getCircuitParameters(const uint32_t node_count) {
+  RandomCircuitParameters parameters =
+      getDefaultRandomCircuitParameters(node_count, nextRandom());
+  parameters.multi_edge_rate = 0.3f;
+  parameters.constant_ratio = 0.1f;
+  return parameters;
+}
+
+// Compiled into a fresh cache directory, the kernel has to give the outputs
+// of the interpreter for random inputs. Needs a C++ compiler at run time.
+void CircuitModelSelfTest::testCompiled(const uint32_t node_count) {
+  static constexpr uint32_t INPUT_VECTORS = 16;
+
+  const RandomCircuit circuit(getCircuitParameters(node_count));
+  bool has_parallel_edges = false;
+  std::vector<uint32_t> input_nodes;
+  std::vector<uint32_t> output_nodes;
+  circuit.forEachNode([&](const CircuitNode &node) {
+    node.forEachFanin([&](const uint32_t, const uint32_t count) {
+      has_parallel_edges |= count > 1;
+      return IterationContinue;
+    });
+    if (node.getType() == InputNodeType) {
+      input_nodes.push_back(node.getIndex());
+    } else if (node.getType() == OutputNodeType) {
+      output_nodes.push_back(node.getIndex());
+    }
+    return IterationContinue;
+  });
+  check(has_parallel_edges, "the random circuit has parallel edges");
+
+  char cache_dir[] = "/tmp/circuit_kernels_XXXXXX";
+  check(mkdtemp(cache_dir) != NULL, "compiled kernel cache directory");
+  {
+    CircuitCompiledEvaluator compiled(circuit, cache_dir);
+    check(compiled.isLoaded() && !compiled.wasCached(), "kernel compiles");
+    check(compiled.getInputCount() == input_nodes.size() &&
+              compiled.getOutputCount() == output_nodes.size(),
+          "kernel inputs and outputs");
+    CircuitCompiledEvaluator cached(circuit, cache_dir);
+    check(cached.isLoaded() && cached.wasCached(), "kernel comes cached");
+
+    if (compiled.isLoaded()) {
+      bool outputs_agree = true;
+      std::vector<uint32_t> inputs(input_nodes.size());
+      std::vector<uint32_t> values;
+      for (uint32_t vector = 0; vector < INPUT_VECTORS; vector++) {
+        for (uint32_t input = 0; input < inputs.size(); input++) {
+          inputs[input] = nextRandom();
+          compiled.setInput(input, inputs[input]);
+        }
+        compiled.evaluate();
+        evaluateCircuit(circuit, inputs, values);
+        for (uint32_t output = 0; output < output_nodes.size(); output++) {
+          outputs_agree &=
+              compiled.getOutput(output) == values[output_nodes[output]];
+        }
+      }
+      check(outputs_agree, "compiled kernel agrees with the interpreter");
+    }
+  }
+  removeDirectory(cache_dir);
+}
+
+// Simplifies model and checks what holds for every circuit: inputs and
+// outputs stay, every node that maps to simplified has the value there for
+// random inputs, original_indices inverts new_indices, and simplifying
+// again changes nothing.
+void CircuitModelSelfTest::checkSimplified(
+    const CircuitModel &model, CircuitModel &simplified,
+    std::vector<uint32_t> &new_indices,
+    std::vector<uint32_t> &original_indices) {
+  static constexpr uint32_t INPUT_VECTORS = 4;
+
+  simplifyCircuitModel(model, simplified, new_indices, original_indices);
+  check(new_indices.size() == model.getNodeCount() &&
+            original_indices.size() == simplified.getNodeCount(),
+        "simplify maps every node");
+
+  uint32_t input_count = 0;
+  bool kept = true;
+  model.forEachNode([&](const CircuitNode &node) {
+    const uint32_t index = node.getIndex();
+    if (node.getType() == InputNodeType) {
+      input_count++;
+      kept &= new_indices[index] != REMOVED_CIRCUIT_NODE &&
+              simplified.getNode(new_indices[index]).getType() ==
+                  InputNodeType;
+    } else if (node.getType() == OutputNodeType) {
+      kept &= new_indices[index] != REMOVED_CIRCUIT_NODE &&
+              simplified.getNode(new_indices[index]).getType() ==
+                  OutputNodeType;
+    }
+    return IterationContinue;
+  });
+  check(kept, "simplify keeps every input and output");
+
+  bool inverse = true;
+  for (uint32_t index = 0; index < simplified.getNodeCount(); index++) {
+    const uint32_t original = original_indices[index];
+    inverse &= original == NEW_CIRCUIT_NODE
+                   ? simplified.getNode(index).getType() == ConstantType
+                   : new_indices[original] == index;
+  }
+  check(inverse, "original_indices inverts new_indices");
+
+  // Inputs keep their order, so the same vector feeds both.
+  bool same_values = true;
+  std::vector<uint32_t> inputs(input_count);
+  std::vector<uint32_t> values;
+  std::vector<uint32_t> simplified_values;
+  for (uint32_t vector = 0; vector < INPUT_VECTORS; vector++) {
+    for (uint32_t &input : inputs) {
+      input = nextRandom();
+    }
+    evaluateCircuit(model, inputs, values);
+    evaluateCircuit(simplified, inputs, simplified_values);
+    for (uint32_t index = 0; index < model.getNodeCount(); index++) {
+      same_values &= new_indices[index] == REMOVED_CIRCUIT_NODE ||
+                     values[index] == simplified_values[new_indices[index]];
+    }
+  }
+  check(same_values, "simplified nodes keep the values of the originals");
+
+  CircuitModel again;
+  std::vector<uint32_t> again_new_indices;
+  std::vector<uint32_t> again_original_indices;
+  simplifyCircuitModel(simplified, again, again_new_indices,
+                       again_original_indices);
+  bool identity = again.getNodeCount() == simplified.getNodeCount() &&
+                  getEdgeCount(again) == getEdgeCount(simplified);
+  for (uint32_t index = 0; identity && index < again.getNodeCount();
+       index++) {
+    identity &= again_new_indices[index] == index &&
+                again_original_indices[index] == index;
+  }
+  check(identity, "simplification is idempotent");
+}
+
+void CircuitModelSelfTest::testSimplify(const uint32_t node_count) {
+  const RandomCircuit circuit(getCircuitParameters(node_count));
+  CircuitModel simplified;
+  std::vector<uint32_t> new_indices;
+  std::vector<uint32_t> original_indices;
+  checkSimplified(circuit, simplified, new_indices, original_indices);
+  check(simplified.getNodeCount() < circuit.getNodeCount(),
+        "a random circuit with constants simplifies");
+}
+
+// Small circuits for each rule, checked node by node.
+void CircuitModelSelfTest::testSimplifyCases(void) {
+  CircuitModel simplified;
+  std::vector<uint32_t> new_indices;
+  std::vector<uint32_t> original_indices;
+
+  // x * 3 * 3 * 3 over parallel edges and x * 7^20, which wraps: both
+  // merge into a new constant of the power.
+  {
+    CircuitModel model;
+    const uint32_t x = model.addNode(InputNodeType, 0);
+    const uint32_t three = model.addNode(ConstantType, 3);
+    const uint32_t seven = model.addNode(ConstantType, 7);
+    const uint32_t cube = model.addNode(MultiplierType, 0);
+    const uint32_t wrapped = model.addNode(MultiplierType, 0);
+    model.addEdge(x, cube);
+    model.addEdges(three, cube, 3);
+    model.addEdge(x, wrapped);
+    model.addEdges(seven, wrapped, 20);
+    model.addEdge(cube, model.addNode(OutputNodeType, 0));
+    model.addEdge(wrapped, model.addNode(OutputNodeType, 0));
+    checkSimplified(model, simplified, new_indices, original_indices);
+
+    uint32_t power = 1;
+    for (uint32_t i = 0; i < 20; i++) {
+      power *= 7;
+    }
+    std::vector<uint32_t> new_values;
+    for (uint32_t index = 0; index < simplified.getNodeCount(); index++) {
+      if (original_indices[index] == NEW_CIRCUIT_NODE) {
+        new_values.push_back(simplified.getNode(index).getValue());
+      }
+    }
+    check(new_values == std::vector<uint32_t>({27, power}) &&
+              new_indices[three] == REMOVED_CIRCUIT_NODE &&
+              new_indices[seven] == REMOVED_CIRCUIT_NODE,
+          "parallel constant edges merge into their power");
+  }
+
+  // x + 5 keeps the constant it has, x + 2 + 3 gets a new 5.
+  {
+    simplified = CircuitModel();
+    CircuitModel model;
+    const uint32_t x = model.addNode(InputNodeType, 0);
+    const uint32_t two = model.addNode(ConstantType, 2);
+    const uint32_t three = model.addNode(ConstantType, 3);
+    const uint32_t five = model.addNode(ConstantType, 5);
+    const uint32_t reused = model.addNode(AdderType, 0);
+    const uint32_t merged = model.addNode(AdderType, 0);
+    model.addEdge(x, reused);
+    model.addEdge(five, reused);
+    model.addEdge(x, merged);
+    model.addEdge(two, merged);
+    model.addEdge(three, merged);
+    model.addEdge(reused, model.addNode(OutputNodeType, 0));
+    model.addEdge(merged, model.addNode(OutputNodeType, 0));
+    checkSimplified(model, simplified, new_indices, original_indices);
+
+    uint32_t new_constants = 0;
+    for (const uint32_t original : original_indices) {
+      new_constants += original == NEW_CIRCUIT_NODE ? 1 : 0;
+    }
+    check(new_indices[five] != REMOVED_CIRCUIT_NODE && new_constants == 1 &&
+              simplified.getNode(new_indices[merged]).getFaninCount() == 2 &&
+              new_indices[two] == REMOVED_CIRCUIT_NODE,
+          "a single constant edge is reused, several merge into a new one");
+  }
+
+  // x through an adder of one fanin, a multiplier by 1 and an adder of 0:
+  // every gate of the chain forwards to x.
+  {
+    simplified = CircuitModel();
+    CircuitModel model;
+    const uint32_t x = model.addNode(InputNodeType, 0);
+    const uint32_t one = model.addNode(ConstantType, 1);
+    const uint32_t zero = model.addNode(ConstantType, 0);
+    const uint32_t pass = model.addNode(AdderType, 0);
+    const uint32_t times_one = model.addNode(MultiplierType, 0);
+    const uint32_t plus_zero = model.addNode(AdderType, 0);
+    const uint32_t output = model.addNode(OutputNodeType, 0);
+    model.addEdge(x, pass);
+    model.addEdge(pass, times_one);
+    model.addEdge(one, times_one);
+    model.addEdge(times_one, plus_zero);
+    model.addEdge(zero, plus_zero);
+    model.addEdge(plus_zero, output);
+    checkSimplified(model, simplified, new_indices, original_indices);
+
+    check(simplified.getNodeCount() == 2 &&
+              new_indices[pass] == new_indices[x] &&
+              new_indices[times_one] == new_indices[x] &&
+              new_indices[plus_zero] == new_indices[x] &&
+              simplified.getNode(new_indices[output]).getFaninCount() == 1 &&
+              new_indices[one] == REMOVED_CIRCUIT_NODE,
+          "forward chains collapse onto their source");
+  }
+
+  // Without outputs what reaches a node without fanouts stays: a gate that
+  // only forwards x leaves x, the unread constant and the product stay.
+  {
+    simplified = CircuitModel();
+    CircuitModel model;
+    const uint32_t x = model.addNode(InputNodeType, 0);
+    const uint32_t y = model.addNode(InputNodeType, 0);
+    const uint32_t constant = model.addNode(ConstantType, 4);
+    const uint32_t sum = model.addNode(AdderType, 0);
+    const uint32_t pass = model.addNode(AdderType, 0);
+    const uint32_t product = model.addNode(MultiplierType, 0);
+    const uint32_t square = model.addNode(MultiplierType, 0);
+    model.addEdge(x, sum);
+    model.addEdge(y, sum);
+    model.addEdge(x, pass);
+    model.addEdge(sum, product);
+    model.addEdge(y, product);
+    model.addEdges(sum, square, 2);
+    model.addEdge(square, product);
+    checkSimplified(model, simplified, new_indices, original_indices);
+
+    check(simplified.getNodeCount() == 6 &&
+              new_indices[pass] == new_indices[x] &&
+              new_indices[constant] != REMOVED_CIRCUIT_NODE &&
+              new_indices[product] != REMOVED_CIRCUIT_NODE,
+          "without outputs the nodes without fanouts are kept");
+  }
+}
+
+// Writes text to a temporary file and reads it back with reader.
+static bool readNetlist(NetlistReader &reader, const std::string &text,
+                        CircuitModel &circuit) {
+  char path[] = "/tmp/circuit_netlist_XXXXXX";
+  const int fd = mkstemp(path);
+  if (fd < 0) {
+    return false;
+  }
+  const bool written = write(fd, text.data(), text.size()) ==
+                       static_cast<ssize_t>(text.size());
+  close(fd);
+  const bool read = written && reader.read(path, circuit);
+  unlink(path);
+  return read;
+}
+
+// Same nodes under the same indices with the same edges, parallel edges
+// counted.
+static bool isSameCircuit(const CircuitModel &a, const CircuitModel &b) {
+  if (a.getNodeCount() != b.getNodeCount()) {
+    return false;
+  }
+  std::vector<std::pair<uint32_t, uint32_t>> fanouts;
+  std::vector<std::pair<uint32_t, uint32_t>> other_fanouts;
+  for (uint32_t index = 0; index < a.getNodeCount(); index++) {
+    const CircuitNode &node = a.getNode(index);
+    const CircuitNode &other = b.getNode(index);
+    fanouts.clear();
+    other_fanouts.clear();
+    node.forEachFanout([&](const uint32_t sink, const uint32_t count) {
+      fanouts.push_back({sink, count});
+      return IterationContinue;
+    });
+    other.forEachFanout([&](const uint32_t sink, const uint32_t count) {
+      other_fanouts.push_back({sink, count});
+      return IterationContinue;
+    });
+    if (node.getType() != other.getType() ||
+        node.getValue() != other.getValue() || fanouts != other_fanouts ||
+        node.getFaninCount() != other.getFaninCount()) {
+      return false;
+    }
+  }
+  return true;
+}
+
+void CircuitModelSelfTest::testNetlistCases(void) {
+  NetlistReader reader(2);
+  {
+    CircuitModel circuit;
+    check(readNetlist(reader, "", circuit) && circuit.getNodeCount() == 0,
+          "an empty netlist is an empty circuit");
+  }
+  {
+    CircuitModel expected;
+    expected.addNode(InputNodeType, 0);
+    expected.addNode(OutputNodeType, 7);
+    expected.addEdges(0, 1, 4);
+    CircuitModel circuit;
+    check(readNetlist(reader,
+                      "N 1 O 7\r\n  # comment\r\n\r\nN 0 I 0\r\n"
+                      "E 0 1 3 # three\r\n\tE 0 1",
+                      circuit) &&
+              isSameCircuit(circuit, expected),
+          "netlist with CRLF, comments, blanks and no trailing newline");
+  }
+
+  // Syntax errors are reported on their line, the others on none.
+  const struct {
+    const char *text;
+    uint64_t line;
+    const char *what;
+  } errors[] = {
+      {"Q 0 1\n", 1, "unknown record fails on its line"},
+      {"N 0 I 0\n\n# comment\nN 1 X 0\n", 4,
+       "unknown node type fails on its line"},
+      {"N 0 I 0\nN 1 O 0\nE 0 1 0\n", 3, "zero edges fail on their line"},
+      {"N 0 I 0\r\nN 1 O 0\r\nE 0\r\n", 3,
+       "edge without sink fails on its line"},
+      {"N 0 I 0\nN 1 O 4294967296", 2,
+       "value over 32 bits fails on its line"},
+      {"N 0 I 0 7\n", 1, "field after a node fails on its line"},
+      {"N 0 I 0\nN 0 O 0\n", 0, "node defined twice fails"},
+      {"N 0 I 0\nN 2 O 0\n", 0, "node index out of range fails"},
+      {"N 0 I 0\nN 1 O 0\nE 0 2\n", 0, "edge to an undefined node fails"},
+      {"N 0 I 0\nN 1 O 0\nE 1 1\n", 0, "self loop fails"},
+  };
+  for (const auto &error : errors) {
+    CircuitModel circuit;
+    check(!readNetlist(reader, error.text, circuit) &&
+              reader.getErrorLine() == error.line &&
+              circuit.getNodeCount() == 0,
+          error.what);
+  }
+}
+
+// Larger than 1 MiB, the smallest chunk, for each of the 8 chunks 2 threads
+// cut a netlist into, with nodes, edges, comments and blank lines in random
+// order and random line ends, so the chunk boundaries fall on every kind of
+// line. Read in parallel it has to give the circuit it was written from, and
+// a broken line on either side of each boundary has to fail on its line.
+void CircuitModelSelfTest::testNetlistChunks(void) {
+  static constexpr uint32_t NODE_COUNT = 100000;
+  static constexpr uint32_t EDGE_LINES = 500000;
+  static constexpr uint32_t CHUNK_COUNT = 8;
+  static constexpr CircuitNodeType TYPES[] = {
+      AdderType, MultiplierType, ConstantType, InputNodeType, OutputNodeType};
+  static constexpr char TYPE_NAMES[] = "AMCIO";
+
+  CircuitModel expected;
+  std::vector<std::string> lines;
+  char line[64];
+  for (uint32_t index = 0; index < NODE_COUNT; index++) {
+    const uint32_t type = nextRandom() % 5;
+    const uint32_t value = nextRandom() % 1000;
+    expected.addNode(TYPES[type], value);
+    snprintf(line, sizeof(line), "N %u %c %u", index, TYPE_NAMES[type],
+             value);
+    lines.push_back(line);
+  }
+  for (uint32_t i = 0; i < EDGE_LINES; i++) {
+    const uint32_t source = nextRandom() % NODE_COUNT;
+    const uint32_t sink = (source + 1 + nextRandom() % (NODE_COUNT - 1)) %
+                          NODE_COUNT;
+    const uint32_t count = nextRandom() % 4;
+    expected.addEdges(source, sink, std::max(count, 1u));
+    if (count == 0) {
+      snprintf(line, sizeof(line), "E %u %u", source, sink);
+    } else {
+      snprintf(line, sizeof(line), "E %u %u %u", source, sink, count);
+    }
+    lines.push_back(line);
+    if (nextRandom() % 8 == 0) {
+      snprintf(line, sizeof(line), "# comment %lu", nextRandom() % 100000);
+      lines.push_back(line);
+    } else if (nextRandom() % 16 == 0) {
+      lines.push_back("");
+    }
+  }
+  for (size_t i = lines.size() - 1; i > 0; i--) {
+    std::swap(lines[i], lines[nextRandom() % (i + 1)]);
+  }
+
+  std::string text;
+  std::vector<size_t> line_starts;
+  for (size_t i = 0; i < lines.size(); i++) {
+    line_starts.push_back(text.size());
+    text += lines[i];
+    if (i + 1 < lines.size()) {
+      text += nextRandom() % 4 == 0 ? "\r\n" : "\n";
+    }
+  }
+  check(text.size() > CHUNK_COUNT << 20, "netlist is cut into 8 chunks");
+
+  NetlistReader reader(2);
+  {
+    CircuitModel circuit;
+    check(readNetlist(reader, text, circuit) &&
+              isSameCircuit(circuit, expected),
+          "netlist read in chunks gives the circuit");
+  }
+
+  std::vector<size_t> broken_lines = {0, lines.size() - 1};
+  for (uint32_t chunk = 1; chunk < CHUNK_COUNT; chunk++) {
+    const size_t boundary = text.size() * chunk / CHUNK_COUNT;
+    const size_t last_line =
+        std::upper_bound(line_starts.begin(), line_starts.end(), boundary) -
+        line_starts.begin() - 1;
+    broken_lines.push_back(last_line);
+    broken_lines.push_back(last_line + 1);
+  }
+  bool errors_on_their_lines = true;
+  for (size_t broken_line : broken_lines) {
+    while (lines[broken_line].empty()) {
+      broken_line++;
+    }
+    // Same length, so the chunks stay where they are.
+    const char first = text[line_starts[broken_line]];
+    text[line_starts[broken_line]] = 'Z';
+    CircuitModel circuit;
+    errors_on_their_lines &= !readNetlist(reader, text, circuit) &&
+                             reader.getErrorLine() == broken_line + 1;
+    text[line_starts[broken_line]] = first;
+  }
+  check(errors_on_their_lines, "broken lines at chunk boundaries fail on "
+                               "their lines");
+}
+
+// The DOT text of circuit, empty when writing failed.
+static std::string writeDot(const CircuitModel &circuit,
+                            const bool rank_layers) {
+  char *text = NULL;
+  size_t size = 0;
+  FILE *file = open_memstream(&text, &size);
+  if (file == NULL) {
+    return std::string();
+  }
+  bool written = false;
+  {
+    CircuitDotWriter writer(file);
+    written = writer.write(circuit, rank_layers);
+  }
+  const bool closed = fclose(file) == 0;
+  const std::string dot = written && closed ? std::string(text, size) : "";
+  free(text);
+  return dot;
+}
+
+static uint64_t countOccurrences(const std::string &text,
+                                 const char *pattern) {
+  uint64_t count = 0;
+  for (size_t at = text.find(pattern); at != std::string::npos;
+       at = text.find(pattern, at + 1)) {
+    count++;
+  }
+  return count;
+}
+
+// Two inputs, a constant, an adder and a multiplier fed twice by the
+// constant, a chain of three adders and a multiplier fed by an input and
+// the end of the chain, which has to sit below the chain and not below
+// the input. Nodes fed by nothing, or partly by such a node, are not laid
+// out.
+void CircuitModelSelfTest::testLayersAndDot(void) {
+  CircuitModel circuit;
+  const uint32_t a = circuit.addNode(InputNodeType, 0);
+  const uint32_t b = circuit.addNode(InputNodeType, 0);
+  const uint32_t three = circuit.addNode(ConstantType, 3);
+  const uint32_t sum = circuit.addNode(AdderType, 0);
+  const uint32_t product = circuit.addNode(MultiplierType, 0);
+  const uint32_t chain_0 = circuit.addNode(AdderType, 0);
+  const uint32_t chain_1 = circuit.addNode(AdderType, 0);
+  const uint32_t chain_2 = circuit.addNode(AdderType, 0);
+  const uint32_t late = circuit.addNode(MultiplierType, 0);
+  const uint32_t output = circuit.addNode(OutputNodeType, 0);
+  const uint32_t floating = circuit.addNode(AdderType, 0);
+  const uint32_t half_floating = circuit.addNode(AdderType, 0);
+  const uint32_t twelve = circuit.addNode(ConstantType, 12);
+  circuit.addEdge(a, sum);
+  circuit.addEdge(b, sum);
+  circuit.addEdge(sum, product);
+  circuit.addEdges(three, product, 2);
+  circuit.addEdge(product, chain_0);
+  circuit.addEdge(chain_0, chain_1);
+  circuit.addEdge(chain_1, chain_2);
+  circuit.addEdge(a, late);
+  circuit.addEdge(chain_2, late);
+  circuit.addEdge(late, output);
+  circuit.addEdge(b, output);
+  circuit.addEdge(floating, half_floating);
+  circuit.addEdge(a, half_floating);
+  circuit.addEdge(twelve, output);
+
+  std::vector<uint32_t> layers;
+  const uint32_t layer_count = circuit.computeLayers(layers);
+  const uint32_t expected_layers[] = {
+      0, 0, 1, 2, 3, 4, 5, 6, 7, 8, CircuitModel::UNREACHED_LAYER,
+      CircuitModel::UNREACHED_LAYER, 1};
+  check(layer_count == 9 &&
+            std::equal(layers.begin(), layers.end(), expected_layers,
+                       expected_layers + circuit.getNodeCount()),
+        "layers of the small circuit");
+
+  const std::string dot = writeDot(circuit, true);
+  check(dot.rfind("digraph circuit {\n", 0) == 0 &&
+            dot.size() >= 2 && dot.compare(dot.size() - 2, 2, "}\n") == 0,
+        "DOT digraph opens and closes");
+  const char *node_lines[] = {
+      "  n0 [label=\"I\", fillcolor=yellow];\n",
+      "  n2 [label=\"3\", fillcolor=green];\n",
+      "  n3 [label=\"+\", fillcolor=skyblue];\n",
+      "  n4 [label=\"x\", fillcolor=beige];\n",
+      "  n9 [label=\"O\", fillcolor=pink];\n",
+      "  n12 [label=\"C\", fillcolor=green];\n"};
+  bool has_node_lines = true;
+  for (const char *node_line : node_lines) {
+    has_node_lines &= countOccurrences(dot, node_line) == 1;
+  }
+  check(has_node_lines, "DOT node lines");
+  check(countOccurrences(dot, "  n2 -> n4;\n") == 2 &&
+            countOccurrences(dot, "  n0 -> n3;\n") == 1 &&
+            countOccurrences(dot, " -> ") == getEdgeCount(circuit),
+        "DOT repeats parallel edges");
+  check(countOccurrences(dot, "  { rank=same; n0; n1; }\n") == 1 &&
+            countOccurrences(dot, "  { rank=same; n2; n12; }\n") == 1 &&
+            countOccurrences(dot, "  { rank=same; n7; }\n") == 1 &&
+            countOccurrences(dot, "  { rank=same; n8; }\n") == 1 &&
+            countOccurrences(dot, "  { rank=same; n9; }\n") == 1 &&
+            countOccurrences(dot, "rank=same") == 9 &&
+            countOccurrences(dot, "; n10;") == 0 &&
+            countOccurrences(dot, "; n11;") == 0,
+        "DOT rank=same groups are the layers");
+  check(countOccurrences(writeDot(circuit, false), "rank=same") == 0,
+        "DOT without rank_layers has no rank groups");
+}
+
+// Larger than the writer's buffer: every edge once per parallel edge, and
+// every laid out node in the rank group of its layer, the groups in layer
+// order.
+void CircuitModelSelfTest::testDot(const uint32_t node_count) {
+  const RandomCircuit circuit(getCircuitParameters(node_count));
+  const std::string dot = writeDot(circuit, true);
+  check(dot.size() > (1 << 16), "DOT of a random circuit takes flushes");
+  check(countOccurrences(dot, " -> ") == getEdgeCount(circuit),
+        "DOT of a random circuit has every edge");
+
+  std::vector<uint32_t> layers;
+  const uint32_t layer_count = circuit.computeLayers(layers);
+  std::vector<uint32_t> listed(circuit.getNodeCount(), 0);
+  bool in_layer = true;
+  uint32_t layer = 0;
+  for (size_t at = dot.find("{ rank=same;"); at != std::string::npos;
+       at = dot.find("{ rank=same;", at + 1), layer++) {
+    const size_t group_end = dot.find('}', at);
+    for (size_t node = dot.find(" n", at); node < group_end;
+         node = dot.find(" n", node + 1)) {
+      const uint32_t index = strtoul(dot.c_str() + node + 2, NULL, 10);
+      in_layer &= index < layers.size() && layers[index] == layer;
+      listed[index < listed.size() ? index : 0]++;
+    }
+  }
+  bool listed_once = true;
+  for (uint32_t index = 0; index < circuit.getNodeCount(); index++) {
+    listed_once &= listed[index] ==
+                   (layers[index] != CircuitModel::UNREACHED_LAYER ? 1u : 0u);
+  }
+  check(layer == layer_count && in_layer && listed_once,
+        "DOT of a random circuit groups every node by its layer");
+}
+
+bool CircuitModelSelfTest::selfTest(void) {
+  _failure_count = 0;
+  testCompiled(300);
+  testCompiled(3000);
+  testSimplifyCases();
+  testSimplify(300);
+  testSimplify(3000);
+  testNetlistCases();
+  testNetlistChunks();
+  testLayersAndDot();
+  testDot(3000);
+  return _failure_count == 0;
+}
@@ -0,0 +1,58 @@
+#include "circuit_model/circuit_renumbering.hpp"
+
+static void getGraph(const CircuitModel &model,
+                     std::vector<uint32_t> &first_fanins,
+                     std::vector<uint32_t> &fanins) {
+  first_fanins.clear();
+  first_fanins.reserve(model.getNodeCount() + 1);
+  fanins.clear();
+  model.forEachNode([&](const CircuitNode &node) {
+    first_fanins.push_back(fanins.size());
+    node.forEachFanin([&](const uint32_t source, const uint32_t) {
+      fanins.push_back(source);
+      return IterationContinue;
+    });
+    return IterationContinue;
+  });
+  first_fanins.push_back(fanins.size());
+}
+
+void renumberCircuitModel(const CircuitModel &model, const NodeOrderType type,
+                          CircuitModel &renumbered,
+                          std::vector<uint32_t> &new_indices) {
+  assert(renumbered.getNodeCount() == 0);
+  const uint32_t node_count = model.getNodeCount();
+  std::vector<uint32_t> first_fanins;
+  std::vector<uint32_t> fanins;
+  getGraph(model, first_fanins, fanins);
+  computeNodeOrder({first_fanins.data(), fanins.data(), node_count}, type,
+                   new_indices);
+
+  std::vector<uint32_t> order(node_count);
+  for (uint32_t index = 0; index < node_count; index++) {
+    order[new_indices[index]] = index;
+  }
+  renumbered.reserveNodes(node_count);
+  for (const uint32_t index : order) {
+    const CircuitNode &node = model.getNode(index);
+    renumbered.addNode(node.getType(), node.getValue());
+  }
+  for (const uint32_t index : order) {
+    model.getNode(index).forEachFanin(
+        [&](const uint32_t source, const uint32_t count) {
+          renumbered.addEdges(new_indices[source], new_indices[index], count);
+          return IterationContinue;
+        });
+  }
+}
+
+void computeCircuitNodeOrderStats(const CircuitModel &model,
+                                  const std::vector<uint32_t> &new_indices,
+                                  NodeOrderStats &stats) {
+  std::vector<uint32_t> first_fanins;
+  std::vector<uint32_t> fanins;
+  getGraph(model, first_fanins, fanins);
+  computeNodeOrderStats(
+      {first_fanins.data(), fanins.data(), model.getNodeCount()}, new_indices,
+      sizeof(CircuitNode), CIRCUIT_ORDER_CACHE_SIZE, stats);
+}
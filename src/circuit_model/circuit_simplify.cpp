@@ -0,0 +1,194 @@
+#include "circuit_model/circuit_simplify.hpp"
+
+namespace {
+struct ReducedFanin {
+  uint32_t node;
+  uint32_t count;
+};
+} // namespace
+
+static uint32_t power(uint32_t base, uint32_t exponent) {
+  uint32_t result = 1;
+  while (exponent > 0) {
+    if (exponent & 1) {
+      result *= base;
+    }
+    base *= base;
+    exponent >>= 1;
+  }
+  return result;
+}
+
+void simplifyCircuitModel(const CircuitModel &model, CircuitModel &simplified,
+                          std::vector<uint32_t> &new_indices,
+                          std::vector<uint32_t> &original_indices) {
+  assert(simplified.getNodeCount() == 0);
+  const uint32_t node_count = model.getNodeCount();
+
+  // Layer order visits fanins first; nodes on a cycle come last and fold
+  // nothing.
+  std::vector<uint32_t> layers;
+  model.computeLayers(layers);
+  std::vector<uint32_t> order(node_count);
+  for (uint32_t index = 0; index < node_count; index++) {
+    order[index] = index;
+  }
+  std::stable_sort(order.begin(), order.end(),
+                   [&](const uint32_t a, const uint32_t b) {
+                     return layers[a] < layers[b];
+                   });
+
+  // forwards[index] is the node with the value of index, itself unless it
+  // passes a fanin on. Merged constant fanins are not in fanins:
+  // merged_nodes holds the constant node that carries them when one does,
+  // NEW_CIRCUIT_NODE when a new constant of merged_values has to.
+  std::vector<uint32_t> forwards(node_count);
+  std::vector<uint8_t> is_constant(node_count, 0);
+  std::vector<uint32_t> values(node_count, 0);
+  std::vector<uint32_t> first_fanins(node_count, 0);
+  std::vector<uint32_t> fanin_counts(node_count, 0);
+  std::vector<ReducedFanin> fanins;
+  std::vector<uint8_t> has_merged(node_count, 0);
+  std::vector<uint32_t> merged_nodes(node_count, NEW_CIRCUIT_NODE);
+  std::vector<uint32_t> merged_values(node_count, 0);
+  for (uint32_t index = 0; index < node_count; index++) {
+    forwards[index] = index;
+  }
+
+  for (const uint32_t index : order) {
+    const CircuitNode &node = model.getNode(index);
+    const CircuitNodeType type = node.getType();
+    if (type == InputNodeType) {
+      continue;
+    }
+    if (type == ConstantType) {
+      is_constant[index] = 1;
+      values[index] = node.getValue();
+      continue;
+    }
+
+    const bool is_gate = type == AdderType || type == MultiplierType;
+    uint32_t merged = type == MultiplierType ? 1 : 0;
+    uint32_t constant_node = NEW_CIRCUIT_NODE;
+    uint32_t constant_edge_count = 0;
+    first_fanins[index] = fanins.size();
+    node.forEachFanin([&](const uint32_t source, const uint32_t count) {
+      const uint32_t fanin = forwards[source];
+      if (is_gate && is_constant[fanin]) {
+        merged = type == AdderType ? merged + values[fanin] * count
+                                   : merged * power(values[fanin], count);
+        constant_node = fanin;
+        constant_edge_count += count;
+        return IterationContinue;
+      }
+      // Two fanins can forward to the same node.
+      for (uint32_t i = first_fanins[index]; i < fanins.size(); i++) {
+        if (fanins[i].node == fanin) {
+          fanins[i].count += count;
+          return IterationContinue;
+        }
+      }
+      fanins.push_back({fanin, count});
+      return IterationContinue;
+    });
+    fanin_counts[index] = fanins.size() - first_fanins[index];
+    if (!is_gate) {
+      continue;
+    }
+
+    const uint32_t identity = type == MultiplierType ? 1 : 0;
+    if (fanin_counts[index] == 0 || (type == MultiplierType && merged == 0)) {
+      fanins.resize(first_fanins[index]);
+      fanin_counts[index] = 0;
+      is_constant[index] = 1;
+      values[index] = merged;
+    } else if (merged != identity) {
+      has_merged[index] = 1;
+      merged_values[index] = merged;
+      if (constant_edge_count == 1) {
+        merged_nodes[index] = constant_node;
+      }
+    } else if (fanin_counts[index] == 1 && fanins.back().count == 1) {
+      forwards[index] = fanins.back().node;
+    }
+  }
+
+  // Live is what the outputs read through the reduced fanins.
+  std::vector<uint8_t> live(node_count, 0);
+  std::vector<uint32_t> stack;
+  model.forEachNode([&](const CircuitNode &node) {
+    if (node.getType() == OutputNodeType) {
+      stack.push_back(node.getIndex());
+    }
+    return IterationContinue;
+  });
+  if (stack.empty()) {
+    model.forEachNode([&](const CircuitNode &node) {
+      if (node.getFanoutCount() == 0) {
+        stack.push_back(forwards[node.getIndex()]);
+      }
+      return IterationContinue;
+    });
+  }
+  while (!stack.empty()) {
+    const uint32_t index = stack.back();
+    stack.pop_back();
+    if (live[index]) {
+      continue;
+    }
+    live[index] = 1;
+    for (uint32_t i = 0; i < fanin_counts[index]; i++) {
+      stack.push_back(fanins[first_fanins[index] + i].node);
+    }
+    if (merged_nodes[index] != NEW_CIRCUIT_NODE) {
+      stack.push_back(merged_nodes[index]);
+    }
+  }
+
+  // Nodes keep their relative order, a new constant goes right before the
+  // gate that reads it.
+  new_indices.assign(node_count, REMOVED_CIRCUIT_NODE);
+  std::vector<uint32_t> new_constants(node_count, REMOVED_CIRCUIT_NODE);
+  original_indices.clear();
+  simplified.reserveNodes(node_count);
+  for (uint32_t index = 0; index < node_count; index++) {
+    const CircuitNode &node = model.getNode(index);
+    if (!live[index] && node.getType() != InputNodeType) {
+      continue;
+    }
+    if (has_merged[index] && merged_nodes[index] == NEW_CIRCUIT_NODE) {
+      new_constants[index] =
+          simplified.addNode(ConstantType, merged_values[index]);
+      original_indices.push_back(NEW_CIRCUIT_NODE);
+    }
+    new_indices[index] =
+        is_constant[index]
+            ? simplified.addNode(ConstantType, values[index])
+            : simplified.addNode(node.getType(), node.getValue());
+    original_indices.push_back(index);
+  }
+
+  for (uint32_t index = 0; index < node_count; index++) {
+    if (new_indices[index] == REMOVED_CIRCUIT_NODE || is_constant[index]) {
+      continue;
+    }
+    for (uint32_t i = 0; i < fanin_counts[index]; i++) {
+      const ReducedFanin &fanin = fanins[first_fanins[index] + i];
+      simplified.addEdges(new_indices[fanin.node], new_indices[index],
+                          fanin.count);
+    }
+    if (has_merged[index]) {
+      simplified.addEdge(merged_nodes[index] == NEW_CIRCUIT_NODE
+                             ? new_constants[index]
+                             : new_indices[merged_nodes[index]],
+                         new_indices[index]);
+    }
+  }
+
+  // A forward points at a node that is not forwarded itself.
+  for (uint32_t index = 0; index < node_count; index++) {
+    if (forwards[index] != index) {
+      new_indices[index] = new_indices[forwards[index]];
+    }
+  }
+}
@@ -0,0 +1,285 @@
+#include "circuit_model/netlist_reader.hpp"
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+static inline const char *findLineEnd(const char *begin, const char *end) {
+  const char *newline =
+      static_cast<const char *>(memchr(begin, '\n', end - begin));
+  return newline == NULL ? end : newline;
+}
+
+static inline const char *skipBlanks(const char *p, const char *end) {
+  while (p < end && (*p == ' ' || *p == '\t' || *p == '\r')) {
+    p++;
+  }
+  return p;
+}
+
+// Decimal without sign, fails on anything else or when it does not fit 32
+// bits.
+static inline bool parseUint(const char *&p, const char *end,
+                             uint32_t &value) {
+  p = skipBlanks(p, end);
+  if (p == end || *p < '0' || *p > '9') {
+    return false;
+  }
+  uint64_t result = 0;
+  while (p < end && *p >= '0' && *p <= '9') {
+    result = result * 10 + (*p - '0');
+    if (result > UINT32_MAX) {
+      return false;
+    }
+    p++;
+  }
+  value = result;
+  return true;
+}
+
+static inline bool parseNodeType(const char *&p, const char *end,
+                                 CircuitNodeType &type) {
+  p = skipBlanks(p, end);
+  if (p == end) {
+    return false;
+  }
+  switch (*p++) {
+  case 'A':
+    type = AdderType;
+    return true;
+  case 'M':
+    type = MultiplierType;
+    return true;
+  case 'C':
+    type = ConstantType;
+    return true;
+  case 'I':
+    type = InputNodeType;
+    return true;
+  case 'O':
+    type = OutputNodeType;
+    return true;
+  default:
+    return false;
+  }
+}
+
+// Nothing but blanks or a comment may follow a record.
+static inline bool isLineDone(const char *p, const char *end) {
+  p = skipBlanks(p, end);
+  return p == end || *p == '#';
+}
+
+void NetlistReader::countLines(Chunk &chunk) {
+  chunk.node_count = 0;
+  chunk.edge_count = 0;
+  chunk.line_count = 0;
+  for (const char *line = chunk.begin; line < chunk.end;) {
+    const char *line_end = findLineEnd(line, chunk.end);
+    const char *p = skipBlanks(line, line_end);
+    if (p < line_end) {
+      chunk.node_count += *p == 'N';
+      chunk.edge_count += *p == 'E';
+    }
+    chunk.line_count++;
+    line = line_end + 1;
+  }
+}
+
+void NetlistReader::parseLines(Chunk &chunk) {
+  NodeRecord *node = _nodes.data() + chunk.first_node;
+  EdgeRecord *edge = _edges.data() + chunk.first_edge;
+  uint64_t line_number = chunk.first_line;
+
+  for (const char *line = chunk.begin; line < chunk.end;) {
+    const char *line_end = findLineEnd(line, chunk.end);
+    const char *p = skipBlanks(line, line_end);
+    line_number++;
+    line = line_end + 1;
+
+    if (p == line_end || *p == '#') {
+      continue;
+    }
+
+    const char record = *p++;
+    if (record == 'N') {
+      if (!parseUint(p, line_end, node->index) ||
+          !parseNodeType(p, line_end, node->type) ||
+          !parseUint(p, line_end, node->value) || !isLineDone(p, line_end)) {
+        chunk.error_line = line_number;
+        chunk.error = "expected N <index> <A|M|C|I|O> <value>";
+        return;
+      }
+      node++;
+    } else if (record == 'E') {
+      if (!parseUint(p, line_end, edge->source) ||
+          !parseUint(p, line_end, edge->sink)) {
+        chunk.error_line = line_number;
+        chunk.error = "expected E <source> <sink> [<count>]";
+        return;
+      }
+      edge->count = 1;
+      if (!isLineDone(p, line_end) &&
+          (!parseUint(p, line_end, edge->count) || edge->count == 0 ||
+           !isLineDone(p, line_end))) {
+        chunk.error_line = line_number;
+        chunk.error = "edge count has to be a positive number";
+        return;
+      }
+      edge++;
+    } else {
+      chunk.error_line = line_number;
+      chunk.error = "unknown record, expected N or E";
+      return;
+    }
+  }
+}
+
+bool NetlistReader::parse(const char *path, const char *data,
+                          const size_t size) {
+  const size_t chunk_count = std::clamp<size_t>(
+      size / MIN_CHUNK_SIZE, 1, _pool.getThreadCount() * CHUNKS_PER_THREAD);
+
+  // Chunk boundaries are moved to the start of the next line.
+  std::vector<Chunk> chunks;
+  const char *end = data + size;
+  const char *begin = data;
+  for (size_t i = 1; i <= chunk_count; i++) {
+    const char *chunk_end = end;
+    if (i < chunk_count) {
+      chunk_end = std::max(begin, data + size * i / chunk_count);
+      chunk_end = std::min(end, findLineEnd(chunk_end, end) + 1);
+    }
+    chunks.push_back({.begin = begin,
+                      .end = chunk_end,
+                      .node_count = 0,
+                      .edge_count = 0,
+                      .line_count = 0,
+                      .first_node = 0,
+                      .first_edge = 0,
+                      .first_line = 0,
+                      .error_line = 0,
+                      .error = NULL});
+    begin = chunk_end;
+  }
+
+  _pool.parallelFor(chunks.size(),
+                    [&](const uint32_t chunk) { countLines(chunks[chunk]); });
+
+  uint64_t node_count = 0;
+  uint64_t edge_count = 0;
+  uint64_t line_count = 0;
+  for (auto &chunk : chunks) {
+    chunk.first_node = node_count;
+    chunk.first_edge = edge_count;
+    chunk.first_line = line_count;
+    node_count += chunk.node_count;
+    edge_count += chunk.edge_count;
+    line_count += chunk.line_count;
+  }
+  if (node_count > UINT32_MAX) {
+    TraceLog(LOG_ERROR, "NETLIST: %s: more than %u nodes", path, UINT32_MAX);
+    return false;
+  }
+  _nodes.resize(node_count);
+  _edges.resize(edge_count);
+
+  _pool.parallelFor(chunks.size(),
+                    [&](const uint32_t chunk) { parseLines(chunks[chunk]); });
+
+  for (const auto &chunk : chunks) {
+    if (chunk.error_line != 0) {
+      _error_line = chunk.error_line;
+      TraceLog(LOG_ERROR, "NETLIST: %s:%lu: %s", path, chunk.error_line,
+               chunk.error);
+      return false;
+    }
+  }
+  return true;
+}
+
+bool NetlistReader::buildCircuit(const char *path, CircuitModel &circuit) {
+  const uint32_t node_count = _nodes.size();
+  std::vector<uint32_t> record_of_index(node_count, UINT32_MAX);
+  for (uint32_t i = 0; i < node_count; i++) {
+    const uint32_t index = _nodes[i].index;
+    if (index >= node_count) {
+      TraceLog(LOG_ERROR, "NETLIST: %s: node index %u out of range, %u nodes",
+               path, index, node_count);
+      return false;
+    }
+    if (record_of_index[index] != UINT32_MAX) {
+      TraceLog(LOG_ERROR, "NETLIST: %s: node %u defined twice", path, index);
+      return false;
+    }
+    record_of_index[index] = i;
+  }
+
+  for (const auto &edge : _edges) {
+    if (edge.source >= node_count || edge.sink >= node_count) {
+      TraceLog(LOG_ERROR, "NETLIST: %s: edge %u -> %u to an undefined node",
+               path, edge.source, edge.sink);
+      return false;
+    }
+    if (edge.source == edge.sink) {
+      TraceLog(LOG_ERROR, "NETLIST: %s: self loop on node %u", path,
+               edge.source);
+      return false;
+    }
+  }
+
+  circuit.reserveNodes(node_count);
+  for (uint32_t index = 0; index < node_count; index++) {
+    const NodeRecord &node = _nodes[record_of_index[index]];
+    circuit.addNode(node.type, node.value);
+  }
+  for (const auto &edge : _edges) {
+    circuit.addEdges(edge.source, edge.sink, edge.count);
+  }
+  return true;
+}
+
+bool NetlistReader::read(const char *path, CircuitModel &circuit) {
+  assert(circuit.getNodeCount() == 0);
+  _error_line = 0;
+
+  const int fd = open(path, O_RDONLY);
+  if (fd < 0) {
+    TraceLog(LOG_ERROR, "NETLIST: could not open %s: %s", path,
+             strerror(errno));
+    return false;
+  }
+  struct stat file_stat;
+  if (fstat(fd, &file_stat) < 0) {
+    TraceLog(LOG_ERROR, "NETLIST: could not stat %s: %s", path,
+             strerror(errno));
+    close(fd);
+    return false;
+  }
+
+  const size_t size = file_stat.st_size;
+  const char *data = NULL;
+  if (size > 0) {
+    void *mapping = mmap(NULL, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (mapping == MAP_FAILED) {
+      TraceLog(LOG_ERROR, "NETLIST: could not map %s: %s", path,
+               strerror(errno));
+      close(fd);
+      return false;
+    }
+    (void)madvise(mapping, size, MADV_WILLNEED);
+    data = static_cast<const char *>(mapping);
+  }
+  close(fd);
+
+  const bool parsed = parse(path, data, size);
+  if (data != NULL) {
+    munmap(const_cast<char *>(data), size);
+  }
+
+  const bool built = parsed && buildCircuit(path, circuit);
+  _nodes.clear();
+  _nodes.shrink_to_fit();
+  _edges.clear();
+  _edges.shrink_to_fit();
+  return built;
+}
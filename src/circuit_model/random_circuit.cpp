@@ -0,0 +1,117 @@
+#include "circuit_model/random_circuit.hpp"
+
+// SplitMix64, fully specified so generated circuits do not change with the
+// standard library the way std::uniform_int_distribution results can.
+class CircuitRandom {
+private:
+  uint64_t _state;
+
+public:
+  CircuitRandom(void) = delete;
+  CircuitRandom(const uint64_t seed) : _state(seed) {}
+
+  inline uint64_t next(void) {
+    uint64_t z = (_state += 0x9e3779b97f4a7c15ull);
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ull;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebull;
+    return z ^ (z >> 31);
+  }
+
+  // Uniform in [0, bound).
+  inline uint32_t nextBelow(const uint32_t bound) {
+    assert(bound > 0);
+    return static_cast<uint32_t>((next() >> 32) * bound >> 32);
+  }
+
+  // Uniform in [0, 1).
+  inline float nextFloat(void) { return (next() >> 40) * 0x1.0p-24f; }
+};
+
+static uint32_t drawFaninCount(const RandomCircuitParameters &parameters,
+                               CircuitRandom &random) {
+  switch (parameters.fanin_distribution) {
+  case FaninUniform:
+    return parameters.min_fanin +
+           random.nextBelow(parameters.max_fanin - parameters.min_fanin + 1);
+  case FaninGeometric: {
+    uint32_t fanin = parameters.min_fanin;
+    while (fanin < parameters.max_fanin &&
+           random.nextFloat() >= parameters.fanin_geometric_p) {
+      fanin++;
+    }
+    return fanin;
+  }
+  default:
+    assert(0);
+    return parameters.min_fanin;
+  }
+}
+
+static inline uint32_t
+drawMultiplicity(const RandomCircuitParameters &parameters,
+                 CircuitRandom &random) {
+  return random.nextFloat() < parameters.multi_edge_rate ? 2 : 1;
+}
+
+void RandomCircuit::createCircuit(const RandomCircuitParameters &parameters) {
+  const uint32_t constant_count =
+      static_cast<uint32_t>(parameters.constant_ratio * parameters.node_count);
+  assert(parameters.depth > 0);
+  assert(parameters.input_count > 0);
+  assert(parameters.output_count > 0);
+  assert(parameters.min_fanin > 0);
+  assert(parameters.min_fanin <= parameters.max_fanin);
+  assert(parameters.node_count >= parameters.input_count + constant_count +
+                                      parameters.output_count +
+                                      parameters.depth &&
+         "every gate layer needs at least one node");
+
+  const uint32_t gate_count = parameters.node_count - parameters.input_count -
+                              constant_count - parameters.output_count;
+  CircuitRandom random(parameters.seed);
+  reserveNodes(parameters.node_count);
+
+  // Nodes are added layer by layer, so every layer is an index range
+  // [layer_start, next layer_start).
+  for (uint32_t i = 0; i < parameters.input_count; i++) {
+    addNode(InputNodeType, 0);
+  }
+  for (uint32_t i = 0; i < constant_count; i++) {
+    addNode(ConstantType, random.nextBelow(10));
+  }
+
+  uint32_t prev_layer_start = 0;
+  uint32_t layer_start = getNodeCount();
+  for (uint32_t layer = 0; layer < parameters.depth; layer++) {
+    const uint32_t layer_gate_count =
+        gate_count / parameters.depth +
+        (layer < gate_count % parameters.depth ? 1 : 0);
+
+    for (uint32_t i = 0; i < layer_gate_count; i++) {
+      const CircuitNodeType type =
+          random.nextBelow(2) == 0 ? AdderType : MultiplierType;
+      const uint32_t gate = addNode(type, 0);
+
+      addEdges(prev_layer_start +
+                   random.nextBelow(layer_start - prev_layer_start),
+               gate, drawMultiplicity(parameters, random));
+
+      const uint32_t fanin_count = drawFaninCount(parameters, random);
+      for (uint32_t fanin = 1; fanin < fanin_count; fanin++) {
+        addEdges(random.nextBelow(layer_start), gate,
+                 drawMultiplicity(parameters, random));
+      }
+    }
+
+    prev_layer_start = layer_start;
+    layer_start = getNodeCount();
+  }
+
+  const uint32_t last_layer_size = layer_start - prev_layer_start;
+  for (uint32_t i = 0; i < parameters.output_count; i++) {
+    const uint32_t output = addNode(OutputNodeType, 0);
+    addEdge(prev_layer_start + i % last_layer_size, output);
+  }
+
+  assert(getNodeCount() == parameters.node_count);
+}
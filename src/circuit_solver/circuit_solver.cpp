@@ -1,7 +1,7 @@
 #include "circuit_solver/circuit_solver.hpp"
-#include "ffmpeg_rendering/ffmpeg.hpp"
 
 void ExampleCircuit001::createCircuit(void) {
+  TRACE_SCOPE(TraceCategoryModel, "ExampleCircuit001::createCircuit");
   // x^2 + 2x + 1
   const uint32_t input = addNode(InputNodeType, 0);
   const uint32_t m1 = addNode(MultiplierType, 0);
@@ -23,6 +23,7 @@ void ExampleCircuit001::createCircuit(void) {
 }
 
 void ExampleCircuit002::createCircuit(void) {
+  TRACE_SCOPE(TraceCategoryModel, "ExampleCircuit002::createCircuit");
   // x^5 + 2x^4 + 3x^3 + 4x^2 + 5x + 6
   const uint32_t input = addNode(InputNodeType, 0);
   uint32_t prev_m(0);
@@ -58,6 +59,7 @@ void ExampleCircuit002::createCircuit(void) {
 }
 
 void ExampleCircuit003::createCircuit(void) {
+  TRACE_SCOPE(TraceCategoryModel, "ExampleCircuit003::createCircuit");
   // x ^ 3
   const uint32_t input = addNode(InputNodeType, 0);
   const uint32_t m1 = addNode(MultiplierType, 0);
@@ -72,6 +74,7 @@ void ExampleCircuit003::createCircuit(void) {
 
 void IntegerFactorization::RegularAPCircuit::createCircuit(
     const uint32_t degree) {
+  TRACE_SCOPE(TraceCategoryModel, "RegularAPCircuit::createCircuit");
 
   const uint32_t input_node = addNode(InputNodeType, 0);
 
@@ -93,6 +96,7 @@ void IntegerFactorization::RegularAPCircuit::createCircuit(
 }
 
 void IntegerFactorization::Opt01Circuit::createCircuit(const uint32_t degree) {
+  TRACE_SCOPE(TraceCategoryModel, "Opt01Circuit::createCircuit");
 
   assert(degree > 2);
   std::vector<std::vector<uint32_t>> nodes;
@@ -133,6 +137,7 @@ void IntegerFactorization::Opt01Circuit::createCircuit(const uint32_t degree) {
 }
 
 void CircuitSolver::addOneCircuitToAnimate(CircuitModel *circuit) {
+  TRACE_SCOPE(TraceCategoryLayout, "addOneCircuitToAnimate");
   float prev_end_time = 0.0f;
   if (_animators.size() != 0) {
     prev_end_time = _animators[_animators.size() - 1].getAnimationEndTime();
@@ -151,9 +156,10 @@ void CircuitSolver::stackCircuitsToAnimate(void) {
   addOneCircuitToAnimate(new IntegerFactorization::Opt01Circuit(4));
 }
 
-inline bool CircuitSolver::drawCircuits(const float time) {
+inline bool CircuitSolver::drawCircuits(const float time,
+                                        DrawBackend &backend) {
   assert(_current_animator < _animators.size());
-  if (_animators[_current_animator].updateCircuitAnimation(time)) {
+  if (_animators[_current_animator].updateCircuitAnimation(time, backend)) {
     return true;
   } else {
     _current_animator++;
@@ -164,6 +170,54 @@ inline bool CircuitSolver::drawCircuits(const float time) {
   return false;
 }
 
+inline const CircuitAnimator *
+CircuitSolver::findAnimator(const float time) const {
+  // Every circuit starts where the previous one ended, the end times are
+  // sorted.
+  auto animator = std::upper_bound(
+      _animators.begin(), _animators.end(), time,
+      [](const float t, const CircuitAnimator &a) {
+        return t < a.getAnimationEndTime();
+      });
+  if (animator == _animators.end()) {
+    return NULL;
+  }
+  assert(time >= animator->getAnimationStartTime());
+  return &*animator;
+}
+
+inline uint64_t CircuitSolver::getFrameCount(void) const {
+  if (_animators.empty()) {
+    return 0;
+  }
+  const float end_time =
+      _animators[_animators.size() - 1].getAnimationEndTime();
+  return static_cast<uint64_t>(ceilf(end_time * SCREEN_FPS));
+}
+
+inline bool CircuitSolver::collectDamage(const float prev_time,
+                                         const float time,
+                                         std::vector<Rectangle> &damage) const {
+  const CircuitAnimator *animator = findAnimator(time);
+  if (animator == NULL || animator != findAnimator(prev_time)) {
+    return false;
+  }
+  animator->collectDamage(prev_time, time, damage);
+  return true;
+}
+
+bool CircuitSolver::renderFrameAt(const float time,
+                                  DrawBackend &backend) const {
+  const CircuitAnimator *animator = findAnimator(time);
+  if (animator == NULL) {
+    return false;
+  }
+  backend.clearBackground(DARKGRAY);
+  drawVideoBackground(true, backend);
+  (void)animator->updateCircuitAnimation(time, backend);
+  return true;
+}
+
 void CircuitSolver::solve() {
   InitWindow(SCREEN_WIDTH, SCREEN_HEIGHT, "circuit visualization");
   SetTargetFPS(SCREEN_FPS);
@@ -180,6 +234,8 @@ void CircuitSolver::solve() {
 
   stackCircuitsToAnimate();
 
+  RaylibDrawBackend *backend = new RaylibDrawBackend();
+
   while (!WindowShouldClose()) {
     curr_frame_time += GetFrameTime();
     if (IsKeyDown(KEY_SPACE)) {
@@ -194,12 +250,12 @@ void CircuitSolver::solve() {
 
     BeginDrawing();
     {
-      ClearBackground(DARKGRAY);
+      backend->clearBackground(DARKGRAY);
       BeginMode2D(camera);
       {
-        drawVideoBackground(true);
-        DrawRectangleLinesEx(SCREEN_RECT, 3.0f, YELLOW);
-        bool should_continue = drawCircuits(curr_frame_time);
+        drawVideoBackground(true, *backend);
+        backend->drawRectangleLines(SCREEN_RECT, 3.0f, YELLOW);
+        bool should_continue = drawCircuits(curr_frame_time, *backend);
         if (!should_continue) {
           break;
         }
@@ -208,10 +264,14 @@ void CircuitSolver::solve() {
     }
     EndDrawing();
   }
+  delete backend;
   CloseWindow();
+
+  writeTrace();
 }
 
-static bool isRectangleInside(Rectangle screen_rect, Rectangle target_rect) {
+[[maybe_unused]] static bool isRectangleInside(Rectangle screen_rect,
+                                               Rectangle target_rect) {
   Rectangle coll_rect = GetCollisionRec(screen_rect, target_rect);
   if (coll_rect.x != target_rect.x) {
     return false;
@@ -329,7 +389,8 @@ static MAYBE_UNUSED Camera2D getCurrCameraZoomFrom(
                                curr_time);
 }
 
-void CircuitSolver::drawVideoBackground(const bool use_mp) {
+void CircuitSolver::drawVideoBackground(const bool use_mp,
+                                        DrawBackend &backend) const {
   // Color apap_color = ColorFromHSV(277, 0.35f, 0.57f);
   // Color mp_color = DARKBLUE;
   // Color bottom_color = use_mp ? mp_color : apap_color;
@@ -337,7 +398,7 @@ void CircuitSolver::drawVideoBackground(const bool use_mp) {
   // bottom_color);
   Color c1 = getBackgroundTopColor();
   Color c2 = getBackgroundBottomColor();
-  DrawRectangleGradientV(0, 0, SCREEN_WIDTH, SCREEN_HEIGHT, c1, c2);
+  backend.drawRectangleGradientV(SCREEN_RECT, c1, c2);
 }
 
 void CircuitSolver::render_video() {
@@ -366,16 +427,39 @@ void CircuitSolver::render_video() {
 
   stackCircuitsToAnimate();
 
-  FFMPEG *ffmpeg = ffmpeg_start_rendering("output.mp4", SCREEN_WIDTH,
-                                          SCREEN_HEIGHT, SCREEN_FPS);
+  YUV420Converter *converter = createVideoConverter();
+  FrameSink *image_sequence = createImageSequenceSink();
+  FrameSink *sink =
+      createFrameSink(VIDEO_OUTPUT_PATH, image_sequence, converter);
+  if (sink == NULL) {
+    delete image_sequence;
+    delete converter;
+    CloseWindow();
+    return;
+  }
 
   RenderTexture2D render_screen =
       LoadRenderTexture(SCREEN_WIDTH, SCREEN_HEIGHT);
+  RaylibDrawBackend *backend = new RaylibDrawBackend();
   SetTraceLogLevel(LOG_WARNING);
 
-  while (!WindowShouldClose()) {
+  float prev_frame_time = -1.0f;
+  std::vector<Rectangle> damage;
+  uint64_t frame_index = 0;
+  bool cancel = false;
+  RenderProfiler profiler;
+
+  for (; !cancel && !WindowShouldClose(); frame_index++) {
     curr_frame_time += GetFrameTime();
 
+    // Damage is in screen space, only valid while the camera does not move.
+    damage.clear();
+    const bool is_static_frame =
+        prev_frame_time >= 0.0f &&
+        collectDamage(prev_frame_time, curr_frame_time, damage) &&
+        damage.empty();
+    prev_frame_time = curr_frame_time;
+
 #if 0
     if (curr_frame_time < zoom_out_start_time) {
       camera = getCurrCameraZoomTo(SCREEN_RECT, zoom_target_center, zoom_factor,
@@ -389,36 +473,317 @@ void CircuitSolver::render_video() {
 #endif
 
     BeginDrawing();
-    {
-      BeginTextureMode(render_screen);
+    if (is_static_frame) {
+      RenderStageTimer send_timer(profiler, RenderStageSend);
+      cancel = !sink->sendDuplicateFrame(frame_index);
+    } else {
       {
-        BeginMode2D(camera);
+        RenderStageTimer draw_timer(profiler, RenderStageDraw);
+        BeginTextureMode(render_screen);
         {
-          ClearBackground(DARKGRAY);
-          drawVideoBackground(true);
+          BeginMode2D(camera);
+          {
+            backend->clearBackground(DARKGRAY);
+            drawVideoBackground(true, *backend);
 #if 0
-          DrawRectangleLinesEx(zoom_target_rect, 1.0f, ORANGE);
+            backend->drawRectangleLines(zoom_target_rect, 1.0f, ORANGE);
 #endif
-          bool should_continue = drawCircuits(curr_frame_time);
-          if (!should_continue) {
-            break;
+            bool should_continue = drawCircuits(curr_frame_time, *backend);
+            if (!should_continue) {
+              break;
+            }
           }
+          EndMode2D();
         }
-        EndMode2D();
       }
-      EndTextureMode();
 
-      Image image = LoadImageFromTexture(render_screen.texture);
-      if (!ffmpeg_send_frame_flipped(ffmpeg, image.data, image.width,
-                                     image.height)) {
-        ffmpeg_end_rendering(ffmpeg, true);
+      {
+        RenderStageTimer flush_timer(profiler, RenderStageFlush);
+        EndTextureMode();
+      }
+
+      Image image;
+      {
+        RenderStageTimer readback_timer(profiler, RenderStageReadback);
+        image = LoadImageFromTexture(render_screen.texture);
+      }
+
+      {
+        RenderStageTimer send_timer(profiler, RenderStageSend);
+        cancel = !sink->sendFrame(frame_index, image.data, true);
       }
 
       UnloadImage(image);
     }
     EndDrawing();
+    profiler.frameDone();
   }
+  delete backend;
   CloseWindow();
 
-  ffmpeg_end_rendering(ffmpeg, false);
+  {
+    RenderStageTimer end_timer(profiler, RenderStageEnd);
+    (void)sink->finish(cancel);
+  }
+  delete sink;
+  delete image_sequence;
+  delete converter;
+
+  reportRenderProfile(profiler);
+  writeTrace();
+}
+
+void CircuitSolver::reportRenderProfile(const RenderProfiler &profiler) const {
+  profiler.printReport();
+  if (!_render_profile_path.empty()) {
+    (void)profiler.dumpJson(_render_profile_path.c_str());
+  }
+}
+
+void CircuitSolver::writeTrace(void) const {
+  if (!_trace_path.empty()) {
+    (void)TraceEvents::writeChromeTrace(_trace_path.c_str());
+  }
+}
+
+FrameSink *CircuitSolver::createImageSequenceSink(void) const {
+  if (_image_sequence_pattern.empty()) {
+    return NULL;
+  }
+  return new ImageSequenceFrameSink(
+      _image_sequence_pattern.c_str(), _image_sequence_format, SCREEN_WIDTH,
+      SCREEN_HEIGHT, 0, IMAGE_SEQUENCE_IN_FLIGHT_FRAMES);
+}
+
+YUV420Converter *CircuitSolver::createVideoConverter(void) const {
+  if (_video_pipe_format != FFMPEG_PIPE_YUV420P) {
+    return NULL;
+  }
+  return new YUV420Converter(0);
+}
+
+FrameSink *CircuitSolver::createFrameSink(const char *video_path,
+                                          FrameSink *image_sequence,
+                                          YUV420Converter *converter) const {
+  FFMPEG *ffmpeg =
+      ffmpeg_start_rendering(video_path, SCREEN_WIDTH, SCREEN_HEIGHT,
+                             SCREEN_FPS, _video_pipe_format, converter);
+  if (ffmpeg == NULL) {
+    return NULL;
+  }
+  FrameSink *video_sink =
+      new FFMPEGFrameSink(ffmpeg, SCREEN_WIDTH, SCREEN_HEIGHT);
+  if (image_sequence == NULL) {
+    return video_sink;
+  }
+
+  FanOutFrameSink *sink = new FanOutFrameSink();
+  sink->addSink(video_sink);
+  sink->addSink(image_sequence, false);
+  return sink;
+}
+
+static std::string getExportCheckpointPath(const char *output_path) {
+  return std::string(output_path) + ".checkpoint";
+}
+
+static std::string getExportSegmentPath(const char *output_path,
+                                        const uint64_t segment) {
+  char suffix[64];
+  snprintf(suffix, sizeof(suffix), ".segment_%05lu.mp4", segment);
+  return std::string(output_path) + suffix;
+}
+
+// Number of finished segments recorded for output_path, 0 when there is no
+// checkpoint or it was written with a different segment size.
+static uint64_t readExportCheckpoint(const char *output_path,
+                                     const uint64_t segment_frames) {
+  const std::string path = getExportCheckpointPath(output_path);
+  FILE *file = fopen(path.c_str(), "r");
+  if (file == NULL) {
+    return 0;
+  }
+
+  unsigned long checkpoint_segment_frames = 0;
+  unsigned long next_frame = 0;
+  const int matched = fscanf(file, "segment_frames %lu\nnext_frame %lu\n",
+                             &checkpoint_segment_frames, &next_frame);
+  fclose(file);
+
+  if (matched != 2 || checkpoint_segment_frames != segment_frames ||
+      next_frame % segment_frames != 0) {
+    TraceLog(LOG_WARNING, "EXPORT: ignoring unusable checkpoint %s",
+             path.c_str());
+    return 0;
+  }
+  return next_frame / segment_frames;
+}
+
+// Written to a temporary file first and renamed over the checkpoint, so a
+// crash leaves either the old or the new checkpoint behind.
+static bool writeExportCheckpoint(const char *output_path,
+                                  const uint64_t segment_frames,
+                                  const uint64_t finished_segments) {
+  const std::string path = getExportCheckpointPath(output_path);
+  const std::string tmp_path = path + ".tmp";
+  FILE *file = fopen(tmp_path.c_str(), "w");
+  if (file == NULL) {
+    TraceLog(LOG_ERROR, "EXPORT: could not create %s: %s", tmp_path.c_str(),
+             strerror(errno));
+    return false;
+  }
+
+  fprintf(file, "segment_frames %lu\nnext_frame %lu\n", segment_frames,
+          finished_segments * segment_frames);
+  const bool written = fflush(file) == 0 && fsync(fileno(file)) == 0;
+  fclose(file);
+
+  if (!written || rename(tmp_path.c_str(), path.c_str()) < 0) {
+    TraceLog(LOG_ERROR, "EXPORT: could not write checkpoint %s: %s",
+             path.c_str(), strerror(errno));
+    return false;
+  }
+  return true;
+}
+
+static bool concatExportSegments(const char *output_path,
+                                 const uint64_t segment_count) {
+  const std::string list_path = std::string(output_path) + ".segments";
+  FILE *list = fopen(list_path.c_str(), "w");
+  if (list == NULL) {
+    TraceLog(LOG_ERROR, "EXPORT: could not create %s: %s", list_path.c_str(),
+             strerror(errno));
+    return false;
+  }
+  // Paths in the list are relative to the list itself.
+  for (uint64_t segment = 0; segment < segment_count; segment++) {
+    const std::string segment_path = getExportSegmentPath(output_path, segment);
+    const char *segment_name = strrchr(segment_path.c_str(), '/');
+    fprintf(list, "file '%s'\n",
+            segment_name ? segment_name + 1 : segment_path.c_str());
+  }
+  fclose(list);
+
+  if (!ffmpeg_concat_files(list_path.c_str(), output_path)) {
+    return false;
+  }
+
+  for (uint64_t segment = 0; segment < segment_count; segment++) {
+    unlink(getExportSegmentPath(output_path, segment).c_str());
+  }
+  unlink(list_path.c_str());
+  unlink(getExportCheckpointPath(output_path).c_str());
+  return true;
+}
+
+void CircuitSolver::render_video_headless() {
+  stackCircuitsToAnimate();
+
+  const uint64_t frame_count = getFrameCount();
+  const uint64_t segment_count =
+      (frame_count + EXPORT_SEGMENT_FRAMES - 1) / EXPORT_SEGMENT_FRAMES;
+  const uint64_t first_segment =
+      readExportCheckpoint(VIDEO_OUTPUT_PATH, EXPORT_SEGMENT_FRAMES);
+  if (first_segment > 0) {
+    TraceLog(LOG_INFO, "EXPORT: resuming at frame %lu of %lu",
+             first_segment * EXPORT_SEGMENT_FRAMES, frame_count);
+  }
+
+  SoftwareRasterizer *rasterizer =
+      new SoftwareRasterizer(SCREEN_WIDTH, SCREEN_HEIGHT, 0);
+  SetTraceLogLevel(LOG_WARNING);
+
+  // The rasterizer has no separate GPU flush or readback, its flush stage is
+  // the tile rasterization in endFrame().
+  RenderProfiler profiler;
+  std::vector<Rectangle> damage;
+  bool completed = true;
+  YUV420Converter *converter = createVideoConverter();
+  FrameSink *image_sequence = createImageSequenceSink();
+  for (uint64_t segment = first_segment; segment < segment_count; segment++) {
+    const std::string segment_path =
+        getExportSegmentPath(VIDEO_OUTPUT_PATH, segment);
+    FrameSink *sink =
+        createFrameSink(segment_path.c_str(), image_sequence, converter);
+    if (sink == NULL) {
+      completed = false;
+      break;
+    }
+
+    // No window means no GetFrameTime(), frames are spaced exactly 1 / fps.
+    // Every segment starts with a full redraw, so it does not depend on what
+    // an earlier run left in the rasterizer.
+    const uint64_t first_frame = segment * EXPORT_SEGMENT_FRAMES;
+    const uint64_t end_frame =
+        std::min(first_frame + EXPORT_SEGMENT_FRAMES, frame_count);
+    bool cancel = false;
+    for (uint64_t frame = first_frame; frame < end_frame; frame++) {
+      const float curr_frame_time = frame / SCREEN_FPS;
+      const float prev_frame_time = (frame - 1.0f) / SCREEN_FPS;
+
+      damage.clear();
+      const bool full_redraw =
+          frame == first_frame ||
+          !collectDamage(prev_frame_time, curr_frame_time, damage);
+
+      if (!full_redraw && damage.empty()) {
+        {
+          RenderStageTimer send_timer(profiler, RenderStageSend);
+          cancel = !sink->sendDuplicateFrame(frame);
+        }
+        profiler.frameDone();
+        if (cancel) {
+          break;
+        }
+        continue;
+      }
+
+      {
+        RenderStageTimer draw_timer(profiler, RenderStageDraw);
+        rasterizer->beginFrame();
+        (void)renderFrameAt(curr_frame_time, *rasterizer);
+      }
+
+      {
+        RenderStageTimer flush_timer(profiler, RenderStageFlush);
+        if (full_redraw) {
+          rasterizer->endFrame();
+        } else {
+          rasterizer->endFrame(damage);
+        }
+      }
+
+      {
+        RenderStageTimer send_timer(profiler, RenderStageSend);
+        cancel = !sink->sendFrame(frame, rasterizer->getPixels(), false);
+      }
+      profiler.frameDone();
+      if (cancel) {
+        break;
+      }
+    }
+
+    bool finished;
+    {
+      RenderStageTimer end_timer(profiler, RenderStageEnd);
+      finished = sink->finish(cancel);
+    }
+    delete sink;
+    if (!finished || cancel ||
+        !writeExportCheckpoint(VIDEO_OUTPUT_PATH, EXPORT_SEGMENT_FRAMES,
+                               segment + 1)) {
+      completed = false;
+      break;
+    }
+  }
+  delete image_sequence;
+  delete converter;
+  delete rasterizer;
+
+  reportRenderProfile(profiler);
+  writeTrace();
+
+  if (completed) {
+    (void)concatExportSegments(VIDEO_OUTPUT_PATH, segment_count);
+  }
 }
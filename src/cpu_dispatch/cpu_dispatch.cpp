@@ -0,0 +1,72 @@
+#include "cpu_dispatch/cpu_dispatch.hpp"
+
+static CpuLevel detectCpuLevel(void) {
+  // __builtin_cpu_supports() also checks that the OS saves the wider
+  // registers.
+  __builtin_cpu_init();
+  if (__builtin_cpu_supports("avx512f") &&
+      __builtin_cpu_supports("avx512bw") &&
+      __builtin_cpu_supports("avx512dq") &&
+      __builtin_cpu_supports("avx512vl")) {
+    return CpuLevelAvx512;
+  }
+  if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma")) {
+    return CpuLevelAvx2;
+  }
+  return CpuLevelSse42;
+}
+
+static CpuLevel getEnvironmentLimit(void) {
+  const char *name = getenv("CIRCUIT_CPU_LEVEL");
+  CpuLevel level = LastCpuLevel;
+  if (name != NULL && name[0] != '\0' && !parseCpuLevel(name, level)) {
+    fprintf(stderr, "CPU_DISPATCH: unknown CIRCUIT_CPU_LEVEL %s\n", name);
+  }
+  return level;
+}
+
+CpuLevel getDetectedCpuLevel(void) {
+  static const CpuLevel detected = detectCpuLevel();
+  return detected;
+}
+
+// Filled on first use, so kernels running from static initializers see the
+// environment limit too.
+static std::atomic<uint8_t> &getLevelStorage(void) {
+  static std::atomic<uint8_t> level(
+      std::min(getDetectedCpuLevel(), getEnvironmentLimit()));
+  return level;
+}
+
+CpuLevel getCpuLevel(void) {
+  return static_cast<CpuLevel>(
+      getLevelStorage().load(std::memory_order_relaxed));
+}
+
+void setCpuLevelLimit(const CpuLevel level) {
+  getLevelStorage().store(std::min(getDetectedCpuLevel(), level),
+                          std::memory_order_relaxed);
+}
+
+const char *getCpuLevelName(const CpuLevel level) {
+  switch (level) {
+  case CpuLevelSse42:
+    return "sse4.2";
+  case CpuLevelAvx2:
+    return "avx2";
+  case CpuLevelAvx512:
+    return "avx512";
+  default:
+    return "unknown";
+  }
+}
+
+bool parseCpuLevel(const char *name, CpuLevel &level) {
+  for (uint8_t i = FirstCpuLevel; i < LastCpuLevel; i++) {
+    if (strcmp(name, getCpuLevelName(static_cast<CpuLevel>(i))) == 0) {
+      level = static_cast<CpuLevel>(i);
+      return true;
+    }
+  }
+  return false;
+}
@@ -0,0 +1,49 @@
+#include "draw_backend/draw_backend.hpp"
+
+void RaylibDrawBackend::clearBackground(const Color color) {
+  ClearBackground(color);
+}
+
+void RaylibDrawBackend::drawRectangleGradientV(const Rectangle rect,
+                                               const Color top,
+                                               const Color bottom) {
+  DrawRectangleGradientV(rect.x, rect.y, rect.width, rect.height, top, bottom);
+}
+
+void RaylibDrawBackend::drawRectangleLines(const Rectangle rect,
+                                           const float thick,
+                                           const Color color) {
+  DrawRectangleLinesEx(rect, thick, color);
+}
+
+void RaylibDrawBackend::drawCircleGradient(const Vector2 center,
+                                           const float radius,
+                                           const Color inner,
+                                           const Color outer) {
+  DrawCircleGradient(center.x, center.y, radius, inner, outer);
+}
+
+void RaylibDrawBackend::drawCircleLines(const Vector2 center,
+                                        const float radius,
+                                        const Color color) {
+  DrawCircleLinesV(center, radius, color);
+}
+
+void RaylibDrawBackend::drawSplineBezierQuadratic(const Vector2 *points,
+                                                  const size_t point_count,
+                                                  const float thick,
+                                                  const Color color) {
+  DrawSplineBezierQuadratic(points, point_count, thick, color);
+}
+
+void RaylibDrawBackend::drawTriangle(const Vector2 v1, const Vector2 v2,
+                                     const Vector2 v3, const Color color) {
+  DrawTriangle(v1, v2, v3, color);
+}
+
+void RaylibDrawBackend::drawTextCodepoint(const int codepoint,
+                                          const Vector2 position,
+                                          const float font_size,
+                                          const Color color) {
+  DrawTextCodepoint(_font, codepoint, position, font_size, color);
+}
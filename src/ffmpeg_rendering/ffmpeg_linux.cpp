@@ -1,4 +1,5 @@
 #include "ffmpeg_rendering/ffmpeg.hpp"
+#include "ffmpeg_rendering/yuv420_converter.hpp"
 #include "standard_defs/standard_defs.hpp"
 
 #define READ_END 0
@@ -7,10 +8,89 @@
 struct FFMPEG {
   int pipe;
   pid_t pid;
+  FFMPEGPipeFormat pipe_format;
+  YUV420Converter *converter;
+  uint8_t *frame;
+  size_t frame_size;
+  // The last frame written, frame or the caller's RGBA, NULL before the
+  // first one.
+  const void *previous;
 };
 
+static bool ffmpeg_write_all(FFMPEG *ffmpeg, const void *data, size_t size) {
+  const uint8_t *bytes = static_cast<const uint8_t *>(data);
+  while (size > 0) {
+    ssize_t written = write(ffmpeg->pipe, bytes, size);
+    if (written < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      TraceLog(LOG_ERROR, "FFMPEG: failed to write frame into ffmpeg pipe: %s",
+               strerror(errno));
+      return false;
+    }
+    bytes += written;
+    size -= written;
+  }
+  return true;
+}
+
+static bool ffmpeg_send_frame_yuv420p(FFMPEG *ffmpeg, const void *data,
+                                      size_t width, size_t height, bool flip) {
+  ffmpeg->converter->convert(data, width, height, flip, ffmpeg->frame);
+  ffmpeg->previous = ffmpeg->frame;
+  return ffmpeg_write_all(ffmpeg, ffmpeg->frame, ffmpeg->frame_size);
+}
+
+static bool ffmpeg_wait_child(pid_t pid) {
+  for (;;) {
+    int wstatus = 0;
+    if (waitpid(pid, &wstatus, 0) < 0) {
+      TraceLog(LOG_ERROR,
+               "FFMPEG: could not wait for ffmpeg child process to finish: %s",
+               strerror(errno));
+      return false;
+    }
+
+    if (WIFEXITED(wstatus)) {
+      int exit_status = WEXITSTATUS(wstatus);
+      if (exit_status != 0) {
+        TraceLog(LOG_ERROR, "FFMPEG: ffmpeg exited with code %d", exit_status);
+        return false;
+      }
+
+      return true;
+    }
+
+    if (WIFSIGNALED(wstatus)) {
+      TraceLog(LOG_ERROR, "FFMPEG: ffmpeg got terminated by %s",
+               strsignal(WTERMSIG(wstatus)));
+      return false;
+    }
+  }
+
+  assert(0 && "unreachable");
+}
+
 FFMPEG *ffmpeg_start_rendering(const char *output_path, size_t width,
-                               size_t height, size_t fps) {
+                               size_t height, size_t fps,
+                               FFMPEGPipeFormat pipe_format,
+                               YUV420Converter *converter) {
+  assert(pipe_format != FFMPEG_PIPE_YUV420P || converter != NULL);
+  if (pipe_format == FFMPEG_PIPE_YUV420P && (width % 2 || height % 2)) {
+    TraceLog(LOG_ERROR, "FFMPEG: yuv420p needs an even resolution, got %zux%zu",
+             width, height);
+    return NULL;
+  }
+
+  // Formatted before the fork, the child cannot.
+  char resolution[64];
+  snprintf(resolution, sizeof(resolution), "%zux%zu", width, height);
+  char framerate[64];
+  snprintf(framerate, sizeof(framerate), "%zu", fps);
+  const char *input_pix_fmt =
+      pipe_format == FFMPEG_PIPE_YUV420P ? "yuv420p" : "rgba";
+
   int pipefd[2];
 
   if (pipe(pipefd) < 0) {
@@ -26,31 +106,16 @@ FFMPEG *ffmpeg_start_rendering(const char *output_path, size_t width,
 
   if (child == 0) {
     if (dup2(pipefd[READ_END], STDIN_FILENO) < 0) {
-      TraceLog(LOG_ERROR,
-               "FFMPEG CHILD: could not reopen read end of pipe as stdin: %s",
-               strerror(errno));
-      exit(1);
+      failForkedChild(
+          "FFMPEG CHILD: could not reopen read end of pipe as stdin\n");
     }
     close(pipefd[WRITE_END]);
 
-    char resolution[64];
-    snprintf(resolution, sizeof(resolution), "%zux%zu", width, height);
-    char framerate[64];
-    snprintf(framerate, sizeof(framerate), "%zu", fps);
-
-    int ret =
-        execlp("ffmpeg", "ffmpeg", "-loglevel", "verbose", "-y", "-f",
-               "rawvideo", "-pix_fmt", "rgba", "-s", resolution, "-r",
-               framerate, "-i", "-", "-c:v", "libx264", "-vb", "2500k", "-c:a",
-               "aac", "-ab", "200k", "-pix_fmt", "yuv420p", output_path, NULL);
-    if (ret < 0) {
-      TraceLog(LOG_ERROR,
-               "FFMPEG CHILD: could not run ffmpeg as a child process: %s",
-               strerror(errno));
-      exit(1);
-    }
-    assert(0 && "unreachable");
-    exit(1);
+    execlp("ffmpeg", "ffmpeg", "-loglevel", "verbose", "-y", "-f", "rawvideo",
+           "-pix_fmt", input_pix_fmt, "-s", resolution, "-r", framerate, "-i",
+           "-", "-c:v", "libx264", "-vb", "2500k", "-c:a", "aac", "-ab", "200k",
+           "-pix_fmt", "yuv420p", output_path, NULL);
+    failForkedChild("FFMPEG CHILD: could not run ffmpeg as a child process\n");
   }
 
   if (close(pipefd[READ_END]) < 0) {
@@ -64,6 +129,17 @@ FFMPEG *ffmpeg_start_rendering(const char *output_path, size_t width,
   assert(ffmpeg != NULL && "Buy MORE RAM lol!!");
   ffmpeg->pid = child;
   ffmpeg->pipe = pipefd[WRITE_END];
+  ffmpeg->pipe_format = pipe_format;
+  ffmpeg->converter = converter;
+  ffmpeg->frame_size = sizeof(uint32_t) * width * height;
+  if (pipe_format == FFMPEG_PIPE_YUV420P) {
+    ffmpeg->frame_size = YUV420Converter::getFrameSize(width, height);
+  }
+  // Converted and flipped frames are kept so that static frames can be
+  // repeated without drawing and reading them back again.
+  ffmpeg->frame = static_cast<uint8_t *>(malloc(ffmpeg->frame_size));
+  assert(ffmpeg->frame != NULL && "Buy MORE RAM lol!!");
+  ffmpeg->previous = NULL;
   return ffmpeg;
 }
 
@@ -71,6 +147,7 @@ bool ffmpeg_end_rendering(FFMPEG *ffmpeg, bool cancel) {
   int pipe = ffmpeg->pipe;
   pid_t pid = ffmpeg->pid;
 
+  free(ffmpeg->frame);
   free(ffmpeg);
 
   if (close(pipe) < 0) {
@@ -83,44 +160,54 @@ bool ffmpeg_end_rendering(FFMPEG *ffmpeg, bool cancel) {
   if (cancel)
     kill(pid, SIGKILL);
 
-  for (;;) {
-    int wstatus = 0;
-    if (waitpid(pid, &wstatus, 0) < 0) {
-      TraceLog(LOG_ERROR,
-               "FFMPEG: could not wait for ffmpeg child process to finish: %s",
-               strerror(errno));
-      return false;
-    }
+  return ffmpeg_wait_child(pid);
+}
 
-    if (WIFEXITED(wstatus)) {
-      int exit_status = WEXITSTATUS(wstatus);
-      if (exit_status != 0) {
-        TraceLog(LOG_ERROR, "FFMPEG: ffmpeg exited with code %d", exit_status);
-        return false;
-      }
+bool ffmpeg_send_frame_flipped(FFMPEG *ffmpeg, const void *data, size_t width,
+                               size_t height) {
+  if (ffmpeg->pipe_format == FFMPEG_PIPE_YUV420P) {
+    return ffmpeg_send_frame_yuv420p(ffmpeg, data, width, height, true);
+  }
 
-      return true;
-    }
+  const size_t row_size = sizeof(uint32_t) * width;
+  for (size_t y = 0; y < height; y++) {
+    memcpy(ffmpeg->frame + y * row_size,
+           (const uint32_t *)data + (height - 1 - y) * width, row_size);
+  }
+  ffmpeg->previous = ffmpeg->frame;
+  return ffmpeg_write_all(ffmpeg, ffmpeg->frame, ffmpeg->frame_size);
+}
 
-    if (WIFSIGNALED(wstatus)) {
-      TraceLog(LOG_ERROR, "FFMPEG: ffmpeg got terminated by %s",
-               strsignal(WTERMSIG(wstatus)));
-      return false;
-    }
+bool ffmpeg_send_frame(FFMPEG *ffmpeg, const void *data, size_t width,
+                       size_t height) {
+  if (ffmpeg->pipe_format == FFMPEG_PIPE_YUV420P) {
+    return ffmpeg_send_frame_yuv420p(ffmpeg, data, width, height, false);
   }
 
-  assert(0 && "unreachable");
+  ffmpeg->previous = data;
+  return ffmpeg_write_all(ffmpeg, data, ffmpeg->frame_size);
 }
 
-bool ffmpeg_send_frame_flipped(FFMPEG *ffmpeg, void *data, size_t width,
-                               size_t height) {
-  for (size_t y = height; y > 0; --y) {
-    if (write(ffmpeg->pipe, (uint32_t *)data + (y - 1) * width,
-              sizeof(uint32_t) * width) < 0) {
-      TraceLog(LOG_ERROR, "FFMPEG: failed to write frame into ffmpeg pipe: %s",
-               strerror(errno));
-      return false;
-    }
+bool ffmpeg_send_previous_frame(FFMPEG *ffmpeg) {
+  if (ffmpeg->previous == NULL) {
+    TraceLog(LOG_ERROR, "FFMPEG: no previous frame to repeat");
+    return false;
   }
-  return true;
+  return ffmpeg_write_all(ffmpeg, ffmpeg->previous, ffmpeg->frame_size);
+}
+
+bool ffmpeg_concat_files(const char *list_path, const char *output_path) {
+  pid_t child = fork();
+  if (child < 0) {
+    TraceLog(LOG_ERROR, "FFMPEG: could not fork a child: %s", strerror(errno));
+    return false;
+  }
+
+  if (child == 0) {
+    execlp("ffmpeg", "ffmpeg", "-loglevel", "error", "-y", "-f", "concat",
+           "-safe", "0", "-i", list_path, "-c", "copy", output_path, NULL);
+    failForkedChild("FFMPEG CHILD: could not run ffmpeg as a child process\n");
+  }
+
+  return ffmpeg_wait_child(child);
 }
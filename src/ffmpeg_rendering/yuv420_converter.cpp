@@ -0,0 +1,186 @@
+#include "ffmpeg_rendering/yuv420_converter.hpp"
+#include "cpu_dispatch/cpu_dispatch.hpp"
+#include <immintrin.h>
+
+// BT.601 limited range in 8 bit fixed point:
+//   Y = (( 66 R + 129 G +  25 B + 128) >> 8) + 16
+//   U = ((-38 R -  74 G + 112 B + 128) >> 8) + 128
+//   V = ((112 R -  94 G -  18 B + 128) >> 8) + 128
+// Chroma takes the sums of a 2x2 block, hence the extra >> 2.
+static constexpr int32_t LUMA_BIAS = 128 + (16 << 8);
+static constexpr int32_t CHROMA_BIAS = 512 + (128 << 10);
+
+static inline uint8_t lumaOf(const uint32_t pixel) {
+  const int32_t r = pixel & 0xFF;
+  const int32_t g = (pixel >> 8) & 0xFF;
+  const int32_t b = (pixel >> 16) & 0xFF;
+  return (66 * r + 129 * g + 25 * b + LUMA_BIAS) >> 8;
+}
+
+static inline void chromaOf(const uint32_t p00, const uint32_t p01,
+                            const uint32_t p10, const uint32_t p11,
+                            uint8_t &u, uint8_t &v) {
+  const int32_t r = (p00 & 0xFF) + (p01 & 0xFF) + (p10 & 0xFF) + (p11 & 0xFF);
+  const int32_t g = ((p00 >> 8) & 0xFF) + ((p01 >> 8) & 0xFF) +
+                    ((p10 >> 8) & 0xFF) + ((p11 >> 8) & 0xFF);
+  const int32_t b = ((p00 >> 16) & 0xFF) + ((p01 >> 16) & 0xFF) +
+                    ((p10 >> 16) & 0xFF) + ((p11 >> 16) & 0xFF);
+  u = (-38 * r - 74 * g + 112 * b + CHROMA_BIAS) >> 10;
+  v = (112 * r - 94 * g - 18 * b + CHROMA_BIAS) >> 10;
+}
+
+static inline int32_t packWords(const int16_t low, const int16_t high) {
+  return static_cast<uint16_t>(low) | (static_cast<int32_t>(high) << 16);
+}
+
+// Narrows two vectors of eight 32 bit values (all within 0..255) into 16
+// bytes in order.
+TRY_TARGET_AVX2 static inline __m128i narrowToBytes(const __m256i a,
+                                                    const __m256i b) {
+  const __m256i words = _mm256_packs_epi32(a, b);
+  const __m256i bytes = _mm256_packus_epi16(words, _mm256_setzero_si256());
+  return _mm256_castsi256_si128(_mm256_permutevar8x32_epi32(
+      bytes, _mm256_setr_epi32(0, 4, 1, 5, 2, 6, 3, 7)));
+}
+
+// Luma of eight pixels split as below, a lambda would not get the target.
+TRY_TARGET_AVX2 static inline __m256i lumaOf8(const __m256i rb,
+                                              const __m256i ga,
+                                              const __m256i y_rb,
+                                              const __m256i y_ga) {
+  return _mm256_srli_epi32(
+      _mm256_add_epi32(_mm256_add_epi32(_mm256_madd_epi16(rb, y_rb),
+                                        _mm256_madd_epi16(ga, y_ga)),
+                       _mm256_set1_epi32(LUMA_BIAS)),
+      8);
+}
+
+// Converts 16 pixels of two rows. Every RGBA pixel is split into the word
+// pairs (R, B) and (G, A) so a single madd applies two coefficients at once.
+TRY_TARGET_AVX2 static void convert16Avx2(const uint32_t *row0,
+                                          const uint32_t *row1, uint8_t *y0,
+                                          uint8_t *y1, uint8_t *u,
+                                          uint8_t *v) {
+  const __m256i byte_mask = _mm256_set1_epi32(0x00FF00FF);
+  const __m256i y_rb = _mm256_set1_epi32(packWords(66, 25));
+  const __m256i y_ga = _mm256_set1_epi32(packWords(129, 0));
+  const __m256i u_rb = _mm256_set1_epi32(packWords(-38, 112));
+  const __m256i u_ga = _mm256_set1_epi32(packWords(-74, 0));
+  const __m256i v_rb = _mm256_set1_epi32(packWords(112, -18));
+  const __m256i v_ga = _mm256_set1_epi32(packWords(-94, 0));
+  const __m256i chroma_bias = _mm256_set1_epi32(CHROMA_BIAS);
+
+  const __m256i a0 = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(row0));
+  const __m256i b0 =
+      _mm256_loadu_si256(reinterpret_cast<const __m256i *>(row0 + 8));
+  const __m256i a1 = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(row1));
+  const __m256i b1 =
+      _mm256_loadu_si256(reinterpret_cast<const __m256i *>(row1 + 8));
+
+  const __m256i rb_a0 = _mm256_and_si256(a0, byte_mask);
+  const __m256i rb_b0 = _mm256_and_si256(b0, byte_mask);
+  const __m256i rb_a1 = _mm256_and_si256(a1, byte_mask);
+  const __m256i rb_b1 = _mm256_and_si256(b1, byte_mask);
+  const __m256i ga_a0 = _mm256_and_si256(_mm256_srli_epi32(a0, 8), byte_mask);
+  const __m256i ga_b0 = _mm256_and_si256(_mm256_srli_epi32(b0, 8), byte_mask);
+  const __m256i ga_a1 = _mm256_and_si256(_mm256_srli_epi32(a1, 8), byte_mask);
+  const __m256i ga_b1 = _mm256_and_si256(_mm256_srli_epi32(b1, 8), byte_mask);
+
+  _mm_storeu_si128(reinterpret_cast<__m128i *>(y0),
+                   narrowToBytes(lumaOf8(rb_a0, ga_a0, y_rb, y_ga),
+                                 lumaOf8(rb_b0, ga_b0, y_rb, y_ga)));
+  _mm_storeu_si128(reinterpret_cast<__m128i *>(y1),
+                   narrowToBytes(lumaOf8(rb_a1, ga_a1, y_rb, y_ga),
+                                 lumaOf8(rb_b1, ga_b1, y_rb, y_ga)));
+
+  // Vertical sums stay below 2^10 per word, so adding neighbouring dwords
+  // horizontally cannot carry from R into B. hadd leaves the blocks in the
+  // order 0 1 4 5 2 3 6 7, the permute puts them back.
+  const __m256i block_order = _mm256_setr_epi32(0, 1, 4, 5, 2, 3, 6, 7);
+  const __m256i rb4 = _mm256_hadd_epi32(_mm256_add_epi32(rb_a0, rb_a1),
+                                        _mm256_add_epi32(rb_b0, rb_b1));
+  const __m256i ga4 = _mm256_hadd_epi32(_mm256_add_epi32(ga_a0, ga_a1),
+                                        _mm256_add_epi32(ga_b0, ga_b1));
+  const __m256i u32 = _mm256_srli_epi32(
+      _mm256_add_epi32(_mm256_add_epi32(_mm256_madd_epi16(rb4, u_rb),
+                                        _mm256_madd_epi16(ga4, u_ga)),
+                       chroma_bias),
+      10);
+  const __m256i v32 = _mm256_srli_epi32(
+      _mm256_add_epi32(_mm256_add_epi32(_mm256_madd_epi16(rb4, v_rb),
+                                        _mm256_madd_epi16(ga4, v_ga)),
+                       chroma_bias),
+      10);
+  const __m128i uv =
+      narrowToBytes(_mm256_permutevar8x32_epi32(u32, block_order),
+                    _mm256_permutevar8x32_epi32(v32, block_order));
+  _mm_storel_epi64(reinterpret_cast<__m128i *>(u), uv);
+  _mm_storel_epi64(reinterpret_cast<__m128i *>(v), _mm_srli_si128(uv, 8));
+}
+
+void YUV420Converter::convertRowPairs(const uint32_t *rgba, const size_t width,
+                                      const size_t height, const bool flip,
+                                      uint8_t *yuv,
+                                      const size_t first_row_pair,
+                                      const size_t last_row_pair) {
+  const size_t chroma_width = (width + 1) / 2;
+  uint8_t *y_plane = yuv;
+  uint8_t *u_plane = yuv + width * height;
+  uint8_t *v_plane = u_plane + chroma_width * ((height + 1) / 2);
+  const bool use_avx2 = getCpuLevel() >= CpuLevelAvx2;
+
+  for (size_t pair = first_row_pair; pair < last_row_pair; pair++) {
+    const size_t y = 2 * pair;
+    const size_t src_y0 = flip ? height - 1 - y : y;
+    const uint32_t *row0 = rgba + src_y0 * width;
+    uint8_t *y0 = y_plane + y * width;
+    // The last row of an odd height pairs with itself, both luma rows are
+    // then written to the same place with the same values.
+    const uint32_t *row1 = row0;
+    uint8_t *y1 = y0;
+    if (y + 1 < height) {
+      row1 = rgba + (flip ? src_y0 - 1 : src_y0 + 1) * width;
+      y1 = y0 + width;
+    }
+    uint8_t *u = u_plane + pair * chroma_width;
+    uint8_t *v = v_plane + pair * chroma_width;
+
+    size_t x = 0;
+    if (use_avx2) {
+      for (; x + 16 <= width; x += 16) {
+        convert16Avx2(row0 + x, row1 + x, y0 + x, y1 + x, u + x / 2,
+                      v + x / 2);
+      }
+    }
+    for (; x + 2 <= width; x += 2) {
+      y0[x] = lumaOf(row0[x]);
+      y0[x + 1] = lumaOf(row0[x + 1]);
+      y1[x] = lumaOf(row1[x]);
+      y1[x + 1] = lumaOf(row1[x + 1]);
+      chromaOf(row0[x], row0[x + 1], row1[x], row1[x + 1], u[x / 2],
+               v[x / 2]);
+    }
+    if (x < width) {
+      y0[x] = lumaOf(row0[x]);
+      y1[x] = lumaOf(row1[x]);
+      chromaOf(row0[x], row0[x], row1[x], row1[x], u[x / 2], v[x / 2]);
+    }
+  }
+}
+
+void YUV420Converter::convert(const void *rgba, const size_t width,
+                              const size_t height, const bool flip,
+                              uint8_t *yuv) {
+  const uint32_t *pixels = static_cast<const uint32_t *>(rgba);
+  const size_t row_pairs = (height + 1) / 2;
+  const uint32_t task_count =
+      (row_pairs + ROW_PAIRS_PER_TASK - 1) / ROW_PAIRS_PER_TASK;
+
+  _pool.parallelFor(task_count, [&](const uint32_t task) {
+    const size_t first_row_pair = task * ROW_PAIRS_PER_TASK;
+    const size_t last_row_pair =
+        std::min(first_row_pair + ROW_PAIRS_PER_TASK, row_pairs);
+    convertRowPairs(pixels, width, height, flip, yuv, first_row_pair,
+                    last_row_pair);
+  });
+}
@@ -0,0 +1,82 @@
+#include "ffmpeg_rendering/yuv420_converter_self_test.hpp"
+#include "cpu_dispatch/cpu_dispatch.hpp"
+
+// Written past the end of every frame, a kernel storing a whole vector
+// beyond a row tail shows up as a changed guard byte.
+static constexpr size_t GUARD_BYTES = 64;
+static constexpr uint8_t GUARD_VALUE = 0xA5;
+
+uint64_t YUV420ConverterSelfTest::nextRandom(void) {
+  // SplitMix64, identical sequence on every platform.
+  uint64_t z = (_random_state += 0x9e3779b97f4a7c15ull);
+  z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ull;
+  z = (z ^ (z >> 27)) * 0x94d049bb133111ebull;
+  return z ^ (z >> 31);
+}
+
+void YUV420ConverterSelfTest::check(const bool condition, const char *what) {
+  if (!condition) {
+    fprintf(stderr, "YUV420_CONVERTER: self test failed: %s\n", what);
+    _failure_count++;
+  }
+}
+
+// Converts a random frame through the pool at the current level, upright
+// and flipped, and compares both byte for byte with the scalar kernel.
+void YUV420ConverterSelfTest::testFrame(YUV420Converter &converter,
+                                        const size_t width,
+                                        const size_t height) {
+  // Mostly random pixels, with runs of black and white for the extremes of
+  // every coefficient.
+  std::vector<uint32_t> rgba(width * height);
+  for (uint32_t &pixel : rgba) {
+    const uint64_t r = nextRandom();
+    pixel = r % 8 == 0 ? 0 : r % 8 == 1 ? UINT32_MAX : r >> 32;
+  }
+  std::vector<uint32_t> flipped(width * height);
+  for (size_t y = 0; y < height; y++) {
+    std::copy(rgba.begin() + y * width, rgba.begin() + (y + 1) * width,
+              flipped.begin() + (height - 1 - y) * width);
+  }
+
+  const size_t frame_size = YUV420Converter::getFrameSize(width, height);
+  const size_t row_pairs = (height + 1) / 2;
+  const CpuLevel level = getCpuLevel();
+  for (const bool flip : {false, true}) {
+    std::vector<uint8_t> actual(frame_size + GUARD_BYTES, GUARD_VALUE);
+    std::vector<uint8_t> expected(frame_size + GUARD_BYTES, GUARD_VALUE);
+    converter.convert(rgba.data(), width, height, flip, actual.data());
+    setCpuLevelLimit(FirstCpuLevel);
+    YUV420Converter::convertRowPairs(rgba.data(), width, height, flip,
+                                     expected.data(), 0, row_pairs);
+    setCpuLevelLimit(level);
+    check(actual == expected, "convert() matches the scalar kernel");
+
+    // Flipping is reading the rows the other way around.
+    std::vector<uint8_t> upright(frame_size + GUARD_BYTES, GUARD_VALUE);
+    converter.convert(flipped.data(), width, height, !flip, upright.data());
+    check(upright == actual, "flip reads the rows bottom-up");
+  }
+}
+
+bool YUV420ConverterSelfTest::selfTest(void) {
+  _failure_count = 0;
+
+  // A gray pixel lands on the same value in every plane as the formulas.
+  const uint32_t gray = 0xFF808080;
+  uint8_t yuv[3];
+  YUV420Converter::convertRowPairs(&gray, 1, 1, false, yuv, 0, 1);
+  check(yuv[0] == 126 && yuv[1] == 128 && yuv[2] == 128,
+        "BT.601 limited range of a single gray pixel");
+
+  // More row pairs than one task takes, so the pool splits the frame.
+  YUV420Converter converter(2);
+  const size_t widths[] = {1, 2, 3, 15, 16, 17, 30, 31, 32, 33, 47, 64, 71};
+  const size_t heights[] = {1, 2, 3, 4, 7, 33, 70};
+  for (const size_t width : widths) {
+    for (const size_t height : heights) {
+      testFrame(converter, width, height);
+    }
+  }
+  return _failure_count == 0;
+}
@@ -0,0 +1,50 @@
+#include "frame_sink/frame_sink.hpp"
+
+bool FFMPEGFrameSink::sendFrame(const uint64_t frame_index, const void *rgba,
+                                const bool flipped) {
+  TraceScope scope(TraceCategoryRender, "encode video");
+  scope.addArg("frame", frame_index);
+
+  if (flipped) {
+    return ffmpeg_send_frame_flipped(_ffmpeg, rgba, _width, _height);
+  }
+  return ffmpeg_send_frame(_ffmpeg, rgba, _width, _height);
+}
+
+bool FFMPEGFrameSink::sendDuplicateFrame(const uint64_t) {
+  return ffmpeg_send_previous_frame(_ffmpeg);
+}
+
+bool FFMPEGFrameSink::finish(const bool cancel) {
+  if (_ffmpeg == NULL) {
+    return false;
+  }
+  FFMPEG *ffmpeg = _ffmpeg;
+  _ffmpeg = NULL;
+  return ffmpeg_end_rendering(ffmpeg, cancel);
+}
+
+bool FanOutFrameSink::sendFrame(const uint64_t frame_index, const void *rgba,
+                                const bool flipped) {
+  bool sent = true;
+  for (auto sink : _sinks) {
+    sent = sink->sendFrame(frame_index, rgba, flipped) && sent;
+  }
+  return sent;
+}
+
+bool FanOutFrameSink::sendDuplicateFrame(const uint64_t frame_index) {
+  bool sent = true;
+  for (auto sink : _sinks) {
+    sent = sink->sendDuplicateFrame(frame_index) && sent;
+  }
+  return sent;
+}
+
+bool FanOutFrameSink::finish(const bool cancel) {
+  bool finished = true;
+  for (auto sink : _sinks) {
+    finished = sink->finish(cancel) && finished;
+  }
+  return finished;
+}
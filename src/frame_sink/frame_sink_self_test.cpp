@@ -0,0 +1,422 @@
+#include "frame_sink/frame_sink_self_test.hpp"
+#include <dirent.h>
+#include <sys/stat.h>
+
+enum QOIOp : uint8_t {
+  QOIOpIndex,
+  QOIOpDiff,
+  QOIOpLuma,
+  QOIOpRun,
+  QOIOpRGB,
+  QOIOpRGBA,
+  QOIOpCount
+};
+
+uint64_t FrameSinkSelfTest::nextRandom(void) {
+  // SplitMix64, identical sequence on every platform.
+  uint64_t z = (_random_state += 0x9e3779b97f4a7c15ull);
+  z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ull;
+  z = (z ^ (z >> 27)) * 0x94d049bb133111ebull;
+  return z ^ (z >> 31);
+}
+
+void FrameSinkSelfTest::check(const bool condition, const char *what) {
+  if (!condition) {
+    fprintf(stderr, "FRAME_SINK: self test failed: %s\n", what);
+    _failure_count++;
+  }
+}
+
+// Channel bytes in memory order r g b a, as the encoder takes them.
+static inline uint32_t makePixel(const uint8_t r, const uint8_t g,
+                                 const uint8_t b, const uint8_t a) {
+  return r | g << 8 | b << 16 | static_cast<uint32_t>(a) << 24;
+}
+
+static inline uint32_t readU32BE(const uint8_t *p) {
+  return static_cast<uint32_t>(p[0]) << 24 | p[1] << 16 | p[2] << 8 | p[3];
+}
+
+// Decoder written from the specification, independent of the encoder.
+// Counts the ops of every kind in op_counts, returns false on a malformed
+// stream, one of another size or one with bytes after the end marker.
+static bool decodeQOI(const uint8_t *data, const size_t size,
+                      const size_t width, const size_t height,
+                      std::vector<uint32_t> &pixels,
+                      uint64_t op_counts[QOIOpCount]) {
+  static const uint8_t END_MARKER[QOI_END_MARKER_SIZE] = {0, 0, 0, 0,
+                                                          0, 0, 0, 1};
+  if (size < QOI_HEADER_SIZE + QOI_END_MARKER_SIZE ||
+      memcmp(data, "qoif", 4) != 0 || readU32BE(data + 4) != width ||
+      readU32BE(data + 8) != height || data[12] != 4 || data[13] != 0) {
+    return false;
+  }
+
+  uint8_t index[64][4];
+  memset(index, 0, sizeof(index));
+  uint8_t px[4] = {0, 0, 0, 255};
+  const uint8_t *p = data + QOI_HEADER_SIZE;
+  const uint8_t *end = data + size - QOI_END_MARKER_SIZE;
+  uint32_t run = 0;
+  pixels.clear();
+  for (size_t i = 0; i < width * height; i++) {
+    if (run > 0) {
+      run--;
+    } else {
+      if (p >= end) {
+        return false;
+      }
+      const uint8_t b1 = *p++;
+      if (b1 == 0xfe || b1 == 0xff) {
+        const size_t channels = b1 == 0xfe ? 3 : 4;
+        if (end - p < static_cast<ptrdiff_t>(channels)) {
+          return false;
+        }
+        memcpy(px, p, channels);
+        p += channels;
+        op_counts[b1 == 0xfe ? QOIOpRGB : QOIOpRGBA]++;
+      } else if ((b1 & 0xc0) == 0x00) {
+        memcpy(px, index[b1], 4);
+        op_counts[QOIOpIndex]++;
+      } else if ((b1 & 0xc0) == 0x40) {
+        px[0] += ((b1 >> 4) & 3) - 2;
+        px[1] += ((b1 >> 2) & 3) - 2;
+        px[2] += (b1 & 3) - 2;
+        op_counts[QOIOpDiff]++;
+      } else if ((b1 & 0xc0) == 0x80) {
+        if (p >= end) {
+          return false;
+        }
+        const uint8_t b2 = *p++;
+        const int vg = (b1 & 0x3f) - 32;
+        px[0] += vg - 8 + ((b2 >> 4) & 0x0f);
+        px[1] += vg;
+        px[2] += vg - 8 + (b2 & 0x0f);
+        op_counts[QOIOpLuma]++;
+      } else {
+        run = b1 & 0x3f;
+        op_counts[QOIOpRun]++;
+      }
+    }
+    memcpy(index[(px[0] * 3 + px[1] * 5 + px[2] * 7 + px[3] * 11) % 64], px,
+           4);
+    pixels.push_back(makePixel(px[0], px[1], px[2], px[3]));
+  }
+  return run == 0 && p == end &&
+         memcmp(end, END_MARKER, QOI_END_MARKER_SIZE) == 0;
+}
+
+// A row of 7 pixels worked out by hand from the specification, one op of
+// every kind: a run over the implicit first pixel, a diff, a run, an RGB,
+// an index hit, an RGBA for the alpha change and a luma.
+void FrameSinkSelfTest::testQOIReference(void) {
+  const uint32_t pixels[] = {
+      makePixel(0, 0, 0, 255),    makePixel(1, 1, 1, 255),
+      makePixel(1, 1, 1, 255),    makePixel(10, 20, 30, 255),
+      makePixel(1, 1, 1, 255),    makePixel(1, 1, 1, 128),
+      makePixel(5, 10, 7, 128)};
+  const uint8_t expected[] = {
+      'q',  'o',  'i',  'f',  0,    0,    0,    7,    0,    0,    0,
+      1,    4,    0,    0xc0, 0x7f, 0xc0, 0xfe, 0x0a, 0x14, 0x1e, 0x04,
+      0xff, 0x01, 0x01, 0x01, 0x80, 0xa9, 0x35, 0,    0,    0,    0,
+      0,    0,    0,    1};
+
+  std::vector<uint8_t> encoded(qoi_max_encoded_size(7, 1));
+  const size_t size = qoi_encode(pixels, 7, 1, encoded.data());
+  check(size == sizeof(expected) &&
+            memcmp(encoded.data(), expected, size) == 0,
+        "QOI encoding of the reference row");
+}
+
+// Random pixels made of runs, some longer than the 62 a run op holds,
+// repeats of a small palette for index hits, small and medium steps for
+// diff and luma, new colors and alpha changes. Decoded they have to give
+// the pixels back.
+void FrameSinkSelfTest::testQOIRoundTrip(const size_t width,
+                                         const size_t height) {
+  uint32_t palette[8];
+  for (uint32_t &color : palette) {
+    const uint32_t alpha = nextRandom() % 2 == 0 ? 0xff : 0x80;
+    color = (nextRandom() & 0x00ffffff) | alpha << 24;
+  }
+
+  const size_t pixel_count = width * height;
+  std::vector<uint32_t> pixels;
+  uint32_t pixel = makePixel(0, 0, 0, 255);
+  while (pixels.size() < pixel_count) {
+    const uint64_t r = nextRandom();
+    const uint8_t red = pixel;
+    const uint8_t green = pixel >> 8;
+    const uint8_t blue = pixel >> 16;
+    const uint8_t alpha = pixel >> 24;
+    // Luma steps reach a little past their range, to the edges either way.
+    const int step = static_cast<int>(r >> 40 & 127) - 64;
+    switch (r % 6) {
+    case 0:
+      pixels.insert(pixels.end(), r >> 8 & 127, pixel);
+      break;
+    case 1:
+      pixel = palette[r >> 8 & 7];
+      break;
+    case 2:
+      pixel = makePixel(red + (r >> 8 & 3) - 2, green + (r >> 10 & 3) - 2,
+                        blue + (r >> 12 & 3) - 2, alpha);
+      break;
+    case 3:
+      pixel = makePixel(red + step + (r >> 8 & 31) - 16, green + step,
+                        blue + step + (r >> 16 & 31) - 16, alpha);
+      break;
+    case 4:
+      pixel = makePixel(r >> 8, r >> 16, r >> 24, alpha);
+      break;
+    default:
+      pixel = makePixel(red, green, blue, r >> 8);
+      break;
+    }
+    pixels.push_back(pixel);
+  }
+  pixels.resize(pixel_count);
+
+  std::vector<uint8_t> encoded(qoi_max_encoded_size(width, height));
+  const size_t size = qoi_encode(pixels.data(), width, height, encoded.data());
+  std::vector<uint32_t> decoded;
+  uint64_t op_counts[QOIOpCount] = {};
+  check(size <= encoded.size() &&
+            decodeQOI(encoded.data(), size, width, height, decoded,
+                      op_counts) &&
+            decoded == pixels,
+        "QOI round trip gives the pixels back");
+  if (pixel_count >= 4096) {
+    bool every_op = true;
+    for (const uint64_t count : op_counts) {
+      every_op &= count > 0;
+    }
+    check(every_op, "QOI round trip uses every op");
+  }
+
+  // A single color is one run after the other, the last one cut short.
+  const std::vector<uint32_t> flat(pixel_count, palette[0]);
+  const size_t flat_size =
+      qoi_encode(flat.data(), width, height, encoded.data());
+  check(decodeQOI(encoded.data(), flat_size, width, height, decoded,
+                  op_counts) &&
+            decoded == flat,
+        "QOI round trip of a single color");
+}
+
+static void removeDirectory(const char *path) {
+  DIR *dir = opendir(path);
+  if (dir != NULL) {
+    for (struct dirent *entry = readdir(dir); entry != NULL;
+         entry = readdir(dir)) {
+      if (entry->d_name[0] != '.') {
+        unlinkat(dirfd(dir), entry->d_name, 0);
+      }
+    }
+    closedir(dir);
+  }
+  rmdir(path);
+}
+
+// One sink over several finish() calls, the way an export hands it every
+// segment: frames written before a finish() are on disk after it, duplicates
+// are links to the frame they repeat, and the sink keeps taking frames
+// after a finish(), a cancelled one included.
+void FrameSinkSelfTest::testImageSequence(void) {
+  static constexpr size_t WIDTH = 33;
+  static constexpr size_t HEIGHT = 17;
+
+  char directory[] = "/tmp/frame_sink_XXXXXX";
+  if (mkdtemp(directory) == NULL) {
+    check(false, "image sequence directory");
+    return;
+  }
+  const std::string pattern = std::string(directory) + "/frame_%02lu.qoi";
+
+  std::vector<std::vector<uint32_t>> frames(8);
+  for (auto &frame : frames) {
+    frame.resize(WIDTH * HEIGHT);
+    for (uint32_t &pixel : frame) {
+      const uint64_t r = nextRandom();
+      pixel = r % 4 == 0 ? 0xff000000 : r >> 32;
+    }
+  }
+
+  // The expected contents of every file, frame 5 is cancelled.
+  std::vector<const std::vector<uint32_t> *> expected(frames.size(), NULL);
+  std::vector<uint32_t> flipped(WIDTH * HEIGHT);
+  for (size_t y = 0; y < HEIGHT; y++) {
+    std::copy(frames[1].begin() + y * WIDTH,
+              frames[1].begin() + (y + 1) * WIDTH,
+              flipped.begin() + (HEIGHT - 1 - y) * WIDTH);
+  }
+  {
+    ImageSequenceFrameSink sink(pattern.c_str(), ImageSequenceQOI, WIDTH,
+                                HEIGHT, 2, 2);
+    check(sink.sendFrame(0, frames[0].data(), false) &&
+              sink.sendFrame(1, frames[1].data(), true) &&
+              sink.sendDuplicateFrame(2) && sink.finish(false),
+          "image sequence first segment");
+    expected[0] = &frames[0];
+    expected[1] = &flipped;
+    expected[2] = &flipped;
+
+    check(sink.sendFrame(3, frames[3].data(), false) &&
+              sink.sendDuplicateFrame(4) && sink.finish(false),
+          "image sequence takes frames after finish()");
+    expected[3] = &frames[3];
+    expected[4] = &frames[3];
+
+    check(sink.sendFrame(5, frames[5].data(), false) && !sink.finish(true),
+          "cancelled image sequence segment fails");
+    check(sink.sendFrame(6, frames[6].data(), false) &&
+              sink.sendFrame(7, frames[7].data(), false) &&
+              sink.finish(false),
+          "image sequence takes frames after a cancelled finish()");
+    expected[6] = &frames[6];
+    expected[7] = &frames[7];
+  }
+
+  std::vector<uint8_t> data;
+  std::vector<uint32_t> decoded;
+  uint64_t op_counts[QOIOpCount] = {};
+  for (size_t frame = 0; frame < frames.size(); frame++) {
+    if (expected[frame] == NULL) {
+      continue;
+    }
+    char path[256];
+    snprintf(path, sizeof(path), pattern.c_str(),
+             static_cast<unsigned long>(frame));
+    FILE *file = fopen(path, "rb");
+    data.resize(qoi_max_encoded_size(WIDTH, HEIGHT) + 1);
+    const size_t size =
+        file != NULL ? fread(data.data(), 1, data.size(), file) : 0;
+    if (file != NULL) {
+      fclose(file);
+    }
+    check(decodeQOI(data.data(), size, WIDTH, HEIGHT, decoded, op_counts) &&
+              decoded == *expected[frame],
+          "image sequence file holds its frame");
+  }
+
+  struct stat original;
+  struct stat duplicate;
+  for (const auto &frame_pair : {std::make_pair(1, 2), std::make_pair(3, 4)}) {
+    char original_path[256];
+    char duplicate_path[256];
+    snprintf(original_path, sizeof(original_path), pattern.c_str(),
+             static_cast<unsigned long>(frame_pair.first));
+    snprintf(duplicate_path, sizeof(duplicate_path), pattern.c_str(),
+             static_cast<unsigned long>(frame_pair.second));
+    check(stat(original_path, &original) == 0 &&
+              stat(duplicate_path, &duplicate) == 0 &&
+              original.st_ino == duplicate.st_ino,
+          "duplicate frame is a link to the frame it repeats");
+  }
+  removeDirectory(directory);
+}
+
+// Through a stand-in ffmpeg on PATH that copies the pipe into the output
+// file: every frame has to arrive as RGBA or as I420 the way the converter
+// makes it, top-down, and duplicates repeat the frame before them.
+void FrameSinkSelfTest::testVideoPipe(const FFMPEGPipeFormat pipe_format) {
+  static constexpr size_t WIDTH = 34;
+  static constexpr size_t HEIGHT = 18;
+
+  char directory[] = "/tmp/frame_sink_XXXXXX";
+  if (mkdtemp(directory) == NULL) {
+    check(false, "video pipe directory");
+    return;
+  }
+  const std::string script = std::string(directory) + "/ffmpeg";
+  const std::string output = std::string(directory) + "/output.raw";
+  FILE *file = fopen(script.c_str(), "w");
+  if (file == NULL) {
+    check(false, "stand-in ffmpeg");
+    removeDirectory(directory);
+    return;
+  }
+  fputs("#!/bin/sh\nfor last; do :; done\ncat > \"$last\"\n", file);
+  fclose(file);
+  chmod(script.c_str(), 0700);
+
+  std::vector<uint32_t> frames[2];
+  for (auto &frame : frames) {
+    frame.resize(WIDTH * HEIGHT);
+    for (uint32_t &pixel : frame) {
+      pixel = nextRandom();
+    }
+  }
+
+  const char *path = getenv("PATH");
+  const std::string saved_path = path != NULL ? path : "";
+  setenv("PATH", (std::string(directory) + ":" + saved_path).c_str(), 1);
+  YUV420Converter converter(2);
+  FFMPEG *ffmpeg = ffmpeg_start_rendering(output.c_str(), WIDTH, HEIGHT, 30,
+                                          pipe_format, &converter);
+  setenv("PATH", saved_path.c_str(), 1);
+  if (ffmpeg == NULL) {
+    check(false, "stand-in ffmpeg starts");
+    removeDirectory(directory);
+    return;
+  }
+  {
+    FFMPEGFrameSink sink(ffmpeg, WIDTH, HEIGHT);
+    check(sink.sendFrame(0, frames[0].data(), false) &&
+              sink.sendDuplicateFrame(1) &&
+              sink.sendFrame(2, frames[1].data(), true) &&
+              sink.sendDuplicateFrame(3) && sink.finish(false),
+          "frames go through the video pipe");
+  }
+
+  // What the pipe should have carried for frames 0 and 2.
+  const size_t frame_size = pipe_format == FFMPEG_PIPE_YUV420P
+                                ? YUV420Converter::getFrameSize(WIDTH, HEIGHT)
+                                : sizeof(uint32_t) * WIDTH * HEIGHT;
+  std::vector<uint8_t> expected[2];
+  for (size_t i = 0; i < 2; i++) {
+    expected[i].resize(frame_size);
+    const bool flip = i == 1;
+    if (pipe_format == FFMPEG_PIPE_YUV420P) {
+      converter.convert(frames[i].data(), WIDTH, HEIGHT, flip,
+                        expected[i].data());
+      continue;
+    }
+    for (size_t y = 0; y < HEIGHT; y++) {
+      const size_t source_y = flip ? HEIGHT - 1 - y : y;
+      memcpy(expected[i].data() + y * WIDTH * sizeof(uint32_t),
+             frames[i].data() + source_y * WIDTH, WIDTH * sizeof(uint32_t));
+    }
+  }
+
+  std::vector<uint8_t> written(4 * frame_size + 1);
+  file = fopen(output.c_str(), "rb");
+  const size_t size =
+      file != NULL ? fread(written.data(), 1, written.size(), file) : 0;
+  if (file != NULL) {
+    fclose(file);
+  }
+  bool frames_agree = size == 4 * frame_size;
+  for (size_t frame = 0; frames_agree && frame < 4; frame++) {
+    frames_agree = memcmp(written.data() + frame * frame_size,
+                          expected[frame / 2].data(), frame_size) == 0;
+  }
+  check(frames_agree, pipe_format == FFMPEG_PIPE_YUV420P
+                          ? "video pipe carries the converted frames"
+                          : "video pipe carries the RGBA frames");
+  removeDirectory(directory);
+}
+
+bool FrameSinkSelfTest::selfTest(void) {
+  _failure_count = 0;
+  testQOIReference();
+  const size_t sizes[][2] = {{1, 1}, {7, 1}, {1, 63}, {62, 2}, {64, 64},
+                             {200, 3}, {257, 129}};
+  for (const auto &size : sizes) {
+    testQOIRoundTrip(size[0], size[1]);
+  }
+  testImageSequence();
+  testVideoPipe(FFMPEG_PIPE_RGBA);
+  testVideoPipe(FFMPEG_PIPE_YUV420P);
+  return _failure_count == 0;
+}
@@ -0,0 +1,204 @@
+#include "frame_sink/image_sequence_frame_sink.hpp"
+#include "frame_sink/qoi_encoder.hpp"
+
+bool parseImageSequenceFormat(const char *name, ImageSequenceFormat &format) {
+  if (strcmp(name, "qoi") == 0) {
+    format = ImageSequenceQOI;
+    return true;
+  }
+  if (strcmp(name, "png") == 0) {
+    format = ImageSequencePNG;
+    return true;
+  }
+  return false;
+}
+
+ImageSequenceFrameSink::ImageSequenceFrameSink(
+    const char *path_pattern, const ImageSequenceFormat format,
+    const size_t width, const size_t height, const uint32_t thread_count,
+    const uint32_t max_in_flight)
+    : _path_pattern(path_pattern), _format(format), _width(width),
+      _height(height), _exit(false), _cancel(false), _failed(false),
+      _last_frame_index(0), _has_last_frame(false) {
+  assert(max_in_flight > 0);
+  for (uint32_t i = 0; i < max_in_flight; i++) {
+    uint32_t *buffer =
+        static_cast<uint32_t *>(malloc(sizeof(uint32_t) * _width * _height));
+    assert(buffer != NULL && "Buy MORE RAM lol!!");
+    _buffers.push_back(buffer);
+    _free_buffers.push_back(buffer);
+  }
+
+  uint32_t encoder_count = thread_count;
+  if (encoder_count == 0) {
+    encoder_count = std::max(1u, std::thread::hardware_concurrency());
+  }
+  for (uint32_t i = 0; i < encoder_count; i++) {
+    _encoders.push_back(std::thread([this]() { encoderLoop(); }));
+  }
+}
+
+ImageSequenceFrameSink::~ImageSequenceFrameSink(void) {
+  {
+    std::lock_guard<std::mutex> lock(_mutex);
+    _cancel = true;
+    _exit = true;
+  }
+  _job_ready.notify_all();
+  for (auto &encoder : _encoders) {
+    encoder.join();
+  }
+  for (auto buffer : _buffers) {
+    free(buffer);
+  }
+}
+
+std::string
+ImageSequenceFrameSink::getFramePath(const uint64_t frame_index) const {
+  char path[4096];
+  snprintf(path, sizeof(path), _path_pattern.c_str(),
+           static_cast<unsigned long>(frame_index));
+  return std::string(path);
+}
+
+bool ImageSequenceFrameSink::encodeFrame(const EncodeJob &job,
+                                         uint8_t *scratch) const {
+  TraceScope scope(TraceCategoryRender, "encode image");
+  scope.addArg("frame", job.frame_index);
+
+  const std::string path = getFramePath(job.frame_index);
+
+  if (_format == ImageSequencePNG) {
+    const Image image = {.data = job.pixels,
+                         .width = static_cast<int>(_width),
+                         .height = static_cast<int>(_height),
+                         .mipmaps = 1,
+                         .format = PIXELFORMAT_UNCOMPRESSED_R8G8B8A8};
+    if (!ExportImage(image, path.c_str())) {
+      TraceLog(LOG_ERROR, "IMAGE SEQUENCE: could not write %s", path.c_str());
+      return false;
+    }
+    return true;
+  }
+
+  const size_t size = qoi_encode(job.pixels, _width, _height, scratch);
+  FILE *file = fopen(path.c_str(), "wb");
+  if (file == NULL) {
+    TraceLog(LOG_ERROR, "IMAGE SEQUENCE: could not create %s: %s",
+             path.c_str(), strerror(errno));
+    return false;
+  }
+  const bool written = fwrite(scratch, 1, size, file) == size;
+  if (fclose(file) != 0 || !written) {
+    TraceLog(LOG_ERROR, "IMAGE SEQUENCE: could not write %s: %s",
+             path.c_str(), strerror(errno));
+    return false;
+  }
+  return true;
+}
+
+void ImageSequenceFrameSink::encoderLoop(void) {
+  uint8_t *scratch = NULL;
+  if (_format == ImageSequenceQOI) {
+    scratch =
+        static_cast<uint8_t *>(malloc(qoi_max_encoded_size(_width, _height)));
+    assert(scratch != NULL && "Buy MORE RAM lol!!");
+  }
+
+  std::unique_lock<std::mutex> lock(_mutex);
+  for (;;) {
+    _job_ready.wait(lock, [this]() { return _exit || !_jobs.empty(); });
+    if (_jobs.empty()) {
+      break;
+    }
+    const EncodeJob job = _jobs.front();
+    _jobs.pop_front();
+    const bool cancel = _cancel;
+    lock.unlock();
+
+    if (!cancel && !encodeFrame(job, scratch)) {
+      _failed = true;
+    }
+
+    lock.lock();
+    _free_buffers.push_back(job.pixels);
+    _buffer_free.notify_one();
+  }
+
+  free(scratch);
+}
+
+bool ImageSequenceFrameSink::sendFrame(const uint64_t frame_index,
+                                       const void *rgba, const bool flipped) {
+  if (_failed) {
+    return false;
+  }
+
+  uint32_t *buffer = NULL;
+  {
+    std::unique_lock<std::mutex> lock(_mutex);
+    _buffer_free.wait(lock, [this]() { return !_free_buffers.empty(); });
+    buffer = _free_buffers.back();
+    _free_buffers.pop_back();
+  }
+
+  const uint32_t *pixels = static_cast<const uint32_t *>(rgba);
+  if (flipped) {
+    for (size_t y = 0; y < _height; y++) {
+      memcpy(buffer + y * _width, pixels + (_height - 1 - y) * _width,
+             sizeof(uint32_t) * _width);
+    }
+  } else {
+    memcpy(buffer, pixels, sizeof(uint32_t) * _width * _height);
+  }
+
+  {
+    std::lock_guard<std::mutex> lock(_mutex);
+    _jobs.push_back({.frame_index = frame_index, .pixels = buffer});
+  }
+  _job_ready.notify_one();
+
+  _last_frame_index = frame_index;
+  _has_last_frame = true;
+  return true;
+}
+
+bool ImageSequenceFrameSink::sendDuplicateFrame(const uint64_t frame_index) {
+  if (_failed || !_has_last_frame) {
+    return false;
+  }
+  // The file of the repeated frame may still be in an encoder queue, links
+  // are made in finish() once everything is written.
+  _pending_links.push_back({_last_frame_index, frame_index});
+  return true;
+}
+
+bool ImageSequenceFrameSink::finish(const bool cancel) {
+  // Every buffer is back once the queue is empty and the last frame taken
+  // from it is written, or dropped when cancelled.
+  {
+    std::unique_lock<std::mutex> lock(_mutex);
+    _cancel = cancel;
+    _buffer_free.wait(
+        lock, [this]() { return _free_buffers.size() == _buffers.size(); });
+    _cancel = false;
+  }
+
+  if (cancel || _failed) {
+    _pending_links.clear();
+    return false;
+  }
+
+  for (const auto &pending_link : _pending_links) {
+    const std::string source_path = getFramePath(pending_link.first);
+    const std::string target_path = getFramePath(pending_link.second);
+    (void)unlink(target_path.c_str());
+    if (link(source_path.c_str(), target_path.c_str()) < 0) {
+      TraceLog(LOG_ERROR, "IMAGE SEQUENCE: could not link %s to %s: %s",
+               target_path.c_str(), source_path.c_str(), strerror(errno));
+      return false;
+    }
+  }
+  _pending_links.clear();
+  return true;
+}
@@ -0,0 +1,98 @@
+#include "frame_sink/qoi_encoder.hpp"
+
+static constexpr uint8_t QOI_OP_INDEX = 0x00;
+static constexpr uint8_t QOI_OP_DIFF = 0x40;
+static constexpr uint8_t QOI_OP_LUMA = 0x80;
+static constexpr uint8_t QOI_OP_RUN = 0xc0;
+static constexpr uint8_t QOI_OP_RGB = 0xfe;
+static constexpr uint8_t QOI_OP_RGBA = 0xff;
+static constexpr uint32_t QOI_MAX_RUN = 62;
+
+static inline void qoi_write_u32_be(uint8_t *out, const uint32_t value) {
+  out[0] = value >> 24;
+  out[1] = value >> 16;
+  out[2] = value >> 8;
+  out[3] = value;
+}
+
+size_t qoi_encode(const uint32_t *rgba, const size_t width,
+                  const size_t height, uint8_t *out) {
+  uint8_t *p = out;
+  memcpy(p, "qoif", 4);
+  qoi_write_u32_be(p + 4, width);
+  qoi_write_u32_be(p + 8, height);
+  p[12] = 4;
+  p[13] = 0;
+  p += QOI_HEADER_SIZE;
+
+  // Pixels are compared as whole words, channel bytes in memory order r g b a.
+  uint32_t index[64];
+  memset(index, 0, sizeof(index));
+  uint32_t prev = 0xff000000;
+  uint32_t run = 0;
+  const size_t pixel_count = width * height;
+
+  for (size_t i = 0; i < pixel_count; i++) {
+    const uint32_t pixel = rgba[i];
+
+    if (pixel == prev) {
+      run++;
+      if (run == QOI_MAX_RUN || i == pixel_count - 1) {
+        *p++ = QOI_OP_RUN | (run - 1);
+        run = 0;
+      }
+      continue;
+    }
+
+    if (run > 0) {
+      *p++ = QOI_OP_RUN | (run - 1);
+      run = 0;
+    }
+
+    const uint8_t r = pixel;
+    const uint8_t g = pixel >> 8;
+    const uint8_t b = pixel >> 16;
+    const uint8_t a = pixel >> 24;
+    const uint32_t hash = (r * 3 + g * 5 + b * 7 + a * 11) % 64;
+
+    if (index[hash] == pixel) {
+      *p++ = QOI_OP_INDEX | hash;
+    } else {
+      index[hash] = pixel;
+
+      if (a == (prev >> 24)) {
+        const int8_t vr = r - static_cast<uint8_t>(prev);
+        const int8_t vg = g - static_cast<uint8_t>(prev >> 8);
+        const int8_t vb = b - static_cast<uint8_t>(prev >> 16);
+        const int8_t vg_r = vr - vg;
+        const int8_t vg_b = vb - vg;
+
+        if (vr > -3 && vr < 2 && vg > -3 && vg < 2 && vb > -3 && vb < 2) {
+          *p++ = QOI_OP_DIFF | (vr + 2) << 4 | (vg + 2) << 2 | (vb + 2);
+        } else if (vg_r > -9 && vg_r < 8 && vg > -33 && vg < 32 &&
+                   vg_b > -9 && vg_b < 8) {
+          *p++ = QOI_OP_LUMA | (vg + 32);
+          *p++ = (vg_r + 8) << 4 | (vg_b + 8);
+        } else {
+          *p++ = QOI_OP_RGB;
+          *p++ = r;
+          *p++ = g;
+          *p++ = b;
+        }
+      } else {
+        *p++ = QOI_OP_RGBA;
+        *p++ = r;
+        *p++ = g;
+        *p++ = b;
+        *p++ = a;
+      }
+    }
+    prev = pixel;
+  }
+
+  memset(p, 0, QOI_END_MARKER_SIZE);
+  p[QOI_END_MARKER_SIZE - 1] = 1;
+  p += QOI_END_MARKER_SIZE;
+
+  return p - out;
+}
@@ -0,0 +1,197 @@
+#include "lut_eval/lut_bit_sliced_evaluator.hpp"
+#include "cpu_dispatch/cpu_dispatch.hpp"
+#include <immintrin.h>
+
+// Bit i of the pattern number within a word, for the inputs below 6.
+static constexpr uint64_t LOW_PATTERN_BITS[] = {
+    0xaaaaaaaaaaaaaaaaull, 0xccccccccccccccccull, 0xf0f0f0f0f0f0f0f0ull,
+    0xff00ff00ff00ff00ull, 0xffff0000ffff0000ull, 0xffffffff00000000ull};
+
+LutBitSlicedEvaluator::LutBitSlicedEvaluator(const LutNetwork &network,
+                                             const LutSliceWidth width)
+    : _node_count(network.getNodeCount()),
+      _input_count(network.getInputCount()),
+      _output_count(network.getOutputCount()),
+      _word_count(width == LutSlice256 ? 4 : 1), _width(width),
+      _use_avx2(width == LutSlice256 && getCpuLevel() >= CpuLevelAvx2) {
+  assert(width < LastLutSliceWidth);
+  const uint64_t edge_count = network.getEdgeCount();
+  assert(edge_count < UINT32_MAX);
+
+  // One spare record each so empty networks still get valid pointers.
+  _nodes = static_cast<SlicedNode *>(
+      malloc((_node_count + 1) * sizeof(SlicedNode)));
+  _fanins =
+      static_cast<uint32_t *>(malloc((edge_count + 1) * sizeof(uint32_t)));
+  _values = static_cast<uint64_t *>(aligned_malloc(
+      (_node_count + 1) * _word_count * sizeof(uint64_t), 32));
+  _input_nodes =
+      static_cast<uint32_t *>(malloc((_input_count + 1) * sizeof(uint32_t)));
+  _output_nodes =
+      static_cast<uint32_t *>(malloc((_output_count + 1) * sizeof(uint32_t)));
+  assert(_nodes != NULL && _fanins != NULL && _values != NULL &&
+         _input_nodes != NULL && _output_nodes != NULL &&
+         "Buy MORE RAM lol!!");
+
+  uint32_t input_edge_index = 0;
+  for (uint32_t node = 0; node < _node_count; node++) {
+    const uint32_t fanin_count = network.getFaninCount(node);
+    _nodes[node] = {.function = network.getFunction(node),
+                    .input_edge_index = input_edge_index,
+                    .input_count = static_cast<uint8_t>(fanin_count),
+                    .is_input = network.isInput(node)};
+    for (uint32_t position = 0; position < fanin_count; position++) {
+      _fanins[input_edge_index++] = network.getFanin(node, position);
+    }
+  }
+  memset(_values, 0, _node_count * _word_count * sizeof(uint64_t));
+
+  for (uint32_t input = 0; input < _input_count; input++) {
+    _input_nodes[input] = network.getInputNode(input);
+  }
+  for (uint32_t output = 0; output < _output_count; output++) {
+    _output_nodes[output] = network.getOutputNode(output);
+  }
+}
+
+LutBitSlicedEvaluator::~LutBitSlicedEvaluator(void) {
+  free(_nodes);
+  free(_fanins);
+  free(_values);
+  free(_input_nodes);
+  free(_output_nodes);
+}
+
+void LutBitSlicedEvaluator::setInputPatterns(const uint32_t input,
+                                             const uint64_t *words) {
+  assert(input < _input_count);
+  uint64_t *values = _values + static_cast<size_t>(_input_nodes[input]) *
+                                   _word_count;
+  for (uint32_t word = 0; word < _word_count; word++) {
+    values[word] = words[word];
+  }
+}
+
+void LutBitSlicedEvaluator::setExhaustivePatterns(
+    const uint64_t first_pattern) {
+  assert(first_pattern % PATTERNS_PER_WORD == 0);
+  uint64_t words[4];
+  for (uint32_t input = 0; input < _input_count; input++) {
+    for (uint32_t word = 0; word < _word_count; word++) {
+      const uint64_t pattern = first_pattern + word * PATTERNS_PER_WORD;
+      if (input < 6) {
+        words[word] = LOW_PATTERN_BITS[input];
+      } else if (input < 64) {
+        words[word] = ((pattern >> input) & 1) ? UINT64_MAX : 0;
+      } else {
+        words[word] = 0;
+      }
+    }
+    setInputPatterns(input, words);
+  }
+}
+
+void LutBitSlicedEvaluator::getOutputPatterns(const uint32_t output,
+                                              uint64_t *words) const {
+  assert(output < _output_count);
+  const uint64_t *values = getNodePatterns(_output_nodes[output]);
+  for (uint32_t word = 0; word < _word_count; word++) {
+    words[word] = values[word];
+  }
+}
+
+// Shannon expansion of the truth table over the bit-planes of the inputs.
+// The first level picks straight from pairs of table bits, which is one of
+// 0, ~x0, x0 and ~0, every further level muxes pairs of planes with the
+// next input.
+static TRY_INLINE uint64_t applyLut(const uint64_t function,
+                                   const uint32_t input_count,
+                                   const uint64_t *inputs) {
+  if (input_count == 0) {
+    return -(function & 1);
+  }
+  const uint64_t x0 = inputs[0];
+  const uint64_t pair_planes[4] = {0, ~x0, x0, UINT64_MAX};
+  uint64_t planes[1 << (LutNetwork::MAX_LUT_INPUTS - 1)];
+  uint32_t plane_count = 1u << (input_count - 1);
+  for (uint32_t t = 0; t < plane_count; t++) {
+    planes[t] = pair_planes[(function >> (2 * t)) & 3];
+  }
+  for (uint32_t j = 1; j < input_count; j++) {
+    const uint64_t x = inputs[j];
+    plane_count >>= 1;
+    for (uint32_t t = 0; t < plane_count; t++) {
+      const uint64_t low = planes[2 * t];
+      planes[t] = low ^ ((low ^ planes[2 * t + 1]) & x);
+    }
+  }
+  return planes[0];
+}
+
+template <uint32_t WORDS> void LutBitSlicedEvaluator::evaluateScalar(void) {
+  uint64_t inputs[LutNetwork::MAX_LUT_INPUTS];
+  for (uint32_t node = 0; node < _node_count; node++) {
+    const SlicedNode &current = _nodes[node];
+    if (current.is_input) {
+      continue;
+    }
+    const uint32_t *fanins = _fanins + current.input_edge_index;
+    uint64_t *values = _values + static_cast<size_t>(node) * WORDS;
+    for (uint32_t word = 0; word < WORDS; word++) {
+      for (uint32_t j = 0; j < current.input_count; j++) {
+        inputs[j] = _values[static_cast<size_t>(fanins[j]) * WORDS + word];
+      }
+      values[word] = applyLut(current.function, current.input_count, inputs);
+    }
+  }
+}
+
+TRY_TARGET_AVX2 void LutBitSlicedEvaluator::evaluateAvx2(void) {
+  const __m256i *values = reinterpret_cast<const __m256i *>(_values);
+  const __m256i ones = _mm256_set1_epi64x(-1);
+  __m256i planes[1 << (LutNetwork::MAX_LUT_INPUTS - 1)];
+
+  for (uint32_t node = 0; node < _node_count; node++) {
+    const SlicedNode &current = _nodes[node];
+    if (current.is_input) {
+      continue;
+    }
+    const uint64_t function = current.function;
+    const uint32_t input_count = current.input_count;
+    const uint32_t *fanins = _fanins + current.input_edge_index;
+    __m256i *result = reinterpret_cast<__m256i *>(_values) + node;
+
+    if (input_count == 0) {
+      _mm256_store_si256(result, _mm256_set1_epi64x(-(function & 1)));
+      continue;
+    }
+    const __m256i x0 = _mm256_load_si256(values + fanins[0]);
+    const __m256i pair_planes[4] = {_mm256_setzero_si256(),
+                                    _mm256_xor_si256(x0, ones), x0, ones};
+    uint32_t plane_count = 1u << (input_count - 1);
+    for (uint32_t t = 0; t < plane_count; t++) {
+      planes[t] = pair_planes[(function >> (2 * t)) & 3];
+    }
+    for (uint32_t j = 1; j < input_count; j++) {
+      const __m256i x = _mm256_load_si256(values + fanins[j]);
+      plane_count >>= 1;
+      for (uint32_t t = 0; t < plane_count; t++) {
+        const __m256i low = planes[2 * t];
+        planes[t] = _mm256_xor_si256(
+            low,
+            _mm256_and_si256(_mm256_xor_si256(low, planes[2 * t + 1]), x));
+      }
+    }
+    _mm256_store_si256(result, planes[0]);
+  }
+}
+
+void LutBitSlicedEvaluator::evaluate(void) {
+  if (_width == LutSlice64) {
+    evaluateScalar<1>();
+  } else if (_use_avx2) {
+    evaluateAvx2();
+  } else {
+    evaluateScalar<4>();
+  }
+}
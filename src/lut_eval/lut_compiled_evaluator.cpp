@@ -0,0 +1,127 @@
+#include "lut_eval/lut_compiled_evaluator.hpp"
+
+static const char *ALL_ZERO = "0ull";
+static const char *ALL_ONE = "~0ull";
+
+// Shannon expansion on the last of fanin_count fan-ins, whose value picks
+// the upper or the lower half of the table.
+static std::string getLutExpression(const uint64_t function,
+                                    const uint32_t fanin_count,
+                                    const std::string *fanins) {
+  if (fanin_count == 0) {
+    return function & 1 ? ALL_ONE : ALL_ZERO;
+  }
+  const uint32_t half_size = 1u << (fanin_count - 1);
+  const uint64_t half_mask =
+      half_size == 64 ? UINT64_MAX : (1ull << half_size) - 1;
+  const uint64_t low = function & half_mask;
+  const uint64_t high = (function >> half_size) & half_mask;
+  if (low == high) {
+    return getLutExpression(low, fanin_count - 1, fanins);
+  }
+
+  const std::string &x = fanins[fanin_count - 1];
+  const std::string e0 = getLutExpression(low, fanin_count - 1, fanins);
+  const std::string e1 = getLutExpression(high, fanin_count - 1, fanins);
+  if (e0 == ALL_ZERO && e1 == ALL_ONE) {
+    return x;
+  }
+  if (e0 == ALL_ONE && e1 == ALL_ZERO) {
+    return "~" + x;
+  }
+  if (e0 == ALL_ZERO) {
+    return "(" + x + " & " + e1 + ")";
+  }
+  if (e1 == ALL_ZERO) {
+    return "(~" + x + " & " + e0 + ")";
+  }
+  if (e1 == ALL_ONE) {
+    return "(" + x + " | " + e0 + ")";
+  }
+  if (e0 == ALL_ONE) {
+    return "(~" + x + " | " + e1 + ")";
+  }
+  return "((" + x + " & " + e1 + ") | (~" + x + " & " + e0 + "))";
+}
+
+void generateLutKernelSource(const LutNetwork &network, const char *symbol,
+                             std::string &source) {
+  const uint32_t node_count = network.getNodeCount();
+  const uint32_t chunk_count =
+      (node_count + KERNEL_CHUNK_NODES - 1) / KERNEL_CHUNK_NODES;
+  char line[128];
+  source = "// Generated from a LutNetwork, do not edit.\n"
+           "#include <stdint.h>\n";
+
+  // Node order is a topological order, every fan-in is computed in time.
+  std::vector<uint32_t> input_numbers(node_count, 0);
+  for (uint32_t input = 0; input < network.getInputCount(); input++) {
+    input_numbers[network.getInputNode(input)] = input;
+  }
+  std::string fanins[LutNetwork::MAX_LUT_INPUTS];
+  for (uint32_t i = 0; i < LutNetwork::MAX_LUT_INPUTS; i++) {
+    snprintf(line, sizeof(line), "x%u", i);
+    fanins[i] = line;
+  }
+  for (uint32_t chunk = 0; chunk < chunk_count; chunk++) {
+    snprintf(line, sizeof(line),
+             "\n__attribute__((noinline)) static void chunk%u(const uint64_t "
+             "*inputs, uint64_t *v) {\n",
+             chunk);
+    source += line;
+    const uint32_t first = chunk * KERNEL_CHUNK_NODES;
+    const uint32_t end = std::min(node_count, first + KERNEL_CHUNK_NODES);
+    for (uint32_t node = first; node < end; node++) {
+      if (network.isInput(node)) {
+        snprintf(line, sizeof(line), "  v[%u] = inputs[%u];\n", node,
+                 input_numbers[node]);
+        source += line;
+        continue;
+      }
+      // Fan-ins loaded once into locals, the expression reads them often.
+      const uint32_t fanin_count = network.getFaninCount(node);
+      source += "  {";
+      for (uint32_t i = 0; i < fanin_count; i++) {
+        snprintf(line, sizeof(line), " const uint64_t x%u = v[%u];", i,
+                 network.getFanin(node, i));
+        source += line;
+      }
+      snprintf(line, sizeof(line), "\n    v[%u] = ", node);
+      source += line;
+      source +=
+          getLutExpression(network.getFunction(node), fanin_count, fanins);
+      source += "; }\n";
+    }
+    source += "}\n";
+  }
+
+  snprintf(line, sizeof(line),
+           "\nextern \"C\" void %s(const uint64_t *inputs, uint64_t "
+           "*outputs,\n    uint64_t *values) {\n",
+           symbol);
+  source += line;
+  for (uint32_t chunk = 0; chunk < chunk_count; chunk++) {
+    snprintf(line, sizeof(line), "  chunk%u(inputs, values);\n", chunk);
+    source += line;
+  }
+  for (uint32_t output = 0; output < network.getOutputCount(); output++) {
+    snprintf(line, sizeof(line), "  outputs[%u] = values[%u];\n", output,
+             network.getOutputNode(output));
+    source += line;
+  }
+  source += "}\n";
+}
+
+std::string LutCompiledEvaluator::getSource(const LutNetwork &network) {
+  std::string source;
+  generateLutKernelSource(network, SYMBOL, source);
+  return source;
+}
+
+LutCompiledEvaluator::LutCompiledEvaluator(const LutNetwork &network,
+                                           const char *cache_dir)
+    : _kernel(getSource(network), SYMBOL, cache_dir),
+      _function(_kernel.getFunction<LutKernelFunction>()),
+      _inputs(network.getInputCount(), 0),
+      _outputs(network.getOutputCount(), 0),
+      _values(network.getNodeCount(), 0) {}
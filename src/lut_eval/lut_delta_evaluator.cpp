@@ -0,0 +1,199 @@
+#include "lut_eval/lut_delta_evaluator.hpp"
+#include "packed_array/packed_array.hpp"
+#include <array>
+#include <utility>
+
+static_assert(sizeof(LutEdgeBlock) == 64);
+
+static inline uint32_t getBitWidth(const uint32_t value) {
+  return value == 0 ? 0 : 32 - __builtin_clz(value);
+}
+
+static void packBlock(LutEdgeBlock &block, const uint32_t *deltas,
+                      const uint32_t edge_count, const uint32_t bit_width) {
+  // Room for the last 8 byte store past the payload.
+  uint8_t payload[LutEdgeBlock::PAYLOAD_SIZE + sizeof(uint64_t)] = {};
+  for (uint32_t i = 0; i < edge_count; i++) {
+    const uint32_t bit = i * bit_width;
+    uint64_t word;
+    memcpy(&word, payload + bit / 8, sizeof(word));
+    word |= static_cast<uint64_t>(deltas[i]) << (bit % 8);
+    memcpy(payload + bit / 8, &word, sizeof(word));
+  }
+  block.bit_width = bit_width;
+  block.edge_count = edge_count;
+  memcpy(block.payload, payload, LutEdgeBlock::PAYLOAD_SIZE);
+}
+
+// Width as a template parameter makes shifts and offsets constants, so the
+// loop unrolls into plain loads and shifts, or AVX2 shuffles for the narrow
+// widths. The unpacking reads up to PACKED_BITS_PADDING bytes past the
+// payload, into the next block or the spare one.
+template <uint32_t BIT_WIDTH>
+static uint32_t decodeFixedWidth(const LutEdgeBlock &block, uint32_t *deltas) {
+  const uint32_t edge_count = block.edge_count;
+  if constexpr (BIT_WIDTH == 0) {
+    memset(deltas, 0, edge_count * sizeof(uint32_t));
+  } else {
+    PackedBits<BIT_WIDTH>::unpack(block.payload, 0, edge_count, deltas);
+  }
+  return edge_count;
+}
+
+template <uint32_t... BIT_WIDTHS>
+static constexpr auto
+getDecoders(std::integer_sequence<uint32_t, BIT_WIDTHS...>) {
+  using Decoder = uint32_t (*)(const LutEdgeBlock &, uint32_t *);
+  return std::array<Decoder, sizeof...(BIT_WIDTHS)>{
+      decodeFixedWidth<BIT_WIDTHS>...};
+}
+
+static constexpr auto DECODERS =
+    getDecoders(std::make_integer_sequence<uint32_t, 33>());
+
+uint32_t LutDeltaEvaluator::decodeBlock(const LutEdgeBlock &block,
+                                        uint32_t *deltas) {
+  assert(block.bit_width < DECODERS.size());
+  return DECODERS[block.bit_width](block, deltas);
+}
+
+LutDeltaEvaluator::LutDeltaEvaluator(const LutNetwork &network)
+    : _node_count(network.getNodeCount()),
+      _input_count(network.getInputCount()),
+      _output_count(network.getOutputCount()) {
+  _functions = static_cast<uint64_t *>(
+      malloc((_node_count + 1) * sizeof(uint64_t)));
+  _fanin_counts = static_cast<uint8_t *>(malloc(_node_count + 1));
+  _values = static_cast<uint8_t *>(malloc(_node_count + 1));
+  _input_nodes =
+      static_cast<uint32_t *>(malloc((_input_count + 1) * sizeof(uint32_t)));
+  _output_nodes =
+      static_cast<uint32_t *>(malloc((_output_count + 1) * sizeof(uint32_t)));
+  assert(_functions != NULL && _fanin_counts != NULL && _values != NULL &&
+         _input_nodes != NULL && _output_nodes != NULL &&
+         "Buy MORE RAM lol!!");
+
+  for (uint32_t node = 0; node < _node_count; node++) {
+    _functions[node] = network.getFunction(node);
+    _fanin_counts[node] =
+        network.isInput(node) ? INPUT_MARK : network.getFaninCount(node);
+  }
+  memset(_values, 0, _node_count + 1);
+  for (uint32_t input = 0; input < _input_count; input++) {
+    _input_nodes[input] = network.getInputNode(input);
+  }
+  for (uint32_t output = 0; output < _output_count; output++) {
+    _output_nodes[output] = network.getOutputNode(output);
+  }
+
+  encodeEdges(network);
+}
+
+LutDeltaEvaluator::~LutDeltaEvaluator(void) {
+  free(_blocks);
+  free(_functions);
+  free(_fanin_counts);
+  free(_values);
+  free(_input_nodes);
+  free(_output_nodes);
+}
+
+// Greedy: a block takes the fan-ins of one LUT after the other until the next
+// LUT's would overflow the payload at the widest width so far. The fan-ins
+// of a LUT never straddle two blocks.
+void LutDeltaEvaluator::encodeEdges(const LutNetwork &network) {
+  static_assert(LutNetwork::MAX_LUT_INPUTS * 32 <= LutEdgeBlock::PAYLOAD_BITS);
+  std::vector<LutEdgeBlock> blocks;
+  uint32_t deltas[LutEdgeBlock::MAX_EDGES];
+  uint32_t edge_count = 0;
+  uint32_t bit_width = 0;
+
+  for (uint32_t node = 0; node < _node_count; node++) {
+    const uint32_t fanin_count = network.getFaninCount(node);
+    if (fanin_count == 0) {
+      continue;
+    }
+    uint32_t lut_width = 0;
+    for (uint32_t i = 0; i < fanin_count; i++) {
+      const uint32_t delta = node - network.getFanin(node, i) - 1;
+      lut_width = std::max(lut_width, getBitWidth(delta));
+    }
+    const uint32_t width = std::max(bit_width, lut_width);
+    if (edge_count + fanin_count > LutEdgeBlock::MAX_EDGES ||
+        (edge_count + fanin_count) * width > LutEdgeBlock::PAYLOAD_BITS) {
+      blocks.emplace_back();
+      packBlock(blocks.back(), deltas, edge_count, bit_width);
+      edge_count = 0;
+      bit_width = lut_width;
+    } else {
+      bit_width = width;
+    }
+    for (uint32_t i = 0; i < fanin_count; i++) {
+      deltas[edge_count++] = node - network.getFanin(node, i) - 1;
+    }
+  }
+  if (edge_count > 0) {
+    blocks.emplace_back();
+    packBlock(blocks.back(), deltas, edge_count, bit_width);
+  }
+
+  // A zeroed spare block absorbs the decoder's reads past the last one.
+  _block_count = blocks.size();
+  _blocks = static_cast<LutEdgeBlock *>(
+      aligned_malloc((_block_count + 1) * sizeof(LutEdgeBlock), 64));
+  assert(_blocks != NULL && "Buy MORE RAM lol!!");
+  if (_block_count > 0) {
+    memcpy(_blocks, blocks.data(), _block_count * sizeof(LutEdgeBlock));
+  }
+  memset(&_blocks[_block_count], 0, sizeof(LutEdgeBlock));
+}
+
+void LutDeltaEvaluator::setInputs(const uint8_t *values) {
+  for (uint32_t input = 0; input < _input_count; input++) {
+    _values[_input_nodes[input]] = values[input] != 0;
+  }
+}
+
+void LutDeltaEvaluator::getOutputs(uint8_t *values) const {
+  for (uint32_t output = 0; output < _output_count; output++) {
+    values[output] = _values[_output_nodes[output]];
+  }
+}
+
+// Fan-ins of a LUT are in one block, so the table index is assembled without
+// checking for the end of the block per edge.
+//
+// Compared to gather the sweep trades a few cycles per edge for decoding for
+// a fraction of the memory traffic.
+void LutDeltaEvaluator::evaluate(void) {
+  uint32_t deltas[LutEdgeBlock::MAX_EDGES + LutNetwork::MAX_LUT_INPUTS] = {};
+  uint32_t decoded = 0;
+  uint32_t next = 0;
+  const LutEdgeBlock *block = _blocks;
+
+  for (uint32_t node = 0; node < _node_count; node++) {
+    const uint32_t fanin_count = _fanin_counts[node];
+    if (fanin_count == INPUT_MARK) {
+      continue;
+    }
+    if (fanin_count == 0) {
+      _values[node] = _functions[node] & 1;
+      continue;
+    }
+    if (next == decoded) {
+      decoded = decodeBlock(*block++, deltas);
+      next = 0;
+    }
+    // Branch free: all 6 fan-in slots are read, the unused ones masked to
+    // delta 0, which reads the node before this one.
+    const uint8_t *values = _values + node - 1;
+    const uint32_t *fanins = deltas + next;
+    uint32_t word = 0;
+    for (uint32_t i = 0; i < LutNetwork::MAX_LUT_INPUTS; i++) {
+      const uint32_t used = i < fanin_count;
+      word |= (*(values - (fanins[i] & -used)) & used) << i;
+    }
+    next += fanin_count;
+    _values[node] = (_functions[node] >> word) & 1;
+  }
+}
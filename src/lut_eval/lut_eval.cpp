@@ -0,0 +1,216 @@
+#include "lut_eval/lut_eval.hpp"
+#include "cpu_dispatch/cpu_dispatch.hpp"
+#include <immintrin.h>
+
+LutEvaluator::LutEvaluator(const LutNetwork &network, const LutEvalMode mode)
+    : _node_count(network.getNodeCount()),
+      _input_count(network.getInputCount()),
+      _output_count(network.getOutputCount()),
+      _mode(mode == LutEvalAuto ? chooseMode(network) : mode) {
+  assert(_mode < LastLutEvalMode);
+  const uint64_t edge_count = network.getEdgeCount();
+  assert(edge_count < UINT32_MAX);
+  static_assert(LutNetwork::MAX_LUT_INPUTS <= GATHER_EDGE_LANES);
+
+  // The vector gather addresses node values by 32 bit byte offsets.
+  _use_avx2_gather =
+      _mode == LutEvalGather && getCpuLevel() >= CpuLevelAvx2 &&
+      (static_cast<uint64_t>(_node_count) + 1) * sizeof(LutNode) < INT32_MAX;
+
+  // One spare record each so empty networks still get valid pointers.
+  _nodes = static_cast<LutNode *>(
+      aligned_malloc((_node_count + 1) * sizeof(LutNode), 64));
+  _input_edges = static_cast<LutEdge *>(aligned_malloc(
+      (edge_count + GATHER_EDGE_PADDING) * sizeof(LutEdge), 64));
+  _output_edges = static_cast<LutEdge *>(
+      aligned_malloc((edge_count + 1) * sizeof(LutEdge), 64));
+  _input_nodes =
+      static_cast<uint32_t *>(malloc((_input_count + 1) * sizeof(uint32_t)));
+  _output_nodes =
+      static_cast<uint32_t *>(malloc((_output_count + 1) * sizeof(uint32_t)));
+  assert(_nodes != NULL && _input_edges != NULL && _output_edges != NULL &&
+         _input_nodes != NULL && _output_nodes != NULL &&
+         "Buy MORE RAM lol!!");
+
+  std::vector<uint32_t> fanout_counts;
+  network.getFanoutCounts(fanout_counts);
+
+  uint32_t input_edge_index = 0;
+  uint32_t output_edge_index = 0;
+  for (uint32_t node = 0; node < _node_count; node++) {
+    const uint32_t fanin_count = network.getFaninCount(node);
+    _nodes[node] = {.function = network.getFunction(node),
+                    .input_edge_index = input_edge_index,
+                    .output_edge_index = output_edge_index,
+                    .output_count = 0,
+                    .input_count = static_cast<uint8_t>(fanin_count),
+                    .is_input = network.isInput(node),
+                    .input_word = 0,
+                    .value = 0};
+    for (uint32_t position = 0; position < fanin_count; position++) {
+      _input_edges[input_edge_index++] = {
+          .node = network.getFanin(node, position),
+          .position = static_cast<uint8_t>(position)};
+    }
+    output_edge_index += fanout_counts[node];
+  }
+
+  // Fan-out lists come out sorted by sink, as sinks are visited in order.
+  for (uint32_t node = 0; node < _node_count; node++) {
+    const LutNode &sink = _nodes[node];
+    for (uint32_t i = 0; i < sink.input_count; i++) {
+      const LutEdge &edge = _input_edges[sink.input_edge_index + i];
+      LutNode &source = _nodes[edge.node];
+      _output_edges[source.output_edge_index + source.output_count++] = {
+          .node = node, .position = edge.position};
+    }
+  }
+
+  // Padding edges point at node 0, they are masked off but still decoded.
+  memset(_input_edges + edge_count, 0, GATHER_EDGE_PADDING * sizeof(LutEdge));
+  memset(&_nodes[_node_count], 0, sizeof(LutNode));
+
+  for (uint32_t input = 0; input < _input_count; input++) {
+    _input_nodes[input] = network.getInputNode(input);
+  }
+  for (uint32_t output = 0; output < _output_count; output++) {
+    _output_nodes[output] = network.getOutputNode(output);
+  }
+}
+
+LutEvaluator::~LutEvaluator(void) {
+  free(_nodes);
+  free(_input_edges);
+  free(_output_edges);
+  free(_input_nodes);
+  free(_output_nodes);
+}
+
+LutEvalMode LutEvaluator::chooseMode(const LutNetwork &network) {
+  std::vector<uint32_t> fanout_counts;
+  network.getFanoutCounts(fanout_counts);
+
+  uint64_t lut_count = 0;
+  uint64_t driver_count = 0;
+  uint64_t wide_edge_count = 0;
+  for (uint32_t node = 0; node < network.getNodeCount(); node++) {
+    lut_count += !network.isInput(node);
+    driver_count += fanout_counts[node] != 0;
+    if (fanout_counts[node] > WIDE_FANOUT) {
+      wide_edge_count += fanout_counts[node];
+    }
+  }
+
+  const uint64_t edge_count = network.getEdgeCount();
+  const uint64_t gather_cost =
+      edge_count * GATHER_EDGE_COST + lut_count * GATHER_NODE_COST;
+  const uint64_t scatter_cost =
+      (edge_count - wide_edge_count) * SCATTER_EDGE_COST +
+      wide_edge_count * SCATTER_WIDE_EDGE_COST +
+      driver_count * SCATTER_NODE_COST;
+  return scatter_cost < gather_cost ? LutEvalScatter : LutEvalGather;
+}
+
+void LutEvaluator::setInputs(const uint8_t *values) {
+  for (uint32_t input = 0; input < _input_count; input++) {
+    _nodes[_input_nodes[input]].value = values[input] != 0;
+  }
+}
+
+void LutEvaluator::getOutputs(uint8_t *values) const {
+  for (uint32_t output = 0; output < _output_count; output++) {
+    values[output] = _nodes[_output_nodes[output]].value;
+  }
+}
+
+void LutEvaluator::executeGather(void) {
+  for (uint32_t node = 0; node < _node_count; node++) {
+    LutNode &current = _nodes[node];
+    if (current.is_input) {
+      continue;
+    }
+    const LutEdge *edges = _input_edges + current.input_edge_index;
+    uint32_t word = 0;
+    for (uint32_t i = 0; i < current.input_count; i++) {
+      word |= static_cast<uint32_t>(_nodes[edges[i].node].value)
+              << edges[i].position;
+    }
+    current.value = (current.function >> word) & 1;
+  }
+}
+
+// Fan-in edges of a LUT are stored in input order, so edge i drives input i
+// and the table index is one movemask of the gathered values.
+//
+// Edge i of 8 starts at byte 5 i and its node index straddles dwords
+// 5 i / 4 and 5 i / 4 + 1, shifted by 8 (5 i % 4) bits. Both dwords are
+// picked by vpermd, from the first 32 bytes for edges 0 to 3 and from bytes
+// 8 to 39 for edges 4 to 7, and merged with variable shifts.
+TRY_TARGET_AVX2 void LutEvaluator::executeGatherAvx2(void) {
+  const __m256i low_dwords = _mm256_setr_epi32(0, 1, 2, 3, 3, 4, 5, 6);
+  const __m256i high_dwords = _mm256_setr_epi32(1, 2, 3, 4, 4, 5, 6, 7);
+  const __m256i low_shifts = _mm256_setr_epi32(0, 8, 16, 24, 0, 8, 16, 24);
+  const __m256i high_shifts = _mm256_setr_epi32(32, 24, 16, 8, 32, 24, 16, 8);
+  const __m256i lanes = _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7);
+  const __m256i record_size = _mm256_set1_epi32(sizeof(LutNode));
+  const int *values = reinterpret_cast<const int *>(
+      reinterpret_cast<const uint8_t *>(_nodes) + offsetof(LutNode, value));
+
+  for (uint32_t node = 0; node < _node_count; node++) {
+    LutNode &current = _nodes[node];
+    if (current.is_input) {
+      continue;
+    }
+    const uint8_t *edges = reinterpret_cast<const uint8_t *>(
+        _input_edges + current.input_edge_index);
+    const __m256i first =
+        _mm256_loadu_si256(reinterpret_cast<const __m256i *>(edges));
+    const __m256i second =
+        _mm256_loadu_si256(reinterpret_cast<const __m256i *>(edges + 8));
+    const __m256i low = _mm256_blend_epi32(
+        _mm256_permutevar8x32_epi32(first, low_dwords),
+        _mm256_permutevar8x32_epi32(second, low_dwords), 0xf0);
+    const __m256i high = _mm256_blend_epi32(
+        _mm256_permutevar8x32_epi32(first, high_dwords),
+        _mm256_permutevar8x32_epi32(second, high_dwords), 0xf0);
+    const __m256i sources =
+        _mm256_or_si256(_mm256_srlv_epi32(low, low_shifts),
+                        _mm256_sllv_epi32(high, high_shifts));
+
+    const __m256i used =
+        _mm256_cmpgt_epi32(_mm256_set1_epi32(current.input_count), lanes);
+    const __m256i gathered =
+        _mm256_mask_i32gather_epi32(_mm256_setzero_si256(), values,
+                                    _mm256_mullo_epi32(sources, record_size),
+                                    used, 1);
+    const uint32_t word = _mm256_movemask_ps(
+        _mm256_castsi256_ps(_mm256_slli_epi32(gathered, 31)));
+    current.value = (current.function >> word) & 1;
+  }
+}
+
+void LutEvaluator::executeScatter(void) {
+  for (uint32_t node = 0; node < _node_count; node++) {
+    LutNode &current = _nodes[node];
+    if (!current.is_input) {
+      current.value = (current.function >> current.input_word) & 1;
+    }
+    const uint32_t value = current.value;
+    const LutEdge *edges = _output_edges + current.output_edge_index;
+    for (uint32_t i = 0; i < current.output_count; i++) {
+      LutNode &sink = _nodes[edges[i].node];
+      const uint32_t bit = 1u << edges[i].position;
+      sink.input_word = (sink.input_word & ~bit) | (value << edges[i].position);
+    }
+  }
+}
+
+void LutEvaluator::evaluate(void) {
+  if (_use_avx2_gather) {
+    executeGatherAvx2();
+  } else if (_mode == LutEvalGather) {
+    executeGather();
+  } else {
+    executeScatter();
+  }
+}
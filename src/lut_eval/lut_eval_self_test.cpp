@@ -0,0 +1,759 @@
+#include "lut_eval/lut_eval_self_test.hpp"
+#include "lut_eval/lut_eval.hpp"
+#include <dirent.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+uint64_t LutEvalSelfTest::nextRandom(void) {
+  // SplitMix64, identical sequence on every platform.
+  uint64_t z = (_random_state += 0x9e3779b97f4a7c15ull);
+  z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ull;
+  z = (z ^ (z >> 27)) * 0x94d049bb133111ebull;
+  return z ^ (z >> 31);
+}
+
+void LutEvalSelfTest::check(const bool condition, const char *what) {
+  if (!condition) {
+    fprintf(stderr, "LUT_EVAL: self test failed: %s\n", what);
+    _failure_count++;
+  }
+}
+
+RandomLutNetworkParameters
+LutEvalSelfTest::getNetworkParameters(const uint32_t input_count,
+                                      const uint32_t lut_count,
+                                      const uint32_t window) {
+  return {.seed = nextRandom(),
+          .input_count = input_count,
+          .lut_count = lut_count,
+          .min_fanin = 0,
+          .max_fanin = input_count == 0 ? 0 : LutNetwork::MAX_LUT_INPUTS,
+          .window = window,
+          .output_rate = 0.25f};
+}
+
+// Truth tables of a 3 input LUT, index bits are (carry, b, a).
+static constexpr uint64_t SUM_FUNCTION = 0x96;
+static constexpr uint64_t CARRY_FUNCTION = 0xe8;
+
+void LutEvalSelfTest::buildFullAdder(LutNetwork &network) {
+  const uint32_t a = network.addInput();
+  const uint32_t b = network.addInput();
+  const uint32_t carry = network.addInput();
+  network.addOutput(network.addLut(SUM_FUNCTION, {a, b, carry}));
+  network.addOutput(network.addLut(CARRY_FUNCTION, {a, b, carry}));
+}
+
+void LutEvalSelfTest::testFullAdder(void) {
+  LutNetwork network;
+  buildFullAdder(network);
+
+  for (uint8_t mode = LutEvalGather; mode < LastLutEvalMode; mode++) {
+    LutEvaluator evaluator(network, static_cast<LutEvalMode>(mode));
+    for (uint32_t pattern = 0; pattern < 8; pattern++) {
+      const uint32_t bits[3] = {pattern & 1, (pattern >> 1) & 1, pattern >> 2};
+      for (uint32_t input = 0; input < 3; input++) {
+        evaluator.setInput(input, bits[input]);
+      }
+      evaluator.evaluate();
+      const uint32_t total = bits[0] + bits[1] + bits[2];
+      check(evaluator.getOutput(0) == (total & 1), "full adder sum");
+      check(evaluator.getOutput(1) == (total >> 1), "full adder carry");
+    }
+  }
+}
+
+// Levels worked out by hand, with an input and a constant created after a
+// LUT so the level order differs from the node order.
+void LutEvalSelfTest::testLevels(void) {
+  LutNetwork network;
+  const uint32_t a = network.addInput();
+  const uint32_t b = network.addInput();
+  const uint32_t x = network.addLut(SUM_FUNCTION, {a, b, a});
+  const uint32_t c = network.addInput();
+  const uint32_t y = network.addLut(CARRY_FUNCTION, {x, c, b});
+  const uint32_t k = network.addLut(1, {});
+
+  std::vector<uint32_t> levels;
+  check(network.computeLevels(levels) == 3, "level count");
+  check(levels == std::vector<uint32_t>({0, 0, 1, 0, 2, 0}), "node levels");
+
+  std::vector<uint32_t> order;
+  std::vector<uint32_t> level_starts;
+  network.computeLevelOrder(order, level_starts);
+  check(order == std::vector<uint32_t>({a, b, c, k, x, y}),
+        "level order keeps the node order within a level");
+  check(level_starts == std::vector<uint32_t>({0, 4, 5, 6}), "level starts");
+
+  LutNetwork empty;
+  empty.computeLevelOrder(order, level_starts);
+  check(empty.computeLevels(levels) == 0 && order.empty() &&
+            level_starts == std::vector<uint32_t>({0}),
+        "empty network has no levels");
+}
+
+void LutEvalSelfTest::testRandomNetwork(const uint32_t input_count,
+                                        const uint32_t lut_count,
+                                        const uint32_t window) {
+  static constexpr uint32_t PATTERN_COUNT = 64;
+
+  LutNetwork network;
+  buildRandomLutNetwork(getNetworkParameters(input_count, lut_count, window),
+                        network);
+
+  LutEvaluator gather(network, LutEvalGather);
+  LutEvaluator scatter(network, LutEvalScatter);
+  LutEvaluator automatic(network, LutEvalAuto);
+  check(gather.getMode() == LutEvalGather, "gather mode kept");
+  check(scatter.getMode() == LutEvalScatter, "scatter mode kept");
+  check(automatic.getMode() == LutEvaluator::chooseMode(network),
+        "auto mode resolved");
+
+  std::vector<uint8_t> inputs(input_count);
+  std::vector<uint8_t> reference(network.getNodeCount());
+  for (uint32_t pattern = 0; pattern < PATTERN_COUNT; pattern++) {
+    for (uint32_t input = 0; input < input_count; input++) {
+      inputs[input] = nextRandom() & 1;
+      reference[network.getInputNode(input)] = inputs[input];
+    }
+    for (uint32_t node = 0; node < network.getNodeCount(); node++) {
+      if (network.isInput(node)) {
+        continue;
+      }
+      uint32_t word = 0;
+      for (uint32_t i = 0; i < network.getFaninCount(node); i++) {
+        word |= reference[network.getFanin(node, i)] << i;
+      }
+      reference[node] = (network.getFunction(node) >> word) & 1;
+    }
+
+    gather.setInputs(inputs.data());
+    scatter.setInputs(inputs.data());
+    automatic.setInputs(inputs.data());
+    gather.evaluate();
+    scatter.evaluate();
+    automatic.evaluate();
+
+    bool nodes_agree = true;
+    bool matches_reference = true;
+    for (uint32_t node = 0; node < network.getNodeCount(); node++) {
+      nodes_agree &= gather.getNodeValue(node) == scatter.getNodeValue(node);
+      nodes_agree &= gather.getNodeValue(node) == automatic.getNodeValue(node);
+      matches_reference &= gather.getNodeValue(node) == reference[node];
+    }
+    check(nodes_agree, "gather and scatter agree on every node");
+    check(matches_reference, "gather matches the reference");
+
+    std::vector<uint8_t> gather_outputs(network.getOutputCount());
+    std::vector<uint8_t> scatter_outputs(network.getOutputCount());
+    gather.getOutputs(gather_outputs.data());
+    scatter.getOutputs(scatter_outputs.data());
+    check(gather_outputs == scatter_outputs,
+          "gather and scatter agree on outputs");
+  }
+}
+
+void LutEvalSelfTest::testBitSlicedFullAdder(void) {
+  LutNetwork network;
+  buildFullAdder(network);
+
+  for (uint8_t width = FirstLutSliceWidth; width < LastLutSliceWidth;
+       width++) {
+    LutBitSlicedEvaluator evaluator(network, static_cast<LutSliceWidth>(width));
+    evaluator.setExhaustivePatterns(0);
+    evaluator.evaluate();
+    uint64_t sums[4];
+    uint64_t carries[4];
+    evaluator.getOutputPatterns(0, sums);
+    evaluator.getOutputPatterns(1, carries);
+    for (uint32_t pattern = 0; pattern < 8; pattern++) {
+      const uint32_t total =
+          (pattern & 1) + ((pattern >> 1) & 1) + (pattern >> 2);
+      check(((sums[0] >> pattern) & 1) == (total & 1),
+            "bit-sliced full adder sum");
+      check(((carries[0] >> pattern) & 1) == (total >> 1),
+            "bit-sliced full adder carry");
+    }
+  }
+}
+
+// Every pattern of the bit-sliced evaluation has to match one evaluation of
+// the single pattern evaluator.
+void LutEvalSelfTest::testBitSliced(const uint32_t input_count,
+                                    const uint32_t lut_count,
+                                    const uint32_t window,
+                                    const LutSliceWidth width) {
+  LutNetwork network;
+  buildRandomLutNetwork(getNetworkParameters(input_count, lut_count, window),
+                        network);
+
+  LutBitSlicedEvaluator sliced(network, width);
+  LutEvaluator single(network, LutEvalGather);
+  const uint32_t word_count = sliced.getWordCount();
+
+  std::vector<uint64_t> input_words(input_count * word_count);
+  for (uint32_t input = 0; input < input_count; input++) {
+    for (uint32_t word = 0; word < word_count; word++) {
+      input_words[input * word_count + word] = nextRandom();
+    }
+    sliced.setInputPatterns(input, input_words.data() + input * word_count);
+  }
+  sliced.evaluate();
+
+  bool nodes_agree = true;
+  for (uint32_t pattern = 0; pattern < sliced.getPatternCount(); pattern++) {
+    const uint32_t word = pattern / LutBitSlicedEvaluator::PATTERNS_PER_WORD;
+    const uint32_t bit = pattern % LutBitSlicedEvaluator::PATTERNS_PER_WORD;
+    for (uint32_t input = 0; input < input_count; input++) {
+      single.setInput(input,
+                      (input_words[input * word_count + word] >> bit) & 1);
+    }
+    single.evaluate();
+    for (uint32_t node = 0; node < network.getNodeCount(); node++) {
+      nodes_agree &= ((sliced.getNodePatterns(node)[word] >> bit) & 1) ==
+                     single.getNodeValue(node);
+    }
+  }
+  check(nodes_agree, "bit-sliced patterns agree with single evaluation");
+}
+
+// Outputs of every vector of a batch have to match a single evaluation.
+void LutEvalSelfTest::testParallel(const uint32_t input_count,
+                                   const uint32_t lut_count,
+                                   const uint32_t window,
+                                   const uint32_t thread_count,
+                                   const LutParallelMode mode) {
+  static constexpr uint32_t VECTOR_COUNT = 37;
+
+  LutNetwork network;
+  buildRandomLutNetwork(getNetworkParameters(input_count, lut_count, window),
+                        network);
+
+  LutParallelEvaluator parallel(network, thread_count, mode);
+  LutEvaluator single(network, LutEvalGather);
+  check(parallel.getThreadCount() == thread_count, "parallel thread count");
+
+  const uint32_t output_count = network.getOutputCount();
+  std::vector<uint8_t> inputs(VECTOR_COUNT * input_count);
+  std::vector<uint8_t> outputs(VECTOR_COUNT * output_count);
+  std::vector<uint8_t> expected(VECTOR_COUNT * output_count);
+  for (uint32_t vector = 0; vector < VECTOR_COUNT; vector++) {
+    for (uint32_t input = 0; input < input_count; input++) {
+      inputs[vector * input_count + input] = nextRandom() & 1;
+    }
+    single.setInputs(inputs.data() + vector * input_count);
+    single.evaluate();
+    single.getOutputs(expected.data() + vector * output_count);
+  }
+
+  // Twice, the second batch starts from the values the first one left.
+  for (uint32_t batch = 0; batch < 2; batch++) {
+    std::fill(outputs.begin(), outputs.end(), 2);
+    parallel.evaluateBatch(inputs.data(), outputs.data(), VECTOR_COUNT);
+    check(outputs == expected, "parallel batch agrees with single evaluation");
+  }
+}
+
+// Every node has to match gather, and the edges must not take more than
+// max_edge_bytes each.
+void LutEvalSelfTest::testDeltaEdges(const uint32_t input_count,
+                                     const uint32_t lut_count,
+                                     const uint32_t window,
+                                     const double max_edge_bytes) {
+  static constexpr uint32_t PATTERN_COUNT = 16;
+
+  LutNetwork network;
+  buildRandomLutNetwork(getNetworkParameters(input_count, lut_count, window),
+                        network);
+
+  LutDeltaEvaluator delta(network);
+  LutEvaluator single(network, LutEvalGather);
+  check(delta.getEdgeBytes() <=
+            max_edge_bytes * std::max<uint64_t>(1, network.getEdgeCount()),
+        "delta edges compress");
+
+  std::vector<uint8_t> inputs(input_count);
+  bool nodes_agree = true;
+  for (uint32_t pattern = 0; pattern < PATTERN_COUNT; pattern++) {
+    for (uint32_t input = 0; input < input_count; input++) {
+      inputs[input] = nextRandom() & 1;
+    }
+    delta.setInputs(inputs.data());
+    single.setInputs(inputs.data());
+    delta.evaluate();
+    single.evaluate();
+    for (uint32_t node = 0; node < network.getNodeCount(); node++) {
+      nodes_agree &= delta.getNodeValue(node) == single.getNodeValue(node);
+    }
+  }
+  check(nodes_agree, "delta edges agree with gather");
+}
+
+void LutEvalSelfTest::testDeltaBlocks(void) {
+  // Every width from 0 to 32 bits, the widest values of each.
+  uint32_t values[LutEdgeBlock::MAX_EDGES];
+  uint32_t decoded[LutEdgeBlock::MAX_EDGES];
+  for (uint32_t bit_width = 0; bit_width <= 32; bit_width++) {
+    const uint32_t edge_count = std::min<uint32_t>(
+        LutEdgeBlock::MAX_EDGES,
+        bit_width == 0 ? UINT32_MAX : LutEdgeBlock::PAYLOAD_BITS / bit_width);
+    const uint64_t mask = (1ull << bit_width) - 1;
+    LutEdgeBlock blocks[2] = {};
+    blocks[0].bit_width = bit_width;
+    blocks[0].edge_count = edge_count;
+    for (uint32_t i = 0; i < edge_count; i++) {
+      values[i] = (i % 2 == 0 ? mask : nextRandom()) & mask;
+      for (uint32_t bit = 0; bit < bit_width; bit++) {
+        const uint32_t position = i * bit_width + bit;
+        blocks[0].payload[position / 8] |= ((values[i] >> bit) & 1)
+                                           << (position % 8);
+      }
+    }
+    check(LutDeltaEvaluator::decodeBlock(blocks[0], decoded) == edge_count,
+          "delta block edge count");
+    check(memcmp(values, decoded, edge_count * sizeof(uint32_t)) == 0,
+          "delta block decodes");
+  }
+}
+
+// Stimulus toggling up to max_toggles inputs per step, every node has to
+// match a full evaluation after every step.
+void LutEvalSelfTest::testEventDriven(const uint32_t input_count,
+                                      const uint32_t lut_count,
+                                      const uint32_t window,
+                                      const uint32_t max_toggles) {
+  static constexpr uint32_t STEP_COUNT = 200;
+
+  LutNetwork network;
+  buildRandomLutNetwork(getNetworkParameters(input_count, lut_count, window),
+                        network);
+
+  LutEventEvaluator event(network);
+  LutEvaluator single(network, LutEvalGather);
+  std::vector<uint8_t> inputs(input_count, 0);
+  single.setInputs(inputs.data());
+  single.evaluate();
+
+  bool nodes_agree = true;
+  for (uint32_t node = 0; node < network.getNodeCount(); node++) {
+    nodes_agree &= event.getNodeValue(node) == single.getNodeValue(node);
+  }
+  for (uint32_t step = 0; step < STEP_COUNT; step++) {
+    const uint32_t toggles = nextRandom() % (max_toggles + 1);
+    for (uint32_t i = 0; i < toggles; i++) {
+      const uint32_t input = nextRandom() % input_count;
+      inputs[input] ^= 1;
+      event.setInput(input, inputs[input]);
+    }
+    single.setInputs(inputs.data());
+    single.evaluate();
+    event.evaluate();
+    for (uint32_t node = 0; node < network.getNodeCount(); node++) {
+      nodes_agree &= event.getNodeValue(node) == single.getNodeValue(node);
+    }
+  }
+  check(nodes_agree, "event-driven values agree with full evaluation");
+
+  const LutActivity &activity = event.getActivity();
+  check(activity.evaluate_count == STEP_COUNT, "event-driven evaluate count");
+  check(activity.lut_toggles <= activity.lut_evaluations,
+        "event-driven toggles are a subset of evaluations");
+  check(event.getActivityFactor() <= event.getEvaluatedFraction() &&
+            event.getEvaluatedFraction() <= 1.0,
+        "event-driven activity factor in range");
+}
+
+// The renumbered network has to compute the same outputs, and measure the
+// same as the original measured through new_indices.
+void LutEvalSelfTest::testRenumbering(const uint32_t input_count,
+                                      const uint32_t lut_count,
+                                      const uint32_t window,
+                                      const NodeOrderType type) {
+  static constexpr uint32_t PATTERN_COUNT = 16;
+
+  LutNetwork network;
+  buildRandomLutNetwork(getNetworkParameters(input_count, lut_count, window),
+                        network);
+  LutNetwork renumbered;
+  std::vector<uint32_t> new_indices;
+  renumberLutNetwork(network, type, renumbered, new_indices);
+
+  std::vector<uint8_t> seen(network.getNodeCount(), 0);
+  bool permutation = new_indices.size() == network.getNodeCount();
+  for (const uint32_t index : new_indices) {
+    permutation &= index < seen.size() && !seen[index];
+    if (index < seen.size()) {
+      seen[index] = 1;
+    }
+  }
+  check(permutation, "renumbering is a permutation");
+  check(renumbered.getEdgeCount() == network.getEdgeCount() &&
+            renumbered.getInputCount() == network.getInputCount() &&
+            renumbered.getOutputCount() == network.getOutputCount(),
+        "renumbered network counts");
+
+  NodeOrderStats mapped;
+  NodeOrderStats measured;
+  computeLutNodeOrderStats(network, new_indices, mapped);
+  computeLutNodeOrderStats(renumbered, {}, measured);
+  check(mapped.edge_count == measured.edge_count &&
+            mapped.average_edge_span == measured.average_edge_span &&
+            mapped.estimated_misses == measured.estimated_misses,
+        "renumbering stats match the renumbered network");
+
+  LutEvaluator original(network, LutEvalGather);
+  LutEvaluator reordered(renumbered, LutEvalGather);
+  std::vector<uint8_t> inputs(input_count);
+  bool outputs_agree = true;
+  for (uint32_t pattern = 0; pattern < PATTERN_COUNT; pattern++) {
+    for (uint32_t input = 0; input < input_count; input++) {
+      inputs[input] = nextRandom() & 1;
+    }
+    original.setInputs(inputs.data());
+    reordered.setInputs(inputs.data());
+    original.evaluate();
+    reordered.evaluate();
+    for (uint32_t node = 0; node < network.getNodeCount(); node++) {
+      outputs_agree &= original.getNodeValue(node) ==
+                       reordered.getNodeValue(new_indices[node]);
+    }
+  }
+  check(outputs_agree, "renumbered network agrees node by node");
+}
+
+// Random LUTs mixed with constants, buffers, LUTs reading a node twice and
+// LUTs ignoring a fan-in, so every rule of the simplification gets used.
+void LutEvalSelfTest::buildReducibleNetwork(const uint32_t input_count,
+                                            const uint32_t lut_count,
+                                            LutNetwork &network) {
+  for (uint32_t input = 0; input < input_count; input++) {
+    network.addInput();
+  }
+  uint32_t fanins[LutNetwork::MAX_LUT_INPUTS];
+  for (uint32_t i = 0; i < lut_count; i++) {
+    const uint32_t node_count = network.getNodeCount();
+    const uint32_t fanin_count =
+        node_count == 0 ? 0 : nextRandom() % (LutNetwork::MAX_LUT_INPUTS + 1);
+    for (uint32_t j = 0; j < fanin_count; j++) {
+      fanins[j] = node_count - 1 - nextRandom() % std::min(node_count, 16u);
+    }
+    uint64_t function = nextRandom();
+    switch (nextRandom() % 5) {
+    case 0:
+      network.addLut(function, fanins, 0);
+      break;
+    case 1:
+      network.addLut(0x2, fanins, std::min(fanin_count, 1u));
+      break;
+    case 2:
+      // Depends on fan-in 0 only.
+      network.addLut(nextRandom() & 1 ? 0xaaaaaaaaaaaaaaaaull
+                                      : 0x5555555555555555ull,
+                     fanins, fanin_count);
+      break;
+    case 3:
+      fanins[fanin_count / 2] = fanins[0];
+      network.addLut(function, fanins, fanin_count);
+      break;
+    default:
+      network.addLut(function, fanins, fanin_count);
+      break;
+    }
+    if (nextRandom() % 8 == 0) {
+      network.addOutput(network.getNodeCount() - 1);
+    }
+  }
+}
+
+// Every node kept has to keep its value, and the outputs theirs.
+void LutEvalSelfTest::testSimplify(const uint32_t input_count,
+                                   const uint32_t lut_count) {
+  static constexpr uint32_t PATTERN_COUNT = 16;
+
+  LutNetwork network;
+  buildReducibleNetwork(input_count, lut_count, network);
+  LutNetwork simplified;
+  std::vector<uint32_t> new_indices;
+  std::vector<uint32_t> original_indices;
+  simplifyLutNetwork(network, simplified, new_indices, original_indices);
+
+  check(simplified.getInputCount() == network.getInputCount() &&
+            simplified.getOutputCount() == network.getOutputCount() &&
+            simplified.getNodeCount() <= network.getNodeCount() &&
+            original_indices.size() == simplified.getNodeCount(),
+        "simplified network counts");
+  bool mapped_back = true;
+  for (uint32_t node = 0; node < simplified.getNodeCount(); node++) {
+    mapped_back &= new_indices[original_indices[node]] == node;
+  }
+  check(mapped_back, "simplified nodes map back to their originals");
+
+  LutEvaluator original(network, LutEvalGather);
+  LutEvaluator reduced(simplified, LutEvalGather);
+  std::vector<uint8_t> inputs(input_count);
+  std::vector<uint8_t> outputs(network.getOutputCount());
+  std::vector<uint8_t> expected(network.getOutputCount());
+  bool values_agree = true;
+  for (uint32_t pattern = 0; pattern < PATTERN_COUNT; pattern++) {
+    for (uint32_t input = 0; input < input_count; input++) {
+      inputs[input] = nextRandom() & 1;
+    }
+    original.setInputs(inputs.data());
+    reduced.setInputs(inputs.data());
+    original.evaluate();
+    reduced.evaluate();
+    original.getOutputs(expected.data());
+    reduced.getOutputs(outputs.data());
+    values_agree &= outputs == expected;
+    for (uint32_t node = 0; node < network.getNodeCount(); node++) {
+      values_agree &= new_indices[node] == REMOVED_LUT_NODE ||
+                      original.getNodeValue(node) ==
+                          reduced.getNodeValue(new_indices[node]);
+    }
+  }
+  check(values_agree, "simplified network keeps the values");
+
+  // Simplifying twice changes nothing.
+  LutNetwork again;
+  simplifyLutNetwork(simplified, again, new_indices, original_indices);
+  check(again.getNodeCount() == simplified.getNodeCount() &&
+            again.getEdgeCount() == simplified.getEdgeCount(),
+        "simplification is idempotent");
+}
+
+// Compiled into a fresh cache directory, so the first evaluator compiles and
+// the second finds the object. Needs a C++ compiler at run time.
+void LutEvalSelfTest::testCompiled(const uint32_t input_count,
+                                   const uint32_t lut_count,
+                                   const uint32_t window) {
+  static constexpr uint32_t PATTERN_WORDS = 4;
+
+  LutNetwork network;
+  buildRandomLutNetwork(getNetworkParameters(input_count, lut_count, window),
+                        network);
+
+  char cache_dir[] = "/tmp/lut_kernels_XXXXXX";
+  check(mkdtemp(cache_dir) != NULL, "compiled kernel cache directory");
+  {
+    LutCompiledEvaluator compiled(network, cache_dir);
+    check(compiled.isLoaded() && !compiled.wasCached(), "kernel compiles");
+    LutCompiledEvaluator cached(network, cache_dir);
+    check(cached.isLoaded() && cached.wasCached(), "kernel comes cached");
+    // Anyone could have swapped the object in a shared directory.
+    chmod(cache_dir, 0777);
+    LutCompiledEvaluator shared(network, cache_dir);
+    check(!shared.isLoaded(), "a group or other writable cache is refused");
+    chmod(cache_dir, 0700);
+
+    // Another compiler, here the same one behind a script, does not get the
+    // objects of the first.
+    const std::string wrapper = std::string(cache_dir) + "/cxx";
+    FILE *file = fopen(wrapper.c_str(), "w");
+    check(file != NULL, "compiler wrapper");
+    if (file != NULL) {
+      fputs("#!/bin/sh\nexec c++ \"$@\"\n", file);
+      fclose(file);
+      chmod(wrapper.c_str(), 0700);
+      const char *cxx = getenv("CXX");
+      const std::string saved_cxx = cxx != NULL ? cxx : "";
+      setenv("CXX", wrapper.c_str(), 1);
+      LutCompiledEvaluator other(network, cache_dir);
+      check(other.isLoaded() && !other.wasCached(),
+            "another compiler compiles anew");
+      if (cxx != NULL) {
+        setenv("CXX", saved_cxx.c_str(), 1);
+      } else {
+        unsetenv("CXX");
+      }
+    }
+
+    if (compiled.isLoaded()) {
+      LutBitSlicedEvaluator sliced(network, LutSlice64);
+      bool outputs_agree = true;
+      for (uint32_t word = 0; word < PATTERN_WORDS; word++) {
+        for (uint32_t input = 0; input < input_count; input++) {
+          const uint64_t patterns = nextRandom();
+          compiled.setInputPatterns(input, patterns);
+          sliced.setInputPatterns(input, &patterns);
+        }
+        compiled.evaluate();
+        sliced.evaluate();
+        for (uint32_t output = 0; output < network.getOutputCount();
+             output++) {
+          uint64_t expected;
+          sliced.getOutputPatterns(output, &expected);
+          outputs_agree &= compiled.getOutputPatterns(output) == expected;
+        }
+      }
+      check(outputs_agree, "compiled kernel agrees with bit-sliced");
+    }
+  }
+
+  DIR *dir = opendir(cache_dir);
+  if (dir != NULL) {
+    for (struct dirent *entry = readdir(dir); entry != NULL;
+         entry = readdir(dir)) {
+      if (entry->d_name[0] != '.') {
+        unlinkat(dirfd(dir), entry->d_name, 0);
+      }
+    }
+    closedir(dir);
+  }
+  rmdir(cache_dir);
+}
+
+// Written to a temporary file and read back through a window of window_size
+// bytes, small windows make records straddle refills.
+void LutEvalSelfTest::testStream(const uint32_t input_count,
+                                 const uint32_t lut_count,
+                                 const uint32_t window,
+                                 const size_t window_size) {
+  static constexpr uint32_t PATTERN_COUNT = 8;
+
+  LutNetwork network;
+  buildRandomLutNetwork(getNetworkParameters(input_count, lut_count, window),
+                        network);
+
+  char path[] = "/tmp/lut_stream_XXXXXX";
+  const int fd = mkstemp(path);
+  check(fd >= 0, "stream temporary file");
+  if (fd < 0) {
+    return;
+  }
+  close(fd);
+
+  check(writeLutStreamFile(network, path), "stream file written");
+  LutStreamEvaluator stream(window_size);
+  const bool opened = stream.open(path);
+  check(opened, "stream file opens");
+  if (opened) {
+    check(stream.getNodeCount() == network.getNodeCount() &&
+              stream.getInputCount() == network.getInputCount() &&
+              stream.getOutputCount() == network.getOutputCount(),
+          "stream header counts");
+
+    LutEvaluator single(network, LutEvalGather);
+    std::vector<uint8_t> inputs(input_count);
+    std::vector<uint8_t> outputs(network.getOutputCount());
+    std::vector<uint8_t> expected(network.getOutputCount());
+    bool outputs_agree = true;
+    for (uint32_t pattern = 0; pattern < PATTERN_COUNT; pattern++) {
+      for (uint32_t input = 0; input < input_count; input++) {
+        inputs[input] = nextRandom() & 1;
+      }
+      stream.setInputs(inputs.data());
+      single.setInputs(inputs.data());
+      outputs_agree &= stream.evaluate();
+      single.evaluate();
+      stream.getOutputs(outputs.data());
+      single.getOutputs(expected.data());
+      outputs_agree &= outputs == expected;
+    }
+    check(outputs_agree, "streamed outputs agree with gather");
+
+    // A header that does not match the file fails to open instead of
+    // sizing the trailer by a corrupt count.
+    const auto rejects_field = [&](const size_t offset,
+                                   const uint64_t value) {
+      uint64_t original = 0;
+      const int file = open(path, O_RDWR);
+      bool rejected = file >= 0 &&
+                      pread(file, &original, sizeof(original), offset) ==
+                          sizeof(original) &&
+                      pwrite(file, &value, sizeof(value), offset) ==
+                          sizeof(value);
+      rejected = rejected && !stream.open(path);
+      rejected = rejected && pwrite(file, &original, sizeof(original),
+                                    offset) == sizeof(original);
+      if (file >= 0) {
+        close(file);
+      }
+      return rejected;
+    };
+    check(rejects_field(offsetof(LutStreamHeader, output_count),
+                        UINT64_MAX) &&
+              rejects_field(offsetof(LutStreamHeader, output_count),
+                            network.getOutputCount() + 1) &&
+              rejects_field(offsetof(LutStreamHeader, input_count),
+                            network.getInputCount() + 1) &&
+              rejects_field(offsetof(LutStreamHeader, edge_count),
+                            UINT64_MAX / 2 + 1),
+          "stream header with corrupt counts rejected");
+    check(stream.open(path), "restored stream header opens");
+    struct stat file_stat;
+    check(stat(path, &file_stat) == 0 &&
+              truncate(path, file_stat.st_size - 1) == 0 &&
+              !stream.open(path),
+          "truncated stream trailer rejected");
+  }
+  unlink(path);
+
+  LutStreamEvaluator missing(window_size);
+  check(!missing.open("/nonexistent/lut_stream"), "missing stream rejected");
+}
+
+bool LutEvalSelfTest::selfTest(void) {
+  _failure_count = 0;
+  testFullAdder();
+  testLevels();
+  testBitSlicedFullAdder();
+
+  // Empty network and a network of inputs only.
+  testRandomNetwork(0, 0, 0);
+  testRandomNetwork(8, 0, 0);
+  // Deep and narrow, wide and shallow, and few inputs driving everything.
+  testRandomNetwork(4, 2000, 8);
+  testRandomNetwork(64, 2000, 1000);
+  testRandomNetwork(6, 2000, 0);
+
+  for (uint8_t width = FirstLutSliceWidth; width < LastLutSliceWidth;
+       width++) {
+    testBitSliced(0, 10, 0, static_cast<LutSliceWidth>(width));
+    testBitSliced(4, 2000, 8, static_cast<LutSliceWidth>(width));
+    testBitSliced(64, 2000, 1000, static_cast<LutSliceWidth>(width));
+  }
+
+  for (uint8_t mode = FirstLutParallelMode; mode < LastLutParallelMode;
+       mode++) {
+    for (const uint32_t thread_count : {1u, 3u}) {
+      testParallel(4, 2000, 8, thread_count,
+                   static_cast<LutParallelMode>(mode));
+      testParallel(64, 2000, 200, thread_count,
+                   static_cast<LutParallelMode>(mode));
+      // Fewer levels than threads leaves stages without levels.
+      testParallel(8, 2, 0, thread_count, static_cast<LutParallelMode>(mode));
+    }
+  }
+
+  testDeltaBlocks();
+  testDeltaEdges(0, 10, 0, 0.0);
+  testDeltaEdges(4, 2000, 1, 0.5);
+  testDeltaEdges(4, 2000, 8, 1.0);
+  testDeltaEdges(64, 2000, 1000, 2.0);
+  testDeltaEdges(6, 2000, 0, 2.0);
+
+  testEventDriven(4, 2000, 8, 1);
+  testEventDriven(64, 2000, 1000, 3);
+  testEventDriven(6, 2000, 0, 6);
+
+  for (uint8_t type = FirstNodeOrderType; type < LastNodeOrderType; type++) {
+    testRenumbering(0, 10, 0, static_cast<NodeOrderType>(type));
+    testRenumbering(4, 2000, 8, static_cast<NodeOrderType>(type));
+    testRenumbering(64, 2000, 1000, static_cast<NodeOrderType>(type));
+  }
+
+  testSimplify(0, 50);
+  testSimplify(4, 2000);
+  testSimplify(32, 2000);
+
+  testCompiled(0, 10, 0);
+  testCompiled(8, 500, 8);
+  testCompiled(64, 500, 200);
+
+  testStream(0, 10, 0, 0);
+  testStream(4, 2000, 8, 0);
+  testStream(64, 2000, 1000, 1000);
+  testStream(6, 2000, 0, 1 << 20);
+  return _failure_count == 0;
+}
@@ -0,0 +1,126 @@
+#include "lut_eval/lut_event_evaluator.hpp"
+
+LutEventEvaluator::LutEventEvaluator(const LutNetwork &network)
+    : _lut_count(0), _activity({}) {
+  const uint32_t node_count = network.getNodeCount();
+  _functions.resize(node_count);
+  _first_fanins.resize(node_count + 1);
+  _fanins.reserve(network.getEdgeCount());
+
+  const uint32_t level_count = network.computeLevels(_levels);
+  for (uint32_t node = 0; node < node_count; node++) {
+    _functions[node] = network.getFunction(node);
+    _first_fanins[node] = _fanins.size();
+    for (uint32_t i = 0; i < network.getFaninCount(node); i++) {
+      _fanins.push_back(network.getFanin(node, i));
+    }
+    _lut_count += !network.isInput(node);
+  }
+  _first_fanins[node_count] = _fanins.size();
+
+  // Fan-out lists in CSR form, sinks in node order.
+  std::vector<uint32_t> fanout_counts;
+  network.getFanoutCounts(fanout_counts);
+  _first_fanouts.assign(node_count + 1, 0);
+  for (uint32_t node = 0; node < node_count; node++) {
+    _first_fanouts[node + 1] = _first_fanouts[node] + fanout_counts[node];
+  }
+  _fanouts.resize(_fanins.size());
+  std::vector<uint32_t> fanout_fill(_first_fanouts.begin(),
+                                    _first_fanouts.end() - 1);
+  for (uint32_t node = 0; node < node_count; node++) {
+    for (uint32_t i = _first_fanins[node]; i < _first_fanins[node + 1]; i++) {
+      _fanouts[fanout_fill[_fanins[i]]++] = node;
+    }
+  }
+
+  _input_nodes.resize(network.getInputCount());
+  for (uint32_t input = 0; input < network.getInputCount(); input++) {
+    _input_nodes[input] = network.getInputNode(input);
+  }
+  _output_nodes.resize(network.getOutputCount());
+  for (uint32_t output = 0; output < network.getOutputCount(); output++) {
+    _output_nodes[output] = network.getOutputNode(output);
+  }
+
+  _values.assign(node_count, 0);
+  _queued.assign(node_count, 0);
+  _level_queues.resize(level_count);
+  _first_dirty_level = level_count;
+  for (uint32_t node = 0; node < node_count; node++) {
+    if (!network.isInput(node)) {
+      _values[node] = computeValue(node);
+    }
+  }
+}
+
+void LutEventEvaluator::queueFanouts(const uint32_t node) {
+  for (uint32_t i = _first_fanouts[node]; i < _first_fanouts[node + 1]; i++) {
+    const uint32_t sink = _fanouts[i];
+    if (!_queued[sink]) {
+      _queued[sink] = 1;
+      _level_queues[_levels[sink]].push_back(sink);
+      _first_dirty_level = std::min(_first_dirty_level, _levels[sink]);
+    }
+  }
+}
+
+void LutEventEvaluator::setInput(const uint32_t input, const bool value) {
+  assert(input < getInputCount());
+  const uint32_t node = _input_nodes[input];
+  if (_values[node] != value) {
+    _values[node] = value;
+    _activity.input_toggles++;
+    queueFanouts(node);
+  }
+}
+
+void LutEventEvaluator::setInputs(const uint8_t *values) {
+  for (uint32_t input = 0; input < getInputCount(); input++) {
+    setInput(input, values[input] != 0);
+  }
+}
+
+// Queues of a level only get LUTs of higher levels added while it is being
+// worked through, so a level is done in one pass.
+void LutEventEvaluator::evaluate(void) {
+  _activity.evaluate_count++;
+  for (uint32_t level = _first_dirty_level; level < getLevelCount();
+       level++) {
+    std::vector<uint32_t> &queue = _level_queues[level];
+    for (const uint32_t node : queue) {
+      _queued[node] = 0;
+      _activity.lut_evaluations++;
+      const uint8_t value = computeValue(node);
+      if (value != _values[node]) {
+        _values[node] = value;
+        _activity.lut_toggles++;
+        queueFanouts(node);
+      }
+    }
+    queue.clear();
+  }
+  _first_dirty_level = getLevelCount();
+}
+
+void LutEventEvaluator::getOutputs(uint8_t *values) const {
+  for (uint32_t output = 0; output < getOutputCount(); output++) {
+    values[output] = _values[_output_nodes[output]];
+  }
+}
+
+double LutEventEvaluator::getActivityFactor(void) const {
+  if (_activity.evaluate_count == 0 || _lut_count == 0) {
+    return 0.0;
+  }
+  return static_cast<double>(_activity.lut_toggles) /
+         (static_cast<double>(_activity.evaluate_count) * _lut_count);
+}
+
+double LutEventEvaluator::getEvaluatedFraction(void) const {
+  if (_activity.evaluate_count == 0 || _lut_count == 0) {
+    return 0.0;
+  }
+  return static_cast<double>(_activity.lut_evaluations) /
+         (static_cast<double>(_activity.evaluate_count) * _lut_count);
+}
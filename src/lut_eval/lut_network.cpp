@@ -0,0 +1,80 @@
+#include "lut_eval/lut_network.hpp"
+
+uint32_t LutNetwork::addInput(void) {
+  const uint32_t node = _functions.size();
+  _functions.push_back(0);
+  _first_fanins.push_back(_fanins.size());
+  _fanin_counts.push_back(0);
+  _is_input.push_back(1);
+  _input_nodes.push_back(node);
+  return node;
+}
+
+uint32_t LutNetwork::addLut(const uint64_t function, const uint32_t *fanins,
+                            const uint32_t fanin_count) {
+  assert(fanin_count <= MAX_LUT_INPUTS);
+  const uint32_t node = _functions.size();
+  assert(node < UINT32_MAX);
+
+  // Only the first 2^fanin_count bits of the table are reachable.
+  const uint32_t table_size = 1u << fanin_count;
+  const uint64_t table_mask =
+      table_size == 64 ? UINT64_MAX : (1ull << table_size) - 1;
+
+  _functions.push_back(function & table_mask);
+  _first_fanins.push_back(_fanins.size());
+  _fanin_counts.push_back(fanin_count);
+  _is_input.push_back(0);
+  for (uint32_t i = 0; i < fanin_count; i++) {
+    assert(fanins[i] < node && "LUTs can only read earlier nodes");
+    _fanins.push_back(fanins[i]);
+  }
+  return node;
+}
+
+uint32_t LutNetwork::addOutput(const uint32_t node) {
+  assert(node < getNodeCount());
+  _output_nodes.push_back(node);
+  return _output_nodes.size() - 1;
+}
+
+void LutNetwork::getFanoutCounts(std::vector<uint32_t> &fanout_counts) const {
+  fanout_counts.assign(getNodeCount(), 0);
+  for (const uint32_t fanin : _fanins) {
+    fanout_counts[fanin]++;
+  }
+}
+
+uint32_t LutNetwork::computeLevels(std::vector<uint32_t> &levels) const {
+  const uint32_t node_count = getNodeCount();
+  levels.assign(node_count, 0);
+  uint32_t level_count = node_count == 0 ? 0 : 1;
+  for (uint32_t node = 0; node < node_count; node++) {
+    for (uint32_t i = 0; i < getFaninCount(node); i++) {
+      levels[node] = std::max(levels[node], levels[getFanin(node, i)] + 1);
+    }
+    level_count = std::max(level_count, levels[node] + 1);
+  }
+  return level_count;
+}
+
+// Counting sort by level, stable so a level keeps the node order.
+void LutNetwork::computeLevelOrder(std::vector<uint32_t> &order,
+                                   std::vector<uint32_t> &level_starts) const {
+  std::vector<uint32_t> levels;
+  const uint32_t level_count = computeLevels(levels);
+
+  level_starts.assign(level_count + 1, 0);
+  for (const uint32_t level : levels) {
+    level_starts[level + 1]++;
+  }
+  for (uint32_t level = 0; level < level_count; level++) {
+    level_starts[level + 1] += level_starts[level];
+  }
+  std::vector<uint32_t> level_fill(level_starts.begin(),
+                                   level_starts.end() - 1);
+  order.resize(getNodeCount());
+  for (uint32_t node = 0; node < getNodeCount(); node++) {
+    order[level_fill[levels[node]]++] = node;
+  }
+}
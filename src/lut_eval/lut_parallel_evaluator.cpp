@@ -0,0 +1,178 @@
+#include "lut_eval/lut_parallel_evaluator.hpp"
+
+LutParallelEvaluator::LutParallelEvaluator(const LutNetwork &network,
+                                           const uint32_t thread_count,
+                                           const LutParallelMode mode)
+    : _pool(thread_count, true), _barrier(_pool.getThreadCount()),
+      _mode(mode) {
+  assert(mode < LastLutParallelMode);
+  levelize(network);
+  partitionStages();
+
+  const uint32_t slot_count =
+      _mode == LutParallelPipelined ? getThreadCount() : 1;
+  _values.assign(static_cast<size_t>(slot_count) * _nodes.size(), 0);
+}
+
+// Nodes are placed level by level, in network order within a level.
+void LutParallelEvaluator::levelize(const LutNetwork &network) {
+  const uint32_t node_count = network.getNodeCount();
+  std::vector<uint32_t> old_nodes;
+  network.computeLevelOrder(old_nodes, _level_starts);
+  std::vector<uint32_t> new_nodes(node_count);
+  for (uint32_t new_node = 0; new_node < node_count; new_node++) {
+    new_nodes[old_nodes[new_node]] = new_node;
+  }
+  _nodes.resize(node_count);
+  _fanins.clear();
+  _fanins.reserve(network.getEdgeCount());
+  for (uint32_t new_node = 0; new_node < node_count; new_node++) {
+    const uint32_t node = old_nodes[new_node];
+    const uint32_t fanin_count = network.getFaninCount(node);
+    _nodes[new_node] = {.function = network.getFunction(node),
+                        .input_edge_index =
+                            static_cast<uint32_t>(_fanins.size()),
+                        .input_count = static_cast<uint8_t>(fanin_count),
+                        .is_input = network.isInput(node)};
+    for (uint32_t i = 0; i < fanin_count; i++) {
+      _fanins.push_back(new_nodes[network.getFanin(node, i)]);
+    }
+  }
+
+  _input_nodes.resize(network.getInputCount());
+  for (uint32_t input = 0; input < network.getInputCount(); input++) {
+    _input_nodes[input] = new_nodes[network.getInputNode(input)];
+  }
+  _output_nodes.resize(network.getOutputCount());
+  for (uint32_t output = 0; output < network.getOutputCount(); output++) {
+    _output_nodes[output] = new_nodes[network.getOutputNode(output)];
+  }
+}
+
+// Cuts the levels into one run per thread with about the same node count.
+void LutParallelEvaluator::partitionStages(void) {
+  const uint32_t thread_count = getThreadCount();
+  const uint32_t level_count = getLevelCount();
+  const uint64_t node_count = _nodes.size();
+  _stage_starts.assign(thread_count + 1, level_count);
+  _stage_starts[0] = 0;
+
+  uint32_t level = 0;
+  for (uint32_t stage = 1; stage < thread_count; stage++) {
+    const uint64_t stage_end = node_count * stage / thread_count;
+    while (level < level_count && _level_starts[level + 1] <= stage_end) {
+      level++;
+    }
+    _stage_starts[stage] = level;
+  }
+}
+
+void LutParallelEvaluator::evaluateNodes(uint8_t *values, const uint32_t begin,
+                                         const uint32_t end) const {
+  for (uint32_t node = begin; node < end; node++) {
+    const ParallelNode &current = _nodes[node];
+    if (current.is_input) {
+      continue;
+    }
+    const uint32_t *fanins = _fanins.data() + current.input_edge_index;
+    uint32_t word = 0;
+    for (uint32_t i = 0; i < current.input_count; i++) {
+      word |= static_cast<uint32_t>(values[fanins[i]]) << i;
+    }
+    values[node] = (current.function >> word) & 1;
+  }
+}
+
+void LutParallelEvaluator::evaluateLevelShare(uint8_t *values,
+                                              const uint32_t level,
+                                              const uint32_t thread) const {
+  const uint64_t begin = _level_starts[level];
+  const uint64_t size = _level_starts[level + 1] - begin;
+  const uint32_t thread_count = getThreadCount();
+  evaluateNodes(values, begin + size * thread / thread_count,
+                begin + size * (thread + 1) / thread_count);
+}
+
+static inline void copyInputs(uint8_t *values, const uint8_t *row,
+                              const std::vector<uint32_t> &input_nodes) {
+  for (uint32_t input = 0; input < input_nodes.size(); input++) {
+    values[input_nodes[input]] = row[input] != 0;
+  }
+}
+
+static inline void copyOutputs(const uint8_t *values, uint8_t *row,
+                               const std::vector<uint32_t> &output_nodes) {
+  for (uint32_t output = 0; output < output_nodes.size(); output++) {
+    row[output] = values[output_nodes[output]];
+  }
+}
+
+void LutParallelEvaluator::runLayered(const uint32_t thread,
+                                      const uint8_t *inputs, uint8_t *outputs,
+                                      const uint32_t vector_count) {
+  uint8_t *values = _values.data();
+  const uint32_t level_count = getLevelCount();
+  for (uint32_t vector = 0; vector < vector_count; vector++) {
+    if (thread == 0) {
+      copyInputs(values, inputs + static_cast<size_t>(vector) * getInputCount(),
+                 _input_nodes);
+    }
+    _barrier.wait();
+    for (uint32_t level = 0; level < level_count; level++) {
+      evaluateLevelShare(values, level, thread);
+      _barrier.wait();
+    }
+    if (thread == 0) {
+      copyOutputs(values,
+                  outputs + static_cast<size_t>(vector) * getOutputCount(),
+                  _output_nodes);
+    }
+  }
+}
+
+// Step s has thread t run its levels for vector s - t in value slot
+// (s - t) % thread_count. The slot of a vector is free again once the last
+// stage is done with it, one step before thread 0 takes it for a new one.
+void LutParallelEvaluator::runPipelined(const uint32_t thread,
+                                        const uint8_t *inputs,
+                                        uint8_t *outputs,
+                                        const uint32_t vector_count) {
+  const uint32_t thread_count = getThreadCount();
+  const uint32_t node_count = _nodes.size();
+  const uint32_t begin = _level_starts[_stage_starts[thread]];
+  const uint32_t end = _level_starts[_stage_starts[thread + 1]];
+  const uint64_t step_count = static_cast<uint64_t>(vector_count) +
+                              thread_count - 1;
+
+  for (uint64_t step = 0; step < step_count; step++) {
+    if (step >= thread && step - thread < vector_count) {
+      const uint64_t vector = step - thread;
+      uint8_t *values =
+          _values.data() +
+          static_cast<size_t>(vector % thread_count) * node_count;
+      if (thread == 0) {
+        copyInputs(values, inputs + vector * getInputCount(), _input_nodes);
+      }
+      evaluateNodes(values, begin, end);
+      if (thread == thread_count - 1) {
+        copyOutputs(values, outputs + vector * getOutputCount(),
+                    _output_nodes);
+      }
+    }
+    _barrier.wait();
+  }
+}
+
+// Every thread takes exactly one task: no task can finish before all of them
+// passed the first barrier, so no thread can pick up a second one.
+void LutParallelEvaluator::evaluateBatch(const uint8_t *inputs,
+                                         uint8_t *outputs,
+                                         const uint32_t vector_count) {
+  _pool.parallelFor(getThreadCount(), [&](const uint32_t thread) {
+    if (_mode == LutParallelLayered) {
+      runLayered(thread, inputs, outputs, vector_count);
+    } else {
+      runPipelined(thread, inputs, outputs, vector_count);
+    }
+  });
+}
@@ -0,0 +1,64 @@
+#include "lut_eval/lut_renumbering.hpp"
+#include "lut_eval/lut_eval.hpp"
+
+static_assert(LUT_ORDER_RECORD_SIZE == sizeof(LutNode));
+
+static void getGraph(const LutNetwork &network,
+                     std::vector<uint32_t> &first_fanins,
+                     std::vector<uint32_t> &fanins) {
+  const uint32_t node_count = network.getNodeCount();
+  first_fanins.resize(node_count + 1);
+  fanins.clear();
+  fanins.reserve(network.getEdgeCount());
+  for (uint32_t node = 0; node < node_count; node++) {
+    first_fanins[node] = fanins.size();
+    for (uint32_t i = 0; i < network.getFaninCount(node); i++) {
+      fanins.push_back(network.getFanin(node, i));
+    }
+  }
+  first_fanins[node_count] = fanins.size();
+}
+
+void renumberLutNetwork(const LutNetwork &network, const NodeOrderType type,
+                        LutNetwork &renumbered,
+                        std::vector<uint32_t> &new_indices) {
+  assert(renumbered.getNodeCount() == 0);
+  const uint32_t node_count = network.getNodeCount();
+  std::vector<uint32_t> first_fanins;
+  std::vector<uint32_t> fanins;
+  getGraph(network, first_fanins, fanins);
+  computeNodeOrder({first_fanins.data(), fanins.data(), node_count}, type,
+                   new_indices);
+
+  std::vector<uint32_t> order(node_count);
+  for (uint32_t node = 0; node < node_count; node++) {
+    order[new_indices[node]] = node;
+  }
+  // Nodes without fan-ins keep their order, the inputs among them too.
+  uint32_t new_fanins[LutNetwork::MAX_LUT_INPUTS];
+  for (const uint32_t node : order) {
+    if (network.isInput(node)) {
+      renumbered.addInput();
+      continue;
+    }
+    const uint32_t fanin_count = network.getFaninCount(node);
+    for (uint32_t i = 0; i < fanin_count; i++) {
+      new_fanins[i] = new_indices[network.getFanin(node, i)];
+    }
+    renumbered.addLut(network.getFunction(node), new_fanins, fanin_count);
+  }
+  for (uint32_t output = 0; output < network.getOutputCount(); output++) {
+    renumbered.addOutput(new_indices[network.getOutputNode(output)]);
+  }
+}
+
+void computeLutNodeOrderStats(const LutNetwork &network,
+                              const std::vector<uint32_t> &new_indices,
+                              NodeOrderStats &stats) {
+  std::vector<uint32_t> first_fanins;
+  std::vector<uint32_t> fanins;
+  getGraph(network, first_fanins, fanins);
+  computeNodeOrderStats(
+      {first_fanins.data(), fanins.data(), network.getNodeCount()},
+      new_indices, LUT_ORDER_RECORD_SIZE, LUT_ORDER_CACHE_SIZE, stats);
+}
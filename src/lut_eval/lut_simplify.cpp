@@ -0,0 +1,146 @@
+#include "lut_eval/lut_simplify.hpp"
+
+// Where old fan-in i takes its value from: a new fan-in or a constant.
+static constexpr int8_t SOURCE_ZERO = -1;
+static constexpr int8_t SOURCE_ONE = -2;
+
+// Truth table over new_count fan-ins of function over fanin_count old ones.
+static uint64_t remapFunction(const uint64_t function,
+                              const uint32_t fanin_count,
+                              const int8_t *sources,
+                              const uint32_t new_count) {
+  uint64_t result = 0;
+  for (uint32_t word = 0; word < (1u << new_count); word++) {
+    uint32_t old_word = 0;
+    for (uint32_t i = 0; i < fanin_count; i++) {
+      const uint32_t bit =
+          sources[i] < 0 ? sources[i] == SOURCE_ONE : (word >> sources[i]) & 1;
+      old_word |= bit << i;
+    }
+    result |= ((function >> old_word) & 1) << word;
+  }
+  return result;
+}
+
+static bool dependsOn(const uint64_t function, const uint32_t fanin_count,
+                      const uint32_t fanin) {
+  // Table bits whose index has bit fanin clear.
+  static constexpr uint64_t LOW_HALVES[LutNetwork::MAX_LUT_INPUTS] = {
+      0x5555555555555555ull, 0x3333333333333333ull, 0x0f0f0f0f0f0f0f0full,
+      0x00ff00ff00ff00ffull, 0x0000ffff0000ffffull, 0x00000000ffffffffull};
+  const uint32_t table_size = 1u << fanin_count;
+  const uint64_t table_mask =
+      table_size == 64 ? UINT64_MAX : (1ull << table_size) - 1;
+  const uint64_t low = function & LOW_HALVES[fanin] & table_mask;
+  const uint64_t high =
+      (function >> (1u << fanin)) & LOW_HALVES[fanin] & table_mask;
+  return low != high;
+}
+
+void simplifyLutNetwork(const LutNetwork &network, LutNetwork &simplified,
+                        std::vector<uint32_t> &new_indices,
+                        std::vector<uint32_t> &original_indices) {
+  static constexpr uint32_t MAX_INPUTS = LutNetwork::MAX_LUT_INPUTS;
+  assert(simplified.getNodeCount() == 0);
+  const uint32_t node_count = network.getNodeCount();
+
+  // Reduced LUT of every node, forwards[node] is the node with its value:
+  // itself unless it passes a fan-in through.
+  std::vector<uint64_t> functions(node_count, 0);
+  std::vector<uint8_t> fanin_counts(node_count, 0);
+  std::vector<uint32_t> fanins(static_cast<size_t>(node_count) * MAX_INPUTS);
+  std::vector<uint32_t> forwards(node_count);
+  const auto isConstant = [&](const uint32_t node) {
+    return !network.isInput(node) && fanin_counts[node] == 0;
+  };
+
+  for (uint32_t node = 0; node < node_count; node++) {
+    forwards[node] = node;
+    if (network.isInput(node)) {
+      continue;
+    }
+    const uint32_t fanin_count = network.getFaninCount(node);
+    uint64_t function = network.getFunction(node);
+    uint32_t *new_fanins = &fanins[static_cast<size_t>(node) * MAX_INPUTS];
+    int8_t sources[MAX_INPUTS];
+    uint32_t new_count = 0;
+    for (uint32_t i = 0; i < fanin_count; i++) {
+      const uint32_t fanin = forwards[network.getFanin(node, i)];
+      if (isConstant(fanin)) {
+        sources[i] = functions[fanin] & 1 ? SOURCE_ONE : SOURCE_ZERO;
+        continue;
+      }
+      sources[i] = std::find(new_fanins, new_fanins + new_count, fanin) -
+                   new_fanins;
+      if (sources[i] == static_cast<int8_t>(new_count)) {
+        new_fanins[new_count++] = fanin;
+      }
+    }
+    function = remapFunction(function, fanin_count, sources, new_count);
+
+    // Dropping a fan-in the table ignores keeps the others' dependence.
+    for (uint32_t i = new_count; i-- > 0;) {
+      if (dependsOn(function, new_count, i)) {
+        continue;
+      }
+      for (uint32_t j = 0; j < new_count; j++) {
+        sources[j] = j < i ? j : j - 1;
+      }
+      sources[i] = SOURCE_ZERO;
+      function = remapFunction(function, new_count, sources, new_count - 1);
+      std::copy(new_fanins + i + 1, new_fanins + new_count, new_fanins + i);
+      new_count--;
+    }
+
+    if (new_count == 1 && function == 0x2) {
+      forwards[node] = new_fanins[0];
+    }
+    functions[node] = function;
+    fanin_counts[node] = new_count;
+  }
+
+  // Live is what an output reads through the reduced LUTs.
+  std::vector<uint8_t> live(node_count, 0);
+  std::vector<uint32_t> stack;
+  for (uint32_t output = 0; output < network.getOutputCount(); output++) {
+    stack.push_back(forwards[network.getOutputNode(output)]);
+  }
+  while (!stack.empty()) {
+    const uint32_t node = stack.back();
+    stack.pop_back();
+    if (live[node]) {
+      continue;
+    }
+    live[node] = 1;
+    for (uint32_t i = 0; i < fanin_counts[node]; i++) {
+      stack.push_back(fanins[static_cast<size_t>(node) * MAX_INPUTS + i]);
+    }
+  }
+
+  new_indices.assign(node_count, REMOVED_LUT_NODE);
+  original_indices.clear();
+  for (uint32_t node = 0; node < node_count; node++) {
+    if (network.isInput(node)) {
+      new_indices[node] = simplified.addInput();
+    } else if (live[node]) {
+      uint32_t *node_fanins = &fanins[static_cast<size_t>(node) * MAX_INPUTS];
+      for (uint32_t i = 0; i < fanin_counts[node]; i++) {
+        node_fanins[i] = new_indices[node_fanins[i]];
+      }
+      new_indices[node] =
+          simplified.addLut(functions[node], node_fanins, fanin_counts[node]);
+    } else {
+      continue;
+    }
+    original_indices.push_back(node);
+  }
+  // A forward points at a node that is not forwarded itself.
+  for (uint32_t node = 0; node < node_count; node++) {
+    if (forwards[node] != node) {
+      new_indices[node] = new_indices[forwards[node]];
+    }
+  }
+  for (uint32_t output = 0; output < network.getOutputCount(); output++) {
+    simplified.addOutput(new_indices[network.getOutputNode(output)]);
+  }
+}
@@ -0,0 +1,300 @@
+#include "lut_eval/lut_stream.hpp"
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+LutStreamWriter::LutStreamWriter(const char *path)
+    : _path(path), _header({}), _failed(false) {
+  _file = fopen(path, "wb");
+  if (_file == NULL) {
+    fprintf(stderr, "LUT_STREAM: could not create %s: %s\n", path,
+            strerror(errno));
+    _failed = true;
+    return;
+  }
+  (void)setvbuf(_file, NULL, _IOFBF, BUFFER_SIZE);
+  _header.magic = LutStreamHeader::MAGIC;
+  write(&_header, sizeof(_header));
+}
+
+LutStreamWriter::~LutStreamWriter(void) {
+  if (_file != NULL) {
+    fclose(_file);
+  }
+}
+
+void LutStreamWriter::write(const void *data, const size_t size) {
+  if (!_failed && fwrite(data, 1, size, _file) != size) {
+    _failed = true;
+  }
+}
+
+uint32_t LutStreamWriter::addInput(void) {
+  assert(_header.node_count < UINT32_MAX);
+  const uint32_t node = _header.node_count++;
+  const uint64_t function = 0;
+  write(&function, sizeof(function));
+  write(&INPUT_MARK, sizeof(INPUT_MARK));
+  _input_nodes.push_back(node);
+  return node;
+}
+
+uint32_t LutStreamWriter::addLut(const uint64_t function,
+                                 const uint32_t *fanins,
+                                 const uint32_t fanin_count) {
+  assert(fanin_count <= LutNetwork::MAX_LUT_INPUTS);
+  assert(_header.node_count < UINT32_MAX);
+  const uint32_t node = _header.node_count++;
+  const uint8_t count = fanin_count;
+  write(&function, sizeof(function));
+  write(&count, sizeof(count));
+  for (uint32_t i = 0; i < fanin_count; i++) {
+    assert(fanins[i] < node && "LUTs can only read earlier nodes");
+  }
+  write(fanins, fanin_count * sizeof(uint32_t));
+  _header.edge_count += fanin_count;
+  return node;
+}
+
+void LutStreamWriter::addOutput(const uint32_t node) {
+  assert(node < _header.node_count);
+  _output_nodes.push_back(node);
+}
+
+bool LutStreamWriter::finish(void) {
+  if (_file == NULL) {
+    return false;
+  }
+  _header.input_count = _input_nodes.size();
+  _header.output_count = _output_nodes.size();
+  _header.trailer_offset =
+      sizeof(_header) + _header.node_count * (sizeof(uint64_t) + 1) +
+      _header.edge_count * sizeof(uint32_t);
+  write(_input_nodes.data(), _input_nodes.size() * sizeof(uint32_t));
+  write(_output_nodes.data(), _output_nodes.size() * sizeof(uint32_t));
+  if (!_failed && fseek(_file, 0, SEEK_SET) != 0) {
+    _failed = true;
+  }
+  write(&_header, sizeof(_header));
+
+  const bool closed = fclose(_file) == 0;
+  _file = NULL;
+  if (_failed || !closed) {
+    fprintf(stderr, "LUT_STREAM: could not write %s: %s\n", _path,
+            strerror(errno));
+    return false;
+  }
+  return true;
+}
+
+bool writeLutStreamFile(const LutNetwork &network, const char *path) {
+  std::vector<uint32_t> order;
+  std::vector<uint32_t> level_starts;
+  network.computeLevelOrder(order, level_starts);
+  std::vector<uint32_t> new_nodes(order.size());
+  for (uint32_t place = 0; place < order.size(); place++) {
+    new_nodes[order[place]] = place;
+  }
+
+  // Level 0 keeps the inputs in network order, so the stream numbers them
+  // the same as the network does.
+  LutStreamWriter writer(path);
+  uint32_t fanins[LutNetwork::MAX_LUT_INPUTS];
+  for (const uint32_t node : order) {
+    if (network.isInput(node)) {
+      writer.addInput();
+      continue;
+    }
+    for (uint32_t i = 0; i < network.getFaninCount(node); i++) {
+      fanins[i] = new_nodes[network.getFanin(node, i)];
+    }
+    writer.addLut(network.getFunction(node), fanins,
+                  network.getFaninCount(node));
+  }
+  for (uint32_t output = 0; output < network.getOutputCount(); output++) {
+    writer.addOutput(new_nodes[network.getOutputNode(output)]);
+  }
+  return writer.finish();
+}
+
+LutStreamEvaluator::LutStreamEvaluator(const size_t window_size)
+    : _window_size(std::max(window_size, MAX_RECORD_SIZE)), _fd(-1),
+      _header({}) {
+  // Room for a record cut off at the end of the previous window.
+  _window = static_cast<uint8_t *>(malloc(_window_size + MAX_RECORD_SIZE));
+  assert(_window != NULL && "Buy MORE RAM lol!!");
+}
+
+LutStreamEvaluator::~LutStreamEvaluator(void) {
+  close();
+  free(_window);
+}
+
+void LutStreamEvaluator::close(void) {
+  if (_fd >= 0) {
+    ::close(_fd);
+    _fd = -1;
+  }
+}
+
+bool LutStreamEvaluator::readAt(void *data, const size_t size,
+                                const uint64_t offset) const {
+  size_t done = 0;
+  while (done < size) {
+    const ssize_t n = pread(_fd, static_cast<uint8_t *>(data) + done,
+                            size - done, offset + done);
+    if (n < 0 && errno == EINTR) {
+      continue;
+    }
+    if (n <= 0) {
+      return false;
+    }
+    done += n;
+  }
+  return true;
+}
+
+bool LutStreamEvaluator::open(const char *path) {
+  close();
+  _fd = ::open(path, O_RDONLY);
+  if (_fd < 0) {
+    fprintf(stderr, "LUT_STREAM: could not open %s: %s\n", path,
+            strerror(errno));
+    return false;
+  }
+  (void)posix_fadvise(_fd, 0, 0, POSIX_FADV_SEQUENTIAL);
+
+  // Every count is checked against the file size before anything is sized
+  // by it: node_count bounds edge_count, so the record size cannot
+  // overflow, and the trailer has to fill the rest of the file exactly.
+  struct stat file_stat;
+  const bool stat_ok = fstat(_fd, &file_stat) == 0;
+  const uint64_t file_size = stat_ok ? file_stat.st_size : 0;
+  if (!stat_ok || !readAt(&_header, sizeof(_header), 0) ||
+      _header.magic != LutStreamHeader::MAGIC ||
+      _header.node_count > UINT32_MAX ||
+      _header.edge_count >
+          _header.node_count * LutNetwork::MAX_LUT_INPUTS ||
+      _header.input_count > _header.node_count ||
+      _header.output_count > UINT32_MAX ||
+      _header.trailer_offset !=
+          sizeof(_header) + _header.node_count * (sizeof(uint64_t) + 1) +
+              _header.edge_count * sizeof(uint32_t) ||
+      _header.trailer_offset > file_size ||
+      file_size - _header.trailer_offset !=
+          (_header.input_count + _header.output_count) * sizeof(uint32_t)) {
+    fprintf(stderr, "LUT_STREAM: %s is not a LUT stream file\n", path);
+    close();
+    return false;
+  }
+
+  _input_nodes.resize(_header.input_count);
+  _output_nodes.resize(_header.output_count);
+  const size_t input_size = _input_nodes.size() * sizeof(uint32_t);
+  if (!readAt(_input_nodes.data(), input_size, _header.trailer_offset) ||
+      !readAt(_output_nodes.data(), _output_nodes.size() * sizeof(uint32_t),
+              _header.trailer_offset + input_size)) {
+    fprintf(stderr, "LUT_STREAM: %s: truncated trailer\n", path);
+    close();
+    return false;
+  }
+  for (const uint32_t node : _input_nodes) {
+    if (node >= _header.node_count) {
+      fprintf(stderr, "LUT_STREAM: %s: input node %u out of range\n", path,
+              node);
+      close();
+      return false;
+    }
+  }
+  for (const uint32_t node : _output_nodes) {
+    if (node >= _header.node_count) {
+      fprintf(stderr, "LUT_STREAM: %s: output node %u out of range\n", path,
+              node);
+      close();
+      return false;
+    }
+  }
+
+  _values.assign((_header.node_count + 63) / 64, 0);
+  return true;
+}
+
+uint64_t LutStreamEvaluator::getResidentBytes(void) const {
+  return _window_size + MAX_RECORD_SIZE +
+         _values.size() * sizeof(uint64_t) +
+         (_input_nodes.size() + _output_nodes.size()) * sizeof(uint32_t);
+}
+
+void LutStreamEvaluator::setInputs(const uint8_t *values) {
+  for (uint32_t input = 0; input < getInputCount(); input++) {
+    setValue(_input_nodes[input], values[input] != 0);
+  }
+}
+
+void LutStreamEvaluator::getOutputs(uint8_t *values) const {
+  for (uint32_t output = 0; output < getOutputCount(); output++) {
+    values[output] = getValue(_output_nodes[output]);
+  }
+}
+
+// The window is refilled whenever less than a whole record is left in it,
+// the unread tail moves to the front first.
+bool LutStreamEvaluator::evaluate(void) {
+  if (_fd < 0) {
+    return false;
+  }
+  uint64_t offset = sizeof(_header);
+  size_t filled = 0;
+  size_t next = 0;
+
+  for (uint64_t node = 0; node < _header.node_count; node++) {
+    if (filled - next < MAX_RECORD_SIZE && offset < _header.trailer_offset) {
+      memmove(_window, _window + next, filled - next);
+      filled -= next;
+      next = 0;
+      const size_t size = std::min<uint64_t>(
+          _window_size + MAX_RECORD_SIZE - filled,
+          _header.trailer_offset - offset);
+      if (!readAt(_window + filled, size, offset)) {
+        fprintf(stderr, "LUT_STREAM: read failed at %lu: %s\n", offset,
+                strerror(errno));
+        return false;
+      }
+      filled += size;
+      offset += size;
+      (void)posix_fadvise(_fd, offset, _window_size, POSIX_FADV_WILLNEED);
+    }
+
+    if (filled - next < sizeof(uint64_t) + 1) {
+      fprintf(stderr, "LUT_STREAM: truncated record of node %lu\n", node);
+      return false;
+    }
+    uint64_t function;
+    memcpy(&function, _window + next, sizeof(function));
+    const uint32_t fanin_count = _window[next + sizeof(function)];
+    next += sizeof(function) + 1;
+    if (fanin_count == LutStreamWriter::INPUT_MARK) {
+      continue;
+    }
+    if (fanin_count > LutNetwork::MAX_LUT_INPUTS ||
+        filled - next < fanin_count * sizeof(uint32_t)) {
+      fprintf(stderr, "LUT_STREAM: bad record of node %lu\n", node);
+      return false;
+    }
+
+    uint32_t word = 0;
+    for (uint32_t i = 0; i < fanin_count; i++) {
+      uint32_t fanin;
+      memcpy(&fanin, _window + next + i * sizeof(uint32_t), sizeof(fanin));
+      if (fanin >= node) {
+        fprintf(stderr, "LUT_STREAM: node %lu reads later node %u\n", node,
+                fanin);
+        return false;
+      }
+      word |= static_cast<uint32_t>(getValue(fanin)) << i;
+    }
+    next += fanin_count * sizeof(uint32_t);
+    setValue(node, (function >> word) & 1);
+  }
+  return true;
+}
@@ -0,0 +1,44 @@
+#include "lut_eval/random_lut_network.hpp"
+
+// SplitMix64, identical sequence on every platform.
+static inline uint64_t nextRandom(uint64_t &state) {
+  uint64_t z = (state += 0x9e3779b97f4a7c15ull);
+  z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ull;
+  z = (z ^ (z >> 27)) * 0x94d049bb133111ebull;
+  return z ^ (z >> 31);
+}
+
+void buildRandomLutNetwork(const RandomLutNetworkParameters &parameters,
+                           LutNetwork &network) {
+  assert(network.getNodeCount() == 0);
+  assert(parameters.min_fanin <= parameters.max_fanin);
+  assert(parameters.max_fanin <= LutNetwork::MAX_LUT_INPUTS);
+  assert(parameters.input_count > 0 || parameters.max_fanin == 0);
+
+  uint64_t state = parameters.seed;
+  const uint64_t output_threshold = parameters.output_rate * 0x1p32;
+
+  for (uint32_t i = 0; i < parameters.input_count; i++) {
+    network.addInput();
+  }
+
+  uint32_t fanins[LutNetwork::MAX_LUT_INPUTS];
+  const uint32_t fanin_range = parameters.max_fanin - parameters.min_fanin + 1;
+  for (uint32_t i = 0; i < parameters.lut_count; i++) {
+    const uint32_t node_count = network.getNodeCount();
+    const uint32_t window = parameters.window;
+    const uint32_t first =
+        window == 0 || window >= node_count ? 0 : node_count - window;
+    const uint32_t last = window == 0 ? parameters.input_count : node_count;
+    const uint32_t fanin_count =
+        parameters.min_fanin + nextRandom(state) % fanin_range;
+    for (uint32_t j = 0; j < fanin_count; j++) {
+      fanins[j] = first + nextRandom(state) % (last - first);
+    }
+    const uint32_t node =
+        network.addLut(nextRandom(state), fanins, fanin_count);
+    if ((nextRandom(state) & UINT32_MAX) < output_threshold) {
+      network.addOutput(node);
+    }
+  }
+}
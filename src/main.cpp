@@ -1,8 +1,67 @@
+#include "circuit_solver/circuit_solver.hpp"
 #include "circuit_solver/circuit_solver_self_test.hpp"
 #include "raylib_probe/raylib_probe_self_test.hpp"
 #include "animation_demo/animation_demo_self_test.hpp"
 
-int main() {
+static int usage(const char *program) {
+  fprintf(stderr,
+          "usage: %s [--headless] [--image-sequence pattern [qoi|png]]\n"
+          "          [--render-profile json] [--trace json [categories]]\n"
+          "          [--rgba-pipe]\n",
+          program);
+  return 1;
+}
+
+int main(int argc, char **argv) {
+  // Any option exports the video: --headless with the CPU rasterizer,
+  // without a window or a GL context, else in a window.
+  // --image-sequence additionally writes every frame as an image, the
+  // pattern takes the frame index, e.g. frames/frame_%06lu.qoi.
+  // --render-profile writes the per stage timings printed after the export
+  // as JSON.
+  // --trace records a Chrome trace of the given comma separated categories,
+  // by default model, layout and render; layout_detail adds an event per
+  // laid out node and edge.
+  // --rgba-pipe hands ffmpeg RGBA frames to convert instead of converting
+  // them to I420 first.
+  if (argc > 1) {
+    CircuitSolver circuit_solver;
+    bool headless = false;
+    for (int i = 1; i < argc; i++) {
+      const bool has_value = i + 1 < argc;
+      if (strcmp(argv[i], "--headless") == 0) {
+        headless = true;
+      } else if (strcmp(argv[i], "--rgba-pipe") == 0) {
+        circuit_solver.setVideoPipeFormat(FFMPEG_PIPE_RGBA);
+      } else if (has_value && strcmp(argv[i], "--image-sequence") == 0) {
+        const char *pattern = argv[++i];
+        ImageSequenceFormat format = ImageSequenceQOI;
+        if (i + 1 < argc && parseImageSequenceFormat(argv[i + 1], format)) {
+          i++;
+        }
+        circuit_solver.exportImageSequence(pattern, format);
+      } else if (has_value && strcmp(argv[i], "--render-profile") == 0) {
+        circuit_solver.dumpRenderProfile(argv[++i]);
+      } else if (has_value && strcmp(argv[i], "--trace") == 0) {
+        const char *path = argv[++i];
+        uint32_t categories =
+            TraceCategoryModel | TraceCategoryLayout | TraceCategoryRender;
+        if (i + 1 < argc && parseTraceCategories(argv[i + 1], categories)) {
+          i++;
+        }
+        circuit_solver.recordTrace(path, categories);
+      } else {
+        return usage(argv[0]);
+      }
+    }
+    if (headless) {
+      circuit_solver.render_video_headless();
+    } else {
+      circuit_solver.render_video();
+    }
+    return 0;
+  }
+
   CircuitSolverSelfTest circuit_solver_self_test;
   circuit_solver_self_test.selfTest();
 
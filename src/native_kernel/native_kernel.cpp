@@ -0,0 +1,238 @@
+#include "native_kernel/native_kernel.hpp"
+#include <dlfcn.h>
+#include <limits.h>
+#include <pwd.h>
+#include <sys/stat.h>
+
+static bool isSet(const char *variable) {
+  return variable != NULL && variable[0] != '\0';
+}
+
+const char *getDefaultKernelCacheDir(void) {
+  static const std::string cache_dir = [](void) -> std::string {
+    const char *kernel_cache = getenv("CIRCUIT_KERNEL_CACHE");
+    if (isSet(kernel_cache)) {
+      return kernel_cache;
+    }
+    const char *xdg_cache_home = getenv("XDG_CACHE_HOME");
+    if (isSet(xdg_cache_home)) {
+      return std::string(xdg_cache_home) + "/circuit_vis/kernels";
+    }
+    const char *home = getenv("HOME");
+    if (!isSet(home)) {
+      const struct passwd *user = getpwuid(geteuid());
+      home = user != NULL ? user->pw_dir : NULL;
+    }
+    return isSet(home) ? std::string(home) + "/.cache/circuit_vis/kernels"
+                       : std::string();
+  }();
+  return cache_dir.c_str();
+}
+
+// Creates cache_dir and its missing parents private to this user. Anyone
+// who can write into cache_dir can plant an object under the name we are
+// about to dlopen, so a directory of another user or one that is group or
+// other writable is refused, whoever created it.
+static bool openCacheDir(const char *cache_dir) {
+  if (cache_dir[0] == '\0') {
+    fprintf(stderr, "NATIVE_KERNEL: no cache directory, set HOME or "
+                    "CIRCUIT_KERNEL_CACHE\n");
+    return false;
+  }
+  std::string path(cache_dir);
+  for (size_t slash = path.find('/', 1); slash != std::string::npos;
+       slash = path.find('/', slash + 1)) {
+    path[slash] = '\0';
+    mkdir(path.c_str(), 0700);
+    path[slash] = '/';
+  }
+  if (mkdir(cache_dir, 0700) < 0 && errno != EEXIST) {
+    fprintf(stderr, "NATIVE_KERNEL: could not create %s: %s\n", cache_dir,
+            strerror(errno));
+    return false;
+  }
+
+  struct stat status;
+  if (stat(cache_dir, &status) < 0) {
+    fprintf(stderr, "NATIVE_KERNEL: could not stat %s: %s\n", cache_dir,
+            strerror(errno));
+    return false;
+  }
+  if (!S_ISDIR(status.st_mode) || status.st_uid != geteuid() ||
+      (status.st_mode & (S_IWGRP | S_IWOTH)) != 0) {
+    fprintf(stderr,
+            "NATIVE_KERNEL: refusing %s, it has to be a directory of this "
+            "user that nobody else can write to\n",
+            cache_dir);
+    return false;
+  }
+  return true;
+}
+
+static const char *const COMPILE_FLAGS[] = {"-O1", "-shared", "-fPIC"};
+
+static const char *getCompiler(void) {
+  const char *compiler = getenv("CXX");
+  return isSet(compiler) ? compiler : "c++";
+}
+
+// What the cache key knows of the compiler: the path it resolves to with its
+// size and modification time, so another compiler or an upgrade of the same
+// one is not served objects of the old, and the flags.
+static std::string describeCompiler(const char *compiler) {
+  std::string path(compiler);
+  const char *search = getenv("PATH");
+  if (strchr(compiler, '/') == NULL && isSet(search)) {
+    const std::string directories(search);
+    size_t start = 0;
+    for (;;) {
+      const size_t end = directories.find(':', start);
+      const std::string candidate =
+          directories.substr(start, end - start) + "/" + compiler;
+      if (access(candidate.c_str(), X_OK) == 0) {
+        path = candidate;
+        break;
+      }
+      if (end == std::string::npos) {
+        break;
+      }
+      start = end + 1;
+    }
+  }
+
+  std::string description(compiler);
+  char resolved[PATH_MAX];
+  struct stat status;
+  if (realpath(path.c_str(), resolved) != NULL &&
+      stat(resolved, &status) == 0) {
+    char identity[PATH_MAX + 64];
+    snprintf(identity, sizeof(identity), " %s %ld %ld", resolved,
+             static_cast<long>(status.st_size),
+             static_cast<long>(status.st_mtime));
+    description += identity;
+  }
+  for (const char *flag : COMPILE_FLAGS) {
+    description += ' ';
+    description += flag;
+  }
+  return description;
+}
+
+// FNV-1a, the same on every platform.
+uint64_t NativeKernel::hashSource(const std::string &source) {
+  uint64_t hash = 0xcbf29ce484222325ull;
+  for (const char c : source) {
+    hash = (hash ^ static_cast<uint8_t>(c)) * 0x100000001b3ull;
+  }
+  return hash;
+}
+
+bool NativeKernel::compile(const char *source_path,
+                           const char *library_path) const {
+  const char *compiler = getCompiler();
+
+  // Put together before the fork, the child cannot.
+  std::vector<const char *> arguments = {compiler};
+  for (const char *flag : COMPILE_FLAGS) {
+    arguments.push_back(flag);
+  }
+  arguments.insert(arguments.end(), {"-o", library_path, source_path, NULL});
+  char message[PATH_MAX + 64];
+  snprintf(message, sizeof(message), "NATIVE_KERNEL CHILD: could not run %s\n",
+           compiler);
+
+  pid_t child = fork();
+  if (child < 0) {
+    fprintf(stderr, "NATIVE_KERNEL: could not fork a child: %s\n",
+            strerror(errno));
+    return false;
+  }
+  if (child == 0) {
+    execvp(compiler, const_cast<char *const *>(arguments.data()));
+    failForkedChild(message);
+  }
+
+  int wstatus = 0;
+  while (waitpid(child, &wstatus, 0) < 0) {
+    if (errno != EINTR) {
+      fprintf(stderr, "NATIVE_KERNEL: could not wait for %s: %s\n", compiler,
+              strerror(errno));
+      return false;
+    }
+  }
+  if (!WIFEXITED(wstatus) || WEXITSTATUS(wstatus) != 0) {
+    fprintf(stderr, "NATIVE_KERNEL: %s failed on %s\n", compiler,
+            source_path);
+    return false;
+  }
+  return true;
+}
+
+NativeKernel::NativeKernel(const std::string &source, const char *symbol,
+                           const char *cache_dir)
+    : _library(NULL), _function(NULL),
+      _hash(hashSource(describeCompiler(getCompiler()) + "\n" + source)),
+      _cached(false) {
+  if (source.empty()) {
+    return;
+  }
+  if (!openCacheDir(cache_dir)) {
+    return;
+  }
+  char library_path[PATH_MAX];
+  if (snprintf(library_path, sizeof(library_path), "%s/%s_%016lx.so",
+               cache_dir, symbol, _hash) >= PATH_MAX) {
+    fprintf(stderr, "NATIVE_KERNEL: %s is too long a path\n", cache_dir);
+    return;
+  }
+
+  _library = dlopen(library_path, RTLD_NOW | RTLD_LOCAL);
+  _cached = _library != NULL;
+  if (_library == NULL) {
+    // Written and compiled under names of this process, the rename makes
+    // the object appear whole to anyone else looking for it.
+    char source_path[PATH_MAX + 32];
+    char temporary_path[PATH_MAX + 32];
+    snprintf(source_path, sizeof(source_path), "%s.%d.cpp", library_path,
+             getpid());
+    snprintf(temporary_path, sizeof(temporary_path), "%s.%d", library_path,
+             getpid());
+    FILE *file = fopen(source_path, "w");
+    if (file == NULL) {
+      fprintf(stderr, "NATIVE_KERNEL: could not create %s: %s\n", source_path,
+              strerror(errno));
+      return;
+    }
+    const bool written =
+        fwrite(source.data(), 1, source.size(), file) == source.size();
+    if (fclose(file) != 0 || !written) {
+      fprintf(stderr, "NATIVE_KERNEL: could not write %s\n", source_path);
+      unlink(source_path);
+      return;
+    }
+
+    const bool compiled = compile(source_path, temporary_path);
+    unlink(source_path);
+    if (!compiled || rename(temporary_path, library_path) < 0) {
+      unlink(temporary_path);
+      return;
+    }
+    _library = dlopen(library_path, RTLD_NOW | RTLD_LOCAL);
+    if (_library == NULL) {
+      fprintf(stderr, "NATIVE_KERNEL: could not load %s: %s\n", library_path,
+              dlerror());
+      return;
+    }
+  }
+
+  _function = dlsym(_library, symbol);
+  if (_function == NULL) {
+    fprintf(stderr, "NATIVE_KERNEL: %s has no %s\n", library_path, symbol);
+  }
+}
+
+NativeKernel::~NativeKernel(void) {
+  if (_library != NULL) {
+    dlclose(_library);
+  }
+}
@@ -0,0 +1,217 @@
+#include "node_order/node_order.hpp"
+
+static void getFanouts(const NodeOrderGraph &graph,
+                       std::vector<uint32_t> &first_fanouts,
+                       std::vector<uint32_t> &fanouts) {
+  const uint32_t node_count = graph.node_count;
+  first_fanouts.assign(node_count + 1, 0);
+  for (uint32_t i = 0; i < graph.first_fanins[node_count]; i++) {
+    first_fanouts[graph.fanins[i] + 1]++;
+  }
+  for (uint32_t node = 0; node < node_count; node++) {
+    first_fanouts[node + 1] += first_fanouts[node];
+  }
+  fanouts.resize(first_fanouts[node_count]);
+  std::vector<uint32_t> next(first_fanouts.begin(), first_fanouts.end() - 1);
+  for (uint32_t node = 0; node < node_count; node++) {
+    for (uint32_t i = graph.first_fanins[node];
+         i < graph.first_fanins[node + 1]; i++) {
+      fanouts[next[graph.fanins[i]]++] = node;
+    }
+  }
+}
+
+static void computeLevelBfsOrder(const NodeOrderGraph &graph,
+                                 std::vector<uint32_t> &new_indices) {
+  const uint32_t node_count = graph.node_count;
+  std::vector<uint32_t> first_fanouts;
+  std::vector<uint32_t> fanouts;
+  getFanouts(graph, first_fanouts, fanouts);
+
+  // Longest path levels, Kahn's algorithm. Nodes on or behind a cycle are
+  // never ready and keep UINT32_MAX.
+  std::vector<uint32_t> levels(node_count, UINT32_MAX);
+  std::vector<uint32_t> pending_fanins(node_count);
+  std::vector<uint32_t> ready;
+  ready.reserve(node_count);
+  for (uint32_t node = 0; node < node_count; node++) {
+    pending_fanins[node] =
+        graph.first_fanins[node + 1] - graph.first_fanins[node];
+    if (pending_fanins[node] == 0) {
+      levels[node] = 0;
+      ready.push_back(node);
+    }
+  }
+  uint32_t level_count = node_count == 0 ? 0 : 1;
+  for (size_t i = 0; i < ready.size(); i++) {
+    const uint32_t node = ready[i];
+    for (uint32_t j = first_fanouts[node]; j < first_fanouts[node + 1]; j++) {
+      const uint32_t sink = fanouts[j];
+      levels[sink] = levels[sink] == UINT32_MAX
+                         ? levels[node] + 1
+                         : std::max(levels[sink], levels[node] + 1);
+      level_count = std::max(level_count, levels[sink] + 1);
+      if (--pending_fanins[sink] == 0) {
+        ready.push_back(sink);
+      }
+    }
+  }
+
+  // Stable counting sort by level, the unordered nodes last.
+  std::vector<uint32_t> first_level_nodes(level_count + 2, 0);
+  for (uint32_t node = 0; node < node_count; node++) {
+    const uint32_t level = std::min(levels[node], level_count);
+    first_level_nodes[level + 1]++;
+  }
+  for (uint32_t level = 0; level <= level_count; level++) {
+    first_level_nodes[level + 1] += first_level_nodes[level];
+  }
+  std::vector<uint32_t> order(node_count);
+  std::vector<uint32_t> next(first_level_nodes.begin(),
+                             first_level_nodes.end() - 1);
+  for (uint32_t node = 0; node < node_count; node++) {
+    order[next[std::min(levels[node], level_count)]++] = node;
+  }
+
+  // Every fan-in of a node is on a lower level and already numbered, so a
+  // level sorts by the first new index among its nodes' fan-ins.
+  new_indices.assign(node_count, UINT32_MAX);
+  std::vector<uint32_t> keys(node_count, UINT32_MAX);
+  for (uint32_t level = 0; level <= level_count; level++) {
+    const auto begin = order.begin() + first_level_nodes[level];
+    const auto end = order.begin() + first_level_nodes[level + 1];
+    for (auto it = begin; it != end; it++) {
+      for (uint32_t i = graph.first_fanins[*it];
+           i < graph.first_fanins[*it + 1]; i++) {
+        keys[*it] = std::min(keys[*it], new_indices[graph.fanins[i]]);
+      }
+    }
+    if (level > 0 && level < level_count) {
+      std::stable_sort(begin, end, [&](const uint32_t a, const uint32_t b) {
+        return keys[a] < keys[b];
+      });
+    }
+    for (auto it = begin; it != end; it++) {
+      new_indices[*it] = it - order.begin();
+    }
+  }
+}
+
+static void computeDepthFirstOrder(const NodeOrderGraph &graph,
+                                   std::vector<uint32_t> &new_indices) {
+  const uint32_t node_count = graph.node_count;
+  std::vector<uint32_t> fanout_counts(node_count, 0);
+  for (uint32_t i = 0; i < graph.first_fanins[node_count]; i++) {
+    fanout_counts[graph.fanins[i]]++;
+  }
+
+  new_indices.assign(node_count, UINT32_MAX);
+  uint32_t next_index = 0;
+  for (uint32_t node = 0; node < node_count; node++) {
+    if (graph.first_fanins[node] == graph.first_fanins[node + 1]) {
+      new_indices[node] = next_index++;
+    }
+  }
+
+  // Roots are the sinks, then whatever a cycle kept out of reach. A node is
+  // numbered once all its fan-ins are, the stack holds the next fan-in to
+  // visit of every node on the path.
+  std::vector<uint8_t> visited(node_count, 0);
+  std::vector<std::pair<uint32_t, uint32_t>> stack;
+  for (const bool sinks_only : {true, false}) {
+    for (uint32_t root = 0; root < node_count; root++) {
+      if (visited[root] || new_indices[root] != UINT32_MAX ||
+          (sinks_only && fanout_counts[root] > 0)) {
+        continue;
+      }
+      visited[root] = 1;
+      stack.push_back({root, graph.first_fanins[root]});
+      while (!stack.empty()) {
+        const uint32_t node = stack.back().first;
+        const uint32_t i = stack.back().second;
+        if (i == graph.first_fanins[node + 1]) {
+          new_indices[node] = next_index++;
+          stack.pop_back();
+          continue;
+        }
+        stack.back().second++;
+        const uint32_t fanin = graph.fanins[i];
+        if (!visited[fanin] && new_indices[fanin] == UINT32_MAX) {
+          visited[fanin] = 1;
+          stack.push_back({fanin, graph.first_fanins[fanin]});
+        }
+      }
+    }
+  }
+  assert(next_index == node_count);
+}
+
+void computeNodeOrder(const NodeOrderGraph &graph, const NodeOrderType type,
+                      std::vector<uint32_t> &new_indices) {
+  switch (type) {
+  case NodeOrderLevelBfs:
+    computeLevelBfsOrder(graph, new_indices);
+    break;
+  case NodeOrderDepthFirst:
+    computeDepthFirstOrder(graph, new_indices);
+    break;
+  default:
+    assert(0);
+  }
+}
+
+void computeNodeOrderStats(const NodeOrderGraph &graph,
+                           const std::vector<uint32_t> &new_indices,
+                           const uint32_t record_size,
+                           const uint32_t cache_size, NodeOrderStats &stats) {
+  static constexpr uint32_t LINE_SIZE = 64;
+  const uint32_t node_count = graph.node_count;
+  assert(new_indices.empty() || new_indices.size() == node_count);
+  const auto getIndex = [&](const uint32_t node) {
+    return new_indices.empty() ? node : new_indices[node];
+  };
+
+  std::vector<uint32_t> order(node_count);
+  for (uint32_t node = 0; node < node_count; node++) {
+    order[getIndex(node)] = node;
+  }
+
+  const uint32_t line_count = std::max(1u, cache_size / LINE_SIZE);
+  std::vector<uint64_t> tags(line_count, UINT64_MAX);
+  const auto touch = [&](const uint32_t index) {
+    const uint64_t line =
+        static_cast<uint64_t>(index) * record_size / LINE_SIZE;
+    uint64_t &tag = tags[line % line_count];
+    stats.estimated_misses += tag != line;
+    tag = line;
+  };
+
+  uint64_t span_sum = 0;
+  stats = {};
+  for (uint32_t index = 0; index < node_count; index++) {
+    const uint32_t node = order[index];
+    touch(index);
+    for (uint32_t i = graph.first_fanins[node];
+         i < graph.first_fanins[node + 1]; i++) {
+      const uint32_t fanin_index = getIndex(graph.fanins[i]);
+      span_sum += index > fanin_index ? index - fanin_index
+                                      : fanin_index - index;
+      touch(fanin_index);
+    }
+  }
+  stats.edge_count = graph.first_fanins[node_count];
+  stats.average_edge_span =
+      stats.edge_count == 0 ? 0.0
+                            : static_cast<double>(span_sum) / stats.edge_count;
+}
+
+const char *getNodeOrderName(const NodeOrderType type) {
+  switch (type) {
+  case NodeOrderLevelBfs:
+    return "level_bfs";
+  case NodeOrderDepthFirst:
+    return "depth_first";
+  default:
+    return "unknown";
+  }
+}
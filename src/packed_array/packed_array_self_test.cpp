@@ -0,0 +1,113 @@
+#include "packed_array/packed_array_self_test.hpp"
+
+uint64_t PackedArraySelfTest::nextRandom(void) {
+  // SplitMix64, identical sequence on every platform.
+  uint64_t z = (_random_state += 0x9e3779b97f4a7c15ull);
+  z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ull;
+  z = (z ^ (z >> 27)) * 0x94d049bb133111ebull;
+  return z ^ (z >> 31);
+}
+
+void PackedArraySelfTest::check(const bool condition, const char *what) {
+  if (!condition) {
+    fprintf(stderr, "PACKED_ARRAY: self test failed: %s\n", what);
+    _failure_count++;
+  }
+}
+
+// Runs starting on and off a group boundary, shorter than a group, and up
+// to the last value, through T as wide as the values allow.
+template <uint32_t BITS, typename T>
+void PackedArraySelfTest::testBulk(const PackedArray<BITS> &array,
+                                   const std::vector<uint64_t> &expected) {
+  const uint64_t size = array.getSize();
+  std::vector<T> values(size + 1);
+  for (const uint64_t first : {0ul, 1ul, 7ul, 8ul, 13ul}) {
+    for (const uint64_t count : {0ul, 3ul, 8ul, 21ul, size}) {
+      if (first + count > size) {
+        continue;
+      }
+      values[count] = 0x5a;
+      array.unpackTo(first, count, values.data());
+      bool same = values[count] == 0x5a;
+      for (uint64_t i = 0; i < count; i++) {
+        same &= values[i] == expected[first + i];
+      }
+      check(same, "unpackTo() matches get()");
+
+      PackedArray<BITS> copy(size);
+      copy.packFrom(first, count, values.data());
+      bool packed = true;
+      for (uint64_t i = 0; i < size; i++) {
+        const bool inside = i >= first && i < first + count;
+        packed &= copy.get(i) == (inside ? expected[i] : 0);
+      }
+      check(packed, "packFrom() stores the run and nothing else");
+    }
+  }
+}
+
+template <uint32_t BITS>
+void PackedArraySelfTest::testWidth(const uint64_t size) {
+  PackedArray<BITS> array(size);
+  check(array.getBytes() == (size * BITS + 7) / 8, "payload bytes");
+  std::vector<uint64_t> expected(size);
+  bool zeroed = true;
+  for (uint64_t i = 0; i < size; i++) {
+    zeroed &= array.get(i) == 0;
+    expected[i] = nextRandom() & PackedBits<BITS>::MASK;
+    array.set(i, expected[i]);
+  }
+  check(zeroed, "new array is zero filled");
+
+  // Every value after setting all of them, so a set that spilled into a
+  // neighbour shows.
+  bool same = true;
+  uint64_t index = 0;
+  for (const uint64_t value : array) {
+    same &= value == expected[index++] && value == array.get(index - 1);
+  }
+  check(same && index == size, "get() and the iterator return what was set");
+
+  if (size > 0) {
+    array.set(size / 2, ~0ull);
+    check(array.get(size / 2) == PackedBits<BITS>::MASK,
+          "set() keeps the lower BITS bits");
+    array.set(size / 2, expected[size / 2]);
+  }
+
+  if constexpr (BITS <= 16) {
+    testBulk<BITS, uint16_t>(array, expected);
+  }
+  if constexpr (BITS <= 32) {
+    testBulk<BITS, uint32_t>(array, expected);
+  }
+  testBulk<BITS, uint64_t>(array, expected);
+}
+
+bool PackedArraySelfTest::selfTest(void) {
+  _failure_count = 0;
+  check(getPackedBits(0) == 1 && getPackedBits(1) == 1 &&
+            getPackedBits(255) == 8 && getPackedBits(256) == 9 &&
+            getPackedBits(UINT64_MAX >> 1) == 63,
+        "getPackedBits()");
+
+  // Both sides of every kernel limit: 16 bit and 32 bit values, the AVX2
+  // lanes and the 8 byte word.
+  testWidth<1>(1000);
+  testWidth<3>(1000);
+  testWidth<7>(0);
+  testWidth<8>(1000);
+  testWidth<12>(5);
+  testWidth<12>(1000);
+  testWidth<16>(1000);
+  testWidth<17>(1000);
+  testWidth<25>(1000);
+  testWidth<26>(1000);
+  testWidth<32>(1000);
+  testWidth<33>(1000);
+  testWidth<57>(1000);
+  testWidth<58>(1000);
+  testWidth<63>(1000);
+  return _failure_count == 0;
+}
@@ -0,0 +1,120 @@
+#include "recursive_graph/circuit_graph.hpp"
+
+// others[begin, end) is sorted, so the median goes in first and each half
+// after it the same way, which keeps the edge tree of node balanced.
+static void
+addMedianFirst(RecursiveGraph::Graph &graph, const uint32_t node,
+               const std::vector<std::pair<uint32_t, uint32_t>> &others,
+               const size_t begin, const size_t end) {
+  if (begin == end) {
+    return;
+  }
+  const size_t middle = begin + (end - begin) / 2;
+  for (uint32_t i = 0; i < others[middle].second; i++) {
+    graph.addEdge(node, others[middle].first);
+  }
+  addMedianFirst(graph, node, others, begin, middle);
+  addMedianFirst(graph, node, others, middle + 1, end);
+}
+
+// CircuitNode hands out its fanouts and fanins sorted, added in that order
+// every edge tree would degenerate into a list.
+CircuitGraph::CircuitGraph(const CircuitModel &circuit) {
+  _types.reserve(circuit.getNodeCount());
+  _values.reserve(circuit.getNodeCount());
+  circuit.forEachNode([&](const CircuitNode &node) {
+    addNode(node.getType(), node.getValue());
+    return IterationContinue;
+  });
+
+  std::vector<std::pair<uint32_t, uint32_t>> others;
+  const auto collect = [&](const uint32_t other, const uint32_t count) {
+    others.push_back({other, count});
+    return IterationContinue;
+  };
+  circuit.forEachNode([&](const CircuitNode &node) {
+    others.clear();
+    node.forEachFanout(collect);
+    addMedianFirst(_fanouts, node.getIndex(), others, 0, others.size());
+    others.clear();
+    node.forEachFanin(collect);
+    addMedianFirst(_fanins, node.getIndex(), others, 0, others.size());
+    return IterationContinue;
+  });
+}
+
+uint32_t CircuitGraph::addNode(const CircuitNodeType type,
+                               const uint32_t value) {
+  const uint32_t index = _types.size();
+  _types.push_back(type);
+  _values.push_back(value);
+  _fanouts.addNode();
+  _fanins.addNode();
+  return index;
+}
+
+void CircuitGraph::addEdge(const uint32_t source, const uint32_t sink) {
+  _fanouts.addEdge(source, sink);
+  _fanins.addEdge(sink, source);
+}
+
+void CircuitGraph::addEdges(const uint32_t source, const uint32_t sink,
+                            const uint32_t count) {
+  assert(count > 0);
+  for (uint32_t i = 0; i < count; i++) {
+    addEdge(source, sink);
+  }
+}
+
+bool CircuitGraph::deleteEdge(const uint32_t source, const uint32_t sink) {
+  if (!_fanouts.deleteEdge(source, sink)) {
+    return false;
+  }
+  const bool deleted = _fanins.deleteEdge(sink, source);
+  assert(deleted);
+  return deleted;
+}
+
+void CircuitGraph::forEachCounted(
+    const RecursiveGraph::Graph &graph, const uint32_t node,
+    std::function<IteratorStatus(const uint32_t other, const uint32_t count)>
+        &f) {
+  uint64_t previous = UINT64_MAX;
+  uint32_t count = 0;
+  IteratorStatus status = IterationContinue;
+  graph.forEachEdge(node, [&](const uint64_t other) {
+    if (other != previous && count > 0) {
+      status = f(previous, count);
+      count = 0;
+      if (status == IterationBreak) {
+        return IterationBreak;
+      }
+    }
+    previous = other;
+    count++;
+    return IterationContinue;
+  });
+  if (status == IterationContinue && count > 0) {
+    f(previous, count);
+  }
+}
+
+void CircuitGraph::forEachFanout(
+    const uint32_t node,
+    std::function<IteratorStatus(const uint32_t sink, const uint32_t count)> f)
+    const {
+  forEachCounted(_fanouts, node, f);
+}
+
+void CircuitGraph::forEachFanin(
+    const uint32_t node,
+    std::function<IteratorStatus(const uint32_t source, const uint32_t count)>
+        f) const {
+  forEachCounted(_fanins, node, f);
+}
+
+uint64_t CircuitGraph::getBytes(void) const {
+  return _types.capacity() * sizeof(CircuitNodeType) +
+         _values.capacity() * sizeof(uint32_t) + _fanouts.getBytes() +
+         _fanins.getBytes();
+}
@@ -0,0 +1,313 @@
+#include "recursive_graph/recursive_graph.hpp"
+#include "widening_copy/widening_copy.hpp"
+
+using namespace RecursiveGraph;
+
+static constexpr uint64_t INITIAL_CAPACITY = 16;
+
+// Narrowest index width that holds max_index.
+static uint32_t getIndexBytes(const uint64_t max_index) {
+  if (max_index <= UINT8_MAX) {
+    return 1;
+  } else if (max_index <= UINT16_MAX) {
+    return 2;
+  } else if (max_index <= UINT32_MAX) {
+    return 4;
+  }
+  return 8;
+}
+
+// Calls f.template operator()<E, N>() with the index types of the widths.
+template <typename E, typename F>
+static auto withNodeIndexType(const uint32_t node_index_bytes, F &&f) {
+  switch (node_index_bytes) {
+  case 1:
+    return f.template operator()<E, uint8_t>();
+  case 2:
+    return f.template operator()<E, uint16_t>();
+  case 4:
+    return f.template operator()<E, uint32_t>();
+  default:
+    assert(node_index_bytes == 8);
+    return f.template operator()<E, uint64_t>();
+  }
+}
+
+template <typename F>
+static auto withIndexTypes(const uint32_t edge_index_bytes,
+                           const uint32_t node_index_bytes, F &&f) {
+  switch (edge_index_bytes) {
+  case 1:
+    return withNodeIndexType<uint8_t>(node_index_bytes, f);
+  case 2:
+    return withNodeIndexType<uint16_t>(node_index_bytes, f);
+  case 4:
+    return withNodeIndexType<uint32_t>(node_index_bytes, f);
+  default:
+    assert(edge_index_bytes == 8);
+    return withNodeIndexType<uint64_t>(node_index_bytes, f);
+  }
+}
+
+Graph::Graph(void)
+    : _nodes(NULL), _node_count(0), _node_capacity(0), _node_index_bytes(1),
+      _edges(NULL), _edge_records(1), _edge_capacity(0), _edge_count(0),
+      _edge_index_bytes(1), _free_edge(NO_EDGE) {
+  resizeNodes(INITIAL_CAPACITY, 1);
+  resizeEdges(INITIAL_CAPACITY, 1, 1);
+  // The sentinel, what NO_EDGE points at.
+  memset(_edges, 0, getEdgeRecordBytes());
+}
+
+Graph::~Graph(void) {
+  free(_nodes);
+  free(_edges);
+}
+
+// A node is its root edge index, so the node array only widens with the
+// edge count, in one contiguous widening copy. Comes before resizeEdges()
+// when both widen, which takes the new widths.
+void Graph::resizeNodes(const uint64_t node_capacity,
+                        const uint32_t edge_index_bytes) {
+  assert(node_capacity >= _node_count);
+  uint8_t *nodes = static_cast<uint8_t *>(
+      aligned_malloc(node_capacity * edge_index_bytes, 32));
+  assert(nodes != NULL && "Buy MORE RAM lol!!");
+  if (_nodes != NULL) {
+    widenCopy(_nodes, _edge_index_bytes, nodes, edge_index_bytes,
+              _node_count);
+    free(_nodes);
+  }
+  _nodes = nodes;
+  _node_capacity = node_capacity;
+}
+
+// Edges are packed records of two edge indices and a node index, so
+// widening either is three strided copies, one per field, each moving to
+// the new stride and zero extended to its new width.
+void Graph::resizeEdges(const uint64_t edge_capacity,
+                        const uint32_t edge_index_bytes,
+                        const uint32_t node_index_bytes) {
+  assert(edge_capacity >= _edge_records);
+  const uint64_t stride = 2 * edge_index_bytes + node_index_bytes;
+  uint8_t *edges =
+      static_cast<uint8_t *>(aligned_malloc(edge_capacity * stride, 32));
+  assert(edges != NULL && "Buy MORE RAM lol!!");
+  if (_edges != NULL) {
+    const uint64_t old_stride = getEdgeRecordBytes();
+    if (old_stride == stride) {
+      memcpy(edges, _edges, _edge_records * stride);
+    } else {
+      widenCopyStrided(_edges, old_stride, _edge_index_bytes, edges, stride,
+                       edge_index_bytes, _edge_records);
+      widenCopyStrided(_edges + _edge_index_bytes, old_stride,
+                       _edge_index_bytes, edges + edge_index_bytes, stride,
+                       edge_index_bytes, _edge_records);
+      widenCopyStrided(_edges + 2 * _edge_index_bytes, old_stride,
+                       _node_index_bytes, edges + 2 * edge_index_bytes,
+                       stride, node_index_bytes, _edge_records);
+    }
+    free(_edges);
+  }
+  _edges = edges;
+  _edge_capacity = edge_capacity;
+  _edge_index_bytes = edge_index_bytes;
+  _node_index_bytes = node_index_bytes;
+}
+
+uint64_t Graph::addNode(void) {
+  const uint64_t node = _node_count;
+  const uint32_t node_index_bytes = getIndexBytes(node);
+  if (__builtin_expect(node_index_bytes > _node_index_bytes, 0)) {
+    resizeEdges(_edge_capacity, _edge_index_bytes, node_index_bytes);
+  }
+  if (__builtin_expect(node >= _node_capacity, 0)) {
+    resizeNodes(2 * _node_capacity, _edge_index_bytes);
+  }
+  memset(_nodes + node * _edge_index_bytes, 0, _edge_index_bytes);
+  _node_count++;
+  return node;
+}
+
+template <typename E, typename N>
+uint64_t Graph::addEdgeAs(const uint64_t start_node, const uint64_t end_node,
+                          const uint64_t edge) {
+  Node<E, N> *nodes = reinterpret_cast<Node<E, N> *>(_nodes);
+  Edge<E, N> *edges = reinterpret_cast<Edge<E, N> *>(_edges);
+  if (edge == _free_edge) {
+    _free_edge = edges[edge]._left_edge_index_offset;
+  }
+  ::new (&edges[edge])
+      Edge<E, N>(NO_EDGE, NO_EDGE, static_cast<N>(end_node));
+
+  if (nodes[start_node]._root_edge_index == NO_EDGE) {
+    nodes[start_node]._root_edge_index = static_cast<E>(edge);
+    return edge;
+  }
+  uint64_t current = nodes[start_node]._root_edge_index;
+  for (;;) {
+    Edge<E, N> &parent = edges[current];
+    if (end_node < parent._node_index) {
+      if (parent._left_edge_index_offset == NO_EDGE) {
+        parent._left_edge_index_offset = static_cast<E>(edge);
+        return edge;
+      }
+      current = parent._left_edge_index_offset;
+    } else {
+      if (parent._right_edge_index_offset == NO_EDGE) {
+        parent._right_edge_index_offset = static_cast<E>(edge);
+        return edge;
+      }
+      current = parent._right_edge_index_offset;
+    }
+  }
+}
+
+uint64_t Graph::addEdge(const uint64_t start_node, const uint64_t end_node) {
+  assert(start_node < _node_count && end_node < _node_count);
+  uint64_t edge = _free_edge;
+  if (edge == NO_EDGE) {
+    edge = _edge_records;
+    const uint32_t edge_index_bytes =
+        std::max(_edge_index_bytes, getIndexBytes(edge));
+    if (__builtin_expect(edge_index_bytes > _edge_index_bytes, 0)) {
+      resizeNodes(_node_capacity, edge_index_bytes);
+    }
+    if (__builtin_expect(edge >= _edge_capacity, 0)) {
+      resizeEdges(2 * _edge_capacity, edge_index_bytes, _node_index_bytes);
+    } else if (__builtin_expect(edge_index_bytes > _edge_index_bytes, 0)) {
+      resizeEdges(_edge_capacity, edge_index_bytes, _node_index_bytes);
+    }
+    _edge_records++;
+  }
+  _edge_count++;
+  return withIndexTypes(_edge_index_bytes, _node_index_bytes,
+                        [&]<typename E, typename N>() {
+                          return addEdgeAs<E, N>(start_node, end_node, edge);
+                        });
+}
+
+template <typename E, typename N>
+uint64_t Graph::findEdgeAs(const uint64_t start_node,
+                           const uint64_t end_node) const {
+  const Node<E, N> *nodes = reinterpret_cast<const Node<E, N> *>(_nodes);
+  const Edge<E, N> *edges = reinterpret_cast<const Edge<E, N> *>(_edges);
+  uint64_t current = nodes[start_node]._root_edge_index;
+  while (current != NO_EDGE && edges[current]._node_index != end_node) {
+    current = end_node < edges[current]._node_index
+                  ? edges[current]._left_edge_index_offset
+                  : edges[current]._right_edge_index_offset;
+  }
+  return current;
+}
+
+uint64_t Graph::findEdge(const uint64_t start_node,
+                         const uint64_t end_node) const {
+  assert(start_node < _node_count);
+  return withIndexTypes(_edge_index_bytes, _node_index_bytes,
+                        [&]<typename E, typename N>() {
+                          return findEdgeAs<E, N>(start_node, end_node);
+                        });
+}
+
+template <typename E, typename N>
+bool Graph::deleteEdgeAs(const uint64_t start_node, const uint64_t end_node) {
+  Node<E, N> *nodes = reinterpret_cast<Node<E, N> *>(_nodes);
+  Edge<E, N> *edges = reinterpret_cast<Edge<E, N> *>(_edges);
+
+  // The edge and the link to it, the root when parent is NO_EDGE.
+  uint64_t parent = NO_EDGE;
+  bool left = false;
+  uint64_t current = nodes[start_node]._root_edge_index;
+  while (current != NO_EDGE && edges[current]._node_index != end_node) {
+    parent = current;
+    left = end_node < edges[current]._node_index;
+    current = left ? edges[current]._left_edge_index_offset
+                   : edges[current]._right_edge_index_offset;
+  }
+  if (current == NO_EDGE) {
+    return false;
+  }
+
+  // With two children the leftmost edge of the right subtree takes its
+  // place: it sorts between both subtrees, and being leftmost has no left
+  // child to give up.
+  Edge<E, N> &edge = edges[current];
+  uint64_t replacement;
+  if (edge._left_edge_index_offset == NO_EDGE) {
+    replacement = edge._right_edge_index_offset;
+  } else if (edge._right_edge_index_offset == NO_EDGE) {
+    replacement = edge._left_edge_index_offset;
+  } else {
+    uint64_t successor_parent = current;
+    replacement = edge._right_edge_index_offset;
+    while (edges[replacement]._left_edge_index_offset != NO_EDGE) {
+      successor_parent = replacement;
+      replacement = edges[replacement]._left_edge_index_offset;
+    }
+    if (successor_parent != current) {
+      edges[successor_parent]._left_edge_index_offset =
+          edges[replacement]._right_edge_index_offset;
+      edges[replacement]._right_edge_index_offset =
+          edge._right_edge_index_offset;
+    }
+    edges[replacement]._left_edge_index_offset = edge._left_edge_index_offset;
+  }
+
+  if (parent == NO_EDGE) {
+    nodes[start_node]._root_edge_index = static_cast<E>(replacement);
+  } else if (left) {
+    edges[parent]._left_edge_index_offset = static_cast<E>(replacement);
+  } else {
+    edges[parent]._right_edge_index_offset = static_cast<E>(replacement);
+  }
+
+  edge._left_edge_index_offset = static_cast<E>(_free_edge);
+  edge._right_edge_index_offset = NO_EDGE;
+  _free_edge = current;
+  return true;
+}
+
+bool Graph::deleteEdge(const uint64_t start_node, const uint64_t end_node) {
+  assert(start_node < _node_count);
+  const bool deleted = withIndexTypes(
+      _edge_index_bytes, _node_index_bytes, [&]<typename E, typename N>() {
+        return deleteEdgeAs<E, N>(start_node, end_node);
+      });
+  _edge_count -= deleted;
+  return deleted;
+}
+
+// In order with an explicit stack, the trees are not balanced and can be as
+// deep as the node has edges.
+template <typename E, typename N>
+void Graph::forEachEdgeAs(
+    const uint64_t start_node,
+    std::function<IteratorStatus(const uint64_t end_node)> &f) const {
+  const Node<E, N> *nodes = reinterpret_cast<const Node<E, N> *>(_nodes);
+  const Edge<E, N> *edges = reinterpret_cast<const Edge<E, N> *>(_edges);
+  std::vector<uint64_t> stack;
+  uint64_t current = nodes[start_node]._root_edge_index;
+  while (current != NO_EDGE || !stack.empty()) {
+    while (current != NO_EDGE) {
+      stack.push_back(current);
+      current = edges[current]._left_edge_index_offset;
+    }
+    current = stack.back();
+    stack.pop_back();
+    if (f(edges[current]._node_index) == IterationBreak) {
+      return;
+    }
+    current = edges[current]._right_edge_index_offset;
+  }
+}
+
+void Graph::forEachEdge(
+    const uint64_t start_node,
+    std::function<IteratorStatus(const uint64_t end_node)> f) const {
+  assert(start_node < _node_count);
+  withIndexTypes(_edge_index_bytes, _node_index_bytes,
+                 [&]<typename E, typename N>() {
+                   forEachEdgeAs<E, N>(start_node, f);
+                 });
+}
@@ -0,0 +1,194 @@
+#include "recursive_graph/recursive_graph_self_test.hpp"
+
+using namespace RecursiveGraph;
+
+uint64_t RecursiveGraphSelfTest::nextRandom(void) {
+  // SplitMix64, identical sequence on every platform.
+  uint64_t z = (_random_state += 0x9e3779b97f4a7c15ull);
+  z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ull;
+  z = (z ^ (z >> 27)) * 0x94d049bb133111ebull;
+  return z ^ (z >> 31);
+}
+
+void RecursiveGraphSelfTest::check(const bool condition, const char *what) {
+  if (!condition) {
+    fprintf(stderr, "RECURSIVE_GRAPH: self test failed: %s\n", what);
+    _failure_count++;
+  }
+}
+
+// Grows a graph through 1, 2 and 4 byte node and edge indices, every index
+// handed out has to find the same edge after each promotion.
+void RecursiveGraphSelfTest::testPromotion(void) {
+  Graph graph;
+  check(graph.getNodeIndexBytes() == 1 && graph.getEdgeIndexBytes() == 1 &&
+            graph.getEdgeRecordBytes() == 3,
+        "an empty graph starts at 1 byte indices");
+
+  // Each node gets an edge to a random earlier node as it is added, so
+  // the edge count runs one behind the node count.
+  std::vector<uint64_t> edges;
+  std::vector<uint64_t> ends;
+  // Nodes, then the bytes of a node index and an edge index, edge index 0
+  // being the sentinel.
+  const uint64_t stages[][3] = {
+      {255, 1, 1}, {256, 1, 2}, {257, 2, 2}, {65536, 2, 4}, {65537, 4, 4}};
+  for (const auto &stage : stages) {
+    while (graph.getNodeCount() < stage[0]) {
+      const uint64_t node = graph.addNode();
+      ends.push_back(nextRandom() % (node + 1));
+      edges.push_back(graph.addEdge(node, ends.back()));
+    }
+    check(graph.getNodeIndexBytes() == stage[1] &&
+              graph.getEdgeIndexBytes() == stage[2],
+          "the narrowest widths that hold the counts");
+
+    bool found = true;
+    for (uint64_t node = 0; node < edges.size(); node++) {
+      found &= edges[node] != NO_EDGE &&
+               graph.findEdge(node, ends[node]) == edges[node];
+    }
+    check(found, "edge indices survive promotion");
+  }
+  check(graph.getEdgeCount() == edges.size(), "edge count");
+}
+
+// Random additions, lookups and deletions against a multiset per node,
+// then every node's edges in order.
+void RecursiveGraphSelfTest::testRandomEdits(const uint32_t node_count,
+                                             const uint32_t edit_count) {
+  Graph graph;
+  std::vector<std::multiset<uint64_t>> expected(node_count);
+  for (uint32_t i = 0; i < node_count; i++) {
+    check(graph.addNode() == i, "node indices count up from 0");
+  }
+
+  uint64_t edge_count = 0;
+  bool agree = true;
+  for (uint32_t i = 0; i < edit_count; i++) {
+    // Few distinct ends per node, so parallel edges and deletions of
+    // nodes with two children come up often.
+    const uint64_t start = nextRandom() % node_count;
+    const uint64_t end = nextRandom() % std::min(node_count, 24u);
+    const uint64_t action = nextRandom() % 3;
+    if (action == 0) {
+      const bool deleted = graph.deleteEdge(start, end);
+      agree &= deleted == (expected[start].count(end) > 0);
+      if (deleted) {
+        expected[start].erase(expected[start].find(end));
+        edge_count--;
+      }
+    } else if (action == 1) {
+      const uint64_t edge = graph.findEdge(start, end);
+      agree &= (edge != NO_EDGE) == (expected[start].count(end) > 0);
+    } else {
+      graph.addEdge(start, end);
+      expected[start].insert(end);
+      edge_count++;
+    }
+  }
+  check(agree, "addEdge(), findEdge() and deleteEdge() agree with a multiset");
+  check(graph.getEdgeCount() == edge_count, "edge count after deletions");
+
+  // deleteEdge() takes the edge findEdge() finds.
+  const uint64_t start = nextRandom() % node_count;
+  const uint64_t end = nextRandom() % node_count;
+  graph.addEdge(start, end);
+  const uint64_t edge = graph.findEdge(start, end);
+  graph.deleteEdge(start, end);
+  check(graph.addEdge(start, end) == edge, "a deleted edge index is reused");
+  expected[start].insert(end);
+
+  bool same = true;
+  for (uint32_t node = 0; node < node_count; node++) {
+    std::vector<uint64_t> ends;
+    graph.forEachEdge(node, [&](const uint64_t end) {
+      ends.push_back(end);
+      return IterationContinue;
+    });
+    same &= std::equal(ends.begin(), ends.end(), expected[node].begin(),
+                       expected[node].end());
+  }
+  check(same, "forEachEdge() enumerates the edges in order");
+}
+
+// A random circuit with parallel edges and a node fanning out to every
+// other, node by node the same fanouts and fanins as the CircuitModel it was
+// built from.
+void RecursiveGraphSelfTest::testCircuitGraph(const uint32_t node_count,
+                                              const uint32_t edge_count) {
+  CircuitModel circuit;
+  for (uint32_t i = 0; i < node_count; i++) {
+    circuit.addNode(static_cast<CircuitNodeType>(i % LastCircuitNodeType),
+                    nextRandom() % 1000);
+  }
+  for (uint32_t i = 0; i < edge_count; i++) {
+    const uint32_t sink = nextRandom() % node_count;
+    const uint32_t source = nextRandom() % (sink + 1);
+    circuit.addEdges(source, sink, 1 + nextRandom() % 2);
+  }
+  for (uint32_t sink = 1; sink < node_count; sink++) {
+    circuit.addEdge(0, sink);
+  }
+
+  CircuitGraph graph(circuit);
+  check(graph.getNodeCount() == circuit.getNodeCount(), "circuit node count");
+  bool same = true;
+  uint64_t circuit_edge_count = 0;
+  circuit.forEachNode([&](const CircuitNode &node) {
+    const uint32_t index = node.getIndex();
+    same &= graph.getType(index) == node.getType() &&
+            graph.getValue(index) == node.getValue();
+    std::vector<std::pair<uint32_t, uint32_t>> expected;
+    std::vector<std::pair<uint32_t, uint32_t>> actual;
+    const auto collect = [](std::vector<std::pair<uint32_t, uint32_t>> &list) {
+      return [&list](const uint32_t other, const uint32_t count) {
+        list.push_back({other, count});
+        return IterationContinue;
+      };
+    };
+    node.forEachFanout(collect(expected));
+    graph.forEachFanout(index, collect(actual));
+    same &= expected == actual;
+    expected.clear();
+    actual.clear();
+    node.forEachFanin(collect(expected));
+    graph.forEachFanin(index, collect(actual));
+    same &= expected == actual;
+    circuit_edge_count += node.getFanoutCount();
+    return IterationContinue;
+  });
+  check(same, "CircuitGraph has the circuit's nodes, fanouts and fanins");
+  check(graph.getEdgeCount() == circuit_edge_count, "circuit edge count");
+
+  // One of the parallel edges to the first sink of node 0 goes.
+  uint32_t sink = UINT32_MAX;
+  uint32_t parallel = 0;
+  graph.forEachFanout(0, [&](const uint32_t fanout, const uint32_t count) {
+    sink = fanout;
+    parallel = count;
+    return IterationBreak;
+  });
+  if (sink != UINT32_MAX) {
+    check(graph.deleteEdge(0, sink), "deleteEdge() of an edge");
+    uint32_t left = 0;
+    graph.forEachFanin(sink, [&](const uint32_t fanin, const uint32_t count) {
+      left += fanin == 0 ? count : 0;
+      return IterationContinue;
+    });
+    check(left + 1 == parallel &&
+              graph.getEdgeCount() == circuit_edge_count - 1,
+          "deleteEdge() removes one edge both ways");
+  }
+}
+
+bool RecursiveGraphSelfTest::selfTest(void) {
+  _failure_count = 0;
+  testPromotion();
+  testRandomEdits(1, 1000);
+  testRandomEdits(100, 20000);
+  testRandomEdits(1000, 100000);
+  testCircuitGraph(200, 600);
+  testCircuitGraph(3000, 9000);
+  return _failure_count == 0;
+}
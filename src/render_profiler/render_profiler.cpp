@@ -0,0 +1,112 @@
+#include "render_profiler/render_profiler.hpp"
+
+uint64_t LatencyHistogram::getPercentileNs(const double percentile) const {
+  if (_count == 0) {
+    return 0;
+  }
+  const uint64_t rank = std::max<uint64_t>(
+      1, static_cast<uint64_t>(ceil(percentile / 100.0 * _count)));
+
+  uint64_t seen = 0;
+  for (uint32_t bucket = 0; bucket < BUCKET_COUNT; bucket++) {
+    seen += _buckets[bucket];
+    if (seen >= rank) {
+      const uint32_t octave = bucket / SUB_BUCKETS;
+      const uint64_t width = octave == 0 ? 1 : 1ull << (octave - 1);
+      const uint64_t middle = getBucketLowerBound(bucket) + width / 2;
+      return std::clamp(middle, getMinNs(), getMaxNs());
+    }
+  }
+  return _max_ns;
+}
+
+const char *RenderProfiler::getStageName(const RenderStage stage) {
+  switch (stage) {
+  case RenderStageDraw:
+    return "draw";
+  case RenderStageFlush:
+    return "flush";
+  case RenderStageReadback:
+    return "readback";
+  case RenderStageSend:
+    return "send";
+  case RenderStageEnd:
+    return "end";
+  default:
+    assert(0);
+    return "unknown";
+  }
+}
+
+static inline double nsToMs(const uint64_t ns) { return ns / 1.0e6; }
+
+// Frames per second the stage alone would allow.
+static inline double getStageFps(const LatencyHistogram &stage) {
+  if (stage.getTotalNs() == 0) {
+    return 0.0;
+  }
+  return stage.getCount() / (stage.getTotalNs() / 1.0e9);
+}
+
+void RenderProfiler::printReport(void) const {
+  const double wall_seconds =
+      std::chrono::duration<double>(Clock::now() - _export_start).count();
+
+  printf("RENDER_PROFILE: %lu frames in %.3f s, %.2f frames/sec\n", _frames,
+         wall_seconds, wall_seconds > 0.0 ? _frames / wall_seconds : 0.0);
+  printf("RENDER_PROFILE: %-9s %8s %10s %10s %10s %10s %12s\n", "stage",
+         "count", "p50 ms", "p95 ms", "p99 ms", "max ms", "frames/sec");
+
+  for (uint32_t i = FirstRenderStage; i <= LastRenderStage; i++) {
+    const RenderStage stage = static_cast<RenderStage>(i);
+    const LatencyHistogram &histogram = _stages[stage];
+    if (histogram.getCount() == 0) {
+      continue;
+    }
+    printf("RENDER_PROFILE: %-9s %8lu %10.3f %10.3f %10.3f %10.3f %12.2f\n",
+           getStageName(stage), histogram.getCount(),
+           nsToMs(histogram.getPercentileNs(50.0)),
+           nsToMs(histogram.getPercentileNs(95.0)),
+           nsToMs(histogram.getPercentileNs(99.0)),
+           nsToMs(histogram.getMaxNs()), getStageFps(histogram));
+  }
+}
+
+bool RenderProfiler::dumpJson(const char *path) const {
+  FILE *file = fopen(path, "w");
+  if (file == NULL) {
+    TraceLog(LOG_ERROR, "RENDER_PROFILE: could not create %s: %s", path,
+             strerror(errno));
+    return false;
+  }
+
+  const double wall_seconds =
+      std::chrono::duration<double>(Clock::now() - _export_start).count();
+  fprintf(file, "{\n  \"frames\": %lu,\n  \"wall_seconds\": %.6f,\n", _frames,
+          wall_seconds);
+  fprintf(file, "  \"stages\": {");
+
+  bool first = true;
+  for (uint32_t i = FirstRenderStage; i <= LastRenderStage; i++) {
+    const RenderStage stage = static_cast<RenderStage>(i);
+    const LatencyHistogram &histogram = _stages[stage];
+    fprintf(file,
+            "%s\n    \"%s\": {\"count\": %lu, \"total_ns\": %lu, "
+            "\"min_ns\": %lu, \"p50_ns\": %lu, \"p95_ns\": %lu, "
+            "\"p99_ns\": %lu, \"max_ns\": %lu, \"frames_per_sec\": %.3f}",
+            first ? "" : ",", getStageName(stage), histogram.getCount(),
+            histogram.getTotalNs(), histogram.getMinNs(),
+            histogram.getPercentileNs(50.0), histogram.getPercentileNs(95.0),
+            histogram.getPercentileNs(99.0), histogram.getMaxNs(),
+            getStageFps(histogram));
+    first = false;
+  }
+  fprintf(file, "\n  }\n}\n");
+
+  if (fclose(file) != 0) {
+    TraceLog(LOG_ERROR, "RENDER_PROFILE: could not write %s: %s", path,
+             strerror(errno));
+    return false;
+  }
+  return true;
+}
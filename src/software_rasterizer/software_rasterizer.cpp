@@ -0,0 +1,717 @@
+#include "software_rasterizer/software_rasterizer.hpp"
+#include "cpu_dispatch/cpu_dispatch.hpp"
+#include <immintrin.h>
+
+static inline uint32_t packColor(const Color color) {
+  return static_cast<uint32_t>(color.r) |
+         (static_cast<uint32_t>(color.g) << 8) |
+         (static_cast<uint32_t>(color.b) << 16) |
+         (static_cast<uint32_t>(color.a) << 24);
+}
+
+static inline uint32_t div255(const uint32_t x) {
+  const uint32_t t = x + 128;
+  return (t + (t >> 8)) >> 8;
+}
+
+static inline uint32_t blendPixel(const uint32_t dst, const Color color) {
+  const uint32_t a = color.a;
+  const uint32_t ia = 255 - a;
+  const uint32_t r = div255(color.r * a + (dst & 0xFF) * ia);
+  const uint32_t g = div255(color.g * a + ((dst >> 8) & 0xFF) * ia);
+  const uint32_t b = div255(color.b * a + ((dst >> 16) & 0xFF) * ia);
+  const uint32_t o = div255(255 * a + (dst >> 24) * ia);
+  return r | (g << 8) | (b << 16) | (o << 24);
+}
+
+////////////////////////////////////////////////////////////////////////////
+///                           SPAN FILLS                                 ///
+////////////////////////////////////////////////////////////////////////////
+TRY_TARGET_AVX2 static int32_t fillSpanAvx2(uint32_t *dst, const int32_t count,
+                                            const uint32_t pixel) {
+  const __m256i value = _mm256_set1_epi32(pixel);
+  int32_t i = 0;
+  for (; i + 8 <= count; i += 8) {
+    _mm256_storeu_si256(reinterpret_cast<__m256i *>(dst + i), value);
+  }
+  return i;
+}
+
+TRY_TARGET_AVX2 static int32_t
+blendSpanAvx2(uint32_t *dst, const int32_t count, const Color color) {
+  const uint16_t a = color.a;
+  const __m256i zero = _mm256_setzero_si256();
+  const __m256i inv_alpha = _mm256_set1_epi16(255 - a);
+  const __m256i src = _mm256_setr_epi16(
+      color.r * a + 128, color.g * a + 128, color.b * a + 128, 255 * a + 128,
+      color.r * a + 128, color.g * a + 128, color.b * a + 128, 255 * a + 128,
+      color.r * a + 128, color.g * a + 128, color.b * a + 128, 255 * a + 128,
+      color.r * a + 128, color.g * a + 128, color.b * a + 128, 255 * a + 128);
+  int32_t i = 0;
+  for (; i + 8 <= count; i += 8) {
+    const __m256i d =
+        _mm256_loadu_si256(reinterpret_cast<const __m256i *>(dst + i));
+    __m256i lo = _mm256_unpacklo_epi8(d, zero);
+    __m256i hi = _mm256_unpackhi_epi8(d, zero);
+    lo = _mm256_add_epi16(_mm256_mullo_epi16(lo, inv_alpha), src);
+    hi = _mm256_add_epi16(_mm256_mullo_epi16(hi, inv_alpha), src);
+    lo = _mm256_srli_epi16(_mm256_add_epi16(lo, _mm256_srli_epi16(lo, 8)), 8);
+    hi = _mm256_srli_epi16(_mm256_add_epi16(hi, _mm256_srli_epi16(hi, 8)), 8);
+    _mm256_storeu_si256(reinterpret_cast<__m256i *>(dst + i),
+                        _mm256_packus_epi16(lo, hi));
+  }
+  return i;
+}
+
+static void fillSpan(uint32_t *dst, const int32_t count, const uint32_t pixel) {
+  int32_t i = 0;
+  if (getCpuLevel() >= CpuLevelAvx2) {
+    i = fillSpanAvx2(dst, count, pixel);
+  }
+  for (; i < count; i++) {
+    dst[i] = pixel;
+  }
+}
+
+static void blendSpan(uint32_t *dst, const int32_t count, const Color color) {
+  if (count <= 0 || color.a == 0) {
+    return;
+  }
+  int32_t i = 0;
+  if (color.a == 255) {
+    fillSpan(dst, count, packColor(color));
+  } else {
+    if (getCpuLevel() >= CpuLevelAvx2) {
+      i = blendSpanAvx2(dst, count, color);
+    }
+    for (; i < count; i++) {
+      dst[i] = blendPixel(dst[i], color);
+    }
+  }
+}
+
+// Colors are interpolated linearly from inner (t = 0) to outer (t = 1),
+// the same way the vertex colors of raylib's triangle fan are.
+struct RadialGradient {
+  float cx;
+  float dy2;
+  float radius2;
+  float inv_radius;
+  float inner[4];
+  float delta[4];
+};
+
+static inline uint32_t blendRadialPixel(const uint32_t dst,
+                                        const RadialGradient &g,
+                                        const float d2) {
+  const float t = fminf(sqrtf(d2) * g.inv_radius, 1.0f);
+  const float a = (g.inner[3] + g.delta[3] * t) * (1.0f / 255.0f);
+  const float dr = dst & 0xFF;
+  const float dg = (dst >> 8) & 0xFF;
+  const float db = (dst >> 16) & 0xFF;
+  const float da = dst >> 24;
+  const uint32_t r = lrintf(dr + (g.inner[0] + g.delta[0] * t - dr) * a);
+  const uint32_t gg = lrintf(dg + (g.inner[1] + g.delta[1] * t - dg) * a);
+  const uint32_t b = lrintf(db + (g.inner[2] + g.delta[2] * t - db) * a);
+  const uint32_t o = lrintf(da + (255.0f - da) * a);
+  return r | (gg << 8) | (b << 16) | (o << 24);
+}
+
+TRY_TARGET_AVX2 static int32_t blendSpanRadialAvx2(uint32_t *row,
+                                                   const int32_t x0,
+                                                   const int32_t x1,
+                                                   const RadialGradient &g) {
+  const __m256 lane = _mm256_setr_ps(0.5f, 1.5f, 2.5f, 3.5f, 4.5f, 5.5f, 6.5f,
+                                     7.5f);
+  const __m256 dy2 = _mm256_set1_ps(g.dy2);
+  const __m256 radius2 = _mm256_set1_ps(g.radius2);
+  const __m256 inv_radius = _mm256_set1_ps(g.inv_radius);
+  const __m256 one = _mm256_set1_ps(1.0f);
+  const __m256 full = _mm256_set1_ps(255.0f);
+  const __m256 inv_full = _mm256_set1_ps(1.0f / 255.0f);
+  const __m256i byte_mask = _mm256_set1_epi32(0xFF);
+
+  int32_t x = x0;
+  for (; x + 8 <= x1; x += 8) {
+    const __m256 dx =
+        _mm256_sub_ps(_mm256_add_ps(_mm256_set1_ps(x), lane),
+                      _mm256_set1_ps(g.cx));
+    const __m256 d2 = _mm256_fmadd_ps(dx, dx, dy2);
+    const __m256 inside = _mm256_cmp_ps(d2, radius2, _CMP_LE_OQ);
+    const __m256 t =
+        _mm256_min_ps(_mm256_mul_ps(_mm256_sqrt_ps(d2), inv_radius), one);
+    const __m256 a = _mm256_and_ps(
+        inside,
+        _mm256_mul_ps(_mm256_fmadd_ps(_mm256_set1_ps(g.delta[3]), t,
+                                      _mm256_set1_ps(g.inner[3])),
+                      inv_full));
+
+    uint32_t *dst = row + x;
+    const __m256i d =
+        _mm256_loadu_si256(reinterpret_cast<const __m256i *>(dst));
+    __m256i out = _mm256_setzero_si256();
+    for (int32_t c = 0; c < 3; c++) {
+      const __m256 dc = _mm256_cvtepi32_ps(
+          _mm256_and_si256(_mm256_srli_epi32(d, 8 * c), byte_mask));
+      const __m256 sc = _mm256_fmadd_ps(_mm256_set1_ps(g.delta[c]), t,
+                                        _mm256_set1_ps(g.inner[c]));
+      const __m256 oc = _mm256_fmadd_ps(_mm256_sub_ps(sc, dc), a, dc);
+      out = _mm256_or_si256(
+          out, _mm256_slli_epi32(_mm256_cvtps_epi32(oc), 8 * c));
+    }
+    const __m256 da = _mm256_cvtepi32_ps(_mm256_srli_epi32(d, 24));
+    const __m256 oa = _mm256_fmadd_ps(_mm256_sub_ps(full, da), a, da);
+    out = _mm256_or_si256(out, _mm256_slli_epi32(_mm256_cvtps_epi32(oa), 24));
+    _mm256_storeu_si256(reinterpret_cast<__m256i *>(dst), out);
+  }
+  return x;
+}
+
+static void blendSpanRadial(uint32_t *row, const int32_t x0, const int32_t x1,
+                            const RadialGradient &g) {
+  int32_t x = x0;
+  if (getCpuLevel() >= CpuLevelAvx2) {
+    x = blendSpanRadialAvx2(row, x0, x1, g);
+  }
+  for (; x < x1; x++) {
+    const float dx = x + 0.5f - g.cx;
+    const float d2 = dx * dx + g.dy2;
+    if (d2 <= g.radius2) {
+      row[x] = blendRadialPixel(row[x], g, d2);
+    }
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////
+///                          PRIMITIVES                                  ///
+////////////////////////////////////////////////////////////////////////////
+struct TileClip {
+  int32_t x0;
+  int32_t y0;
+  int32_t x1;
+  int32_t y1;
+};
+
+static inline TileClip clipCommand(const SoftwareDrawCommand &command,
+                                   const TileClip &tile) {
+  return {.x0 = std::max(command.x0, tile.x0),
+          .y0 = std::max(command.y0, tile.y0),
+          .x1 = std::min(command.x1, tile.x1),
+          .y1 = std::min(command.y1, tile.y1)};
+}
+
+static void rasterizeRectangleGradientV(uint32_t *pixels, const int32_t stride,
+                                        const SoftwareDrawCommand &command,
+                                        const TileClip &clip) {
+  const float height = command.f1;
+  for (int32_t y = clip.y0; y < clip.y1; y++) {
+    const float t =
+        Clamp((y + 0.5f - command.p1.y) / height, 0.0f, 1.0f);
+    const Color color = {
+        .r = static_cast<uint8_t>(Lerp(command.color1.r, command.color2.r, t)),
+        .g = static_cast<uint8_t>(Lerp(command.color1.g, command.color2.g, t)),
+        .b = static_cast<uint8_t>(Lerp(command.color1.b, command.color2.b, t)),
+        .a = static_cast<uint8_t>(Lerp(command.color1.a, command.color2.a, t))};
+    blendSpan(pixels + y * stride + clip.x0, clip.x1 - clip.x0, color);
+  }
+}
+
+static void rasterizeCircleGradient(uint32_t *pixels, const int32_t stride,
+                                    const SoftwareDrawCommand &command,
+                                    const TileClip &clip) {
+  const float radius = command.f1;
+  RadialGradient g;
+  g.cx = command.p1.x;
+  g.radius2 = radius * radius;
+  g.inv_radius = 1.0f / radius;
+  g.inner[0] = command.color1.r;
+  g.inner[1] = command.color1.g;
+  g.inner[2] = command.color1.b;
+  g.inner[3] = command.color1.a;
+  g.delta[0] = command.color2.r - g.inner[0];
+  g.delta[1] = command.color2.g - g.inner[1];
+  g.delta[2] = command.color2.b - g.inner[2];
+  g.delta[3] = command.color2.a - g.inner[3];
+
+  for (int32_t y = clip.y0; y < clip.y1; y++) {
+    const float dy = y + 0.5f - command.p1.y;
+    g.dy2 = dy * dy;
+    if (g.dy2 > g.radius2) {
+      continue;
+    }
+    const float half_span = sqrtf(g.radius2 - g.dy2);
+    const int32_t x0 =
+        std::max(clip.x0, static_cast<int32_t>(floorf(g.cx - half_span)));
+    const int32_t x1 =
+        std::min(clip.x1, static_cast<int32_t>(ceilf(g.cx + half_span)));
+    if (x0 < x1) {
+      blendSpanRadial(pixels + y * stride, x0, x1, g);
+    }
+  }
+}
+
+static void rasterizeCircleLines(uint32_t *pixels, const int32_t stride,
+                                 const SoftwareDrawCommand &command,
+                                 const TileClip &clip) {
+  const float outer = command.f1 + 0.5f;
+  const float inner = std::max(command.f1 - 0.5f, 0.0f);
+  const float outer2 = outer * outer;
+  const float inner2 = inner * inner;
+  for (int32_t y = clip.y0; y < clip.y1; y++) {
+    const float dy = y + 0.5f - command.p1.y;
+    uint32_t *row = pixels + y * stride;
+    for (int32_t x = clip.x0; x < clip.x1; x++) {
+      const float dx = x + 0.5f - command.p1.x;
+      const float d2 = dx * dx + dy * dy;
+      if (d2 <= outer2 && d2 >= inner2) {
+        row[x] = blendPixel(row[x], command.color1);
+      }
+    }
+  }
+}
+
+static void rasterizeThickLine(uint32_t *pixels, const int32_t stride,
+                               const SoftwareDrawCommand &command,
+                               const TileClip &clip) {
+  const Vector2 a = command.p1;
+  const Vector2 ab = Vector2Subtract(command.p2, command.p1);
+  const float ab_len2 = Vector2DotProduct(ab, ab);
+  const float inv_ab_len2 = ab_len2 > 0.0f ? 1.0f / ab_len2 : 0.0f;
+  const float half_thick2 = command.f1 * command.f1 * 0.25f;
+
+  for (int32_t y = clip.y0; y < clip.y1; y++) {
+    uint32_t *row = pixels + y * stride;
+    int32_t run_start = -1;
+    for (int32_t x = clip.x0; x <= clip.x1; x++) {
+      bool inside = false;
+      if (x < clip.x1) {
+        const Vector2 ap = {.x = x + 0.5f - a.x, .y = y + 0.5f - a.y};
+        const float t =
+            Clamp(Vector2DotProduct(ap, ab) * inv_ab_len2, 0.0f, 1.0f);
+        const float ex = ap.x - ab.x * t;
+        const float ey = ap.y - ab.y * t;
+        inside = (ex * ex + ey * ey) <= half_thick2;
+      }
+      if (inside && run_start < 0) {
+        run_start = x;
+      } else if (!inside && run_start >= 0) {
+        blendSpan(row + run_start, x - run_start, command.color1);
+        run_start = -1;
+      }
+    }
+  }
+}
+
+static inline float edgeFunction(const Vector2 a, const Vector2 b,
+                                 const float px, const float py) {
+  return (b.x - a.x) * (py - a.y) - (b.y - a.y) * (px - a.x);
+}
+
+static void rasterizeTriangle(uint32_t *pixels, const int32_t stride,
+                              const SoftwareDrawCommand &command,
+                              const TileClip &clip) {
+  const Vector2 v1 = command.p1;
+  Vector2 v2 = command.p2;
+  Vector2 v3 = command.p3;
+  if (edgeFunction(v1, v2, v3.x, v3.y) < 0.0f) {
+    std::swap(v2, v3);
+  }
+
+  for (int32_t y = clip.y0; y < clip.y1; y++) {
+    uint32_t *row = pixels + y * stride;
+    const float py = y + 0.5f;
+    int32_t run_start = -1;
+    for (int32_t x = clip.x0; x <= clip.x1; x++) {
+      bool inside = false;
+      if (x < clip.x1) {
+        const float px = x + 0.5f;
+        inside = edgeFunction(v1, v2, px, py) >= 0.0f &&
+                 edgeFunction(v2, v3, px, py) >= 0.0f &&
+                 edgeFunction(v3, v1, px, py) >= 0.0f;
+      }
+      if (inside && run_start < 0) {
+        run_start = x;
+      } else if (!inside && run_start >= 0) {
+        blendSpan(row + run_start, x - run_start, command.color1);
+        run_start = -1;
+      }
+    }
+  }
+}
+
+static void rasterizeGlyph(uint32_t *pixels, const int32_t stride,
+                           const SoftwareDrawCommand &command,
+                           const SoftwareGlyph &glyph, const TileClip &clip) {
+  const float inv_scale = 1.0f / command.f1;
+  for (int32_t y = clip.y0; y < clip.y1; y++) {
+    const int32_t gy =
+        static_cast<int32_t>((y + 0.5f - command.p1.y) * inv_scale);
+    if (gy < 0 || gy >= glyph.height) {
+      continue;
+    }
+    const uint8_t *alpha_row = glyph.alpha + gy * glyph.width;
+    uint32_t *row = pixels + y * stride;
+    for (int32_t x = clip.x0; x < clip.x1; x++) {
+      const int32_t gx =
+          static_cast<int32_t>((x + 0.5f - command.p1.x) * inv_scale);
+      if (gx < 0 || gx >= glyph.width || alpha_row[gx] == 0) {
+        continue;
+      }
+      Color color = command.color1;
+      color.a = div255(color.a * alpha_row[gx]);
+      row[x] = blendPixel(row[x], color);
+    }
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////
+///                         RASTERIZER                                   ///
+////////////////////////////////////////////////////////////////////////////
+SoftwareRasterizer::SoftwareRasterizer(const int32_t width,
+                                       const int32_t height,
+                                       const uint32_t thread_count)
+    : _width(width), _height(height),
+      _tile_columns((width + TILE_SIZE - 1) / TILE_SIZE),
+      _tile_rows((height + TILE_SIZE - 1) / TILE_SIZE), _font_data(nullptr),
+      _pool(thread_count) {
+  assert(width > 0 && height > 0);
+  _pixels = static_cast<uint32_t *>(
+      aligned_malloc(sizeof(uint32_t) * _width * _height, 32));
+  assert(_pixels != NULL && "Buy MORE RAM lol!!");
+  memset(_pixels, 0, sizeof(uint32_t) * _width * _height);
+
+  _tile_bins.resize(_tile_columns * _tile_rows);
+  _tile_dirty.resize(_tile_columns * _tile_rows, 1);
+
+  loadGlyphs(RaylibDrawBackend::FONT_PATH);
+}
+
+SoftwareRasterizer::~SoftwareRasterizer(void) {
+  if (_font_data != nullptr) {
+    UnloadFontData(_font_data, FONT_CODEPOINT_COUNT);
+  }
+  free(_pixels);
+}
+
+void SoftwareRasterizer::loadGlyphs(const char *font_path) {
+  int data_size = 0;
+  unsigned char *data = LoadFileData(font_path, &data_size);
+  if (data == NULL) {
+    TraceLog(LOG_WARNING, "RASTERIZER: could not load font %s, glyphs are "
+                          "not drawn",
+             font_path);
+    return;
+  }
+
+  // LoadFontData() rasterizes with stb_truetype only, unlike LoadFont() it
+  // does not upload an atlas texture and so works without a GL context.
+  _font_data = LoadFontData(data, data_size, FONT_BASE_SIZE, NULL,
+                            FONT_CODEPOINT_COUNT, FONT_DEFAULT);
+  UnloadFileData(data);
+  if (_font_data == NULL) {
+    return;
+  }
+
+  for (int32_t i = 0; i < FONT_CODEPOINT_COUNT; i++) {
+    const GlyphInfo &info = _font_data[i];
+    assert(info.image.format == PIXELFORMAT_UNCOMPRESSED_GRAYSCALE);
+    _glyphs.push_back({.codepoint = info.value,
+                       .offset_x = info.offsetX,
+                       .offset_y = info.offsetY,
+                       .width = info.image.width,
+                       .height = info.image.height,
+                       .alpha = static_cast<uint8_t *>(info.image.data)});
+  }
+}
+
+inline void SoftwareRasterizer::pushCommand(const SoftwareDrawCommand &command) {
+  SoftwareDrawCommand clipped = command;
+  clipped.x0 = std::max(clipped.x0, 0);
+  clipped.y0 = std::max(clipped.y0, 0);
+  clipped.x1 = std::min(clipped.x1, _width);
+  clipped.y1 = std::min(clipped.y1, _height);
+  if (clipped.x0 >= clipped.x1 || clipped.y0 >= clipped.y1) {
+    return;
+  }
+  _commands.push_back(clipped);
+}
+
+void SoftwareRasterizer::beginFrame(void) { _commands.clear(); }
+
+void SoftwareRasterizer::endFrame(void) {
+  std::fill(_tile_dirty.begin(), _tile_dirty.end(), 1);
+  rasterizeDirtyTiles();
+}
+
+void SoftwareRasterizer::endFrame(const std::vector<Rectangle> &damage) {
+  std::fill(_tile_dirty.begin(), _tile_dirty.end(), 0);
+  for (const Rectangle &rect : damage) {
+    const int32_t x0 = std::max(static_cast<int32_t>(floorf(rect.x)), 0);
+    const int32_t y0 = std::max(static_cast<int32_t>(floorf(rect.y)), 0);
+    const int32_t x1 =
+        std::min(static_cast<int32_t>(ceilf(rect.x + rect.width)), _width);
+    const int32_t y1 =
+        std::min(static_cast<int32_t>(ceilf(rect.y + rect.height)), _height);
+    if (x0 >= x1 || y0 >= y1) {
+      continue;
+    }
+    for (int32_t ty = y0 / TILE_SIZE; ty <= (y1 - 1) / TILE_SIZE; ty++) {
+      for (int32_t tx = x0 / TILE_SIZE; tx <= (x1 - 1) / TILE_SIZE; tx++) {
+        _tile_dirty[ty * _tile_columns + tx] = 1;
+      }
+    }
+  }
+  rasterizeDirtyTiles();
+}
+
+void SoftwareRasterizer::rasterizeDirtyTiles(void) {
+  _dirty_tiles.clear();
+  for (int32_t tile = 0; tile < _tile_columns * _tile_rows; tile++) {
+    _tile_bins[tile].clear();
+    if (_tile_dirty[tile]) {
+      _dirty_tiles.push_back(tile);
+    }
+  }
+  if (_dirty_tiles.empty()) {
+    return;
+  }
+
+  for (uint32_t i = 0; i < _commands.size(); i++) {
+    const SoftwareDrawCommand &command = _commands[i];
+    const int32_t tx0 = command.x0 / TILE_SIZE;
+    const int32_t ty0 = command.y0 / TILE_SIZE;
+    const int32_t tx1 = (command.x1 - 1) / TILE_SIZE;
+    const int32_t ty1 = (command.y1 - 1) / TILE_SIZE;
+    for (int32_t ty = ty0; ty <= ty1; ty++) {
+      for (int32_t tx = tx0; tx <= tx1; tx++) {
+        const int32_t tile = ty * _tile_columns + tx;
+        if (_tile_dirty[tile]) {
+          _tile_bins[tile].push_back(i);
+        }
+      }
+    }
+  }
+
+  _pool.parallelFor(_dirty_tiles.size(), [this](const uint32_t index) {
+    rasterizeTile(_dirty_tiles[index]);
+  });
+}
+
+void SoftwareRasterizer::rasterizeTile(const int32_t tile) {
+  const int32_t tx = tile % _tile_columns;
+  const int32_t ty = tile / _tile_columns;
+  const TileClip tile_clip = {.x0 = tx * TILE_SIZE,
+                              .y0 = ty * TILE_SIZE,
+                              .x1 = std::min((tx + 1) * TILE_SIZE, _width),
+                              .y1 = std::min((ty + 1) * TILE_SIZE, _height)};
+
+  for (const uint32_t index : _tile_bins[tile]) {
+    const SoftwareDrawCommand &command = _commands[index];
+    const TileClip clip = clipCommand(command, tile_clip);
+
+    switch (command.type) {
+    case SoftwareDrawClear:
+      for (int32_t y = clip.y0; y < clip.y1; y++) {
+        fillSpan(_pixels + y * _width + clip.x0, clip.x1 - clip.x0,
+                 packColor(command.color1));
+      }
+      break;
+    case SoftwareDrawRectangleGradientV:
+      rasterizeRectangleGradientV(_pixels, _width, command, clip);
+      break;
+    case SoftwareDrawCircleGradient:
+      rasterizeCircleGradient(_pixels, _width, command, clip);
+      break;
+    case SoftwareDrawCircleLines:
+      rasterizeCircleLines(_pixels, _width, command, clip);
+      break;
+    case SoftwareDrawThickLine:
+      rasterizeThickLine(_pixels, _width, command, clip);
+      break;
+    case SoftwareDrawTriangle:
+      rasterizeTriangle(_pixels, _width, command, clip);
+      break;
+    case SoftwareDrawGlyph:
+      rasterizeGlyph(_pixels, _width, command, _glyphs[command.glyph], clip);
+      break;
+    default:
+      assert(0);
+      break;
+    }
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////
+///                         DRAW BACKEND                                 ///
+////////////////////////////////////////////////////////////////////////////
+void SoftwareRasterizer::clearBackground(const Color color) {
+  SoftwareDrawCommand command = {};
+  command.type = SoftwareDrawClear;
+  command.x1 = _width;
+  command.y1 = _height;
+  command.color1 = color;
+  pushCommand(command);
+}
+
+void SoftwareRasterizer::drawRectangleGradientV(const Rectangle rect,
+                                                const Color top,
+                                                const Color bottom) {
+  SoftwareDrawCommand command = {};
+  command.type = SoftwareDrawRectangleGradientV;
+  command.x0 = static_cast<int32_t>(floorf(rect.x));
+  command.y0 = static_cast<int32_t>(floorf(rect.y));
+  command.x1 = static_cast<int32_t>(ceilf(rect.x + rect.width));
+  command.y1 = static_cast<int32_t>(ceilf(rect.y + rect.height));
+  command.color1 = top;
+  command.color2 = bottom;
+  command.p1 = {.x = rect.x, .y = rect.y};
+  command.f1 = rect.height;
+  pushCommand(command);
+}
+
+void SoftwareRasterizer::drawRectangleLines(const Rectangle rect,
+                                            const float thick,
+                                            const Color color) {
+  const Rectangle sides[4] = {
+      {.x = rect.x, .y = rect.y, .width = rect.width, .height = thick},
+      {.x = rect.x,
+       .y = rect.y + rect.height - thick,
+       .width = rect.width,
+       .height = thick},
+      {.x = rect.x,
+       .y = rect.y + thick,
+       .width = thick,
+       .height = rect.height - 2 * thick},
+      {.x = rect.x + rect.width - thick,
+       .y = rect.y + thick,
+       .width = thick,
+       .height = rect.height - 2 * thick}};
+  for (const Rectangle &side : sides) {
+    drawRectangleGradientV(side, color, color);
+  }
+}
+
+void SoftwareRasterizer::drawCircleGradient(const Vector2 center,
+                                            const float radius,
+                                            const Color inner,
+                                            const Color outer) {
+  if (radius <= 0.0f) {
+    return;
+  }
+  SoftwareDrawCommand command = {};
+  command.type = SoftwareDrawCircleGradient;
+  command.x0 = static_cast<int32_t>(floorf(center.x - radius));
+  command.y0 = static_cast<int32_t>(floorf(center.y - radius));
+  command.x1 = static_cast<int32_t>(ceilf(center.x + radius)) + 1;
+  command.y1 = static_cast<int32_t>(ceilf(center.y + radius)) + 1;
+  command.color1 = inner;
+  command.color2 = outer;
+  command.p1 = center;
+  command.f1 = radius;
+  pushCommand(command);
+}
+
+void SoftwareRasterizer::drawCircleLines(const Vector2 center,
+                                         const float radius,
+                                         const Color color) {
+  if (radius <= 0.0f) {
+    return;
+  }
+  SoftwareDrawCommand command = {};
+  command.type = SoftwareDrawCircleLines;
+  command.x0 = static_cast<int32_t>(floorf(center.x - radius - 1.0f));
+  command.y0 = static_cast<int32_t>(floorf(center.y - radius - 1.0f));
+  command.x1 = static_cast<int32_t>(ceilf(center.x + radius + 1.0f)) + 1;
+  command.y1 = static_cast<int32_t>(ceilf(center.y + radius + 1.0f)) + 1;
+  command.color1 = color;
+  command.p1 = center;
+  command.f1 = radius;
+  pushCommand(command);
+}
+
+void SoftwareRasterizer::drawSplineBezierQuadratic(const Vector2 *points,
+                                                   const size_t point_count,
+                                                   const float thick,
+                                                   const Color color) {
+  if (point_count < 3) {
+    return;
+  }
+  const float half_thick = thick * 0.5f;
+
+  // Same flattening as raylib: SPLINE_SEGMENT_DIVISIONS lines per segment,
+  // every line rasterized as a capsule of the stroke thickness.
+  for (size_t i = 0; i + 2 < point_count; i += 2) {
+    Vector2 prev = points[i];
+    for (uint32_t d = 1; d <= BEZIER_SEGMENT_DIVISIONS; d++) {
+      const float t = static_cast<float>(d) / BEZIER_SEGMENT_DIVISIONS;
+      const Vector2 curr =
+          GetSplinePointBezierQuad(points[i], points[i + 1], points[i + 2], t);
+
+      SoftwareDrawCommand command = {};
+      command.type = SoftwareDrawThickLine;
+      command.x0 =
+          static_cast<int32_t>(floorf(fminf(prev.x, curr.x) - half_thick));
+      command.y0 =
+          static_cast<int32_t>(floorf(fminf(prev.y, curr.y) - half_thick));
+      command.x1 =
+          static_cast<int32_t>(ceilf(fmaxf(prev.x, curr.x) + half_thick)) + 1;
+      command.y1 =
+          static_cast<int32_t>(ceilf(fmaxf(prev.y, curr.y) + half_thick)) + 1;
+      command.color1 = color;
+      command.p1 = prev;
+      command.p2 = curr;
+      command.f1 = thick;
+      pushCommand(command);
+
+      prev = curr;
+    }
+  }
+}
+
+void SoftwareRasterizer::drawTriangle(const Vector2 v1, const Vector2 v2,
+                                      const Vector2 v3, const Color color) {
+  SoftwareDrawCommand command = {};
+  command.type = SoftwareDrawTriangle;
+  command.x0 = static_cast<int32_t>(floorf(fminf(v1.x, fminf(v2.x, v3.x))));
+  command.y0 = static_cast<int32_t>(floorf(fminf(v1.y, fminf(v2.y, v3.y))));
+  command.x1 =
+      static_cast<int32_t>(ceilf(fmaxf(v1.x, fmaxf(v2.x, v3.x)))) + 1;
+  command.y1 =
+      static_cast<int32_t>(ceilf(fmaxf(v1.y, fmaxf(v2.y, v3.y)))) + 1;
+  command.color1 = color;
+  command.p1 = v1;
+  command.p2 = v2;
+  command.p3 = v3;
+  pushCommand(command);
+}
+
+void SoftwareRasterizer::drawTextCodepoint(const int codepoint,
+                                           const Vector2 position,
+                                           const float font_size,
+                                           const Color color) {
+  const int32_t index = codepoint - FONT_FIRST_CODEPOINT;
+  if (index < 0 || index >= static_cast<int32_t>(_glyphs.size()) ||
+      font_size <= 0.0f) {
+    return;
+  }
+  const SoftwareGlyph &glyph = _glyphs[index];
+
+  // Placement follows raylib's DrawTextCodepoint(): the glyph padding of
+  // the atlas cancels out, leaving offset and bitmap size scaled.
+  const float scale = font_size / FONT_BASE_SIZE;
+  const Vector2 origin = {.x = position.x + glyph.offset_x * scale,
+                          .y = position.y + glyph.offset_y * scale};
+
+  SoftwareDrawCommand command = {};
+  command.type = SoftwareDrawGlyph;
+  command.x0 = static_cast<int32_t>(floorf(origin.x));
+  command.y0 = static_cast<int32_t>(floorf(origin.y));
+  command.x1 = static_cast<int32_t>(ceilf(origin.x + glyph.width * scale)) + 1;
+  command.y1 =
+      static_cast<int32_t>(ceilf(origin.y + glyph.height * scale)) + 1;
+  command.color1 = color;
+  command.p1 = origin;
+  command.f1 = scale;
+  command.glyph = index;
+  pushCommand(command);
+}
@@ -0,0 +1,142 @@
+#include "software_rasterizer/software_rasterizer_self_test.hpp"
+#include "cpu_dispatch/cpu_dispatch.hpp"
+
+uint64_t SoftwareRasterizerSelfTest::nextRandom(void) {
+  // SplitMix64, identical sequence on every platform.
+  uint64_t z = (_random_state += 0x9e3779b97f4a7c15ull);
+  z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ull;
+  z = (z ^ (z >> 27)) * 0x94d049bb133111ebull;
+  return z ^ (z >> 31);
+}
+
+void SoftwareRasterizerSelfTest::check(const bool condition,
+                                       const char *what) {
+  if (!condition) {
+    fprintf(stderr, "SOFTWARE_RASTERIZER: self test failed: %s\n", what);
+    _failure_count++;
+  }
+}
+
+// Opaque, invisible and translucent in about equal parts, opaque spans take
+// the fill kernel and translucent ones the blend kernel.
+Color SoftwareRasterizerSelfTest::randomColor(void) {
+  const uint64_t r = nextRandom();
+  const uint8_t alphas[] = {255, 0, static_cast<uint8_t>(r >> 56)};
+  return {.r = static_cast<uint8_t>(r),
+          .g = static_cast<uint8_t>(r >> 8),
+          .b = static_cast<uint8_t>(r >> 16),
+          .a = alphas[(r >> 32) % 3]};
+}
+
+// Random shapes of every kind partly off the target, so spans start and end
+// at every offset of a vector and get clipped.
+void SoftwareRasterizerSelfTest::drawScene(SoftwareRasterizer &rasterizer,
+                                           const bool gradients) {
+  const float width = rasterizer.getWidth();
+  const float height = rasterizer.getHeight();
+  const auto x = [&](void) { return (nextRandom() % 1200) / 1000.0f * width; };
+  const auto y = [&](void) {
+    return (nextRandom() % 1200) / 1000.0f * height - 0.1f * height;
+  };
+
+  rasterizer.beginFrame();
+  rasterizer.clearBackground(randomColor());
+  for (uint32_t i = 0; i < 24; i++) {
+    const Rectangle rect = {.x = x() - 0.1f * width,
+                            .y = y(),
+                            .width = x() / 2,
+                            .height = y() / 2 + 1};
+    switch (nextRandom() % (gradients ? 5 : 4)) {
+    case 0:
+      rasterizer.drawRectangleGradientV(rect, randomColor(), randomColor());
+      break;
+    case 1:
+      rasterizer.drawRectangleLines(rect, 1 + nextRandom() % 4,
+                                    randomColor());
+      break;
+    case 2:
+      rasterizer.drawTriangle({.x = x(), .y = y()}, {.x = x(), .y = y()},
+                              {.x = x(), .y = y()}, randomColor());
+      break;
+    case 3: {
+      const Vector2 points[3] = {
+          {.x = x(), .y = y()}, {.x = x(), .y = y()}, {.x = x(), .y = y()}};
+      rasterizer.drawSplineBezierQuadratic(points, 3, 1 + nextRandom() % 6,
+                                           randomColor());
+      break;
+    }
+    default:
+      rasterizer.drawCircleGradient({.x = x(), .y = y()}, x() / 3,
+                                    randomColor(), randomColor());
+      rasterizer.drawCircleLines({.x = x(), .y = y()}, x() / 4,
+                                 randomColor());
+      break;
+    }
+  }
+  rasterizer.drawTextCodepoint('A', {.x = x(), .y = y()}, 20, randomColor());
+  rasterizer.endFrame();
+}
+
+// Known results of the blend arithmetic on spans longer than a vector.
+void SoftwareRasterizerSelfTest::testSpans(void) {
+  SoftwareRasterizer rasterizer(37, 3, 1);
+  rasterizer.beginFrame();
+  rasterizer.clearBackground({.r = 0, .g = 0, .b = 0, .a = 255});
+  rasterizer.drawRectangleGradientV(
+      {.x = 0, .y = 1, .width = 37, .height = 1},
+      {.r = 255, .g = 255, .b = 255, .a = 128},
+      {.r = 255, .g = 255, .b = 255, .a = 128});
+  rasterizer.endFrame();
+
+  bool blended = true;
+  for (int32_t x = 0; x < 37; x++) {
+    blended &= rasterizer.getPixels()[x] == 0xFF000000 &&
+               rasterizer.getPixels()[37 + x] == 0xFF808080 &&
+               rasterizer.getPixels()[74 + x] == 0xFF000000;
+  }
+  check(blended, "white at alpha 128 over black is 128 gray");
+}
+
+// The same scene at the current level and with the scalar kernels. Fills
+// and blends are integer arithmetic and agree exactly, radial gradients
+// evaluate the same float expressions with fused multiply-adds and may end
+// up 1 apart per channel.
+void SoftwareRasterizerSelfTest::testLevels(const int32_t width,
+                                            const int32_t height,
+                                            const bool gradients) {
+  const uint64_t scene = _random_state;
+  SoftwareRasterizer vector(width, height, 2);
+  drawScene(vector, gradients);
+
+  const CpuLevel level = getCpuLevel();
+  setCpuLevelLimit(FirstCpuLevel);
+  _random_state = scene;
+  SoftwareRasterizer scalar(width, height, 2);
+  drawScene(scalar, gradients);
+  setCpuLevelLimit(level);
+
+  uint32_t max_difference = 0;
+  for (int32_t i = 0; i < width * height; i++) {
+    for (uint32_t shift = 0; shift < 32; shift += 8) {
+      const int32_t a = (vector.getPixels()[i] >> shift) & 0xFF;
+      const int32_t b = (scalar.getPixels()[i] >> shift) & 0xFF;
+      max_difference = std::max<uint32_t>(max_difference, abs(a - b));
+    }
+  }
+  check(max_difference <= (gradients ? 1 : 0),
+        "span kernels match the scalar path");
+}
+
+bool SoftwareRasterizerSelfTest::selfTest(void) {
+  _failure_count = 0;
+  testSpans();
+  // Widths on both sides of a vector of 8 pixels and of a tile.
+  const int32_t sizes[][2] = {{1, 1}, {7, 5}, {9, 9}, {77, 45}, {130, 70}};
+  for (const auto &size : sizes) {
+    for (uint32_t i = 0; i < 4; i++) {
+      testLevels(size[0], size[1], false);
+      testLevels(size[0], size[1], true);
+    }
+  }
+  return _failure_count == 0;
+}
@@ -0,0 +1,244 @@
+#include "trace_events/trace_events.hpp"
+#include <chrono>
+
+std::atomic<uint32_t> TraceEvents::_categories(0);
+
+namespace {
+
+// Single producer ring: only the owning thread writes events and bumps
+// head, writeChromeTrace() reads whatever head it observes.
+struct ThreadTraceBuffer {
+  static constexpr uint64_t CAPACITY = 1 << 15;
+
+  uint32_t thread_index;
+  std::atomic<uint64_t> head;
+  TraceEvent events[CAPACITY];
+};
+
+std::mutex trace_buffers_mutex;
+// Every buffer ever handed out, in the order they were, never freed: their
+// events are written with the trace even after their threads exited.
+std::vector<ThreadTraceBuffer *> trace_buffers;
+// Buffers of exited threads. The next new thread records after their events,
+// so exports that start fresh workers for every segment reuse the same few
+// buffers instead of adding one per thread, and the old events stay until
+// the ring wraps like any other thread's.
+std::vector<ThreadTraceBuffer *> free_trace_buffers;
+thread_local ThreadTraceBuffer *thread_trace_buffer = NULL;
+
+// Constructed by the first event of a thread only, so recording does not pay
+// for a thread_local with a destructor on every event.
+struct ThreadTraceBufferRelease {
+  ~ThreadTraceBufferRelease(void) {
+    std::lock_guard<std::mutex> lock(trace_buffers_mutex);
+    free_trace_buffers.push_back(thread_trace_buffer);
+    thread_trace_buffer = NULL;
+  }
+};
+
+const std::chrono::steady_clock::time_point trace_epoch =
+    std::chrono::steady_clock::now();
+
+ThreadTraceBuffer *getThreadTraceBuffer(void) {
+  if (thread_trace_buffer == NULL) {
+    std::unique_lock<std::mutex> lock(trace_buffers_mutex);
+    ThreadTraceBuffer *buffer = NULL;
+    if (!free_trace_buffers.empty()) {
+      buffer = free_trace_buffers.back();
+      free_trace_buffers.pop_back();
+    } else {
+      buffer = new ThreadTraceBuffer;
+      assert(buffer != NULL && "Buy MORE RAM lol!!");
+      buffer->head.store(0, std::memory_order_relaxed);
+      buffer->thread_index = trace_buffers.size();
+      trace_buffers.push_back(buffer);
+    }
+    thread_trace_buffer = buffer;
+    lock.unlock();
+
+    static thread_local ThreadTraceBufferRelease release;
+    (void)release;
+  }
+  return thread_trace_buffer;
+}
+
+void recordEvent(const uint32_t category, const char *name, const char phase,
+                 const uint64_t start_ns, const uint64_t duration_ns,
+                 const TraceArg *args, const size_t arg_count) {
+  ThreadTraceBuffer *buffer = getThreadTraceBuffer();
+  const uint64_t head = buffer->head.load(std::memory_order_relaxed);
+  TraceEvent &event = buffer->events[head % ThreadTraceBuffer::CAPACITY];
+
+  event.name = name;
+  event.category = category;
+  event.phase = phase;
+  event.start_ns = start_ns;
+  event.duration_ns = duration_ns;
+  event.arg_count = std::min<size_t>(arg_count, TraceEvent::MAX_ARGS);
+  for (uint32_t i = 0; i < event.arg_count; i++) {
+    event.args[i] = args[i];
+  }
+
+  buffer->head.store(head + 1, std::memory_order_release);
+}
+
+const char *getCategoryName(const uint32_t category) {
+  switch (category) {
+  case TraceCategoryModel:
+    return "model";
+  case TraceCategoryLayout:
+    return "layout";
+  case TraceCategoryLayoutDetail:
+    return "layout_detail";
+  case TraceCategoryRender:
+    return "render";
+  default:
+    return "unknown";
+  }
+}
+
+void writeJsonString(FILE *file, const char *string) {
+  fputc('"', file);
+  for (const char *c = string; *c != '\0'; c++) {
+    if (*c == '"' || *c == '\\') {
+      fputc('\\', file);
+    }
+    fputc(*c, file);
+  }
+  fputc('"', file);
+}
+
+void writeEvent(FILE *file, const TraceEvent &event, const int pid,
+                const uint32_t thread_index) {
+  fprintf(file, ",\n{\"name\": ");
+  writeJsonString(file, event.name);
+  fprintf(file,
+          ", \"cat\": \"%s\", \"ph\": \"%c\", \"ts\": %.3f, \"pid\": %d, "
+          "\"tid\": %u",
+          getCategoryName(event.category), event.phase,
+          event.start_ns / 1000.0, pid, thread_index);
+  if (event.phase == 'X') {
+    fprintf(file, ", \"dur\": %.3f", event.duration_ns / 1000.0);
+  } else {
+    fprintf(file, ", \"s\": \"t\"");
+  }
+
+  if (event.arg_count > 0) {
+    fprintf(file, ", \"args\": {");
+    for (uint32_t i = 0; i < event.arg_count; i++) {
+      fprintf(file, "%s", i == 0 ? "" : ", ");
+      writeJsonString(file, event.args[i].name);
+      fprintf(file, ": %.17g", event.args[i].value);
+    }
+    fprintf(file, "}");
+  }
+  fprintf(file, "}");
+}
+
+} // namespace
+
+bool parseTraceCategories(const char *names, uint32_t &categories) {
+  uint32_t parsed = 0;
+  const char *name = names;
+  for (;;) {
+    const size_t length = strcspn(name, ",");
+    const std::string token(name, length);
+    if (token == "all") {
+      parsed |= TraceCategoryAll;
+    } else {
+      uint32_t category = TraceCategoryModel;
+      while (category <= TraceCategoryRender &&
+             token != getCategoryName(category)) {
+        category <<= 1;
+      }
+      if (category > TraceCategoryRender) {
+        return false;
+      }
+      parsed |= category;
+    }
+    if (name[length] == '\0') {
+      break;
+    }
+    name += length + 1;
+  }
+  categories = parsed;
+  return true;
+}
+
+uint64_t TraceEvents::nowNs(void) {
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+             std::chrono::steady_clock::now() - trace_epoch)
+      .count();
+}
+
+void TraceEvents::complete(const uint32_t category, const char *name,
+                           const uint64_t start_ns, const uint64_t end_ns,
+                           std::initializer_list<TraceArg> args) {
+  if (!isEnabled(category)) {
+    return;
+  }
+  recordEvent(category, name, 'X', start_ns, end_ns - start_ns, args.begin(),
+              args.size());
+}
+
+void TraceEvents::instant(const uint32_t category, const char *name,
+                          std::initializer_list<TraceArg> args) {
+  if (!isEnabled(category)) {
+    return;
+  }
+  recordEvent(category, name, 'i', nowNs(), 0, args.begin(), args.size());
+}
+
+bool TraceEvents::writeChromeTrace(const char *path) {
+  FILE *file = fopen(path, "w");
+  if (file == NULL) {
+    TraceLog(LOG_ERROR, "TRACE: could not create %s: %s", path,
+             strerror(errno));
+    return false;
+  }
+
+  const int pid = getpid();
+  uint64_t dropped = 0;
+  fprintf(file, "{\"displayTimeUnit\": \"ms\", \"traceEvents\": [\n");
+  fprintf(file, "{\"name\": \"process_name\", \"ph\": \"M\", \"pid\": %d, "
+                "\"args\": {\"name\": \"circuit_vis\"}}",
+          pid);
+
+  std::lock_guard<std::mutex> lock(trace_buffers_mutex);
+  for (const ThreadTraceBuffer *buffer : trace_buffers) {
+    fprintf(file,
+            ",\n{\"name\": \"thread_name\", \"ph\": \"M\", \"pid\": %d, "
+            "\"tid\": %u, \"args\": {\"name\": \"thread %u\"}}",
+            pid, buffer->thread_index, buffer->thread_index);
+
+    const uint64_t head = buffer->head.load(std::memory_order_acquire);
+    const uint64_t first =
+        head > ThreadTraceBuffer::CAPACITY ? head - ThreadTraceBuffer::CAPACITY
+                                           : 0;
+    dropped += first;
+    for (uint64_t i = first; i < head; i++) {
+      writeEvent(file, buffer->events[i % ThreadTraceBuffer::CAPACITY], pid,
+                 buffer->thread_index);
+    }
+  }
+  fprintf(file, "\n]}\n");
+
+  if (fclose(file) != 0) {
+    TraceLog(LOG_ERROR, "TRACE: could not write %s: %s", path,
+             strerror(errno));
+    return false;
+  }
+  if (dropped > 0) {
+    TraceLog(LOG_WARNING, "TRACE: ring buffers overflowed, %lu events lost",
+             dropped);
+  }
+  return true;
+}
+
+TraceScope::~TraceScope(void) {
+  if (_start_ns == 0 || !TraceEvents::isEnabled(_category)) {
+    return;
+  }
+  recordEvent(_category, _name, 'X', _start_ns,
+              TraceEvents::nowNs() - _start_ns, _args, _arg_count);
+}
@@ -0,0 +1,303 @@
+#include "widening_copy/widening_copy.hpp"
+#include "cpu_dispatch/cpu_dispatch.hpp"
+#include <immintrin.h>
+
+// Everything below works on bytes and moves elements with memcpy, which
+// compiles to plain loads and stores and stays defined for the unaligned
+// fields of packed records.
+
+template <typename Src, typename Dst>
+static inline void widenScalar(const uint8_t *src, uint8_t *dst,
+                               const uint64_t count) {
+  for (uint64_t i = 0; i < count; i++) {
+    Src value;
+    memcpy(&value, src + i * sizeof(Src), sizeof(Src));
+    const Dst wide = value;
+    memcpy(dst + i * sizeof(Dst), &wide, sizeof(Dst));
+  }
+}
+
+// Elements to copy one by one before dst + head is aligned to VECTOR_BYTES,
+// none when dst is not aligned to its own elements and never will be.
+template <typename Dst, uint32_t VECTOR_BYTES>
+static inline uint64_t getHeadCount(const uint8_t *dst, const uint64_t count) {
+  const uintptr_t address = reinterpret_cast<uintptr_t>(dst);
+  if (address % sizeof(Dst) != 0) {
+    return 0;
+  }
+  const uint64_t head =
+      (VECTOR_BYTES - address % VECTOR_BYTES) % VECTOR_BYTES / sizeof(Dst);
+  return head < count ? head : count;
+}
+
+// The low BYTES bytes of a vector, the rest zero.
+template <uint32_t BYTES> static inline __m128i loadLow(const uint8_t *src) {
+  if constexpr (BYTES == 16) {
+    return _mm_loadu_si128(reinterpret_cast<const __m128i *>(src));
+  } else if constexpr (BYTES == 8) {
+    return _mm_loadl_epi64(reinterpret_cast<const __m128i *>(src));
+  } else {
+    static_assert(BYTES == 4 || BYTES == 2, "2 to 16 bytes");
+    uint32_t bytes = 0;
+    memcpy(&bytes, src, BYTES);
+    return _mm_cvtsi32_si128(static_cast<int32_t>(bytes));
+  }
+}
+
+// One vector of dst from the source elements it holds.
+template <typename Src, typename Dst>
+TRY_TARGET_SSE42 static inline __m128i widenVectorSse42(const uint8_t *src) {
+  const __m128i narrow = loadLow<16 * sizeof(Src) / sizeof(Dst)>(src);
+  if constexpr (sizeof(Src) == 1 && sizeof(Dst) == 2) {
+    return _mm_cvtepu8_epi16(narrow);
+  } else if constexpr (sizeof(Src) == 1 && sizeof(Dst) == 4) {
+    return _mm_cvtepu8_epi32(narrow);
+  } else if constexpr (sizeof(Src) == 1 && sizeof(Dst) == 8) {
+    return _mm_cvtepu8_epi64(narrow);
+  } else if constexpr (sizeof(Src) == 2 && sizeof(Dst) == 4) {
+    return _mm_cvtepu16_epi32(narrow);
+  } else if constexpr (sizeof(Src) == 2 && sizeof(Dst) == 8) {
+    return _mm_cvtepu16_epi64(narrow);
+  } else {
+    return _mm_cvtepu32_epi64(narrow);
+  }
+}
+
+template <typename Src, typename Dst>
+TRY_TARGET_AVX2 static inline __m256i widenVectorAvx2(const uint8_t *src) {
+  const __m128i narrow = loadLow<32 * sizeof(Src) / sizeof(Dst)>(src);
+  if constexpr (sizeof(Src) == 1 && sizeof(Dst) == 2) {
+    return _mm256_cvtepu8_epi16(narrow);
+  } else if constexpr (sizeof(Src) == 1 && sizeof(Dst) == 4) {
+    return _mm256_cvtepu8_epi32(narrow);
+  } else if constexpr (sizeof(Src) == 1 && sizeof(Dst) == 8) {
+    return _mm256_cvtepu8_epi64(narrow);
+  } else if constexpr (sizeof(Src) == 2 && sizeof(Dst) == 4) {
+    return _mm256_cvtepu16_epi32(narrow);
+  } else if constexpr (sizeof(Src) == 2 && sizeof(Dst) == 8) {
+    return _mm256_cvtepu16_epi64(narrow);
+  } else {
+    return _mm256_cvtepu32_epi64(narrow);
+  }
+}
+
+// The doubling pairs read half a zmm, the others fit an xmm.
+TRY_AVX512_WARNINGS_BEGIN
+template <typename Src, typename Dst>
+TRY_TARGET_AVX512 static inline __m512i widenVectorAvx512(const uint8_t *src) {
+  if constexpr (sizeof(Dst) == 2 * sizeof(Src)) {
+    const __m256i narrow =
+        _mm256_loadu_si256(reinterpret_cast<const __m256i *>(src));
+    if constexpr (sizeof(Src) == 1) {
+      return _mm512_cvtepu8_epi16(narrow);
+    } else if constexpr (sizeof(Src) == 2) {
+      return _mm512_cvtepu16_epi32(narrow);
+    } else {
+      return _mm512_cvtepu32_epi64(narrow);
+    }
+  } else {
+    const __m128i narrow = loadLow<64 * sizeof(Src) / sizeof(Dst)>(src);
+    if constexpr (sizeof(Src) == 1 && sizeof(Dst) == 4) {
+      return _mm512_cvtepu8_epi32(narrow);
+    } else if constexpr (sizeof(Src) == 1 && sizeof(Dst) == 8) {
+      return _mm512_cvtepu8_epi64(narrow);
+    } else {
+      return _mm512_cvtepu16_epi64(narrow);
+    }
+  }
+}
+TRY_AVX512_WARNINGS_END
+
+template <typename Src, typename Dst>
+TRY_TARGET_SSE42 static void widenSse42(const uint8_t *src, uint8_t *dst,
+                                        const uint64_t count) {
+  constexpr uint32_t LANES = 16 / sizeof(Dst);
+  uint64_t i = getHeadCount<Dst, 16>(dst, count);
+  widenScalar<Src, Dst>(src, dst, i);
+  for (; i + LANES <= count; i += LANES) {
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(dst + i * sizeof(Dst)),
+                     widenVectorSse42<Src, Dst>(src + i * sizeof(Src)));
+  }
+  widenScalar<Src, Dst>(src + i * sizeof(Src), dst + i * sizeof(Dst),
+                        count - i);
+}
+
+template <typename Src, typename Dst>
+TRY_TARGET_AVX2 static void widenAvx2(const uint8_t *src, uint8_t *dst,
+                                      const uint64_t count) {
+  constexpr uint32_t LANES = 32 / sizeof(Dst);
+  uint64_t i = getHeadCount<Dst, 32>(dst, count);
+  widenScalar<Src, Dst>(src, dst, i);
+  for (; i + LANES <= count; i += LANES) {
+    _mm256_storeu_si256(reinterpret_cast<__m256i *>(dst + i * sizeof(Dst)),
+                        widenVectorAvx2<Src, Dst>(src + i * sizeof(Src)));
+  }
+  widenScalar<Src, Dst>(src + i * sizeof(Src), dst + i * sizeof(Dst),
+                        count - i);
+}
+
+TRY_AVX512_WARNINGS_BEGIN
+template <typename Src, typename Dst>
+TRY_TARGET_AVX512 static void widenAvx512(const uint8_t *src, uint8_t *dst,
+                                          const uint64_t count) {
+  constexpr uint32_t LANES = 64 / sizeof(Dst);
+  uint64_t i = getHeadCount<Dst, 64>(dst, count);
+  widenScalar<Src, Dst>(src, dst, i);
+  for (; i + LANES <= count; i += LANES) {
+    _mm512_storeu_si512(dst + i * sizeof(Dst),
+                        widenVectorAvx512<Src, Dst>(src + i * sizeof(Src)));
+  }
+  widenScalar<Src, Dst>(src + i * sizeof(Src), dst + i * sizeof(Dst),
+                        count - i);
+}
+TRY_AVX512_WARNINGS_END
+
+template <typename Src, typename Dst>
+static void widen(const uint8_t *src, uint8_t *dst, const uint64_t count) {
+  if constexpr (sizeof(Src) > sizeof(Dst)) {
+    assert(0 && "narrowing copy");
+  } else if constexpr (sizeof(Src) == sizeof(Dst)) {
+    memcpy(dst, src, count * sizeof(Dst));
+  } else {
+    const CpuLevel level = getCpuLevel();
+    if (level >= CpuLevelAvx512) {
+      widenAvx512<Src, Dst>(src, dst, count);
+    } else if (level >= CpuLevelAvx2) {
+      widenAvx2<Src, Dst>(src, dst, count);
+    } else {
+      widenSse42<Src, Dst>(src, dst, count);
+    }
+  }
+}
+
+void widenCopy8To16(const uint8_t *src, uint16_t *dst, const uint64_t count) {
+  widen<uint8_t, uint16_t>(src, reinterpret_cast<uint8_t *>(dst), count);
+}
+
+void widenCopy16To32(const uint16_t *src, uint32_t *dst,
+                     const uint64_t count) {
+  widen<uint16_t, uint32_t>(reinterpret_cast<const uint8_t *>(src),
+                            reinterpret_cast<uint8_t *>(dst), count);
+}
+
+void widenCopy32To64(const uint32_t *src, uint64_t *dst,
+                     const uint64_t count) {
+  widen<uint32_t, uint64_t>(reinterpret_cast<const uint8_t *>(src),
+                            reinterpret_cast<uint8_t *>(dst), count);
+}
+
+template <typename Src>
+static void widenFrom(const uint8_t *src, uint8_t *dst,
+                      const uint32_t dst_width, const uint64_t count) {
+  switch (dst_width) {
+  case 1:
+    widen<Src, uint8_t>(src, dst, count);
+    return;
+  case 2:
+    widen<Src, uint16_t>(src, dst, count);
+    return;
+  case 4:
+    widen<Src, uint32_t>(src, dst, count);
+    return;
+  case 8:
+    widen<Src, uint64_t>(src, dst, count);
+    return;
+  default:
+    assert(0 && "widths are 1, 2, 4 or 8 bytes");
+  }
+}
+
+void widenCopy(const void *src, const uint32_t src_width, void *dst,
+               const uint32_t dst_width, const uint64_t count) {
+  assert(dst_width >= src_width && "narrowing copy");
+  const uint8_t *src_bytes = static_cast<const uint8_t *>(src);
+  uint8_t *dst_bytes = static_cast<uint8_t *>(dst);
+  switch (src_width) {
+  case 1:
+    widenFrom<uint8_t>(src_bytes, dst_bytes, dst_width, count);
+    return;
+  case 2:
+    widenFrom<uint16_t>(src_bytes, dst_bytes, dst_width, count);
+    return;
+  case 4:
+    widenFrom<uint32_t>(src_bytes, dst_bytes, dst_width, count);
+    return;
+  case 8:
+    widenFrom<uint64_t>(src_bytes, dst_bytes, dst_width, count);
+    return;
+  default:
+    assert(0 && "widths are 1, 2, 4 or 8 bytes");
+  }
+}
+
+// Fixed widths let every field move with one load and one store; unrolled
+// since the loop body is all address arithmetic.
+template <typename Src, typename Dst>
+static void widenStrided(const uint8_t *src, const uint64_t src_stride,
+                         uint8_t *dst, const uint64_t dst_stride,
+                         const uint64_t count) {
+#pragma GCC unroll 4
+  for (uint64_t i = 0; i < count; i++) {
+    Src value;
+    memcpy(&value, src + i * src_stride, sizeof(Src));
+    const Dst wide = value;
+    memcpy(dst + i * dst_stride, &wide, sizeof(Dst));
+  }
+}
+
+template <typename Src>
+static void widenStridedFrom(const uint8_t *src, const uint64_t src_stride,
+                             uint8_t *dst, const uint64_t dst_stride,
+                             const uint32_t dst_width, const uint64_t count) {
+  switch (dst_width) {
+  case 1:
+    widenStrided<Src, uint8_t>(src, src_stride, dst, dst_stride, count);
+    return;
+  case 2:
+    widenStrided<Src, uint16_t>(src, src_stride, dst, dst_stride, count);
+    return;
+  case 4:
+    widenStrided<Src, uint32_t>(src, src_stride, dst, dst_stride, count);
+    return;
+  case 8:
+    widenStrided<Src, uint64_t>(src, src_stride, dst, dst_stride, count);
+    return;
+  default:
+    assert(0 && "widths are 1, 2, 4 or 8 bytes");
+  }
+}
+
+void widenCopyStrided(const void *src, const uint64_t src_stride,
+                      const uint32_t src_width, void *dst,
+                      const uint64_t dst_stride, const uint32_t dst_width,
+                      const uint64_t count) {
+  if (src_stride == src_width && dst_stride == dst_width) {
+    widenCopy(src, src_width, dst, dst_width, count);
+    return;
+  }
+  assert(dst_width >= src_width && "narrowing copy");
+  assert(src_stride >= src_width && dst_stride >= dst_width &&
+         "fields overlap");
+  const uint8_t *src_bytes = static_cast<const uint8_t *>(src);
+  uint8_t *dst_bytes = static_cast<uint8_t *>(dst);
+  switch (src_width) {
+  case 1:
+    widenStridedFrom<uint8_t>(src_bytes, src_stride, dst_bytes, dst_stride,
+                              dst_width, count);
+    return;
+  case 2:
+    widenStridedFrom<uint16_t>(src_bytes, src_stride, dst_bytes, dst_stride,
+                               dst_width, count);
+    return;
+  case 4:
+    widenStridedFrom<uint32_t>(src_bytes, src_stride, dst_bytes, dst_stride,
+                               dst_width, count);
+    return;
+  case 8:
+    widenStridedFrom<uint64_t>(src_bytes, src_stride, dst_bytes, dst_stride,
+                               dst_width, count);
+    return;
+  default:
+    assert(0 && "widths are 1, 2, 4 or 8 bytes");
+  }
+}
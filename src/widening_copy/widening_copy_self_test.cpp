@@ -0,0 +1,135 @@
+#include "widening_copy/widening_copy_self_test.hpp"
+
+static constexpr uint8_t GUARD_BYTE = 0xa5;
+
+static uint64_t loadField(const uint8_t *data, const uint32_t width) {
+  uint64_t value = 0;
+  memcpy(&value, data, width);
+  return value;
+}
+
+uint64_t WideningCopySelfTest::nextRandom(void) {
+  // SplitMix64, identical sequence on every platform.
+  uint64_t z = (_random_state += 0x9e3779b97f4a7c15ull);
+  z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ull;
+  z = (z ^ (z >> 27)) * 0x94d049bb133111ebull;
+  return z ^ (z >> 31);
+}
+
+void WideningCopySelfTest::check(const bool condition, const char *what) {
+  if (!condition) {
+    fprintf(stderr, "WIDENING_COPY: self test failed: %s\n", what);
+    _failure_count++;
+  }
+}
+
+// Counts below, at and well past a vector, from every byte offset into a
+// cache line for both arrays, so each copy runs with and without a head
+// and a tail and with dst off its element alignment.
+void WideningCopySelfTest::testContiguous(const uint32_t src_width,
+                                          const uint32_t dst_width) {
+  static constexpr uint64_t MAX_COUNT = 300;
+  std::vector<uint8_t> src(64 + MAX_COUNT * src_width);
+  std::vector<uint8_t> dst(64 + (MAX_COUNT + 1) * dst_width);
+  for (uint8_t &byte : src) {
+    byte = nextRandom();
+  }
+  for (const uint64_t count : {0ul, 1ul, 7ul, 8ul, 33ul, 64ul, MAX_COUNT}) {
+    for (uint32_t src_offset = 0; src_offset < 64; src_offset += 9) {
+      for (uint32_t dst_offset = 0; dst_offset < 64; dst_offset++) {
+        memset(dst.data(), GUARD_BYTE, dst.size());
+        const uint8_t *from = src.data() + src_offset;
+        uint8_t *to = dst.data() + dst_offset;
+        widenCopy(from, src_width, to, dst_width, count);
+
+        bool same = true;
+        for (uint64_t i = 0; i < count; i++) {
+          same &= loadField(to + i * dst_width, dst_width) ==
+                  loadField(from + i * src_width, src_width);
+        }
+        bool untouched = true;
+        for (uint32_t i = 0; i < dst_offset; i++) {
+          untouched &= dst[i] == GUARD_BYTE;
+        }
+        for (uint32_t i = 0; i < dst_width; i++) {
+          untouched &= to[count * dst_width + i] == GUARD_BYTE;
+        }
+        check(same, "widenCopy() zero extends every value");
+        check(untouched, "widenCopy() stays inside dst");
+      }
+    }
+  }
+
+  // The typed entry points of the doubling pairs.
+  std::vector<uint32_t> narrow(MAX_COUNT);
+  for (uint32_t &value : narrow) {
+    value = nextRandom();
+  }
+  const uint8_t *narrow_bytes = reinterpret_cast<uint8_t *>(narrow.data());
+  std::vector<uint16_t> wide16(MAX_COUNT);
+  std::vector<uint32_t> wide32(MAX_COUNT);
+  std::vector<uint64_t> wide64(MAX_COUNT);
+  widenCopy8To16(narrow_bytes, wide16.data(), MAX_COUNT);
+  widenCopy16To32(reinterpret_cast<const uint16_t *>(narrow_bytes),
+                  wide32.data(), MAX_COUNT);
+  widenCopy32To64(narrow.data(), wide64.data(), MAX_COUNT);
+  bool same = true;
+  for (uint64_t i = 0; i < MAX_COUNT; i++) {
+    same &= wide16[i] == narrow_bytes[i];
+    same &= wide32[i] == loadField(narrow_bytes + i * 2, 2);
+    same &= wide64[i] == narrow[i];
+  }
+  check(same, "widenCopy8To16(), widenCopy16To32() and widenCopy32To64()");
+}
+
+// One field of packed records copied into wider records, the bytes between
+// the fields have to survive.
+void WideningCopySelfTest::testStrided(const uint32_t src_width,
+                                       const uint64_t src_stride,
+                                       const uint32_t dst_width,
+                                       const uint64_t dst_stride) {
+  static constexpr uint64_t COUNT = 257;
+  std::vector<uint8_t> src(1 + COUNT * src_stride);
+  std::vector<uint8_t> dst(1 + COUNT * dst_stride);
+  for (uint8_t &byte : src) {
+    byte = nextRandom();
+  }
+  memset(dst.data(), GUARD_BYTE, dst.size());
+  widenCopyStrided(src.data() + 1, src_stride, src_width, dst.data() + 1,
+                   dst_stride, dst_width, COUNT);
+
+  bool same = true;
+  bool untouched = dst[0] == GUARD_BYTE;
+  for (uint64_t i = 0; i < COUNT; i++) {
+    const uint8_t *from = src.data() + 1 + i * src_stride;
+    const uint8_t *to = dst.data() + 1 + i * dst_stride;
+    same &= loadField(to, dst_width) == loadField(from, src_width);
+    for (uint64_t j = dst_width; j < dst_stride; j++) {
+      untouched &= to[j] == GUARD_BYTE;
+    }
+  }
+  check(same, "widenCopyStrided() zero extends every field");
+  check(untouched, "widenCopyStrided() leaves the other fields alone");
+}
+
+bool WideningCopySelfTest::selfTest(void) {
+  _failure_count = 0;
+  for (const uint32_t src_width : {1u, 2u, 4u, 8u}) {
+    for (const uint32_t dst_width : {1u, 2u, 4u, 8u}) {
+      if (dst_width >= src_width) {
+        testContiguous(src_width, dst_width);
+      }
+    }
+  }
+
+  // copyarrINC's interleaving, the node index of an Edge<uint16_t, uint8_t>
+  // into an Edge<uint16_t, uint16_t>, its offsets as one 4 byte field, and
+  // an edge index promoted inside a wider record.
+  testStrided(1, 1, 1, 2);
+  testStrided(1, 5, 2, 6);
+  testStrided(4, 5, 4, 6);
+  testStrided(2, 6, 4, 12);
+  testStrided(4, 12, 8, 24);
+  testStrided(1, 3, 8, 24);
+  return _failure_count == 0;
+}
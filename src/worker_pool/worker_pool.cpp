@@ -0,0 +1,113 @@
+#include "worker_pool/worker_pool.hpp"
+#include <pthread.h>
+#include <sched.h>
+
+WorkerPool::WorkerPool(const uint32_t thread_count, const bool pin_threads)
+    : _generation(0), _busy_workers(0), _exit(false), _task_count(0),
+      _next_task(0) {
+  uint32_t total_threads = thread_count;
+  if (total_threads == 0) {
+    total_threads = std::max(1u, std::thread::hardware_concurrency());
+  }
+  for (uint32_t i = 1; i < total_threads; i++) {
+    _workers.push_back(std::thread([this]() { workerLoop(); }));
+  }
+  if (pin_threads) {
+    pinWorkers();
+  }
+}
+
+// Pinning is a hint, a worker that cannot be pinned keeps running anywhere.
+void WorkerPool::pinWorkers(void) {
+  cpu_set_t allowed;
+  CPU_ZERO(&allowed);
+  if (sched_getaffinity(0, sizeof(allowed), &allowed) != 0) {
+    return;
+  }
+  std::vector<uint32_t> cpus;
+  for (uint32_t cpu = 0; cpu < CPU_SETSIZE; cpu++) {
+    if (CPU_ISSET(cpu, &allowed)) {
+      cpus.push_back(cpu);
+    }
+  }
+  if (cpus.empty()) {
+    return;
+  }
+
+  // Worker i is thread i + 1, the calling thread is expected on cpus[0].
+  for (uint32_t i = 0; i < _workers.size(); i++) {
+    cpu_set_t cpu_set;
+    CPU_ZERO(&cpu_set);
+    CPU_SET(cpus[(i + 1) % cpus.size()], &cpu_set);
+    (void)pthread_setaffinity_np(_workers[i].native_handle(), sizeof(cpu_set),
+                                 &cpu_set);
+  }
+}
+
+WorkerPool::~WorkerPool(void) {
+  {
+    std::lock_guard<std::mutex> lock(_mutex);
+    _exit = true;
+  }
+  _wakeup.notify_all();
+  for (auto &worker : _workers) {
+    worker.join();
+  }
+}
+
+void WorkerPool::workerLoop(void) {
+  uint64_t seen_generation = 0;
+  std::unique_lock<std::mutex> lock(_mutex);
+  for (;;) {
+    _wakeup.wait(lock,
+                 [&]() { return _exit || _generation != seen_generation; });
+    if (_exit) {
+      return;
+    }
+    seen_generation = _generation;
+    lock.unlock();
+
+    runTasks();
+
+    lock.lock();
+    if (--_busy_workers == 0) {
+      _done.notify_all();
+    }
+  }
+}
+
+void WorkerPool::runTasks(void) {
+  for (;;) {
+    const uint32_t task = _next_task.fetch_add(1);
+    if (task >= _task_count) {
+      return;
+    }
+    _task(task);
+  }
+}
+
+void WorkerPool::parallelFor(const uint32_t task_count,
+                             std::function<void(const uint32_t)> task) {
+  if (_workers.empty() || task_count <= 1) {
+    for (uint32_t i = 0; i < task_count; i++) {
+      task(i);
+    }
+    return;
+  }
+
+  {
+    std::lock_guard<std::mutex> lock(_mutex);
+    _task = task;
+    _task_count = task_count;
+    _next_task.store(0);
+    _generation++;
+    _busy_workers = _workers.size();
+  }
+  _wakeup.notify_all();
+
+  runTasks();
+
+  std::unique_lock<std::mutex> lock(_mutex);
+  _done.wait(lock, [this]() { return _busy_workers == 0; });
+  _task = nullptr;
+}
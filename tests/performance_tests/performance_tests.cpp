@@ -0,0 +1,899 @@
+#include "circuit_model/circuit_renumbering.hpp"
+#include "circuit_model/circuit_simplify.hpp"
+#include "circuit_model/random_circuit.hpp"
+#include "circuit_solver/circuit_solver.hpp"
+#include "cpu_dispatch/cpu_dispatch.hpp"
+#include "ffmpeg_rendering/yuv420_converter.hpp"
+#include "lut_eval/lut_bit_sliced_evaluator.hpp"
+#include "lut_eval/lut_compiled_evaluator.hpp"
+#include "lut_eval/lut_delta_evaluator.hpp"
+#include "lut_eval/lut_eval.hpp"
+#include "lut_eval/lut_event_evaluator.hpp"
+#include "lut_eval/lut_parallel_evaluator.hpp"
+#include "lut_eval/lut_renumbering.hpp"
+#include "lut_eval/lut_simplify.hpp"
+#include "lut_eval/lut_stream.hpp"
+#include "lut_eval/random_lut_network.hpp"
+#include "packed_array/packed_array.hpp"
+#include "recursive_graph/circuit_graph.hpp"
+#include "widening_copy/widening_copy.hpp"
+#include <chrono>
+#include <unistd.h>
+
+// Benchmarks of every stage between building a circuit and handing a frame to
+// ffmpeg, each at several sizes. Results are written as JSON and, when a
+// baseline is given, compared against it: a benchmark whose best time per op
+// is more than threshold slower than its baseline fails the run. A baseline
+// recorded on another host or at another CPU level is not compared.
+//
+//   performance_tests [--output results.json] [--baseline baseline.json]
+//                     [--write-baseline baseline.json] [--threshold 0.25]
+//                     [--filter name] [--min-batch-ms 50]
+
+// The copyarrINC loops of the fast_memcpy experiment, what the widening
+// copies are measured against: one element per iteration, left to the
+// compiler.
+template <typename Src, typename Dst>
+TRY_NOINLINE static void naiveWidenCopy(const Src *src, Dst *dst,
+                                        const uint64_t count) {
+  for (uint64_t i = 0; i < count; i++) {
+    dst[i] = src[i];
+  }
+}
+
+// Edge<uint16_t, uint8_t> records into Edge<uint16_t, uint16_t> ones a byte
+// at a time.
+TRY_NOINLINE static void naiveWidenEdges(const uint8_t *src, uint8_t *dst,
+                                         const uint64_t count) {
+  for (uint64_t i = 0; i < count; i++) {
+    for (uint32_t j = 0; j < 5; j++) {
+      dst[i * 6 + j] = src[i * 5 + j];
+    }
+    dst[i * 6 + 5] = 0;
+  }
+}
+
+class NullDrawBackend : public DrawBackend {
+private:
+  uint64_t _primitives;
+
+public:
+  NullDrawBackend(void) : _primitives(0) {}
+
+  inline uint64_t getPrimitiveCount(void) const { return _primitives; }
+
+  void clearBackground(const Color) override { _primitives++; }
+
+  void drawRectangleGradientV(const Rectangle, const Color,
+                              const Color) override {
+    _primitives++;
+  }
+
+  void drawRectangleLines(const Rectangle, const float, const Color) override {
+    _primitives++;
+  }
+
+  void drawCircleGradient(const Vector2, const float, const Color,
+                          const Color) override {
+    _primitives++;
+  }
+
+  void drawCircleLines(const Vector2, const float, const Color) override {
+    _primitives++;
+  }
+
+  void drawSplineBezierQuadratic(const Vector2 *, const size_t, const float,
+                                 const Color) override {
+    _primitives++;
+  }
+
+  void drawTriangle(const Vector2, const Vector2, const Vector2,
+                    const Color) override {
+    _primitives++;
+  }
+
+  void drawTextCodepoint(const int, const Vector2, const float,
+                         const Color) override {
+    _primitives++;
+  }
+};
+
+struct PerformanceResult {
+  std::string name;
+  uint64_t size;
+  uint64_t iterations;
+  double best_ns_per_op;
+  double median_ns_per_op;
+};
+
+// Where results were recorded, timings only compare on the same machine
+// running the same kernels.
+struct PerformanceMachine {
+  std::string host;
+  std::string cpu_level;
+
+  inline bool operator==(const PerformanceMachine &other) const {
+    return host == other.host && cpu_level == other.cpu_level;
+  }
+};
+
+static PerformanceMachine getPerformanceMachine(void) {
+  char host[256] = "unknown";
+  if (gethostname(host, sizeof(host)) < 0) {
+    strcpy(host, "unknown");
+  }
+  host[sizeof(host) - 1] = '\0';
+  return {.host = host, .cpu_level = getCpuLevelName(getCpuLevel())};
+}
+
+class PerformanceSuite {
+private:
+  using Clock = std::chrono::steady_clock;
+
+  static constexpr uint32_t BATCHES = 5;
+  static constexpr float SCREEN_WIDTH = 1920;
+  static constexpr float SCREEN_HEIGHT = 1080;
+  static constexpr Vector2 SCREEN_RESOLUTION = {.x = SCREEN_WIDTH,
+                                                .y = SCREEN_HEIGHT};
+  static constexpr float SCREEN_FPS = 120;
+  static constexpr uint32_t SAMPLED_FRAMES = 64;
+  static constexpr uint64_t RANDOM_CIRCUIT_SEED = 0x5eed;
+  static constexpr uint32_t LUT_BATCH_VECTORS = 64;
+  static constexpr size_t LUT_STREAM_WINDOW_SIZE = 1 << 20;
+  // Larger networks take too long to compile for a benchmark run.
+  static constexpr uint32_t LUT_COMPILED_MAX_LUTS = 10000;
+
+  const std::string _filter;
+  const double _min_batch_ns;
+  std::vector<PerformanceResult> _results;
+
+  static inline double getElapsedNs(const Clock::time_point start) {
+    return std::chrono::duration<double, std::nano>(Clock::now() - start)
+        .count();
+  }
+
+  // Runs op in BATCHES batches of equal size, the batch size is picked so a
+  // batch takes at least _min_batch_ns.
+  void measure(const char *name, const uint64_t size,
+               std::function<void(void)> op) {
+    if (!_filter.empty() && strstr(name, _filter.c_str()) == NULL) {
+      return;
+    }
+
+    Clock::time_point start = Clock::now();
+    op();
+    const double warmup_ns = std::max(1.0, getElapsedNs(start));
+    const uint64_t iterations =
+        std::max<uint64_t>(1, ceil(_min_batch_ns / warmup_ns));
+
+    std::vector<double> ns_per_op;
+    for (uint32_t batch = 0; batch < BATCHES; batch++) {
+      start = Clock::now();
+      for (uint64_t i = 0; i < iterations; i++) {
+        op();
+      }
+      ns_per_op.push_back(getElapsedNs(start) / iterations);
+    }
+    std::sort(ns_per_op.begin(), ns_per_op.end());
+
+    _results.push_back({.name = name,
+                        .size = size,
+                        .iterations = iterations * BATCHES,
+                        .best_ns_per_op = ns_per_op.front(),
+                        .median_ns_per_op = ns_per_op[BATCHES / 2]});
+    printf("PERF: %-34s size %6lu  best %14.1f ns/op  median %14.1f ns/op\n",
+           name, size, ns_per_op.front(), ns_per_op[BATCHES / 2]);
+    fflush(stdout);
+  }
+
+  static void printOrderStats(const char *name, const size_t size,
+                              const NodeOrderStats &before,
+                              const NodeOrderStats &after) {
+    printf("PERF: %-34s size %6lu  edge span %.1f -> %.1f  estimated misses "
+           "%lu -> %lu\n",
+           name, size, before.average_edge_span, after.average_edge_span,
+           before.estimated_misses, after.estimated_misses);
+  }
+
+  static void printSimplification(const char *name, const size_t size,
+                                  const uint32_t node_count,
+                                  const uint32_t simplified_node_count) {
+    printf("PERF: %-34s size %6lu  nodes %u -> %u\n", name, size, node_count,
+           simplified_node_count);
+  }
+
+  static void printGraphMemory(const char *name, const size_t size,
+                               const uint64_t edge_count,
+                               const uint32_t node_index_bytes,
+                               const uint32_t edge_index_bytes,
+                               const uint64_t bytes) {
+    printf("PERF: %-34s size %6lu  edges %lu  index bytes node %u edge %u  "
+           "%.1f bytes per edge\n",
+           name, size, edge_count, node_index_bytes, edge_index_bytes,
+           static_cast<double>(bytes) / std::max<uint64_t>(1, edge_count));
+  }
+
+  void runCircuitBenchmarks(const char *prefix, const uint32_t size,
+                            std::function<CircuitModel *(void)> createCircuit) {
+    char name[128];
+
+    snprintf(name, sizeof(name), "%s/construction", prefix);
+    measure(name, size, [&]() { delete createCircuit(); });
+
+    CircuitModel *circuit = createCircuit();
+
+    snprintf(name, sizeof(name), "%s/simplification", prefix);
+    uint32_t simplified_node_count = 0;
+    measure(name, size, [&]() {
+      CircuitModel simplified;
+      std::vector<uint32_t> new_indices;
+      std::vector<uint32_t> original_indices;
+      simplifyCircuitModel(*circuit, simplified, new_indices,
+                           original_indices);
+      simplified_node_count = simplified.getNodeCount();
+    });
+    if (simplified_node_count > 0) {
+      printSimplification(name, size, circuit->getNodeCount(),
+                          simplified_node_count);
+    }
+
+    snprintf(name, sizeof(name), "%s/renumbering", prefix);
+    std::vector<uint32_t> new_indices;
+    measure(name, size, [&]() {
+      CircuitModel renumbered;
+      renumberCircuitModel(*circuit, NodeOrderLevelBfs, renumbered,
+                           new_indices);
+    });
+    // Left empty when the filter skipped the pass.
+    if (!new_indices.empty()) {
+      NodeOrderStats before;
+      NodeOrderStats after;
+      computeCircuitNodeOrderStats(*circuit, {}, before);
+      computeCircuitNodeOrderStats(*circuit, new_indices, after);
+      printOrderStats(name, size, before, after);
+    }
+
+    // The fanout and fanin graphs together, left at 0 when the filter
+    // skipped them.
+    snprintf(name, sizeof(name), "%s/circuit_graph", prefix);
+    uint64_t graph_bytes = 0;
+    uint32_t index_bytes[2] = {0, 0};
+    measure(name, size, [&]() {
+      CircuitGraph graph(*circuit);
+      graph_bytes = graph.getBytes();
+      index_bytes[0] = graph.getFanoutGraph().getNodeIndexBytes();
+      index_bytes[1] = graph.getFanoutGraph().getEdgeIndexBytes();
+    });
+    if (graph_bytes > 0) {
+      uint64_t edge_count = 0;
+      circuit->forEachNode([&](const CircuitNode &node) {
+        edge_count += node.getFanoutCount();
+        return IterationContinue;
+      });
+      printGraphMemory(name, size, edge_count, index_bytes[0],
+                       index_bytes[1], graph_bytes);
+    }
+
+    snprintf(name, sizeof(name), "%s/layout", prefix);
+    measure(name, size, [&]() {
+      CircuitAnimator animator(*circuit, SCREEN_RESOLUTION, WHITE, SCREEN_FPS,
+                               0.0f);
+    });
+
+    CircuitAnimator animator(*circuit, SCREEN_RESOLUTION, WHITE, SCREEN_FPS,
+                             0.0f);
+    const float start_time = animator.getAnimationStartTime();
+    const float duration = animator.getAnimationEndTime() - start_time;
+    const auto getSampleTime = [&](const uint32_t frame) {
+      return start_time + duration * frame / SAMPLED_FRAMES;
+    };
+
+    snprintf(name, sizeof(name), "%s/levelization", prefix);
+    measure(name, size, [&]() {
+      const uint32_t layer_count = animator.getLayerCount();
+      assert(layer_count > 0);
+      (void)layer_count;
+    });
+
+    // Per frame: everything the animator computes from its key frames, with
+    // the drawing itself left out.
+    snprintf(name, sizeof(name), "%s/key_frame_sampling", prefix);
+    NullDrawBackend null_backend;
+    uint32_t sampled_frame = 0;
+    measure(name, size, [&]() {
+      (void)animator.updateCircuitAnimation(getSampleTime(sampled_frame),
+                                            null_backend);
+      sampled_frame = (sampled_frame + 1) % SAMPLED_FRAMES;
+    });
+
+    snprintf(name, sizeof(name), "%s/damage_collection", prefix);
+    std::vector<Rectangle> damage;
+    measure(name, size, [&]() {
+      damage.clear();
+      animator.collectDamage(getSampleTime(sampled_frame),
+                             getSampleTime(sampled_frame + 1), damage);
+      sampled_frame = (sampled_frame + 1) % SAMPLED_FRAMES;
+    });
+
+    snprintf(name, sizeof(name), "%s/headless_frame", prefix);
+    if (_filter.empty() || strstr(name, _filter.c_str()) != NULL) {
+      SoftwareRasterizer rasterizer(SCREEN_WIDTH, SCREEN_HEIGHT, 0);
+      measure(name, size, [&]() {
+        rasterizer.beginFrame();
+        rasterizer.clearBackground(DARKGRAY);
+        (void)animator.updateCircuitAnimation(getSampleTime(sampled_frame),
+                                              rasterizer);
+        rasterizer.endFrame();
+        sampled_frame = (sampled_frame + 1) % SAMPLED_FRAMES;
+      });
+    }
+
+    delete circuit;
+  }
+
+  void runFrameBenchmarks(const size_t width, const size_t height) {
+    const char *names[] = {"yuv420_convert", "yuv420_convert_flipped"};
+    uint32_t *rgba =
+        static_cast<uint32_t *>(malloc(sizeof(uint32_t) * width * height));
+    assert(rgba != NULL && "Buy MORE RAM lol!!");
+    for (size_t i = 0; i < width * height; i++) {
+      rgba[i] = static_cast<uint32_t>(i * 2654435761u);
+    }
+    const size_t frame_size = YUV420Converter::getFrameSize(width, height);
+    uint8_t *yuv = static_cast<uint8_t *>(malloc(frame_size));
+    assert(yuv != NULL && "Buy MORE RAM lol!!");
+    memset(yuv, 0, frame_size);
+
+    YUV420Converter converter(0);
+    for (uint32_t flip = 0; flip < 2; flip++) {
+      measure(names[flip], height,
+              [&]() { converter.convert(rgba, width, height, flip, yuv); });
+    }
+
+    // One I420 frame written through a pipe that a second thread drains, the
+    // same path frames take into ffmpeg.
+    int pipe_fds[2];
+    if (pipe(pipe_fds) < 0) {
+      TraceLog(LOG_ERROR, "PERF: could not create pipe: %s", strerror(errno));
+    } else {
+      std::thread reader([&]() {
+        uint8_t buffer[1 << 16];
+        while (read(pipe_fds[0], buffer, sizeof(buffer)) > 0) {
+        }
+      });
+      measure("pipe_throughput", height, [&]() {
+        size_t written = 0;
+        while (written < frame_size) {
+          const ssize_t n =
+              write(pipe_fds[1], yuv + written, frame_size - written);
+          if (n < 0 && errno == EINTR) {
+            continue;
+          }
+          assert(n > 0);
+          written += n;
+        }
+      });
+      close(pipe_fds[1]);
+      reader.join();
+      close(pipe_fds[0]);
+    }
+
+    free(yuv);
+    free(rgba);
+  }
+
+  // One op is one evaluation of the whole network, which covers one pattern
+  // for gather and scatter, 64 or 256 for the bit-sliced ones and 64 for the
+  // compiled one, and a batch of LUT_BATCH_VECTORS vectors on all hardware
+  // threads for the parallel ones. The event-driven op toggles one input and
+  // re-simulates.
+  void runLutBenchmarks(const uint32_t lut_count) {
+    LutNetwork network;
+    buildRandomLutNetwork({.seed = RANDOM_CIRCUIT_SEED,
+                           .input_count = 256,
+                           .lut_count = lut_count,
+                           .min_fanin = 2,
+                           .max_fanin = LutNetwork::MAX_LUT_INPUTS,
+                           .window = 1024,
+                           .output_rate = 0.01f},
+                          network);
+
+    const char *mode_names[] = {"lut_eval/gather", "lut_eval/scatter"};
+    const LutEvalMode modes[] = {LutEvalGather, LutEvalScatter};
+    for (uint32_t i = 0; i < 2; i++) {
+      LutEvaluator evaluator(network, modes[i]);
+      uint32_t pattern = 0;
+      measure(mode_names[i], lut_count, [&]() {
+        evaluator.setInput(pattern % 256, pattern & 1);
+        evaluator.evaluate();
+        pattern++;
+      });
+    }
+
+    {
+      LutDeltaEvaluator evaluator(network);
+      uint32_t pattern = 0;
+      measure("lut_eval/delta_edges", lut_count, [&]() {
+        evaluator.setInput(pattern % 256, pattern & 1);
+        evaluator.evaluate();
+        pattern++;
+      });
+    }
+
+    // Out of the page cache after the first batch, so this times the
+    // record parsing and the read calls rather than the disk.
+    char stream_path[] = "/tmp/lut_stream_XXXXXX";
+    const int stream_fd = mkstemp(stream_path);
+    if (stream_fd >= 0) {
+      close(stream_fd);
+      LutStreamEvaluator evaluator(LUT_STREAM_WINDOW_SIZE);
+      if (writeLutStreamFile(network, stream_path) &&
+          evaluator.open(stream_path)) {
+        uint32_t pattern = 0;
+        measure("lut_eval/streamed", lut_count, [&]() {
+          evaluator.setInput(pattern % 256, pattern & 1);
+          evaluator.evaluate();
+          pattern++;
+        });
+      }
+      unlink(stream_path);
+    }
+
+    {
+      uint32_t simplified_node_count = 0;
+      measure("lut_eval/simplification", lut_count, [&]() {
+        LutNetwork simplified;
+        std::vector<uint32_t> new_indices;
+        std::vector<uint32_t> original_indices;
+        simplifyLutNetwork(network, simplified, new_indices,
+                           original_indices);
+        simplified_node_count = simplified.getNodeCount();
+      });
+      if (simplified_node_count > 0) {
+        printSimplification("lut_eval/simplification", lut_count,
+                            network.getNodeCount(), simplified_node_count);
+      }
+    }
+
+    {
+      std::vector<uint32_t> new_indices;
+      measure("lut_eval/renumbering", lut_count, [&]() {
+        LutNetwork renumbered;
+        renumberLutNetwork(network, NodeOrderLevelBfs, renumbered,
+                           new_indices);
+      });
+      if (!new_indices.empty()) {
+        NodeOrderStats before;
+        NodeOrderStats after;
+        computeLutNodeOrderStats(network, {}, before);
+        computeLutNodeOrderStats(network, new_indices, after);
+        printOrderStats("lut_eval/renumbering", lut_count, before, after);
+      }
+    }
+
+    const char *width_names[] = {"lut_eval/bit_sliced_64",
+                                 "lut_eval/bit_sliced_256"};
+    for (uint8_t width = FirstLutSliceWidth; width < LastLutSliceWidth;
+         width++) {
+      LutBitSlicedEvaluator evaluator(network,
+                                      static_cast<LutSliceWidth>(width));
+      uint64_t first_pattern = 0;
+      measure(width_names[width], lut_count, [&]() {
+        evaluator.setExhaustivePatterns(first_pattern);
+        evaluator.evaluate();
+        first_pattern += evaluator.getPatternCount();
+      });
+    }
+
+    // Compiled on the first run only, the kernel cache keeps it.
+    if (lut_count <= LUT_COMPILED_MAX_LUTS &&
+        (_filter.empty() ||
+         strstr("lut_eval/compiled", _filter.c_str()) != NULL)) {
+      LutCompiledEvaluator evaluator(network, getDefaultKernelCacheDir());
+      if (evaluator.isLoaded()) {
+        uint64_t word = 0;
+        measure("lut_eval/compiled", lut_count, [&]() {
+          evaluator.setInputPatterns(word % 256, word * 2654435761u);
+          evaluator.evaluate();
+          word++;
+        });
+      }
+    }
+
+    // What a toggle costs depends on the input and on the values left by
+    // the toggles before it, so one op toggles the same inputs and back and
+    // every op does the same work.
+    {
+      LutEventEvaluator evaluator(network);
+      const uint32_t input_count = network.getInputCount();
+      measure("lut_eval/event_driven", lut_count, [&]() {
+        for (const bool value : {true, false}) {
+          for (uint32_t toggle = 0; toggle < 4; toggle++) {
+            evaluator.setInput((toggle * 2654435761u) % input_count, value);
+            evaluator.evaluate();
+          }
+        }
+      });
+    }
+
+    const uint32_t input_count = network.getInputCount();
+    std::vector<uint8_t> inputs(LUT_BATCH_VECTORS * input_count);
+    for (size_t i = 0; i < inputs.size(); i++) {
+      inputs[i] = (i * 2654435761u) >> 31;
+    }
+    std::vector<uint8_t> outputs(LUT_BATCH_VECTORS *
+                                 network.getOutputCount());
+    const char *parallel_names[] = {"lut_eval/parallel_layered",
+                                    "lut_eval/parallel_pipelined"};
+    for (uint8_t mode = FirstLutParallelMode; mode < LastLutParallelMode;
+         mode++) {
+      LutParallelEvaluator evaluator(network, 0,
+                                     static_cast<LutParallelMode>(mode));
+      measure(parallel_names[mode], lut_count, [&]() {
+        evaluator.evaluateBatch(inputs.data(), outputs.data(),
+                                LUT_BATCH_VECTORS);
+      });
+    }
+  }
+
+  // One op converts the whole array, 12 and 17 bits are the widths of the
+  // packed_bits_array experiment, 40 takes the scalar path.
+  template <uint32_t BITS> void runPackedArrayBenchmarks(const uint32_t size) {
+    typedef typename PackedArray<BITS>::Value Value;
+    PackedArray<BITS> array(size);
+    std::vector<Value> values(size);
+    for (uint32_t i = 0; i < size; i++) {
+      values[i] = (i * 2654435761ull) & PackedBits<BITS>::MASK;
+    }
+    char name[64];
+    snprintf(name, sizeof(name), "packed_array/pack_%u", BITS);
+    measure(name, size,
+            [&]() { array.packFrom(0, size, values.data()); });
+    snprintf(name, sizeof(name), "packed_array/unpack_%u", BITS);
+    measure(name, size,
+            [&]() { array.unpackTo(0, size, values.data()); });
+  }
+
+  // One op copies the whole array, each width pair against the plain loop,
+  // and the two strided copies that promote the node index of packed edge
+  // records against a byte by byte copy.
+  template <typename Src, typename Dst>
+  void runWideningCopyPair(const uint32_t size) {
+    std::vector<Src> src(size);
+    std::vector<Dst> dst(size);
+    for (uint32_t i = 0; i < size; i++) {
+      src[i] = static_cast<Src>(i * 2654435761ull);
+    }
+    char name[64];
+    snprintf(name, sizeof(name), "widening_copy/%zu_to_%zu", 8 * sizeof(Src),
+             8 * sizeof(Dst));
+    measure(name, size, [&]() {
+      widenCopy(src.data(), sizeof(Src), dst.data(), sizeof(Dst), size);
+    });
+    snprintf(name, sizeof(name), "widening_copy/naive_%zu_to_%zu",
+             8 * sizeof(Src), 8 * sizeof(Dst));
+    measure(name, size,
+            [&]() { naiveWidenCopy(src.data(), dst.data(), size); });
+  }
+
+  void runWideningCopyBenchmarks(const uint32_t size) {
+    runWideningCopyPair<uint8_t, uint16_t>(size);
+    runWideningCopyPair<uint16_t, uint32_t>(size);
+    runWideningCopyPair<uint32_t, uint64_t>(size);
+
+    std::vector<uint8_t> edges(size * 5ull);
+    std::vector<uint8_t> wide_edges(size * 6ull);
+    for (size_t i = 0; i < edges.size(); i++) {
+      edges[i] = static_cast<uint8_t>(i * 2654435761u >> 24);
+    }
+    measure("widening_copy/strided_edges", size, [&]() {
+      widenCopyStrided(edges.data(), 5, 4, wide_edges.data(), 6, 4, size);
+      widenCopyStrided(edges.data() + 4, 5, 1, wide_edges.data() + 4, 6, 2,
+                       size);
+    });
+    measure("widening_copy/naive_strided_edges", size, [&]() {
+      naiveWidenEdges(edges.data(), wide_edges.data(), size);
+    });
+  }
+
+  // One op adds node_count nodes with three edges each to nearby nodes, or
+  // finds all of them again. The sizes land on 1, 2 and 4 byte indices.
+  void runRecursiveGraphBenchmarks(const uint32_t node_count) {
+    static constexpr uint32_t EDGES_PER_NODE = 3;
+    std::vector<uint64_t> ends(node_count * EDGES_PER_NODE);
+    for (uint64_t i = 0; i < ends.size(); i++) {
+      const uint64_t node = i / EDGES_PER_NODE;
+      ends[i] = (node + (i * 2654435761u >> 20) % 64) % node_count;
+    }
+    const auto build = [&](RecursiveGraph::Graph &graph) {
+      for (uint32_t node = 0; node < node_count; node++) {
+        graph.addNode();
+      }
+      for (uint64_t i = 0; i < ends.size(); i++) {
+        graph.addEdge(i / EDGES_PER_NODE, ends[i]);
+      }
+    };
+
+    measure("recursive_graph/add_edges", node_count, [&]() {
+      RecursiveGraph::Graph graph;
+      build(graph);
+    });
+
+    RecursiveGraph::Graph graph;
+    build(graph);
+    uint64_t found = 0;
+    measure("recursive_graph/find_edges", node_count, [&]() {
+      for (uint64_t i = 0; i < ends.size(); i++) {
+        found += graph.findEdge(i / EDGES_PER_NODE, ends[i]) !=
+                 RecursiveGraph::NO_EDGE;
+      }
+    });
+    if (found > 0) {
+      assert(found % ends.size() == 0);
+      printGraphMemory("recursive_graph/find_edges", node_count,
+                       graph.getEdgeCount(), graph.getNodeIndexBytes(),
+                       graph.getEdgeIndexBytes(), graph.getBytes());
+    }
+  }
+
+  // A single input fans out to fanout adders that all feed one output, the
+  // node with the highest fanout and fanin a circuit can have. One op builds
+  // the CircuitGraph, or finds every edge of the input again.
+  void runCircuitGraphBenchmarks(const uint32_t fanout) {
+    CircuitModel circuit;
+    const uint32_t input = circuit.addNode(InputNodeType, 0);
+    const uint32_t output = circuit.addNode(OutputNodeType, 0);
+    for (uint32_t i = 0; i < fanout; i++) {
+      const uint32_t adder = circuit.addNode(AdderType, 0);
+      circuit.addEdge(input, adder);
+      circuit.addEdge(adder, output);
+    }
+
+    measure("circuit_graph/high_fanout", fanout,
+            [&]() { CircuitGraph graph(circuit); });
+
+    CircuitGraph graph(circuit);
+    const RecursiveGraph::Graph &fanouts = graph.getFanoutGraph();
+    uint64_t found = 0;
+    measure("circuit_graph/high_fanout_find", fanout, [&]() {
+      for (uint32_t adder = 2; adder < circuit.getNodeCount(); adder++) {
+        found += fanouts.findEdge(input, adder) != RecursiveGraph::NO_EDGE;
+      }
+    });
+    assert(found % fanout == 0);
+    (void)found;
+  }
+
+public:
+  PerformanceSuite(void) = delete;
+  PerformanceSuite(const char *filter, const double min_batch_ms)
+      : _filter(filter), _min_batch_ns(min_batch_ms * 1.0e6) {}
+
+  void run(void) {
+    // Node labels are single digits, which caps both circuits' degrees.
+    for (const uint32_t degree : {3u, 6u, 9u}) {
+      runCircuitBenchmarks("regular_ap", degree, [&]() {
+        return new IntegerFactorization::RegularAPCircuit(degree);
+      });
+    }
+    for (const uint32_t degree : {4u, 7u, 10u}) {
+      runCircuitBenchmarks("opt01", degree, [&]() {
+        return new IntegerFactorization::Opt01Circuit(degree);
+      });
+    }
+    // Sized by node count, a fixed seed keeps the circuits identical between
+    // runs.
+    for (const uint32_t node_count : {100u, 300u, 1000u}) {
+      const RandomCircuitParameters parameters =
+          getDefaultRandomCircuitParameters(node_count, RANDOM_CIRCUIT_SEED);
+      runCircuitBenchmarks("random", node_count,
+                           [&]() { return new RandomCircuit(parameters); });
+    }
+
+    for (const uint32_t lut_count : {10000u, 1000000u}) {
+      runLutBenchmarks(lut_count);
+    }
+
+    runPackedArrayBenchmarks<12>(1 << 20);
+    runPackedArrayBenchmarks<17>(1 << 20);
+    runPackedArrayBenchmarks<40>(1 << 20);
+
+    runWideningCopyBenchmarks(1 << 20);
+
+    for (const uint32_t node_count : {64u, 1000u, 300000u}) {
+      runRecursiveGraphBenchmarks(node_count);
+    }
+    for (const uint32_t fanout : {1000u, 10000u}) {
+      runCircuitGraphBenchmarks(fanout);
+    }
+
+    const size_t resolutions[][2] = {{1280, 720}, {1920, 1080}, {3840, 2160}};
+    for (const auto &resolution : resolutions) {
+      runFrameBenchmarks(resolution[0], resolution[1]);
+    }
+  }
+
+  inline const std::vector<PerformanceResult> &getResults(void) const {
+    return _results;
+  }
+};
+
+// One result per line, so readResults() gets by without a JSON parser.
+static bool writeResults(const char *path, const PerformanceMachine &machine,
+                         const std::vector<PerformanceResult> &results) {
+  FILE *file = fopen(path, "w");
+  if (file == NULL) {
+    TraceLog(LOG_ERROR, "PERF: could not create %s: %s", path,
+             strerror(errno));
+    return false;
+  }
+  fprintf(file,
+          "{\n  \"machine\": {\"host\": \"%s\", \"cpu_level\": \"%s\"},\n"
+          "  \"results\": [\n",
+          machine.host.c_str(), machine.cpu_level.c_str());
+  for (size_t i = 0; i < results.size(); i++) {
+    const PerformanceResult &result = results[i];
+    fprintf(file,
+            "    {\"name\": \"%s\", \"size\": %lu, \"iterations\": %lu, "
+            "\"best_ns_per_op\": %.1f, \"median_ns_per_op\": %.1f}%s\n",
+            result.name.c_str(), result.size, result.iterations,
+            result.best_ns_per_op, result.median_ns_per_op,
+            i + 1 < results.size() ? "," : "");
+  }
+  fprintf(file, "  ]\n}\n");
+  if (fclose(file) != 0) {
+    TraceLog(LOG_ERROR, "PERF: could not write %s: %s", path,
+             strerror(errno));
+    return false;
+  }
+  return true;
+}
+
+static bool readResults(const char *path, PerformanceMachine &machine,
+                        std::vector<PerformanceResult> &results) {
+  FILE *file = fopen(path, "r");
+  if (file == NULL) {
+    return false;
+  }
+  char line[512];
+  while (fgets(line, sizeof(line), file) != NULL) {
+    char host[256];
+    char cpu_level[32];
+    if (sscanf(line, " \"machine\": {\"host\": \"%255[^\"]\", "
+                     "\"cpu_level\": \"%31[^\"]\"}",
+               host, cpu_level) == 2) {
+      machine = {.host = host, .cpu_level = cpu_level};
+      continue;
+    }
+    char name[128];
+    unsigned long size = 0;
+    unsigned long iterations = 0;
+    double best_ns_per_op = 0.0;
+    double median_ns_per_op = 0.0;
+    if (sscanf(line,
+               " {\"name\": \"%127[^\"]\", \"size\": %lu, \"iterations\": %lu, "
+               "\"best_ns_per_op\": %lf, \"median_ns_per_op\": %lf}",
+               name, &size, &iterations, &best_ns_per_op,
+               &median_ns_per_op) == 5) {
+      results.push_back({.name = name,
+                         .size = size,
+                         .iterations = iterations,
+                         .best_ns_per_op = best_ns_per_op,
+                         .median_ns_per_op = median_ns_per_op});
+    }
+  }
+  fclose(file);
+  return true;
+}
+
+// Best times are compared, they are the least disturbed by other load on the
+// machine. Returns the number of regressions.
+static uint32_t compareResults(const std::vector<PerformanceResult> &results,
+                               const std::vector<PerformanceResult> &baseline,
+                               const double threshold) {
+  uint32_t regressions = 0;
+  for (const auto &result : results) {
+    const auto base = std::find_if(
+        baseline.begin(), baseline.end(), [&](const PerformanceResult &base) {
+          return base.name == result.name && base.size == result.size;
+        });
+    if (base == baseline.end()) {
+      printf("PERF: %-34s size %6lu  not in baseline\n", result.name.c_str(),
+             result.size);
+      continue;
+    }
+    const double ratio = result.best_ns_per_op / base->best_ns_per_op;
+    const bool regressed = ratio > 1.0 + threshold;
+    printf("PERF: %-34s size %6lu  %6.2fx baseline%s\n", result.name.c_str(),
+           result.size, ratio, regressed ? "  REGRESSION" : "");
+    regressions += regressed;
+  }
+  return regressions;
+}
+
+int main(int argc, char **argv) {
+  const char *output_path = NULL;
+  const char *baseline_path = NULL;
+  const char *write_baseline_path = NULL;
+  const char *filter = "";
+  double threshold = 0.25;
+  double min_batch_ms = 50.0;
+  CpuLevel cpu_level = LastCpuLevel;
+
+  for (int i = 1; i < argc; i++) {
+    const bool has_value = i + 1 < argc;
+    if (has_value && strcmp(argv[i], "--output") == 0) {
+      output_path = argv[++i];
+    } else if (has_value && strcmp(argv[i], "--baseline") == 0) {
+      baseline_path = argv[++i];
+    } else if (has_value && strcmp(argv[i], "--write-baseline") == 0) {
+      write_baseline_path = argv[++i];
+    } else if (has_value && strcmp(argv[i], "--threshold") == 0) {
+      threshold = atof(argv[++i]);
+    } else if (has_value && strcmp(argv[i], "--filter") == 0) {
+      filter = argv[++i];
+    } else if (has_value && strcmp(argv[i], "--min-batch-ms") == 0) {
+      min_batch_ms = atof(argv[++i]);
+    } else if (has_value && strcmp(argv[i], "--cpu-level") == 0 &&
+               parseCpuLevel(argv[i + 1], cpu_level)) {
+      i++;
+    } else {
+      fprintf(stderr,
+              "usage: %s [--output path] [--baseline path] "
+              "[--write-baseline path] [--threshold fraction] "
+              "[--filter name] [--min-batch-ms ms] "
+              "[--cpu-level sse4.2|avx2|avx512]\n",
+              argv[0]);
+      return 2;
+    }
+  }
+
+  // A baseline only compares with runs on the same kernels.
+  setCpuLevelLimit(cpu_level);
+  printf("PERF: kernels for %s, the CPU supports %s\n",
+         getCpuLevelName(getCpuLevel()),
+         getCpuLevelName(getDetectedCpuLevel()));
+
+  SetTraceLogLevel(LOG_WARNING);
+  PerformanceSuite suite(filter, min_batch_ms);
+  suite.run();
+
+  const PerformanceMachine machine = getPerformanceMachine();
+  if (output_path != NULL &&
+      !writeResults(output_path, machine, suite.getResults())) {
+    return 2;
+  }
+  if (write_baseline_path != NULL &&
+      !writeResults(write_baseline_path, machine, suite.getResults())) {
+    return 2;
+  }
+
+  if (baseline_path != NULL) {
+    PerformanceMachine baseline_machine;
+    std::vector<PerformanceResult> baseline;
+    if (!readResults(baseline_path, baseline_machine, baseline)) {
+      printf("PERF: no baseline at %s, nothing to compare against\n",
+             baseline_path);
+      return 0;
+    }
+    if (!(baseline_machine == machine)) {
+      printf("PERF: baseline recorded on %s at %s, this is %s at %s, "
+             "nothing to compare against\n",
+             baseline_machine.host.empty() ? "an unknown host"
+                                           : baseline_machine.host.c_str(),
+             baseline_machine.cpu_level.empty()
+                 ? "an unknown level"
+                 : baseline_machine.cpu_level.c_str(),
+             machine.host.c_str(), machine.cpu_level.c_str());
+      return 0;
+    }
+    const uint32_t regressions =
+        compareResults(suite.getResults(), baseline, threshold);
+    if (regressions > 0) {
+      printf("PERF: %u benchmarks more than %.0f%% slower than baseline\n",
+             regressions, threshold * 100.0);
+      return 1;
+    }
+  }
+  return 0;
+}
@@ -0,0 +1,79 @@
+#include "circuit_model/circuit_model_self_test.hpp"
+#include "cpu_dispatch/cpu_dispatch.hpp"
+#include "ffmpeg_rendering/yuv420_converter_self_test.hpp"
+#include "frame_sink/frame_sink_self_test.hpp"
+#include "lut_eval/lut_eval_self_test.hpp"
+#include "packed_array/packed_array_self_test.hpp"
+#include "recursive_graph/recursive_graph_self_test.hpp"
+#include "software_rasterizer/software_rasterizer_self_test.hpp"
+#include "widening_copy/widening_copy_self_test.hpp"
+
+int main(void) {
+  uint32_t failed = 0;
+
+  // Every kernel variant this machine can run, from the best one down.
+  const CpuLevel detected_level = getDetectedCpuLevel();
+  for (int level = detected_level; level >= FirstCpuLevel; level--) {
+    setCpuLevelLimit(static_cast<CpuLevel>(level));
+    printf("kernels for %s\n", getCpuLevelName(getCpuLevel()));
+
+    LutEvalSelfTest lut_eval_self_test;
+    if (!lut_eval_self_test.selfTest()) {
+      fprintf(stderr, "lut_eval self test failed at %s\n",
+              getCpuLevelName(getCpuLevel()));
+      failed++;
+    }
+
+    PackedArraySelfTest packed_array_self_test;
+    if (!packed_array_self_test.selfTest()) {
+      fprintf(stderr, "packed_array self test failed at %s\n",
+              getCpuLevelName(getCpuLevel()));
+      failed++;
+    }
+
+    WideningCopySelfTest widening_copy_self_test;
+    if (!widening_copy_self_test.selfTest()) {
+      fprintf(stderr, "widening_copy self test failed at %s\n",
+              getCpuLevelName(getCpuLevel()));
+      failed++;
+    }
+
+    RecursiveGraphSelfTest recursive_graph_self_test;
+    if (!recursive_graph_self_test.selfTest()) {
+      fprintf(stderr, "recursive_graph self test failed at %s\n",
+              getCpuLevelName(getCpuLevel()));
+      failed++;
+    }
+
+    SoftwareRasterizerSelfTest software_rasterizer_self_test;
+    if (!software_rasterizer_self_test.selfTest()) {
+      fprintf(stderr, "software_rasterizer self test failed at %s\n",
+              getCpuLevelName(getCpuLevel()));
+      failed++;
+    }
+
+    YUV420ConverterSelfTest yuv420_converter_self_test;
+    if (!yuv420_converter_self_test.selfTest()) {
+      fprintf(stderr, "yuv420_converter self test failed at %s\n",
+              getCpuLevelName(getCpuLevel()));
+      failed++;
+    }
+  }
+  setCpuLevelLimit(LastCpuLevel);
+
+  // Nothing below has kernels for more than one level.
+  CircuitModelSelfTest circuit_model_self_test;
+  if (!circuit_model_self_test.selfTest()) {
+    fprintf(stderr, "circuit_model self test failed\n");
+    failed++;
+  }
+
+  FrameSinkSelfTest frame_sink_self_test;
+  if (!frame_sink_self_test.selfTest()) {
+    fprintf(stderr, "frame_sink self test failed\n");
+    failed++;
+  }
+
+  printf("%u unit tests failed\n", failed);
+  return failed == 0 ? 0 : 1;
+}